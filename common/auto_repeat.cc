@@ -0,0 +1,237 @@
+#include "auto_repeat.h"
+
+#include <utility>
+
+namespace hardware_simulator {
+
+RepeatTiming RepeatSchedule::KeyTiming(uint16_t key_code) const {
+    auto it = key_timings_.find(key_code);
+    return it == key_timings_.end() ? default_key_timing_ : it->second;
+}
+
+void RepeatSchedule::KeyDown(uint16_t key_code, TimePoint now) {
+    HeldInput input;
+    input.type = HeldInputType::kKey;
+    input.id = key_code;
+    Press(input, KeyTiming(key_code), now);
+}
+
+bool RepeatSchedule::KeyUp(uint16_t key_code) {
+    return held_.erase(KeyOf(HeldInputType::kKey, key_code)) != 0;
+}
+
+void RepeatSchedule::TouchDown(uint32_t touch_id, int screen_id, double x, double y, TimePoint now) {
+    HeldInput input;
+    input.type = HeldInputType::kTouch;
+    input.id = touch_id;
+    input.screen_id = screen_id;
+    input.x = x;
+    input.y = y;
+    Press(input, touch_timing_, now);
+}
+
+void RepeatSchedule::TouchMove(uint32_t touch_id, int screen_id, double x, double y, TimePoint now) {
+    uint64_t key = KeyOf(HeldInputType::kTouch, touch_id);
+    auto it = held_.find(key);
+    if (it == held_.end()) {
+        return;
+    }
+    Held& held = it->second;
+    held.input.screen_id = screen_id;
+    held.input.x = x;
+    held.input.y = y;
+    Schedule(key, held, now + held.timing.delay);
+}
+
+bool RepeatSchedule::TouchUp(uint32_t touch_id) {
+    return held_.erase(KeyOf(HeldInputType::kTouch, touch_id)) != 0;
+}
+
+void RepeatSchedule::Press(const HeldInput& input, RepeatTiming timing, TimePoint now) {
+    uint64_t key = KeyOf(input.type, input.id);
+    auto inserted = held_.emplace(key, Held());
+    Held& held = inserted.first->second;
+    held.input = input;
+    if (inserted.second) {
+        held.timing = timing;
+        Schedule(key, held, now + timing.delay);
+    }
+}
+
+void RepeatSchedule::Schedule(uint64_t key, Held& held, TimePoint deadline) {
+    held.generation = ++next_generation_;
+    held.deadline = deadline;
+    if (held.timing.interval.count() > 0) {
+        pending_.push({deadline, key, held.generation});
+    }
+}
+
+void RepeatSchedule::Restart(TimePoint now) {
+    for (auto& [key, held] : held_) {
+        Schedule(key, held, now + held.timing.delay);
+    }
+}
+
+std::optional<RepeatSchedule::TimePoint> RepeatSchedule::NextDeadline() {
+    while (!pending_.empty()) {
+        const Pending& top = pending_.top();
+        auto it = held_.find(top.key);
+        if (it != held_.end() && it->second.generation == top.generation) {
+            return top.deadline;
+        }
+        pending_.pop();
+    }
+    return std::nullopt;
+}
+
+void RepeatSchedule::CollectDue(TimePoint now, std::vector<HeldInput>* due) {
+    for (auto deadline = NextDeadline(); deadline && *deadline <= now; deadline = NextDeadline()) {
+        Pending top = pending_.top();
+        pending_.pop();
+        Held& held = held_.find(top.key)->second;
+        due->push_back(held.input);
+
+        TimePoint next = top.deadline + held.timing.interval;
+        if (next <= now) {
+            next = now + held.timing.interval;
+        }
+        Schedule(top.key, held, next);
+    }
+}
+
+std::vector<HeldInput> RepeatSchedule::ReleaseAll() {
+    std::vector<HeldInput> released;
+    released.reserve(held_.size());
+    for (const auto& [key, held] : held_) {
+        released.push_back(held.input);
+    }
+    held_.clear();
+    pending_ = {};
+    return released;
+}
+
+AutoRepeatScheduler::AutoRepeatScheduler(RepeatCallback repeat)
+    : repeat_(std::move(repeat)), thread_(&AutoRepeatScheduler::Run, this) {}
+
+AutoRepeatScheduler::~AutoRepeatScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    changed_.notify_all();
+    thread_.join();
+}
+
+void AutoRepeatScheduler::SetEnabled(bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (enabled_ == enabled) {
+        return;
+    }
+    enabled_ = enabled;
+    if (enabled) {
+        schedule_.Restart(RepeatSchedule::Clock::now());
+        WakeIfEarlier();
+    }
+    // When disabled the thread finds nothing to do at its next deadline and
+    // then waits without one.
+}
+
+void AutoRepeatScheduler::SetDefaultKeyTiming(RepeatTiming timing) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    schedule_.SetDefaultKeyTiming(timing);
+}
+
+void AutoRepeatScheduler::SetKeyTiming(uint16_t key_code, RepeatTiming timing) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    schedule_.SetKeyTiming(key_code, timing);
+}
+
+void AutoRepeatScheduler::SetTouchTiming(RepeatTiming timing) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    schedule_.SetTouchTiming(timing);
+}
+
+void AutoRepeatScheduler::KeyDown(uint16_t key_code) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    schedule_.KeyDown(key_code, RepeatSchedule::Clock::now());
+    WakeIfEarlier();
+}
+
+void AutoRepeatScheduler::KeyUp(uint16_t key_code) {
+    // A stale deadline only costs the thread one early wakeup.
+    std::lock_guard<std::mutex> lock(mutex_);
+    schedule_.KeyUp(key_code);
+}
+
+void AutoRepeatScheduler::TouchDown(uint32_t touch_id, int screen_id, double x, double y) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    schedule_.TouchDown(touch_id, screen_id, x, y, RepeatSchedule::Clock::now());
+    WakeIfEarlier();
+}
+
+void AutoRepeatScheduler::TouchMove(uint32_t touch_id, int screen_id, double x, double y) {
+    // Only ever moves a deadline later, so the thread need not be woken.
+    std::lock_guard<std::mutex> lock(mutex_);
+    schedule_.TouchMove(touch_id, screen_id, x, y, RepeatSchedule::Clock::now());
+}
+
+void AutoRepeatScheduler::TouchUp(uint32_t touch_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    schedule_.TouchUp(touch_id);
+}
+
+bool AutoRepeatScheduler::IsKeyHeld(uint16_t key_code) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return schedule_.IsKeyHeld(key_code);
+}
+
+std::vector<HeldInput> AutoRepeatScheduler::ReleaseAll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return schedule_.ReleaseAll();
+}
+
+uint64_t AutoRepeatScheduler::wakeups() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return wakeups_;
+}
+
+void AutoRepeatScheduler::WakeIfEarlier() {
+    if (!sleeping_ || !enabled_) {
+        return;
+    }
+    auto deadline = schedule_.NextDeadline();
+    if (deadline && (!sleeping_until_ || *deadline < *sleeping_until_)) {
+        changed_.notify_one();
+    }
+}
+
+void AutoRepeatScheduler::Run() {
+    std::vector<HeldInput> due;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        if (enabled_) {
+            schedule_.CollectDue(RepeatSchedule::Clock::now(), &due);
+        }
+        if (!due.empty()) {
+            lock.unlock();
+            for (const auto& input : due) {
+                repeat_(input);
+            }
+            due.clear();
+            lock.lock();
+            continue;
+        }
+
+        sleeping_ = true;
+        sleeping_until_ = enabled_ ? schedule_.NextDeadline() : std::nullopt;
+        if (sleeping_until_) {
+            changed_.wait_until(lock, *sleeping_until_);
+        } else {
+            changed_.wait(lock);
+        }
+        sleeping_ = false;
+        ++wakeups_;
+    }
+}
+
+}  // namespace hardware_simulator
@@ -0,0 +1,186 @@
+#ifndef FLUTTER_PLUGIN_AUTO_REPEAT_H_
+#define FLUTTER_PLUGIN_AUTO_REPEAT_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace hardware_simulator {
+
+// When a held input repeats: first after |delay|, then every |interval|.
+// An interval of zero never repeats.
+struct RepeatTiming {
+    std::chrono::microseconds delay{0};
+    std::chrono::microseconds interval{0};
+};
+
+// Typematic-like defaults for keys, and the keep-alive the Windows touch
+// injection needs so held contacts are not timed out.
+constexpr RepeatTiming kDefaultKeyRepeatTiming{std::chrono::milliseconds(500),
+                                               std::chrono::milliseconds(50)};
+constexpr RepeatTiming kDefaultTouchRepeatTiming{std::chrono::milliseconds(300),
+                                                 std::chrono::milliseconds(300)};
+
+enum class HeldInputType : uint8_t {
+    kKey,
+    kTouch,
+};
+
+// A key or touch contact that is down, as it is repeated.
+struct HeldInput {
+    HeldInputType type = HeldInputType::kKey;
+    uint32_t id = 0;  // Virtual-key code or touch id.
+    int screen_id = 0;
+    double x = 0;
+    double y = 0;
+};
+
+// Held inputs and their repeat deadlines, with time passed in by the caller
+// so it can be driven by a virtual clock. Not thread-safe.
+//
+// Deadlines sit in a min-heap; entries made stale by a release or a restart
+// are skipped when they reach the top, so every operation is O(log n) in
+// the number of held inputs.
+class RepeatSchedule {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+
+    // Timing for keys without their own, and for one key. Applies from the
+    // next press.
+    void SetDefaultKeyTiming(RepeatTiming timing) { default_key_timing_ = timing; }
+    void SetKeyTiming(uint16_t key_code, RepeatTiming timing) { key_timings_[key_code] = timing; }
+    void ClearKeyTiming(uint16_t key_code) { key_timings_.erase(key_code); }
+    RepeatTiming KeyTiming(uint16_t key_code) const;
+    void SetTouchTiming(RepeatTiming timing) { touch_timing_ = timing; }
+
+    // A down for a key that is already held is itself a repeat and keeps the
+    // current schedule.
+    void KeyDown(uint16_t key_code, TimePoint now);
+    bool KeyUp(uint16_t key_code);
+
+    // A held contact repeats at its latest position. Moving it counts as
+    // activity and pushes the next repeat back by the touch delay.
+    void TouchDown(uint32_t touch_id, int screen_id, double x, double y, TimePoint now);
+    void TouchMove(uint32_t touch_id, int screen_id, double x, double y, TimePoint now);
+    bool TouchUp(uint32_t touch_id);
+
+    // Restarts every held input's delay from |now|.
+    void Restart(TimePoint now);
+
+    // Earliest pending repeat, if any.
+    std::optional<TimePoint> NextDeadline();
+
+    // Appends the inputs due at |now| and schedules their next repeat.
+    // Repeats that fell behind are not replayed in a burst; the next one is
+    // an interval after |now|.
+    void CollectDue(TimePoint now, std::vector<HeldInput>* due);
+
+    // Forgets every held input and returns them.
+    std::vector<HeldInput> ReleaseAll();
+
+    bool IsKeyHeld(uint16_t key_code) const {
+        return held_.count(KeyOf(HeldInputType::kKey, key_code)) != 0;
+    }
+    size_t held_count() const { return held_.size(); }
+
+private:
+    struct Held {
+        HeldInput input;
+        RepeatTiming timing;
+        TimePoint deadline;
+        uint64_t generation = 0;
+    };
+    struct Pending {
+        TimePoint deadline;
+        uint64_t key;
+        uint64_t generation;
+
+        bool operator>(const Pending& other) const { return deadline > other.deadline; }
+    };
+
+    static uint64_t KeyOf(HeldInputType type, uint32_t id) {
+        return (static_cast<uint64_t>(type) << 32) | id;
+    }
+    void Press(const HeldInput& input, RepeatTiming timing, TimePoint now);
+    void Schedule(uint64_t key, Held& held, TimePoint deadline);
+
+    RepeatTiming default_key_timing_ = kDefaultKeyRepeatTiming;
+    RepeatTiming touch_timing_ = kDefaultTouchRepeatTiming;
+    std::unordered_map<uint16_t, RepeatTiming> key_timings_;
+
+    std::unordered_map<uint64_t, Held> held_;
+    std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending>> pending_;
+    uint64_t next_generation_ = 0;
+};
+
+// Repeats held keys and touch contacts on its own thread.
+//
+// The thread sleeps on a condition variable until the earliest deadline, and
+// without a timeout while nothing is held or repeating is disabled, so an
+// idle scheduler never wakes up. |repeat| is called on that thread, without
+// the lock held, once per due input; it typically posts the event to the
+// injector.
+class AutoRepeatScheduler {
+public:
+    using RepeatCallback = std::function<void(const HeldInput&)>;
+
+    explicit AutoRepeatScheduler(RepeatCallback repeat);
+    ~AutoRepeatScheduler();
+
+    AutoRepeatScheduler(const AutoRepeatScheduler&) = delete;
+    AutoRepeatScheduler& operator=(const AutoRepeatScheduler&) = delete;
+
+    // Held inputs are still tracked while disabled; enabling restarts their
+    // delays.
+    void SetEnabled(bool enabled);
+
+    void SetDefaultKeyTiming(RepeatTiming timing);
+    void SetKeyTiming(uint16_t key_code, RepeatTiming timing);
+    void SetTouchTiming(RepeatTiming timing);
+
+    void KeyDown(uint16_t key_code);
+    void KeyUp(uint16_t key_code);
+    void TouchDown(uint32_t touch_id, int screen_id, double x, double y);
+    void TouchMove(uint32_t touch_id, int screen_id, double x, double y);
+    void TouchUp(uint32_t touch_id);
+    bool IsKeyHeld(uint16_t key_code) const;
+
+    // Forgets every held input and returns them, so the caller can release
+    // them.
+    std::vector<HeldInput> ReleaseAll();
+
+    // Times the thread woke up, for tests.
+    uint64_t wakeups() const;
+
+private:
+    // Wakes the thread when |schedule_| now has an earlier deadline than the
+    // one it sleeps until. Called with |mutex_| held.
+    void WakeIfEarlier();
+    void Run();
+
+    const RepeatCallback repeat_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    RepeatSchedule schedule_;
+    bool enabled_ = true;
+    bool stopping_ = false;
+    // Whether the thread waits, and for which deadline; unset while it waits
+    // without one.
+    bool sleeping_ = false;
+    std::optional<RepeatSchedule::TimePoint> sleeping_until_;
+    uint64_t wakeups_ = 0;
+    std::thread thread_;
+};
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_AUTO_REPEAT_H_
@@ -0,0 +1,110 @@
+#include "control_plane_executor.h"
+
+namespace hardware_simulator {
+
+ControlPlaneExecutor::ControlPlaneExecutor(size_t worker_count, std::function<void()> wake_platform)
+    : wake_platform_(std::move(wake_platform)) {
+    if (worker_count == 0) {
+        worker_count = 1;
+    }
+    workers_.reserve(worker_count);
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers_.emplace_back(&ControlPlaneExecutor::WorkerLoop, this);
+    }
+}
+
+ControlPlaneExecutor::~ControlPlaneExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_available_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+    // The workers are gone; what is left never started.
+    for (auto& [lane, queue] : lanes_) {
+        for (auto& job : queue) {
+            if (job.cancel) {
+                job.cancel();
+            }
+        }
+    }
+    RunPendingReplies();
+}
+
+void ControlPlaneExecutor::Submit(int lane, std::function<void()> work) {
+    SubmitCancellable(lane, std::move(work), nullptr);
+}
+
+void ControlPlaneExecutor::SubmitCancellable(int lane, std::function<void()> work,
+                                             std::function<void()> cancel) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& queue = lanes_[lane];
+        queue.push_back(Job{std::move(work), std::move(cancel)});
+        // A busy lane is re-queued by its worker when the current job ends.
+        if (queue.size() == 1 && !lane_busy_[lane]) {
+            ready_lanes_.push_back(lane);
+        }
+    }
+    work_available_.notify_one();
+}
+
+void ControlPlaneExecutor::PostReply(std::function<void()> reply) {
+    bool was_empty;
+    {
+        std::lock_guard<std::mutex> lock(reply_mutex_);
+        was_empty = replies_.empty();
+        replies_.push_back(std::move(reply));
+    }
+    // One wake-up covers every reply queued before the platform thread runs.
+    if (was_empty && wake_platform_) {
+        wake_platform_();
+    }
+}
+
+size_t ControlPlaneExecutor::RunPendingReplies() {
+    std::deque<std::function<void()>> replies;
+    {
+        std::lock_guard<std::mutex> lock(reply_mutex_);
+        replies.swap(replies_);
+    }
+    for (auto& reply : replies) {
+        reply();
+    }
+    return replies.size();
+}
+
+void ControlPlaneExecutor::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        work_available_.wait(lock, [this] { return stopping_ || !ready_lanes_.empty(); });
+        if (stopping_) {
+            return;
+        }
+
+        int lane = ready_lanes_.front();
+        ready_lanes_.pop_front();
+        auto& queue = lanes_[lane];
+        std::function<void()> work = std::move(queue.front().work);
+        queue.pop_front();
+        lane_busy_[lane] = true;
+
+        lock.unlock();
+        // An exception escaping the thread would end the host process.
+        try {
+            work();
+        } catch (...) {
+        }
+        lock.lock();
+
+        lane_busy_[lane] = false;
+        if (!lanes_[lane].empty()) {
+            ready_lanes_.push_back(lane);
+            work_available_.notify_one();
+        }
+    }
+}
+
+}  // namespace hardware_simulator
@@ -0,0 +1,97 @@
+#ifndef FLUTTER_PLUGIN_CONTROL_PLANE_EXECUTOR_H_
+#define FLUTTER_PLUGIN_CONTROL_PLANE_EXECUTOR_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace hardware_simulator {
+
+// Runs slow control-plane work (display enumeration, virtual display and
+// controller setup, elevated batch files) on worker threads so the platform
+// thread stays free for input calls.
+//
+// Work is submitted to a lane. Jobs on the same lane run one at a time in
+// submission order, so calls into a subsystem that is not thread-safe keep
+// the order Dart issued them in; different lanes run in parallel.
+//
+// A job that throws is abandoned and its lane goes on; work that owes a reply
+// catches its own exceptions to send one.
+//
+// Replies are queued and run on the platform thread: the executor calls
+// |wake_platform| from a worker whenever the reply queue becomes non-empty,
+// and the platform thread answers by calling RunPendingReplies().
+class ControlPlaneExecutor {
+public:
+    ControlPlaneExecutor(size_t worker_count, std::function<void()> wake_platform);
+    // Platform thread only. Waits for running jobs, runs the |cancel| of each
+    // job that has not started instead of its work, then runs every queued
+    // reply, so no call is left unanswered.
+    ~ControlPlaneExecutor();
+
+    ControlPlaneExecutor(const ControlPlaneExecutor&) = delete;
+    ControlPlaneExecutor& operator=(const ControlPlaneExecutor&) = delete;
+
+    // Runs |work| on a worker, after earlier jobs of the same |lane|.
+    void Submit(int lane, std::function<void()> work);
+
+    // Like Submit, but runs |cancel| on the destroying thread instead of
+    // |work| if the executor is destroyed before |work| starts.
+    void SubmitCancellable(int lane, std::function<void()> work, std::function<void()> cancel);
+
+    // Runs |work| on a worker and then |reply|(result) on the platform thread.
+    template <typename Work, typename Reply>
+    void Submit(int lane, Work work, Reply reply) {
+        using Result = std::invoke_result_t<Work&>;
+        Submit(lane, [this, work = std::move(work), reply = std::move(reply)]() mutable {
+            if constexpr (std::is_void_v<Result>) {
+                work();
+                PostReply(std::move(reply));
+            } else {
+                PostReply([reply = std::move(reply), result = work()]() mutable {
+                    reply(std::move(result));
+                });
+            }
+        });
+    }
+
+    // Queues |reply| for the platform thread. Callable from any thread.
+    void PostReply(std::function<void()> reply);
+
+    // Platform thread only. Runs every queued reply and returns how many.
+    size_t RunPendingReplies();
+
+private:
+    struct Job {
+        std::function<void()> work;
+        std::function<void()> cancel;
+    };
+
+    void WorkerLoop();
+
+    std::function<void()> wake_platform_;
+
+    std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::map<int, std::deque<Job>> lanes_;
+    // Lanes with queued work and no job running, in the order they became so.
+    std::deque<int> ready_lanes_;
+    std::map<int, bool> lane_busy_;
+    bool stopping_ = false;
+
+    std::mutex reply_mutex_;
+    std::deque<std::function<void()>> replies_;
+
+    std::vector<std::thread> workers_;
+};
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_CONTROL_PLANE_EXECUTOR_H_
@@ -0,0 +1,40 @@
+#include "cursor_motion_accumulator.h"
+
+namespace hardware_simulator {
+
+bool CursorMotionAccumulator::Add(const RawMouseSample& sample, CursorMotion* flushed) {
+    bool did_flush = false;
+    const uint32_t changed = sample.buttons_down | sample.buttons_up;
+    if (changed & (pending_.buttons_down | pending_.buttons_up)) {
+        did_flush = Flush(sample.timestamp_us, flushed);
+    }
+
+    if (pending_.sample_count == 0) {
+        pending_.first_timestamp_us = sample.timestamp_us;
+    }
+    pending_.dx += sample.dx;
+    pending_.dy += sample.dy;
+    pending_.wheel += sample.wheel;
+    pending_.hwheel += sample.hwheel;
+    pending_.buttons_down |= sample.buttons_down;
+    pending_.buttons_up |= sample.buttons_up;
+    pending_.last_timestamp_us = sample.timestamp_us;
+    pending_.sample_count++;
+    return did_flush;
+}
+
+bool CursorMotionAccumulator::ShouldFlush(int64_t now_us) const {
+    return HasPending() && now_us - last_flush_us_ >= flush_interval_us_;
+}
+
+bool CursorMotionAccumulator::Flush(int64_t now_us, CursorMotion* out) {
+    if (!HasPending()) {
+        return false;
+    }
+    *out = pending_;
+    pending_ = CursorMotion();
+    last_flush_us_ = now_us;
+    return true;
+}
+
+}  // namespace hardware_simulator
@@ -0,0 +1,80 @@
+#ifndef FLUTTER_PLUGIN_CURSOR_MOTION_ACCUMULATOR_H_
+#define FLUTTER_PLUGIN_CURSOR_MOTION_ACCUMULATOR_H_
+
+#include <cstdint>
+
+namespace hardware_simulator {
+
+// Mouse button bits used by RawMouseSample and CursorMotion. Bit (id - 1)
+// matches the button ids of mousePress / onCursorButton.
+constexpr uint32_t kMouseButtonLeft = 1 << 0;
+constexpr uint32_t kMouseButtonMiddle = 1 << 1;
+constexpr uint32_t kMouseButtonRight = 1 << 2;
+constexpr uint32_t kMouseButtonX1 = 1 << 3;
+constexpr uint32_t kMouseButtonX2 = 1 << 4;
+
+// One packet from the raw mouse device.
+struct RawMouseSample {
+    int32_t dx = 0;
+    int32_t dy = 0;
+    int32_t wheel = 0;         // Vertical wheel, WHEEL_DELTA units.
+    int32_t hwheel = 0;        // Horizontal wheel, WHEEL_DELTA units.
+    uint32_t buttons_down = 0;
+    uint32_t buttons_up = 0;
+    int64_t timestamp_us = 0;
+};
+
+// Everything that happened between two flushes.
+struct CursorMotion {
+    int64_t dx = 0;
+    int64_t dy = 0;
+    int64_t wheel = 0;
+    int64_t hwheel = 0;
+    uint32_t buttons_down = 0;
+    uint32_t buttons_up = 0;
+    uint32_t sample_count = 0;
+    int64_t first_timestamp_us = 0;
+    int64_t last_timestamp_us = 0;
+};
+
+// Coalesces high-rate raw mouse packets (1-8 kHz gaming mice) into at most
+// one delivery per flush interval, so the Dart isolate sees one onCursorMoved
+// per frame instead of one per packet. The first packet after an idle period
+// is due immediately; the interval only throttles what follows it. Deltas and wheel are summed; button
+// transitions are merged as long as no button changes twice, otherwise the
+// pending state is flushed first so press/release order is never lost.
+//
+// Not thread safe; owned by the thread that receives the raw input.
+class CursorMotionAccumulator {
+public:
+    // |flush_interval_us| of 0 flushes on every sample.
+    explicit CursorMotionAccumulator(int64_t flush_interval_us = 0)
+        : flush_interval_us_(flush_interval_us) {}
+
+    void set_flush_interval_us(int64_t interval_us) { flush_interval_us_ = interval_us; }
+    int64_t flush_interval_us() const { return flush_interval_us_; }
+
+    bool HasPending() const { return pending_.sample_count != 0; }
+
+    // Adds |sample|. Returns true when pending state had to be flushed into
+    // |*flushed| before the sample could be merged; deliver it before the
+    // next flush.
+    bool Add(const RawMouseSample& sample, CursorMotion* flushed);
+
+    // True when something is pending and the interval since the previous
+    // flush has elapsed at |now_us|.
+    bool ShouldFlush(int64_t now_us) const;
+
+    // Moves the pending state into |*out| and starts a new interval at
+    // |now_us|. Returns false, leaving |*out| untouched, if nothing is pending.
+    bool Flush(int64_t now_us, CursorMotion* out);
+
+private:
+    int64_t flush_interval_us_;
+    int64_t last_flush_us_ = 0;
+    CursorMotion pending_;
+};
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_CURSOR_MOTION_ACCUMULATOR_H_
@@ -0,0 +1,168 @@
+#include "gesture.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "method_schema.h"
+
+namespace hardware_simulator {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+}  // namespace
+
+bool ParseGestureType(std::string_view name, GestureType* type) {
+    if (name == "pinch") {
+        *type = GestureType::kPinch;
+    } else if (name == "swipe") {
+        *type = GestureType::kSwipe;
+    } else if (name == "drag") {
+        *type = GestureType::kDrag;
+    } else if (name == "longPress") {
+        *type = GestureType::kLongPress;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool MakeGestureSpec(const PerformGestureArgs& args, GestureSpec* spec) {
+    if (!ParseGestureType(args.type, &spec->type)) {
+        return false;
+    }
+    spec->screen_id = args.screen_id;
+    spec->start_x = args.start_x;
+    spec->start_y = args.start_y;
+    spec->end_x = std::isnan(args.end_x) ? args.start_x : args.end_x;
+    spec->end_y = std::isnan(args.end_y) ? args.start_y : args.end_y;
+    spec->center_x = args.center_x;
+    spec->center_y = args.center_y;
+    spec->duration = std::chrono::milliseconds((std::max)(args.duration_ms, 0));
+    int contacts = args.contacts;
+    if (contacts <= 0) {
+        contacts = spec->type == GestureType::kPinch ? 2 : 1;
+    }
+    spec->contacts = (std::min)(contacts, static_cast<int>(kDefaultMaxTouchContacts));
+    spec->rate_hz = args.rate_hz > 0 ? (std::min)(args.rate_hz, kMaxGestureRateHz)
+                                     : kDefaultGestureRateHz;
+    return true;
+}
+
+GesturePlayer::GesturePlayer(const GestureSpec& spec) : spec_(spec) {
+    spec_.contacts = std::clamp(spec_.contacts, 1, static_cast<int>(kDefaultMaxTouchContacts));
+    spec_.rate_hz = std::clamp(spec_.rate_hz, 1, kMaxGestureRateHz);
+    if (spec_.duration.count() < 0) {
+        spec_.duration = std::chrono::microseconds(0);
+    }
+    if (spec_.type == GestureType::kLongPress) {
+        spec_.end_x = spec_.start_x;
+        spec_.end_y = spec_.start_y;
+    }
+    period_ = std::chrono::microseconds(1000000 / spec_.rate_hz);
+    // At least one move frame, so even an instant swipe reaches its end.
+    move_frames_ = (std::max<size_t>)(
+        (spec_.duration.count() + period_.count() - 1) / period_.count(), 1);
+    // A drag holds still for a frame before lifting, so the target sees it
+    // come to rest instead of a fling.
+    up_time_ = spec_.duration;
+    if (spec_.type == GestureType::kDrag) {
+        up_time_ += period_;
+    }
+    for (int i = 0; i < spec_.contacts; ++i) {
+        updates_[i].screen_id = spec_.screen_id;
+        updates_[i].touch_id = kGestureTouchIdBase + static_cast<uint32_t>(i);
+    }
+}
+
+bool GesturePlayer::Advance(std::chrono::microseconds elapsed, InputSink& sink) {
+    if (done_) {
+        return false;
+    }
+    if (!down_) {
+        down_ = true;
+        Inject(TouchUpdateType::kDown, 0, sink);
+    }
+    size_t due = move_frames_;
+    if (elapsed < spec_.duration) {
+        due = (std::min)(static_cast<size_t>((std::max<int64_t>)(elapsed.count(), 0) /
+                                             period_.count()),
+                         move_frames_);
+    }
+    if (due > moved_) {
+        moved_ = due;
+        progress_ = FrameProgress(due);
+        Inject(TouchUpdateType::kMove, progress_, sink);
+    }
+    if (moved_ == move_frames_ && elapsed >= up_time_) {
+        done_ = true;
+        Inject(TouchUpdateType::kUp, progress_, sink);
+    }
+    return !done_;
+}
+
+std::chrono::microseconds GesturePlayer::NextFrameTime() const {
+    if (!down_) {
+        return std::chrono::microseconds(0);
+    }
+    if (moved_ < move_frames_) {
+        return (std::min)(period_ * static_cast<int64_t>(moved_ + 1), spec_.duration);
+    }
+    return up_time_;
+}
+
+void GesturePlayer::Cancel(InputSink& sink) {
+    if (!down_ || done_) {
+        return;
+    }
+    done_ = true;
+    Inject(TouchUpdateType::kUp, progress_, sink);
+}
+
+double GesturePlayer::FrameProgress(size_t frame) const {
+    if (spec_.duration.count() == 0) {
+        return 1;
+    }
+    std::chrono::microseconds at =
+        (std::min)(period_ * static_cast<int64_t>(frame), spec_.duration);
+    return static_cast<double>(at.count()) / spec_.duration.count();
+}
+
+void GesturePlayer::Inject(TouchUpdateType type, double progress, InputSink& sink) {
+    double x = spec_.start_x + (spec_.end_x - spec_.start_x) * progress;
+    double y = spec_.start_y + (spec_.end_y - spec_.start_y) * progress;
+    int count = spec_.contacts;
+    for (int i = 0; i < count; ++i) {
+        TouchUpdate& update = updates_[i];
+        update.type = type;
+        if (spec_.type == GestureType::kPinch) {
+            // Contact 0 follows the path; the others are it turned around the
+            // center by equal steps.
+            double angle = 2 * kPi * i / count;
+            double dx = x - spec_.center_x;
+            double dy = y - spec_.center_y;
+            update.x = spec_.center_x + dx * std::cos(angle) - dy * std::sin(angle);
+            update.y = spec_.center_y + dx * std::sin(angle) + dy * std::cos(angle);
+        } else {
+            update.x = x + (i - (count - 1) / 2.0) * kGestureContactSpacing;
+            update.y = y;
+        }
+    }
+    sink.TouchFrame(updates_, count);
+    ++frames_injected_;
+}
+
+size_t PlayGesture(GesturePlayer& player, InputSink& sink, const GestureWait& wait) {
+    std::chrono::microseconds at(0);
+    while (player.Advance(at, sink)) {
+        at = player.NextFrameTime();
+        if (!wait(at)) {
+            player.Cancel(sink);
+            break;
+        }
+    }
+    return player.frames_injected();
+}
+
+}  // namespace hardware_simulator
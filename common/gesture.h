@@ -0,0 +1,109 @@
+#ifndef FLUTTER_PLUGIN_GESTURE_H_
+#define FLUTTER_PLUGIN_GESTURE_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+#include "input_sink.h"
+#include "touch_contact_table.h"
+
+namespace hardware_simulator {
+
+struct PerformGestureArgs;
+
+enum class GestureType : uint8_t {
+    kPinch,      // Contacts spread evenly around a center, scaled and turned
+                 // as contact 0 goes from start to end.
+    kSwipe,      // Contacts move from start to end and lift at speed.
+    kDrag,       // Like a swipe, but the contacts rest at the end before lifting.
+    kLongPress,  // Contacts hold still at start for the duration.
+};
+
+// Parses "pinch", "swipe", "drag" or "longPress".
+bool ParseGestureType(std::string_view name, GestureType* type);
+
+constexpr int kDefaultGestureRateHz = 120;
+constexpr int kMaxGestureRateHz = 1000;
+
+// Gesture contacts use touch ids from here up, clear of the small ids
+// touchEvent callers pick.
+constexpr uint32_t kGestureTouchIdBase = 0xFFFFFF00u;
+
+// Horizontal distance between the contacts of a multi-finger swipe, drag or
+// long press, as a fraction of the screen.
+constexpr double kGestureContactSpacing = 0.03;
+
+// A gesture in screen fractions of |screen_id|.
+struct GestureSpec {
+    GestureType type = GestureType::kSwipe;
+    int screen_id = 0;
+    double start_x = 0;
+    double start_y = 0;
+    double end_x = 0;
+    double end_y = 0;
+    double center_x = 0.5;
+    double center_y = 0.5;
+    std::chrono::microseconds duration{0};
+    int contacts = 1;
+    int rate_hz = kDefaultGestureRateHz;
+};
+
+// Fills |spec| from performGesture arguments: a missing end is the start,
+// contacts are clamped to [1, kDefaultMaxTouchContacts] (2 for a pinch when
+// omitted), the rate to [1, kMaxGestureRateHz]. Returns false for an unknown
+// gesture type.
+bool MakeGestureSpec(const PerformGestureArgs& args, GestureSpec* spec);
+
+// Plays a gesture as touch frames on a fixed schedule: every contact goes
+// down at 0, a move frame follows every 1/rate_hz up to the duration, then
+// every contact lifts. The caller supplies the time, so the schedule is the
+// same whatever clock drives it. Not thread-safe.
+class GesturePlayer {
+public:
+    explicit GesturePlayer(const GestureSpec& spec);
+
+    // Injects into |sink| what is due |elapsed| after the start: the downs on
+    // the first call, then the latest move frame due, then the ups once they
+    // are due too. Frames that fell behind the clock are skipped, not
+    // replayed in a burst. Returns false once the contacts are up.
+    bool Advance(std::chrono::microseconds elapsed, InputSink& sink);
+
+    // When the next frame is due, counted from the start.
+    std::chrono::microseconds NextFrameTime() const;
+
+    // Lifts the contacts where they are, if they are down.
+    void Cancel(InputSink& sink);
+
+    bool done() const { return done_; }
+    size_t frames_injected() const { return frames_injected_; }
+
+private:
+    double FrameProgress(size_t frame) const;
+    void Inject(TouchUpdateType type, double progress, InputSink& sink);
+
+    GestureSpec spec_;
+    std::chrono::microseconds period_;
+    std::chrono::microseconds up_time_;
+    size_t move_frames_ = 0;
+    size_t moved_ = 0;
+    double progress_ = 0;
+    bool down_ = false;
+    bool done_ = false;
+    size_t frames_injected_ = 0;
+    TouchUpdate updates_[kDefaultMaxTouchContacts];
+};
+
+// Waits until |at| after the gesture started. Returns false to cancel it.
+using GestureWait = std::function<bool(std::chrono::microseconds at)>;
+
+// Plays |player| into |sink| to the end, calling |wait| before every frame
+// after the first. A cancelled gesture lifts its contacts. Returns how many
+// frames were injected.
+size_t PlayGesture(GesturePlayer& player, InputSink& sink, const GestureWait& wait);
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_GESTURE_H_
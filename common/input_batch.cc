@@ -0,0 +1,90 @@
+#include "input_batch.h"
+
+#include <cstring>
+
+#include "touch_frame.h"
+
+namespace hardware_simulator {
+
+InputBatchStatus DecodeInputBatch(const uint8_t* data, size_t size, InputSink& sink) {
+    if (!data || size < kInputBatchHeaderSize) {
+        return InputBatchStatus::kTruncated;
+    }
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    memcpy(&magic, data, sizeof(magic));
+    memcpy(&version, data + 4, sizeof(version));
+    memcpy(&count, data + 6, sizeof(count));
+
+    if (magic != kInputBatchMagic) {
+        return InputBatchStatus::kBadMagic;
+    }
+    if (version != kInputBatchVersion) {
+        return InputBatchStatus::kUnsupportedVersion;
+    }
+    if (size < kInputBatchHeaderSize + static_cast<size_t>(count) * kInputRecordSize) {
+        return InputBatchStatus::kTruncated;
+    }
+
+    // Consecutive pen moves on one screen go to the sink as one run, so it
+    // can convert and inject them together.
+    PenRunBuilder pen_run;
+
+    // Touch updates go to the sink as frames, ending at a record flagged
+    // kInputRecordFrameEnd, at any other input and at the end of the message.
+    TouchFrameBuilder touch_frame;
+
+    // The message buffer has no alignment guarantee, so copy each record onto
+    // the stack rather than casting in place.
+    const uint8_t* cursor = data + kInputBatchHeaderSize;
+    for (uint16_t i = 0; i < count; ++i, cursor += kInputRecordSize) {
+        InputRecord record;
+        memcpy(&record, cursor, kInputRecordSize);
+        const InputRecordType type = static_cast<InputRecordType>(record.type);
+        if ((type == InputRecordType::kTouchEvent && (record.flags & kInputRecordRepeat) == 0) ||
+            type == InputRecordType::kTouchMove) {
+            pen_run.Commit(sink);
+            TouchUpdate update;
+            if (type == InputRecordType::kTouchMove) {
+                update.type = TouchUpdateType::kMove;
+            } else {
+                update.type = (record.flags & kInputRecordDown) != 0 ? TouchUpdateType::kDown
+                                                                     : TouchUpdateType::kUp;
+            }
+            update.screen_id = record.screen_id;
+            update.touch_id = record.touch_id;
+            update.x = record.x;
+            update.y = record.y;
+            touch_frame.Stage(update, sink);
+            if ((record.flags & kInputRecordFrameEnd) != 0) {
+                touch_frame.Commit(sink);
+            }
+            continue;
+        }
+        touch_frame.Commit(sink);
+        if (!pen_run.Stage(record, sink)) {
+            pen_run.Commit(sink);
+            DispatchInputRecord(record, sink);
+        }
+    }
+    pen_run.Commit(sink);
+    touch_frame.Commit(sink);
+    return InputBatchStatus::kOk;
+}
+
+void EncodeInputBatch(const InputRecord* records, size_t count, std::vector<uint8_t>* out) {
+    const uint16_t record_count = static_cast<uint16_t>(count);
+    out->resize(kInputBatchHeaderSize + record_count * kInputRecordSize);
+
+    uint8_t* cursor = out->data();
+    memcpy(cursor, &kInputBatchMagic, sizeof(kInputBatchMagic));
+    memcpy(cursor + 4, &kInputBatchVersion, sizeof(kInputBatchVersion));
+    memcpy(cursor + 6, &record_count, sizeof(record_count));
+    if (record_count > 0) {
+        memcpy(cursor + kInputBatchHeaderSize, records, record_count * kInputRecordSize);
+    }
+}
+
+}  // namespace hardware_simulator
@@ -0,0 +1,47 @@
+#ifndef FLUTTER_PLUGIN_INPUT_BATCH_H_
+#define FLUTTER_PLUGIN_INPUT_BATCH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "input_record.h"
+#include "input_sink.h"
+
+namespace hardware_simulator {
+
+// Binary message channel carrying many input events per platform-channel
+// crossing. Dart sends raw bytes with BinaryCodec; the plugin decodes them in
+// place without building any EncodableValue.
+//
+// Message layout (little-endian):
+//   uint32 magic    kInputBatchMagic ("HSIB")
+//   uint16 version  kInputBatchVersion
+//   uint16 count    number of records that follow
+//   InputRecord records[count]
+constexpr char kInputBatchChannel[] = "hardware_simulator/input_batch";
+constexpr uint32_t kInputBatchMagic = 0x42495348;
+constexpr uint16_t kInputBatchVersion = 1;
+constexpr size_t kInputBatchHeaderSize = 8;
+
+enum class InputBatchStatus {
+    kOk = 0,
+    kTruncated,        // Shorter than the header or the advertised records.
+    kBadMagic,
+    kUnsupportedVersion,
+};
+
+// Validates the whole message first, then feeds every record to |sink| in
+// order. Nothing is dispatched unless the message is well formed. Runs of
+// pen moves on one screen arrive as InputSink::PenMoveBatch calls, and touch
+// updates as InputSink::TouchFrame calls: one frame per message unless a
+// record ends it early with kInputRecordFrameEnd (see TouchFrameBuilder).
+InputBatchStatus DecodeInputBatch(const uint8_t* data, size_t size, InputSink& sink);
+
+// Serializes up to 65535 |records| into the layout above. Used by tests and
+// benchmarks; the Dart side has its own encoder.
+void EncodeInputBatch(const InputRecord* records, size_t count, std::vector<uint8_t>* out);
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_INPUT_BATCH_H_
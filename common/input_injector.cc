@@ -0,0 +1,367 @@
+#include "input_injector.h"
+
+namespace hardware_simulator {
+
+namespace {
+
+uint32_t RoundUpToPowerOfTwo(uint32_t value) {
+    uint32_t result = 2;
+    while (result < value && result < (1u << 31)) {
+        result <<= 1;
+    }
+    return result;
+}
+
+// Marks where a PostTask() task runs. Outside the wire protocol's types;
+// only the injector itself queues it.
+constexpr uint8_t kTaskRecordType = 0xff;
+
+InputRecord MakeRecord(InputRecordType type) {
+    InputRecord record = {};
+    record.type = static_cast<uint8_t>(type);
+    return record;
+}
+
+}  // namespace
+
+InputQueue::InputQueue(uint32_t capacity)
+    : capacity_(RoundUpToPowerOfTwo(capacity)),
+      mask_(capacity_ - 1),
+      cells_(new Cell[capacity_]) {
+    for (uint32_t i = 0; i < capacity_; ++i) {
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool InputQueue::TryPush(const InputRecord& record) {
+    uint64_t position = enqueue_.value.load(std::memory_order_relaxed);
+    while (true) {
+        Cell& cell = cells_[position & mask_];
+        uint64_t sequence = cell.sequence.load(std::memory_order_acquire);
+        int64_t lap = static_cast<int64_t>(sequence - position);
+        if (lap == 0) {
+            // The cell is free for this lap; claim it.
+            if (enqueue_.value.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                cell.record = record;
+                cell.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (lap < 0) {
+            // The consumer has not freed this cell from the previous lap.
+            return false;
+        } else {
+            // Another producer claimed it first.
+            position = enqueue_.value.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool InputQueue::TryPop(InputRecord* record) {
+    uint64_t position = dequeue_.value.load(std::memory_order_relaxed);
+    Cell& cell = cells_[position & mask_];
+    if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+        return false;
+    }
+    *record = cell.record;
+    // Frees the cell for the producers' next lap.
+    cell.sequence.store(position + capacity_, std::memory_order_release);
+    dequeue_.value.store(position + 1, std::memory_order_relaxed);
+    return true;
+}
+
+bool InputQueue::IsEmpty() const {
+    uint64_t position = dequeue_.value.load(std::memory_order_relaxed);
+    return cells_[position & mask_].sequence.load(std::memory_order_acquire) != position + 1;
+}
+
+InputInjector::InputInjector(InputSink& sink, uint32_t capacity, int spin_iterations)
+    : queue_(capacity),
+      sink_(sink),
+      spin_iterations_(std::thread::hardware_concurrency() > 1 ? spin_iterations : 0),
+      thread_(&InputInjector::Run, this) {}
+
+InputInjector::~InputInjector() {
+    Stop();
+}
+
+void InputInjector::Post(const InputRecord& record) {
+    if (stopping_.load(std::memory_order_acquire)) {
+        return;
+    }
+    // Counted before the push so WaitUntilIdle() never undercounts what is
+    // ahead of a caller's own records.
+    posted_.fetch_add(1);
+    while (!queue_.TryPush(record)) {
+        Wake();
+        std::this_thread::yield();
+    }
+    Wake();
+}
+
+void InputInjector::PostTask(std::function<void()> task) {
+    if (stopping_.load(std::memory_order_acquire)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    InputRecord marker = {};
+    marker.type = kTaskRecordType;
+    Post(marker);
+}
+
+void InputInjector::RunTask() {
+    std::function<void()> task;
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex_);
+        if (tasks_.empty()) {
+            return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+    }
+    task();
+}
+
+void InputInjector::Dispatch(const InputRecord& record) {
+    if (record.type == kTaskRecordType) {
+        RunTask();
+    } else {
+        DispatchInputRecord(record, sink_);
+    }
+}
+
+void InputInjector::WaitUntilIdle() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    const uint64_t target = posted_.load();
+    idle_waiters_.fetch_add(1);
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait(lock, [this, target] {
+            return injected_.load() >= target || stopping_.load();
+        });
+    }
+    idle_waiters_.fetch_sub(1);
+}
+
+void InputInjector::Stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_.store(true);
+        wake_.notify_one();
+        idle_.notify_all();
+    }
+    thread_.join();
+}
+
+void InputInjector::Wake() {
+    // Pairs with the fence in Run(): either the injector sees the new record
+    // before parking, or we see parked_ and wake it.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (parked_.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wake_.notify_one();
+    }
+}
+
+void InputInjector::Run() {
+    InputRecord record;
+    // Pen moves are held here until their run ends, so a PenMoveBatch posted
+    // by QueuedInputSink reaches the sink as one call. They count as injected
+    // only once the run is committed.
+    PenRunBuilder pen_run;
+    int idle = 0;
+    auto commit_pen_run = [&] {
+        const uint64_t staged = pen_run.size();
+        pen_run.Commit(sink_);
+        return staged;
+    };
+    auto count_injected = [&](uint64_t count) {
+        if (count == 0) {
+            return;
+        }
+        injected_.fetch_add(count);
+        if (idle_waiters_.load() > 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            idle_.notify_all();
+        }
+    };
+    while (true) {
+        if (queue_.TryPop(&record)) {
+            const uint64_t before = pen_run.size();
+            if (pen_run.Stage(record, sink_)) {
+                // Staging commits the run when it fills up, or ends with this
+                // record; everything staged before it then went to the sink.
+                count_injected(pen_run.empty() ? before + 1 : before + 1 - pen_run.size());
+            } else {
+                const uint64_t staged = commit_pen_run();
+                Dispatch(record);
+                count_injected(staged + 1);
+            }
+            idle = 0;
+            continue;
+        }
+        if (stopping_.load(std::memory_order_acquire)) {
+            break;
+        }
+        if (++idle < spin_iterations_) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // A run whose end never came, e.g. from a producer that posted pen
+        // moves one at a time, goes out before the injector parks.
+        count_injected(commit_pen_run());
+        std::unique_lock<std::mutex> lock(mutex_);
+        parked_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        wake_.wait(lock, [this] {
+            return !queue_.IsEmpty() || stopping_.load(std::memory_order_relaxed);
+        });
+        parked_.store(false, std::memory_order_relaxed);
+        idle = 0;
+    }
+    // Records queued before Stop() are still injected.
+    while (queue_.TryPop(&record)) {
+        if (!pen_run.Stage(record, sink_)) {
+            pen_run.Commit(sink_);
+            Dispatch(record);
+        }
+    }
+    pen_run.Commit(sink_);
+}
+
+void QueuedInputSink::KeyEvent(uint16_t key_code, bool is_down) {
+    InputRecord record = MakeRecord(InputRecordType::kKey);
+    record.code = key_code;
+    record.flags = is_down ? kInputRecordDown : uint8_t{0};
+    injector_.Post(record);
+}
+
+void QueuedInputSink::MouseMoveRelative(double dx, double dy) {
+    InputRecord record = MakeRecord(InputRecordType::kMouseMoveRelative);
+    record.x = dx;
+    record.y = dy;
+    injector_.Post(record);
+}
+
+void QueuedInputSink::MouseMoveAbsolute(double x, double y, int screen_id) {
+    InputRecord record = MakeRecord(InputRecordType::kMouseMoveAbsolute);
+    record.x = x;
+    record.y = y;
+    record.screen_id = screen_id;
+    injector_.Post(record);
+}
+
+void QueuedInputSink::MouseButton(int button_id, bool is_down) {
+    InputRecord record = MakeRecord(InputRecordType::kMouseButton);
+    record.code = static_cast<uint16_t>(button_id);
+    record.flags = is_down ? kInputRecordDown : uint8_t{0};
+    injector_.Post(record);
+}
+
+void QueuedInputSink::MouseScroll(double dx, double dy) {
+    InputRecord record = MakeRecord(InputRecordType::kMouseScroll);
+    record.x = dx;
+    record.y = dy;
+    injector_.Post(record);
+}
+
+void QueuedInputSink::TouchEvent(int screen_id, double x, double y, uint32_t touch_id, bool is_down) {
+    TouchUpdate update;
+    update.type = is_down ? TouchUpdateType::kDown : TouchUpdateType::kUp;
+    update.screen_id = screen_id;
+    update.touch_id = touch_id;
+    update.x = x;
+    update.y = y;
+    TouchFrame(&update, 1);
+}
+
+void QueuedInputSink::TouchMove(int screen_id, double x, double y, uint32_t touch_id) {
+    TouchUpdate update;
+    update.screen_id = screen_id;
+    update.touch_id = touch_id;
+    update.x = x;
+    update.y = y;
+    TouchFrame(&update, 1);
+}
+
+void QueuedInputSink::PenEvent(int screen_id, double x, double y, bool is_down, bool has_button,
+                               double pressure, double rotation, double tilt) {
+    InputRecord record = MakeRecord(InputRecordType::kPenEvent);
+    record.screen_id = screen_id;
+    record.x = x;
+    record.y = y;
+    record.flags = static_cast<uint8_t>((is_down ? kInputRecordDown : 0) | (has_button ? kInputRecordButton : 0));
+    record.pressure = static_cast<float>(pressure);
+    record.rotation = static_cast<float>(rotation);
+    record.tilt = static_cast<float>(tilt);
+    injector_.Post(record);
+}
+
+void QueuedInputSink::PenMove(int screen_id, double x, double y, bool has_button,
+                              double pressure, double rotation, double tilt) {
+    PenSample sample;
+    sample.x = x;
+    sample.y = y;
+    sample.has_button = has_button;
+    sample.pressure = static_cast<float>(pressure);
+    sample.rotation = static_cast<float>(rotation);
+    sample.tilt = static_cast<float>(tilt);
+    PenMoveBatch(screen_id, &sample, 1);
+}
+
+void QueuedInputSink::PenMoveBatch(int screen_id, const PenSample* samples, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const PenSample& sample = samples[i];
+        InputRecord record = MakeRecord(InputRecordType::kPenMove);
+        record.screen_id = screen_id;
+        record.x = sample.x;
+        record.y = sample.y;
+        record.flags = static_cast<uint8_t>((sample.has_button ? kInputRecordButton : 0) |
+                                            (i + 1 == count ? kInputRecordFrameEnd : 0));
+        record.pressure = sample.pressure;
+        record.rotation = sample.rotation;
+        record.tilt = sample.tilt;
+        injector_.Post(record);
+    }
+}
+
+void QueuedInputSink::TouchFrame(const TouchUpdate* updates, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const TouchUpdate& update = updates[i];
+        InputRecord record = MakeRecord(update.type == TouchUpdateType::kMove
+                                            ? InputRecordType::kTouchMove
+                                            : InputRecordType::kTouchEvent);
+        record.screen_id = update.screen_id;
+        record.x = update.x;
+        record.y = update.y;
+        record.touch_id = update.touch_id;
+        record.flags = static_cast<uint8_t>(
+            (update.type == TouchUpdateType::kDown ? kInputRecordDown : 0) |
+            (i + 1 == count ? kInputRecordFrameEnd : 0));
+        injector_.Post(record);
+    }
+}
+
+void QueuedInputSink::KeyRepeat(uint16_t key_code) {
+    InputRecord record = MakeRecord(InputRecordType::kKey);
+    record.code = key_code;
+    record.flags = kInputRecordDown | kInputRecordRepeat;
+    injector_.Post(record);
+}
+
+void QueuedInputSink::TouchRepeat(uint32_t touch_id) {
+    InputRecord record = MakeRecord(InputRecordType::kTouchEvent);
+    record.touch_id = touch_id;
+    record.flags = kInputRecordDown | kInputRecordRepeat;
+    injector_.Post(record);
+}
+
+}  // namespace hardware_simulator
@@ -0,0 +1,165 @@
+#ifndef FLUTTER_PLUGIN_INPUT_INJECTOR_H_
+#define FLUTTER_PLUGIN_INPUT_INJECTOR_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "input_record.h"
+#include "input_sink.h"
+
+namespace hardware_simulator {
+
+// Bounded lock-free multi-producer/single-consumer queue of InputRecords.
+//
+// Each cell carries a sequence number that tells a producer whether the cell
+// is free for the current lap and tells the consumer whether it has been
+// published. Producers claim a cell with one CAS on the enqueue counter and
+// then fill it without waiting on each other.
+class InputQueue {
+public:
+    // |capacity| is rounded up to a power of two, at least 2.
+    explicit InputQueue(uint32_t capacity);
+
+    InputQueue(const InputQueue&) = delete;
+    InputQueue& operator=(const InputQueue&) = delete;
+
+    uint32_t capacity() const { return capacity_; }
+
+    // Any thread. Returns false when the queue is full.
+    bool TryPush(const InputRecord& record);
+
+    // Consumer thread only. Returns false when nothing is published.
+    bool TryPop(InputRecord* record);
+    bool IsEmpty() const;
+
+private:
+    struct Cell {
+        std::atomic<uint64_t> sequence;
+        InputRecord record;
+    };
+
+    // Explicit padding rather than alignas, which MSVC warns about at /W4.
+    struct PaddedCounter {
+        char before[64];
+        std::atomic<uint64_t> value{0};
+        char after[56];
+    };
+
+    const uint32_t capacity_;
+    const uint32_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+
+    PaddedCounter enqueue_;
+    PaddedCounter dequeue_;
+};
+
+// The one thread that injects input. Producers (the platform thread, the
+// input ring consumer, timers) Post() records and return immediately; the
+// injector dispatches them to |sink| in the order they were queued, so slow
+// or retried OS injection calls never stall the caller, and per-thread OS
+// state such as the input desktop belongs to a single thread.
+//
+// Like InputRingConsumer it spins briefly after the last record and then
+// parks until the next Post().
+class InputInjector {
+public:
+    static constexpr uint32_t kDefaultCapacity = 4096;
+    static constexpr int kDefaultSpinIterations = 4096;
+
+    explicit InputInjector(InputSink& sink,
+                           uint32_t capacity = kDefaultCapacity,
+                           int spin_iterations = kDefaultSpinIterations);
+    ~InputInjector();
+
+    InputInjector(const InputInjector&) = delete;
+    InputInjector& operator=(const InputInjector&) = delete;
+
+    // Any thread. Input is not dropped while the injector runs: when the queue
+    // is full the caller yields until there is room. Ignored after Stop().
+    void Post(const InputRecord& record);
+
+    // Any thread. Runs |task| on the injector thread after the records posted
+    // before it, for work on state the injector owns, such as the platform
+    // sink's devices. Counts as one record for WaitUntilIdle(). Ignored after
+    // Stop().
+    void PostTask(std::function<void()> task);
+
+    // Blocks until every record posted before the call has been injected.
+    // For the rare calls that have to run after queued input on the caller's
+    // thread, such as releasing everything that is held down. Must not be
+    // called from the sink.
+    void WaitUntilIdle();
+
+    // Injects what is already queued and joins the thread.
+    void Stop();
+
+private:
+    void Run();
+    void Wake();
+    // Dispatches |record| to |sink_|, or runs the next task for a marker.
+    void Dispatch(const InputRecord& record);
+    void RunTask();
+
+    InputQueue queue_;
+    InputSink& sink_;
+    const int spin_iterations_;
+
+    // Tasks in PostTask() order; each has a marker record in |queue_|.
+    std::mutex tasks_mutex_;
+    std::deque<std::function<void()>> tasks_;
+
+    std::atomic<uint64_t> posted_{0};
+    std::atomic<uint64_t> injected_{0};
+    std::atomic<int> idle_waiters_{0};
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    std::atomic<bool> parked_{false};
+    std::atomic<bool> stopping_{false};
+    std::thread thread_;
+};
+
+// InputSink that turns each call into an InputRecord and posts it to an
+// InputInjector. Hand this to the method channel, the batch channel and the
+// input ring so they all feed the injector thread.
+//
+// Every touch call posts a whole frame: the last record of a TouchFrame, and
+// each single TouchEvent or TouchMove, carries kInputRecordFrameEnd. So
+// FlushTouchFrame has nothing to do here. Pen moves are marked the same way,
+// the last sample of a PenMoveBatch and each single PenMove, and the injector
+// hands each run to its sink as one PenMoveBatch.
+class QueuedInputSink : public InputSink {
+public:
+    explicit QueuedInputSink(InputInjector& injector) : injector_(injector) {}
+
+    void KeyEvent(uint16_t key_code, bool is_down) override;
+    void MouseMoveRelative(double dx, double dy) override;
+    void MouseMoveAbsolute(double x, double y, int screen_id) override;
+    void MouseButton(int button_id, bool is_down) override;
+    void MouseScroll(double dx, double dy) override;
+    void TouchEvent(int screen_id, double x, double y, uint32_t touch_id, bool is_down) override;
+    void TouchMove(int screen_id, double x, double y, uint32_t touch_id) override;
+    void PenEvent(int screen_id, double x, double y, bool is_down, bool has_button,
+                  double pressure, double rotation, double tilt) override;
+    void PenMove(int screen_id, double x, double y, bool has_button,
+                 double pressure, double rotation, double tilt) override;
+    void PenMoveBatch(int screen_id, const PenSample* samples, size_t count) override;
+    void TouchFrame(const TouchUpdate* updates, size_t count) override;
+    void KeyRepeat(uint16_t key_code) override;
+    void TouchRepeat(uint32_t touch_id) override;
+
+private:
+    InputInjector& injector_;
+};
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_INPUT_INJECTOR_H_
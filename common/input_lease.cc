@@ -0,0 +1,111 @@
+#include "input_lease.h"
+
+#include <utility>
+
+namespace hardware_simulator {
+
+void InputLease::Start(std::chrono::microseconds timeout, TimePoint now) {
+    timeout_ = timeout.count() > 0 ? timeout : std::chrono::microseconds(0);
+    renewed_ = now;
+    lapsed_ = false;
+}
+
+void InputLease::Renew(TimePoint now) {
+    if (now > renewed_) {
+        renewed_ = now;
+        lapsed_ = false;
+    }
+}
+
+std::optional<InputLease::TimePoint> InputLease::Deadline() const {
+    if (!armed() || lapsed_) {
+        return std::nullopt;
+    }
+    return renewed_ + timeout_;
+}
+
+bool InputLease::Expire(TimePoint now) {
+    std::optional<TimePoint> deadline = Deadline();
+    if (!deadline || now < *deadline) {
+        return false;
+    }
+    lapsed_ = true;
+    return true;
+}
+
+InputLeaseWatchdog::InputLeaseWatchdog(ExpiredCallback expired)
+    : expired_(std::move(expired)), thread_(&InputLeaseWatchdog::Run, this) {}
+
+InputLeaseWatchdog::~InputLeaseWatchdog() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    changed_.notify_all();
+    thread_.join();
+}
+
+void InputLeaseWatchdog::Start(std::chrono::microseconds timeout) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        InputLease::TimePoint now = InputLease::Clock::now();
+        heartbeat_.store(now.time_since_epoch().count(), std::memory_order_relaxed);
+        lease_.Start(timeout, now);
+        lapsed_.store(false, std::memory_order_release);
+    }
+    changed_.notify_all();
+}
+
+void InputLeaseWatchdog::Renew() {
+    InputLease::TimePoint now = InputLease::Clock::now();
+    heartbeat_.store(now.time_since_epoch().count(), std::memory_order_relaxed);
+    if (!lapsed_.load(std::memory_order_acquire)) {
+        return;
+    }
+    // The thread waits without a deadline while lapsed; give it one.
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lease_.Renew(now);
+        lapsed_.store(false, std::memory_order_release);
+    }
+    changed_.notify_all();
+}
+
+uint64_t InputLeaseWatchdog::expirations() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return expirations_;
+}
+
+uint64_t InputLeaseWatchdog::wakeups() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return wakeups_;
+}
+
+void InputLeaseWatchdog::Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        // Catch up with the heartbeats stored since the last wakeup.
+        // One that raced with the last expiry revives the lease.
+        lease_.Renew(InputLease::TimePoint(
+            InputLease::Clock::duration(heartbeat_.load(std::memory_order_relaxed))));
+        lapsed_.store(lease_.lapsed(), std::memory_order_release);
+        if (lease_.Expire(InputLease::Clock::now())) {
+            lapsed_.store(true, std::memory_order_release);
+            ++expirations_;
+            lock.unlock();
+            expired_();
+            lock.lock();
+            continue;
+        }
+
+        std::optional<InputLease::TimePoint> deadline = lease_.Deadline();
+        if (deadline) {
+            changed_.wait_until(lock, *deadline);
+        } else {
+            changed_.wait(lock);
+        }
+        ++wakeups_;
+    }
+}
+
+}  // namespace hardware_simulator
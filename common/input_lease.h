@@ -0,0 +1,99 @@
+#ifndef FLUTTER_PLUGIN_INPUT_LEASE_H_
+#define FLUTTER_PLUGIN_INPUT_LEASE_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace hardware_simulator {
+
+// A client's claim on the input it holds down, kept alive by heartbeats.
+// When a heartbeat is more than |timeout| late the lease lapses once, and
+// stays lapsed until the next heartbeat renews it.
+//
+// Time is passed in by the caller so it can be driven by a virtual clock.
+// Not thread-safe.
+class InputLease {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+
+    // Arms the lease for |timeout| from |now|; zero or less disarms it.
+    void Start(std::chrono::microseconds timeout, TimePoint now);
+
+    // A heartbeat at |now|. Heartbeats older than the latest are ignored, so
+    // they may be applied late and out of order.
+    void Renew(TimePoint now);
+
+    // When the lease lapses, unless it is disarmed or already lapsed.
+    std::optional<TimePoint> Deadline() const;
+
+    // True once, when |now| has reached the deadline.
+    bool Expire(TimePoint now);
+
+    bool armed() const { return timeout_.count() > 0; }
+    bool lapsed() const { return lapsed_; }
+
+private:
+    std::chrono::microseconds timeout_{0};
+    TimePoint renewed_{};
+    bool lapsed_ = false;
+};
+
+// Watches an InputLease on its own thread and calls |expired| on that thread
+// when it lapses, typically to release everything the client held.
+//
+// The thread sleeps until the deadline, or without a timeout while the lease
+// is disarmed or lapsed. A heartbeat is one atomic store that does not wake
+// the thread: the thread finds the later heartbeat when it wakes at the old
+// deadline and sleeps on, so a live lease costs one wakeup per timeout
+// however often it is renewed.
+class InputLeaseWatchdog {
+public:
+    using ExpiredCallback = std::function<void()>;
+
+    explicit InputLeaseWatchdog(ExpiredCallback expired);
+    ~InputLeaseWatchdog();
+
+    InputLeaseWatchdog(const InputLeaseWatchdog&) = delete;
+    InputLeaseWatchdog& operator=(const InputLeaseWatchdog&) = delete;
+
+    // Arms the lease from now; zero or less disarms it.
+    void Start(std::chrono::microseconds timeout);
+
+    // Any thread.
+    void Renew();
+
+    bool lapsed() const { return lapsed_.load(std::memory_order_acquire); }
+
+    // Times the lease lapsed, and times the thread woke up, for tests.
+    uint64_t expirations() const;
+    uint64_t wakeups() const;
+
+private:
+    void Run();
+
+    const ExpiredCallback expired_;
+
+    // Latest heartbeat, in Clock ticks.
+    std::atomic<int64_t> heartbeat_{0};
+    // Set while lapsed, so only the heartbeat that revives the lease locks.
+    std::atomic<bool> lapsed_{false};
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    InputLease lease_;
+    bool stopping_ = false;
+    uint64_t expirations_ = 0;
+    uint64_t wakeups_ = 0;
+    std::thread thread_;
+};
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_INPUT_LEASE_H_
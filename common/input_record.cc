@@ -0,0 +1,88 @@
+#include "input_record.h"
+
+namespace hardware_simulator {
+
+void DispatchInputRecord(const InputRecord& record, InputSink& sink) {
+    const bool is_down = (record.flags & kInputRecordDown) != 0;
+    const bool has_button = (record.flags & kInputRecordButton) != 0;
+    const bool is_repeat = (record.flags & kInputRecordRepeat) != 0;
+    const bool is_frame_end = (record.flags & kInputRecordFrameEnd) != 0;
+
+    switch (static_cast<InputRecordType>(record.type)) {
+    case InputRecordType::kKey:
+        if (is_repeat) {
+            sink.KeyRepeat(record.code);
+        } else {
+            sink.KeyEvent(record.code, is_down);
+        }
+        break;
+    case InputRecordType::kMouseMoveRelative:
+        sink.MouseMoveRelative(record.x, record.y);
+        break;
+    case InputRecordType::kMouseMoveAbsolute:
+        sink.MouseMoveAbsolute(record.x, record.y, record.screen_id);
+        break;
+    case InputRecordType::kMouseButton:
+        sink.MouseButton(record.code, is_down);
+        break;
+    case InputRecordType::kMouseScroll:
+        sink.MouseScroll(record.x, record.y);
+        break;
+    case InputRecordType::kTouchEvent:
+        if (is_repeat) {
+            sink.TouchRepeat(record.touch_id);
+        } else {
+            sink.TouchEvent(record.screen_id, record.x, record.y, record.touch_id, is_down);
+            if (is_frame_end) {
+                sink.FlushTouchFrame();
+            }
+        }
+        break;
+    case InputRecordType::kTouchMove:
+        sink.TouchMove(record.screen_id, record.x, record.y, record.touch_id);
+        if (is_frame_end) {
+            sink.FlushTouchFrame();
+        }
+        break;
+    case InputRecordType::kPenEvent:
+        sink.PenEvent(record.screen_id, record.x, record.y, is_down, has_button,
+                      record.pressure, record.rotation, record.tilt);
+        break;
+    case InputRecordType::kPenMove:
+        sink.PenMove(record.screen_id, record.x, record.y, has_button,
+                     record.pressure, record.rotation, record.tilt);
+        break;
+    default:
+        break;
+    }
+}
+
+bool PenRunBuilder::Stage(const InputRecord& record, InputSink& sink) {
+    if (static_cast<InputRecordType>(record.type) != InputRecordType::kPenMove) {
+        return false;
+    }
+    if (size_ == kMaxSize || (size_ > 0 && record.screen_id != screen_id_)) {
+        Commit(sink);
+    }
+    PenSample& sample = samples_[size_++];
+    sample.x = record.x;
+    sample.y = record.y;
+    sample.pressure = record.pressure;
+    sample.rotation = record.rotation;
+    sample.tilt = record.tilt;
+    sample.has_button = (record.flags & kInputRecordButton) != 0;
+    screen_id_ = record.screen_id;
+    if ((record.flags & kInputRecordFrameEnd) != 0) {
+        Commit(sink);
+    }
+    return true;
+}
+
+void PenRunBuilder::Commit(InputSink& sink) {
+    if (size_ > 0) {
+        sink.PenMoveBatch(screen_id_, samples_, size_);
+        size_ = 0;
+    }
+}
+
+}  // namespace hardware_simulator
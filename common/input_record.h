@@ -0,0 +1,88 @@
+#ifndef FLUTTER_PLUGIN_INPUT_RECORD_H_
+#define FLUTTER_PLUGIN_INPUT_RECORD_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "input_sink.h"
+
+namespace hardware_simulator {
+
+enum class InputRecordType : uint8_t {
+    kNone = 0,
+    kKey = 1,               // code = virtual-key code, kInputRecordDown
+    kMouseMoveRelative = 2, // x/y = delta
+    kMouseMoveAbsolute = 3, // x/y = screen fraction, screen_id
+    kMouseButton = 4,       // code = button id, kInputRecordDown
+    kMouseScroll = 5,       // x/y = horizontal/vertical distance
+    kTouchEvent = 6,        // x/y, screen_id, touch_id, kInputRecordDown
+    kTouchMove = 7,         // x/y, screen_id, touch_id
+    kPenEvent = 8,          // x/y, screen_id, pressure/rotation/tilt, flags
+    kPenMove = 9,           // x/y, screen_id, pressure/rotation/tilt, flags
+};
+
+constexpr uint8_t kInputRecordDown = 1 << 0;
+constexpr uint8_t kInputRecordButton = 1 << 1;
+// On kKey and kTouchEvent: an auto-repeat (InputSink::KeyRepeat/TouchRepeat).
+constexpr uint8_t kInputRecordRepeat = 1 << 2;
+// On kTouchEvent and kTouchMove: the last update of a touch frame. Updates
+// before it may be held back and injected together with it. On kPenMove: the
+// last sample of a pen run (InputSink::PenMoveBatch), likewise.
+constexpr uint8_t kInputRecordFrameEnd = 1 << 3;
+
+// One input event in the fixed-size little-endian wire format shared with
+// Dart (lib/input_batch.dart). The layout is part of the protocol: do not
+// reorder fields without bumping kInputBatchVersion.
+struct InputRecord {
+    uint8_t type;          // InputRecordType
+    uint8_t flags;         // kInputRecord* bits
+    uint16_t code;
+    int32_t screen_id;
+    uint32_t touch_id;
+    float pressure;
+    float rotation;
+    float tilt;
+    int64_t timestamp_us;  // Sender's clock, informational.
+    double x;
+    double y;
+};
+
+constexpr size_t kInputRecordSize = 48;
+static_assert(sizeof(InputRecord) == kInputRecordSize, "InputRecord must match the wire format");
+static_assert(offsetof(InputRecord, timestamp_us) == 24, "InputRecord must match the wire format");
+static_assert(offsetof(InputRecord, x) == 32, "InputRecord must match the wire format");
+
+// Forwards |record| to the matching InputSink call, followed by
+// FlushTouchFrame() when it ends a touch frame. Records of unknown type are
+// ignored so newer senders keep working against older plugins.
+void DispatchInputRecord(const InputRecord& record, InputSink& sink);
+
+// Gathers consecutive kPenMove records on one screen into a single
+// InputSink::PenMoveBatch call, so the sink can convert and inject the run
+// together. Every path that dispatches records in bulk (the batch channel,
+// the input ring and the injector thread) stages pen moves here.
+class PenRunBuilder {
+public:
+    static constexpr size_t kMaxSize = 64;
+
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+
+    // Adds |record| if it is a pen move, committing the run to |sink| first
+    // when it is full or on another screen, and after |record| when it is
+    // flagged kInputRecordFrameEnd. Returns false, and adds nothing, for any
+    // other record.
+    bool Stage(const InputRecord& record, InputSink& sink);
+
+    // Hands the run to |sink|, unless it is empty, and starts a new one.
+    void Commit(InputSink& sink);
+
+private:
+    PenSample samples_[kMaxSize];
+    size_t size_ = 0;
+    int32_t screen_id_ = 0;
+};
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_INPUT_RECORD_H_
@@ -0,0 +1,293 @@
+#include "input_remap.h"
+
+#include <cmath>
+#include <utility>
+
+namespace hardware_simulator {
+
+namespace {
+
+constexpr uint64_t kPressed = uint64_t{1} << 63;
+constexpr uint8_t kButtonPressed = 0x80;
+
+uint64_t PackChord(const KeyChord& chord) {
+    uint64_t packed = kPressed | chord.count;
+    for (size_t i = 0; i < chord.count; ++i) {
+        packed |= static_cast<uint64_t>(chord.keys[i]) << (8 * (i + 1));
+    }
+    return packed;
+}
+
+KeyChord UnpackChord(uint64_t packed) {
+    KeyChord chord;
+    chord.count = static_cast<uint8_t>(packed & 0xFF);
+    for (size_t i = 0; i < chord.count; ++i) {
+        chord.keys[i] = static_cast<uint8_t>(packed >> (8 * (i + 1)));
+    }
+    return chord;
+}
+
+bool IsButton(int32_t button_id) {
+    return button_id >= 1 && button_id <= 5;
+}
+
+}  // namespace
+
+const char* RemapStatusMessage(RemapStatus status) {
+    switch (status) {
+        case RemapStatus::kOk:
+            return "OK";
+        case RemapStatus::kBadKeyMap:
+            return "keyMap must be rows of a source key and 4 targets in 1..255, each source once";
+        case RemapStatus::kBadButtonMap:
+            return "buttonMap must be (source, target) pairs of buttons 1..5, target 0 to swallow, each source once";
+        case RemapStatus::kBadSensitivity:
+            return "sensitivityX and sensitivityY must be finite and not negative";
+        case RemapStatus::kBadCurve:
+            return "curve must be (speed, gain) pairs with increasing speeds and finite, non-negative values";
+    }
+    return "Invalid remap";
+}
+
+InputRemap::InputRemap() {
+    for (size_t key = 0; key < 256; ++key) {
+        keys_[key].count = key == 0 ? 0 : 1;
+        keys_[key].keys[0] = static_cast<uint8_t>(key);
+    }
+    for (int button = 0; button <= 5; ++button) {
+        buttons_[button] = static_cast<uint8_t>(button);
+    }
+    for (auto& gain : gain_) {
+        gain = 1;
+    }
+}
+
+RemapStatus InputRemap::Build(const InputRemapSpec& spec, InputRemap* out) {
+    InputRemap remap;
+
+    if (spec.key_map.size() % kKeyRemapStride != 0) {
+        return RemapStatus::kBadKeyMap;
+    }
+    bool seen_keys[256] = {};
+    for (size_t row = 0; row < spec.key_map.size(); row += kKeyRemapStride) {
+        int32_t source = spec.key_map[row];
+        if (source < 1 || source > 255 || seen_keys[source]) {
+            return RemapStatus::kBadKeyMap;
+        }
+        seen_keys[source] = true;
+        KeyChord chord;
+        for (size_t i = 1; i < kKeyRemapStride; ++i) {
+            int32_t target = spec.key_map[row + i];
+            if (target < 0 || target > 255) {
+                return RemapStatus::kBadKeyMap;
+            }
+            if (target != 0) {
+                chord.keys[chord.count++] = static_cast<uint8_t>(target);
+            }
+        }
+        remap.keys_[source] = chord;
+    }
+
+    if (spec.button_map.size() % 2 != 0) {
+        return RemapStatus::kBadButtonMap;
+    }
+    bool seen_buttons[6] = {};
+    for (size_t i = 0; i < spec.button_map.size(); i += 2) {
+        int32_t source = spec.button_map[i];
+        int32_t target = spec.button_map[i + 1];
+        if (!IsButton(source) || seen_buttons[source] || (target != 0 && !IsButton(target))) {
+            return RemapStatus::kBadButtonMap;
+        }
+        seen_buttons[source] = true;
+        remap.buttons_[source] = static_cast<uint8_t>(target);
+    }
+
+    if (!std::isfinite(spec.sensitivity_x) || spec.sensitivity_x < 0 ||
+        !std::isfinite(spec.sensitivity_y) || spec.sensitivity_y < 0) {
+        return RemapStatus::kBadSensitivity;
+    }
+    remap.sensitivity_x_ = spec.sensitivity_x;
+    remap.sensitivity_y_ = spec.sensitivity_y;
+
+    const std::vector<double>& curve = spec.curve;
+    if (curve.size() % 2 != 0) {
+        return RemapStatus::kBadCurve;
+    }
+    for (size_t i = 0; i < curve.size(); i += 2) {
+        if (!std::isfinite(curve[i]) || curve[i] < 0 || !std::isfinite(curve[i + 1]) || curve[i + 1] < 0 ||
+            (i > 0 && !(curve[i] > curve[i - 2]))) {
+            return RemapStatus::kBadCurve;
+        }
+    }
+    if (!curve.empty()) {
+        remap.has_curve_ = true;
+        size_t next = 0;
+        for (size_t speed = 0; speed < kSensitivityTableSize; ++speed) {
+            while (next < curve.size() && curve[next] <= speed) {
+                next += 2;
+            }
+            double gain;
+            if (next == 0) {
+                gain = curve[1];
+            } else if (next == curve.size()) {
+                gain = curve[curve.size() - 1];
+            } else {
+                double t = (speed - curve[next - 2]) / (curve[next] - curve[next - 2]);
+                gain = curve[next - 1] + t * (curve[next + 1] - curve[next - 1]);
+            }
+            remap.gain_[speed] = gain;
+        }
+    }
+
+    remap.is_identity_ = spec.key_map.empty() && spec.button_map.empty() && curve.empty() &&
+                         spec.sensitivity_x == 1 && spec.sensitivity_y == 1;
+    *out = remap;
+    return RemapStatus::kOk;
+}
+
+KeyChord InputRemap::KeyTarget(uint16_t key_code) const {
+    return key_code < 256 ? keys_[key_code] : KeyChord();
+}
+
+int InputRemap::ButtonTarget(int button_id) const {
+    return IsButton(button_id) ? buttons_[button_id] : button_id;
+}
+
+double InputRemap::Gain(double speed) const {
+    // Linear between the tabulated integer speeds.
+    if (speed >= kSensitivityTableSize - 1) {
+        return gain_[kSensitivityTableSize - 1];
+    }
+    size_t index = static_cast<size_t>(speed);
+    double t = speed - index;
+    return gain_[index] + t * (gain_[index + 1] - gain_[index]);
+}
+
+void InputRemap::ScaleMotion(double dx, double dy, double* out_dx, double* out_dy) const {
+    double gain = has_curve_ ? Gain(std::sqrt(dx * dx + dy * dy)) : 1;
+    *out_dx = dx * sensitivity_x_ * gain;
+    *out_dy = dy * sensitivity_y_ * gain;
+}
+
+RemappingInputSink::RemappingInputSink(InputSink& next)
+    : next_(next), remaps_(std::make_shared<const InputRemap>()) {
+    ForgetPressed();
+}
+
+void RemappingInputSink::ForgetPressed() {
+    for (auto& key : pressed_keys_) {
+        key.store(0, std::memory_order_relaxed);
+    }
+    for (auto& button : pressed_buttons_) {
+        button.store(0, std::memory_order_relaxed);
+    }
+}
+
+void RemappingInputSink::KeyEvent(uint16_t key_code, bool is_down) {
+    if (key_code >= 256) {
+        next_.KeyEvent(key_code, is_down);
+        return;
+    }
+    std::atomic<uint64_t>& pressed = pressed_keys_[key_code];
+    KeyChord chord;
+    if (is_down) {
+        // A down for a key that is already down (client-side typematic)
+        // repeats what it was pressed as.
+        uint64_t previous = 0;
+        uint64_t packed = PackChord(current()->KeyTarget(key_code));
+        chord = UnpackChord(pressed.compare_exchange_strong(previous, packed, std::memory_order_relaxed)
+                                ? packed
+                                : previous);
+        for (size_t i = 0; i < chord.count; ++i) {
+            next_.KeyEvent(chord.keys[i], true);
+        }
+        return;
+    }
+    uint64_t previous = pressed.exchange(0, std::memory_order_relaxed);
+    chord = previous != 0 ? UnpackChord(previous) : current()->KeyTarget(key_code);
+    for (size_t i = chord.count; i > 0; --i) {
+        next_.KeyEvent(chord.keys[i - 1], false);
+    }
+}
+
+void RemappingInputSink::MouseMoveRelative(double dx, double dy) {
+    std::shared_ptr<const InputRemap> remap = current();
+    if (remap->is_identity()) {
+        next_.MouseMoveRelative(dx, dy);
+        return;
+    }
+    double scaled_x;
+    double scaled_y;
+    remap->ScaleMotion(dx, dy, &scaled_x, &scaled_y);
+    next_.MouseMoveRelative(scaled_x, scaled_y);
+}
+
+void RemappingInputSink::MouseMoveAbsolute(double x, double y, int screen_id) {
+    next_.MouseMoveAbsolute(x, y, screen_id);
+}
+
+void RemappingInputSink::MouseButton(int button_id, bool is_down) {
+    if (!IsButton(button_id)) {
+        next_.MouseButton(button_id, is_down);
+        return;
+    }
+    std::atomic<uint8_t>& pressed = pressed_buttons_[button_id];
+    int target;
+    if (is_down) {
+        uint8_t previous = 0;
+        uint8_t packed = static_cast<uint8_t>(kButtonPressed | current()->ButtonTarget(button_id));
+        target = (pressed.compare_exchange_strong(previous, packed, std::memory_order_relaxed) ? packed
+                                                                                               : previous) &
+                 ~kButtonPressed;
+    } else {
+        uint8_t previous = pressed.exchange(0, std::memory_order_relaxed);
+        target = previous != 0 ? previous & ~kButtonPressed : current()->ButtonTarget(button_id);
+    }
+    if (target != 0) {
+        next_.MouseButton(target, is_down);
+    }
+}
+
+void RemappingInputSink::MouseScroll(double dx, double dy) {
+    next_.MouseScroll(dx, dy);
+}
+
+void RemappingInputSink::TouchEvent(int screen_id, double x, double y, uint32_t touch_id, bool is_down) {
+    next_.TouchEvent(screen_id, x, y, touch_id, is_down);
+}
+
+void RemappingInputSink::TouchMove(int screen_id, double x, double y, uint32_t touch_id) {
+    next_.TouchMove(screen_id, x, y, touch_id);
+}
+
+void RemappingInputSink::PenEvent(int screen_id, double x, double y, bool is_down, bool has_button,
+                                  double pressure, double rotation, double tilt) {
+    next_.PenEvent(screen_id, x, y, is_down, has_button, pressure, rotation, tilt);
+}
+
+void RemappingInputSink::PenMove(int screen_id, double x, double y, bool has_button,
+                                 double pressure, double rotation, double tilt) {
+    next_.PenMove(screen_id, x, y, has_button, pressure, rotation, tilt);
+}
+
+void RemappingInputSink::PenMoveBatch(int screen_id, const PenSample* samples, size_t count) {
+    next_.PenMoveBatch(screen_id, samples, count);
+}
+
+void RemappingInputSink::TouchFrame(const TouchUpdate* updates, size_t count) {
+    next_.TouchFrame(updates, count);
+}
+
+void RemappingInputSink::FlushTouchFrame() {
+    next_.FlushTouchFrame();
+}
+
+void RemappingInputSink::KeyRepeat(uint16_t key_code) {
+    next_.KeyRepeat(key_code);
+}
+
+void RemappingInputSink::TouchRepeat(uint32_t touch_id) {
+    next_.TouchRepeat(touch_id);
+}
+
+}  // namespace hardware_simulator
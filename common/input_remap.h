@@ -0,0 +1,133 @@
+#ifndef FLUTTER_PLUGIN_INPUT_REMAP_H_
+#define FLUTTER_PLUGIN_INPUT_REMAP_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "input_sink.h"
+#include "snapshot_publisher.h"
+
+namespace hardware_simulator {
+
+// A remapped key presses up to this many keys.
+constexpr size_t kMaxChordKeys = 4;
+// Length of one key_map row: the source key, then its targets.
+constexpr size_t kKeyRemapStride = 1 + kMaxChordKeys;
+// Speeds, in counts per move, at which a sensitivity curve is tabulated.
+constexpr size_t kSensitivityTableSize = 128;
+
+// Keys pressed in order, and released in reverse, for one source key. An
+// empty chord swallows the key.
+struct KeyChord {
+    uint8_t count = 0;
+    uint8_t keys[kMaxChordKeys] = {};
+};
+
+// A remap profile as it comes from Dart. Everything left empty is identity.
+struct InputRemapSpec {
+    // Rows of kKeyRemapStride: source key, then target keys, zero-padded. A
+    // row without targets swallows its source key.
+    std::vector<int32_t> key_map;
+    // (source, target) button pairs; target 0 swallows the button.
+    std::vector<int32_t> button_map;
+    // Applied to relative mouse motion, times the curve's gain.
+    double sensitivity_x = 1;
+    double sensitivity_y = 1;
+    // (speed, gain) points with strictly increasing speed, in counts per
+    // move. Gain is interpolated between points and held beyond the ends.
+    std::vector<double> curve;
+};
+
+enum class RemapStatus {
+    kOk = 0,
+    kBadKeyMap,      // Not whole rows, codes out of 1..255, or a repeated source.
+    kBadButtonMap,   // Odd length, buttons out of range, or a repeated source.
+    kBadSensitivity, // Negative or not finite.
+    kBadCurve,       // Odd length, unordered speeds, or a bad gain.
+};
+
+// e.g. "keyMap must be rows of a source key and 4 targets in 1..255".
+const char* RemapStatusMessage(RemapStatus status);
+
+// Immutable lookup tables built from an InputRemapSpec. Every lookup is a
+// table index.
+class InputRemap {
+public:
+    // Identity.
+    InputRemap();
+
+    // Leaves |out| untouched unless the spec is valid.
+    static RemapStatus Build(const InputRemapSpec& spec, InputRemap* out);
+
+    // Codes past 255 are not remapped; the sink passes them through.
+    KeyChord KeyTarget(uint16_t key_code) const;
+    // Button ids outside 1..5 map to themselves; 0 means swallowed.
+    int ButtonTarget(int button_id) const;
+    void ScaleMotion(double dx, double dy, double* out_dx, double* out_dy) const;
+
+    bool is_identity() const { return is_identity_; }
+
+private:
+    double Gain(double speed) const;
+
+    KeyChord keys_[256];
+    uint8_t buttons_[6];
+    double sensitivity_x_ = 1;
+    double sensitivity_y_ = 1;
+    bool has_curve_ = false;
+    double gain_[kSensitivityTableSize];
+    bool is_identity_ = true;
+};
+
+// InputSink that applies the current InputRemap to client input and passes
+// the result on to |next|. Keys and buttons are released as whatever they
+// were pressed as, so swapping profiles while something is held never leaves
+// a key stuck. Relative motion is scaled; everything else passes through.
+//
+// Safe to call from several producer threads; a new profile applies to the
+// events that start after Publish() returns.
+class RemappingInputSink : public InputSink {
+public:
+    explicit RemappingInputSink(InputSink& next);
+
+    RemappingInputSink(const RemappingInputSink&) = delete;
+    RemappingInputSink& operator=(const RemappingInputSink&) = delete;
+
+    void Publish(std::shared_ptr<const InputRemap> remap) { remaps_.Publish(std::move(remap)); }
+    std::shared_ptr<const InputRemap> current() const { return remaps_.Current(); }
+
+    // Forgets what is held, after everything was released downstream.
+    void ForgetPressed();
+
+    void KeyEvent(uint16_t key_code, bool is_down) override;
+    void MouseMoveRelative(double dx, double dy) override;
+    void MouseMoveAbsolute(double x, double y, int screen_id) override;
+    void MouseButton(int button_id, bool is_down) override;
+    void MouseScroll(double dx, double dy) override;
+    void TouchEvent(int screen_id, double x, double y, uint32_t touch_id, bool is_down) override;
+    void TouchMove(int screen_id, double x, double y, uint32_t touch_id) override;
+    void PenEvent(int screen_id, double x, double y, bool is_down, bool has_button,
+                  double pressure, double rotation, double tilt) override;
+    void PenMove(int screen_id, double x, double y, bool has_button,
+                 double pressure, double rotation, double tilt) override;
+    void PenMoveBatch(int screen_id, const PenSample* samples, size_t count) override;
+    void TouchFrame(const TouchUpdate* updates, size_t count) override;
+    void FlushTouchFrame() override;
+    void KeyRepeat(uint16_t key_code) override;
+    void TouchRepeat(uint32_t touch_id) override;
+
+private:
+    InputSink& next_;
+    SnapshotPublisher<InputRemap> remaps_;
+    // What each source key and button was pressed as, packed so it is
+    // claimed and released with one atomic operation. Zero: not pressed.
+    std::atomic<uint64_t> pressed_keys_[256];
+    std::atomic<uint8_t> pressed_buttons_[6];
+};
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_INPUT_REMAP_H_
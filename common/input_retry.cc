@@ -0,0 +1,125 @@
+#include "input_retry.h"
+
+#include <algorithm>
+
+namespace hardware_simulator {
+
+std::chrono::microseconds RetryPolicy::BackoffBefore(int attempt) const {
+    if (attempt <= 0) {
+        return std::chrono::microseconds(0);
+    }
+    std::chrono::microseconds backoff = initial_backoff;
+    for (int i = 1; i < attempt && backoff < max_backoff; ++i) {
+        backoff *= 2;
+    }
+    return (std::min)(backoff, max_backoff);
+}
+
+InputRetryEngine::InputRetryEngine(RetryPolicy policy, ReacquireHook reacquire)
+    : policy_(policy),
+      reacquire_(std::move(reacquire)),
+      thread_(&InputRetryEngine::Run, this) {}
+
+InputRetryEngine::~InputRetryEngine() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_.notify_all();
+    thread_.join();
+}
+
+void InputRetryEngine::CatchUpWithWorker() {
+    uint64_t generation = generation_.load(std::memory_order_acquire);
+    if (generation != injector_generation_.load(std::memory_order_relaxed)) {
+        injector_generation_.store(generation, std::memory_order_relaxed);
+        if (reacquire_) {
+            reacquire_();
+        }
+    }
+}
+
+bool InputRetryEngine::HasBacklog() {
+    // Anything still being retried goes first.
+    std::lock_guard<std::mutex> lock(mutex_);
+    return busy_ || !pending_.empty();
+}
+
+void InputRetryEngine::Enqueue(Attempt attempt) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_.size() >= policy_.max_pending) {
+            pending_.pop_front();
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        pending_.push_back(std::move(attempt));
+    }
+    work_.notify_one();
+}
+
+void InputRetryEngine::WaitUntilIdle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this] { return stopping_ || (!busy_ && pending_.empty()); });
+}
+
+bool InputRetryEngine::Retry(const Attempt& attempt, int max_attempts,
+                             std::unique_lock<std::mutex>& lock) {
+    for (int i = 0; i < max_attempts; ++i) {
+        auto backoff = policy_.BackoffBefore(i);
+        if (backoff.count() > 0 && work_.wait_for(lock, backoff, [this] { return stopping_; })) {
+            return false;
+        }
+        if (stopping_) {
+            return false;
+        }
+
+        lock.unlock();
+        if (reacquire_) {
+            reacquire_();
+        }
+        generation_.fetch_add(1, std::memory_order_release);
+        retries_.fetch_add(1, std::memory_order_relaxed);
+        bool delivered = attempt();
+        lock.lock();
+
+        if (delivered) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void InputRetryEngine::Run() {
+    // Set after an event is given up on: the context is unreachable, so the
+    // events queued behind it get a single attempt each until one succeeds
+    // instead of sitting through the full backoff one by one.
+    bool unreachable = false;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        work_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+        if (stopping_) {
+            break;
+        }
+
+        Attempt attempt = std::move(pending_.front());
+        pending_.pop_front();
+        busy_ = true;
+
+        bool delivered = Retry(attempt, unreachable ? 1 : policy_.max_attempts, lock);
+        if (!delivered) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        unreachable = !delivered;
+
+        busy_ = false;
+        if (pending_.empty()) {
+            idle_.notify_all();
+        }
+    }
+    dropped_.fetch_add(pending_.size(), std::memory_order_relaxed);
+    pending_.clear();
+    idle_.notify_all();
+}
+
+}  // namespace hardware_simulator
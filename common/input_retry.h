@@ -0,0 +1,106 @@
+#ifndef FLUTTER_PLUGIN_INPUT_RETRY_H_
+#define FLUTTER_PLUGIN_INPUT_RETRY_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace hardware_simulator {
+
+// How hard InputRetryEngine tries to deliver one failed injection.
+struct RetryPolicy {
+    // Attempts on the retry worker after the failed inline one.
+    int max_attempts = 6;
+    std::chrono::microseconds initial_backoff{2000};
+    std::chrono::microseconds max_backoff{64000};
+    // Failed events waiting for the worker. Beyond this the oldest is
+    // dropped, so a long outage cannot build an unbounded backlog.
+    size_t max_pending = 256;
+
+    // Wait before worker attempt |attempt| (0-based): none for the first,
+    // then initial_backoff doubling up to max_backoff.
+    std::chrono::microseconds BackoffBefore(int attempt) const;
+};
+
+// Retries injections that the OS rejected, typically because the input
+// desktop changed (UAC prompt, lock screen, secure desktop).
+//
+// The injecting thread calls Inject() with an attempt that returns whether
+// the OS accepted the event. When it fails, the event goes to one
+// long-lived worker that calls the |reacquire| hook (syncThreadDesktop on
+// Windows) and retries with bounded backoff. While anything is queued for
+// the worker, later events queue behind it, so input keeps its order.
+//
+// After the worker reacquired the context, the next Inject() calls the hook
+// on the injecting thread as well, so it stops failing once the context is
+// back.
+class InputRetryEngine {
+public:
+    using Attempt = std::function<bool()>;
+    using ReacquireHook = std::function<void()>;
+
+    InputRetryEngine(RetryPolicy policy, ReacquireHook reacquire);
+    // Stops the worker; events still waiting are dropped.
+    ~InputRetryEngine();
+
+    InputRetryEngine(const InputRetryEngine&) = delete;
+    InputRetryEngine& operator=(const InputRetryEngine&) = delete;
+
+    // Called from the injecting thread. |attempt| is any callable returning
+    // bool; it is only copied into an Attempt when it has to be retried.
+    // Returns true when it was delivered inline, false when it was handed to
+    // the worker.
+    template <typename F>
+    bool Inject(F&& attempt) {
+        CatchUpWithWorker();
+        if (!HasBacklog() && attempt()) {
+            return true;
+        }
+        Enqueue(Attempt(std::forward<F>(attempt)));
+        return false;
+    }
+
+    // Blocks until the worker has nothing left to retry.
+    void WaitUntilIdle();
+
+    // Worker attempts made, and events given up on.
+    uint64_t retries() const { return retries_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    void CatchUpWithWorker();
+    bool HasBacklog();
+    void Enqueue(Attempt attempt);
+    void Run();
+    bool Retry(const Attempt& attempt, int max_attempts, std::unique_lock<std::mutex>& lock);
+
+    const RetryPolicy policy_;
+    const ReacquireHook reacquire_;
+
+    // Bumped by the worker on every reacquire; the injecting thread catches
+    // up by calling the hook itself.
+    std::atomic<uint64_t> generation_{0};
+    std::atomic<uint64_t> injector_generation_{0};
+
+    std::atomic<uint64_t> retries_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    std::mutex mutex_;
+    std::condition_variable work_;
+    std::condition_variable idle_;
+    std::deque<Attempt> pending_;
+    bool busy_ = false;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_INPUT_RETRY_H_
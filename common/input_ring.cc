@@ -0,0 +1,139 @@
+#include "input_ring.h"
+
+#include <algorithm>
+#include <new>
+
+namespace hardware_simulator {
+
+namespace {
+
+uint32_t RoundUpToPowerOfTwo(uint32_t value) {
+    uint32_t result = 2;
+    while (result < value && result < (1u << 31)) {
+        result <<= 1;
+    }
+    return result;
+}
+
+}  // namespace
+
+InputRing::InputRing(uint32_t capacity)
+    : capacity_(RoundUpToPowerOfTwo(capacity)),
+      mask_(capacity_ - 1),
+      slots_(new InputRecord[capacity_]()) {}
+
+InputRing::~InputRing() {
+    delete[] slots_;
+}
+
+uint32_t InputRing::Reserve() const {
+    uint64_t head = head_.value.load(std::memory_order_relaxed);
+    uint64_t tail = tail_.value.load(std::memory_order_acquire);
+    uint32_t free_slots = capacity_ - static_cast<uint32_t>(head - tail);
+    uint32_t until_wrap = capacity_ - static_cast<uint32_t>(head & mask_);
+    return (std::min)(free_slots, until_wrap);
+}
+
+uint32_t InputRing::WriteIndex() const {
+    return static_cast<uint32_t>(head_.value.load(std::memory_order_relaxed) & mask_);
+}
+
+void InputRing::Commit(uint32_t count) {
+    head_.value.store(head_.value.load(std::memory_order_relaxed) + count, std::memory_order_release);
+}
+
+bool InputRing::TryPush(const InputRecord& record) {
+    if (Reserve() == 0) {
+        return false;
+    }
+    slots_[WriteIndex()] = record;
+    Commit(1);
+    return true;
+}
+
+size_t InputRing::Drain(InputSink& sink, size_t max_records) {
+    uint64_t tail = tail_.value.load(std::memory_order_relaxed);
+    uint64_t head = head_.value.load(std::memory_order_acquire);
+    size_t available = static_cast<size_t>(head - tail);
+    size_t count = (std::min)(available, max_records);
+    PenRunBuilder pen_run;
+    for (size_t i = 0; i < count; ++i) {
+        const InputRecord& record = slots_[(tail + i) & mask_];
+        if (!pen_run.Stage(record, sink)) {
+            pen_run.Commit(sink);
+            DispatchInputRecord(record, sink);
+        }
+    }
+    pen_run.Commit(sink);
+    if (count > 0) {
+        // Hands the slots back to the producer only after they were read.
+        tail_.value.store(tail + count, std::memory_order_release);
+    }
+    return count;
+}
+
+bool InputRing::IsEmpty() const {
+    return head_.value.load(std::memory_order_acquire) == tail_.value.load(std::memory_order_relaxed);
+}
+
+InputRingConsumer::InputRingConsumer(InputRing& ring, InputSink& sink, int spin_iterations)
+    : ring_(ring),
+      sink_(sink),
+      spin_iterations_(std::thread::hardware_concurrency() > 1 ? spin_iterations : 0),
+      thread_(&InputRingConsumer::Run, this) {}
+
+InputRingConsumer::~InputRingConsumer() {
+    Stop();
+}
+
+void InputRingConsumer::Notify() {
+    // Pairs with the fence in Run(): either the consumer sees the new head
+    // before parking, or we see parked_ and wake it.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (parked_.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wake_.notify_one();
+    }
+}
+
+void InputRingConsumer::Stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_.store(true);
+        wake_.notify_one();
+    }
+    thread_.join();
+}
+
+void InputRingConsumer::Run() {
+    int idle = 0;
+    while (true) {
+        if (ring_.Drain(sink_) > 0) {
+            idle = 0;
+            continue;
+        }
+        if (stopping_.load(std::memory_order_acquire)) {
+            break;
+        }
+        if (++idle < spin_iterations_) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        parked_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        wake_.wait(lock, [this] {
+            return !ring_.IsEmpty() || stopping_.load(std::memory_order_relaxed);
+        });
+        parked_.store(false, std::memory_order_relaxed);
+        idle = 0;
+    }
+    // Records committed before Stop() are still delivered.
+    ring_.Drain(sink_);
+}
+
+}  // namespace hardware_simulator
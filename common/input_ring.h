@@ -0,0 +1,109 @@
+#ifndef FLUTTER_PLUGIN_INPUT_RING_H_
+#define FLUTTER_PLUGIN_INPUT_RING_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "input_record.h"
+#include "input_sink.h"
+
+namespace hardware_simulator {
+
+// Lock-free single-producer/single-consumer ring of InputRecords.
+//
+// The producer is Dart, writing records straight into slots() through FFI
+// (see input_ring_ffi.h); the consumer is an InputRingConsumer thread. Both
+// counters only ever grow, so `head - tail` is the fill level and a slot index
+// is `counter & (capacity - 1)`.
+//
+// Producer:  n = Reserve(); write slots()[WriteIndex() .. +n); Commit(count)
+// Consumer:  Drain(sink)
+class InputRing {
+public:
+    // |capacity| is rounded up to a power of two, at least 2.
+    explicit InputRing(uint32_t capacity);
+    ~InputRing();
+
+    InputRing(const InputRing&) = delete;
+    InputRing& operator=(const InputRing&) = delete;
+
+    uint32_t capacity() const { return capacity_; }
+    InputRecord* slots() { return slots_; }
+
+    // Producer side. Number of free slots that follow WriteIndex() without
+    // wrapping, so the caller can fill them as one contiguous run.
+    uint32_t Reserve() const;
+    uint32_t WriteIndex() const;
+    // Publishes |count| slots written since the last Commit.
+    void Commit(uint32_t count);
+    // Copies |record| into the next slot and publishes it. Returns false when
+    // the ring is full.
+    bool TryPush(const InputRecord& record);
+
+    // Consumer side. Dispatches up to |max_records| published records to
+    // |sink| and returns how many it consumed. Consecutive pen moves on one
+    // screen go to |sink| as PenMoveBatch runs (see PenRunBuilder).
+    size_t Drain(InputSink& sink, size_t max_records = SIZE_MAX);
+    bool IsEmpty() const;
+
+private:
+    const uint32_t capacity_;
+    const uint32_t mask_;
+    InputRecord* slots_;
+
+    // Explicit padding rather than alignas, which MSVC warns about at /W4.
+    struct PaddedCounter {
+        char before[64];
+        std::atomic<uint64_t> value{0};
+        char after[56];
+    };
+
+    // Written by the producer, read by the consumer, and the other way round.
+    // Padded apart so the two threads do not false-share a cache line.
+    PaddedCounter head_;
+    PaddedCounter tail_;
+};
+
+// Thread that drains an InputRing into an InputSink. It spins for a short
+// while after the last record so back-to-back events do not pay for a wake
+// up, then parks until the producer calls Notify(). On a single core the
+// spin would only delay the producer, so it parks straight away.
+class InputRingConsumer {
+public:
+    static constexpr int kDefaultSpinIterations = 4096;
+
+    InputRingConsumer(InputRing& ring, InputSink& sink,
+                      int spin_iterations = kDefaultSpinIterations);
+    ~InputRingConsumer();
+
+    InputRingConsumer(const InputRingConsumer&) = delete;
+    InputRingConsumer& operator=(const InputRingConsumer&) = delete;
+
+    // Call after InputRing::Commit. Cheap when the consumer is spinning.
+    void Notify();
+
+    // Drains what is already published and joins the thread.
+    void Stop();
+
+private:
+    void Run();
+
+    InputRing& ring_;
+    InputSink& sink_;
+    const int spin_iterations_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::atomic<bool> parked_{false};
+    std::atomic<bool> stopping_{false};
+    std::thread thread_;
+};
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_INPUT_RING_H_
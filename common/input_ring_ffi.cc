@@ -0,0 +1,101 @@
+#include "input_ring_ffi.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "input_ring.h"
+
+struct HardwareSimulatorInputRing {
+    HardwareSimulatorInputRing(uint32_t capacity, hardware_simulator::InputSink& sink)
+        : ring(capacity), consumer(ring, sink) {}
+
+    hardware_simulator::InputRing ring;
+    hardware_simulator::InputRingConsumer consumer;
+    // Set once the sink went away. Dart may still hold the handle and a view
+    // of the slots, so the ring stays allocated until it is closed, but
+    // reserves nothing more.
+    std::atomic<bool> detached{false};
+};
+
+namespace {
+
+std::mutex g_ring_mutex;
+hardware_simulator::InputSink* g_ring_sink = nullptr;
+std::unique_ptr<HardwareSimulatorInputRing> g_ring;
+// Rings whose sink went away before Dart closed them.
+std::vector<std::unique_ptr<HardwareSimulatorInputRing>> g_detached_rings;
+
+}  // namespace
+
+namespace hardware_simulator {
+
+void SetInputRingSink(InputSink* sink) {
+    std::lock_guard<std::mutex> lock(g_ring_mutex);
+    if (g_ring_sink != sink && g_ring) {
+        // Drains what was committed into the old sink, which is still alive.
+        g_ring->detached.store(true, std::memory_order_release);
+        g_ring->consumer.Stop();
+        g_detached_rings.push_back(std::move(g_ring));
+    }
+    g_ring_sink = sink;
+}
+
+}  // namespace hardware_simulator
+
+HardwareSimulatorInputRing* hardware_simulator_input_ring_open(uint32_t capacity) {
+    std::lock_guard<std::mutex> lock(g_ring_mutex);
+    if (!g_ring && g_ring_sink) {
+        g_ring = std::make_unique<HardwareSimulatorInputRing>(capacity, *g_ring_sink);
+    }
+    return g_ring.get();
+}
+
+void hardware_simulator_input_ring_close(HardwareSimulatorInputRing* ring) {
+    std::unique_ptr<HardwareSimulatorInputRing> closed;
+    {
+        std::lock_guard<std::mutex> lock(g_ring_mutex);
+        if (ring == nullptr) {
+            return;
+        }
+        if (ring == g_ring.get()) {
+            closed = std::move(g_ring);
+        } else {
+            auto detached = std::find_if(
+                g_detached_rings.begin(), g_detached_rings.end(),
+                [ring](const auto& candidate) { return candidate.get() == ring; });
+            if (detached == g_detached_rings.end()) {
+                return;
+            }
+            closed = std::move(*detached);
+            g_detached_rings.erase(detached);
+        }
+    }
+    closed.reset();
+}
+
+uint32_t hardware_simulator_input_ring_capacity(HardwareSimulatorInputRing* ring) {
+    return ring->ring.capacity();
+}
+
+void* hardware_simulator_input_ring_slots(HardwareSimulatorInputRing* ring) {
+    return ring->ring.slots();
+}
+
+uint32_t hardware_simulator_input_ring_reserve(HardwareSimulatorInputRing* ring) {
+    if (ring->detached.load(std::memory_order_acquire)) {
+        return 0;
+    }
+    return ring->ring.Reserve();
+}
+
+uint32_t hardware_simulator_input_ring_write_index(HardwareSimulatorInputRing* ring) {
+    return ring->ring.WriteIndex();
+}
+
+void hardware_simulator_input_ring_commit(HardwareSimulatorInputRing* ring, uint32_t count) {
+    ring->ring.Commit(count);
+    ring->consumer.Notify();
+}
@@ -0,0 +1,69 @@
+#ifndef FLUTTER_PLUGIN_INPUT_RING_FFI_H_
+#define FLUTTER_PLUGIN_INPUT_RING_FFI_H_
+
+#include <stdint.h>
+
+#include "input_record.h"
+#include "input_sink.h"
+
+// C ABI exported from the plugin library for lib/input_ring.dart. Dart looks
+// the symbols up with DynamicLibrary and writes InputRecords directly into the
+// ring, skipping the platform channel and the platform thread entirely.
+#if defined(_WIN32)
+#define HARDWARE_SIMULATOR_FFI_EXPORT __declspec(dllexport)
+#else
+#define HARDWARE_SIMULATOR_FFI_EXPORT __attribute__((visibility("default")))
+#endif
+
+typedef struct HardwareSimulatorInputRing HardwareSimulatorInputRing;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+// Creates the process-wide ring and its consumer thread, or returns the one
+// already open. Returns NULL when the platform has no injection sink.
+HARDWARE_SIMULATOR_FFI_EXPORT HardwareSimulatorInputRing* hardware_simulator_input_ring_open(
+    uint32_t capacity);
+
+// Stops the consumer after it drained what was committed, then frees the ring.
+// The handle and the slots are valid until then, even once detached.
+HARDWARE_SIMULATOR_FFI_EXPORT void hardware_simulator_input_ring_close(
+    HardwareSimulatorInputRing* ring);
+
+HARDWARE_SIMULATOR_FFI_EXPORT uint32_t hardware_simulator_input_ring_capacity(
+    HardwareSimulatorInputRing* ring);
+
+// Base address of capacity() 48-byte records.
+HARDWARE_SIMULATOR_FFI_EXPORT void* hardware_simulator_input_ring_slots(
+    HardwareSimulatorInputRing* ring);
+
+// Free slots starting at the producer's write index, without wrapping. 0 once
+// the ring is detached from its sink.
+HARDWARE_SIMULATOR_FFI_EXPORT uint32_t hardware_simulator_input_ring_reserve(
+    HardwareSimulatorInputRing* ring);
+
+// Slot the next record goes into. Only the producer moves it, by committing.
+HARDWARE_SIMULATOR_FFI_EXPORT uint32_t hardware_simulator_input_ring_write_index(
+    HardwareSimulatorInputRing* ring);
+
+// Publishes |count| records written after the previous commit and wakes the
+// consumer if it is parked.
+HARDWARE_SIMULATOR_FFI_EXPORT void hardware_simulator_input_ring_commit(
+    HardwareSimulatorInputRing* ring, uint32_t count);
+
+#if defined(__cplusplus)
+}  // extern "C"
+#endif
+
+namespace hardware_simulator {
+
+// Set by the platform plugin when it registers; rings opened afterwards
+// drain into |sink|. Changing it, to nullptr when the plugin goes away,
+// detaches the open ring: what was committed is injected into the old sink,
+// later reserves return 0, and the ring is freed when Dart closes it.
+void SetInputRingSink(InputSink* sink);
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_INPUT_RING_FFI_H_
@@ -0,0 +1,92 @@
+#ifndef FLUTTER_PLUGIN_INPUT_SINK_H_
+#define FLUTTER_PLUGIN_INPUT_SINK_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace hardware_simulator {
+
+// One sample of a pen stroke, with PenMove's arguments.
+struct PenSample {
+    double x = 0;
+    double y = 0;
+    float pressure = 0;
+    float rotation = -1;
+    float tilt = -1;
+    bool has_button = false;
+};
+
+enum class TouchUpdateType : uint8_t {
+    kDown,
+    kMove,
+    kUp,
+};
+
+// One contact's part in a touch frame, with TouchEvent's or TouchMove's
+// arguments.
+struct TouchUpdate {
+    TouchUpdateType type = TouchUpdateType::kMove;
+    int32_t screen_id = 0;
+    uint32_t touch_id = 0;
+    double x = 0;
+    double y = 0;
+};
+
+// Destination for decoded input events. Each platform implements this on top
+// of its injection functions (performKeyEvent, performTouchEvent, ...), and
+// tests implement it to record what would have been injected.
+//
+// Arguments follow the method channel: key codes are Windows virtual-key
+// codes, mouse buttons are 1 = left, 2 = middle, 3 = right, 4/5 = X buttons,
+// and touch/pen/absolute coordinates are 0..1 fractions of screen |screen_id|.
+class InputSink {
+public:
+    virtual ~InputSink() = default;
+
+    virtual void KeyEvent(uint16_t key_code, bool is_down) = 0;
+    virtual void MouseMoveRelative(double dx, double dy) = 0;
+    virtual void MouseMoveAbsolute(double x, double y, int screen_id) = 0;
+    virtual void MouseButton(int button_id, bool is_down) = 0;
+    virtual void MouseScroll(double dx, double dy) = 0;
+    virtual void TouchEvent(int screen_id, double x, double y, uint32_t touch_id, bool is_down) = 0;
+    virtual void TouchMove(int screen_id, double x, double y, uint32_t touch_id) = 0;
+    virtual void PenEvent(int screen_id, double x, double y, bool is_down, bool has_button,
+                          double pressure, double rotation, double tilt) = 0;
+    virtual void PenMove(int screen_id, double x, double y, bool has_button,
+                         double pressure, double rotation, double tilt) = 0;
+    // Consecutive pen moves on one screen, oldest first. Sinks that can
+    // convert and inject them together override this.
+    virtual void PenMoveBatch(int screen_id, const PenSample* samples, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            const PenSample& sample = samples[i];
+            PenMove(screen_id, sample.x, sample.y, sample.has_button, sample.pressure,
+                    sample.rotation, sample.tilt);
+        }
+    }
+    // Touch updates the OS should see at once, each contact at most once,
+    // in order. Sinks that can inject several contacts in one call override
+    // this.
+    virtual void TouchFrame(const TouchUpdate* updates, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            const TouchUpdate& update = updates[i];
+            if (update.type == TouchUpdateType::kMove) {
+                TouchMove(update.screen_id, update.x, update.y, update.touch_id);
+            } else {
+                TouchEvent(update.screen_id, update.x, update.y, update.touch_id,
+                           update.type == TouchUpdateType::kDown);
+            }
+        }
+    }
+    // Ends the touch frame being gathered. Only sinks that gather touch
+    // updates into frames (TouchFrameSink) and those passing calls along do
+    // anything with it.
+    virtual void FlushTouchFrame() {}
+    // Auto-repeat of a held key or touch contact. Sinks drop it when the
+    // input was released after the repeat was scheduled.
+    virtual void KeyRepeat(uint16_t key_code) = 0;
+    virtual void TouchRepeat(uint32_t touch_id) = 0;
+};
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_INPUT_SINK_H_
@@ -0,0 +1,326 @@
+#include "input_smoothing.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "gesture.h"
+#include "method_schema.h"
+
+namespace hardware_simulator {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Pen samples smoothed per lock, and per call on to the next sink.
+constexpr size_t kPenChunk = 64;
+
+constexpr double kMinInterval =
+    std::chrono::duration<double>(kMinSmoothingInterval).count();
+// Weight of each arrival interval in the average.
+constexpr double kIntervalWeight = 0.05;
+// An arrival this many average intervals after the previous one is a pause.
+constexpr double kPauseIntervals = 4;
+
+// Weight of a new sample in a low-pass filter at |cutoff_hz|.
+double Alpha(double cutoff_hz, double dt) {
+    double tau = 1 / (2 * kPi * cutoff_hz);
+    return dt / (dt + tau);
+}
+
+bool IsGestureContact(uint32_t touch_id) {
+    return touch_id >= kGestureTouchIdBase;
+}
+
+}  // namespace
+
+bool ParseSmoothedDevice(std::string_view name, SmoothedDevice* device) {
+    if (name == "pen") {
+        *device = SmoothedDevice::kPen;
+    } else if (name == "touch") {
+        *device = SmoothedDevice::kTouch;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool MakeSmoothingParams(const SetInputSmoothingArgs& args, SmoothedDevice* device,
+                         OneEuroParams* params) {
+    if (!ParseSmoothedDevice(args.device, device)) {
+        return false;
+    }
+    OneEuroParams read;
+    if (!std::isnan(args.min_cutoff_hz)) {
+        read.min_cutoff_hz = args.min_cutoff_hz;
+    }
+    if (!std::isnan(args.beta)) {
+        read.beta = args.beta;
+    }
+    if (!std::isnan(args.derivative_cutoff_hz)) {
+        read.derivative_cutoff_hz = args.derivative_cutoff_hz;
+    }
+    if (!std::isfinite(read.min_cutoff_hz) || read.min_cutoff_hz <= 0 ||
+        !std::isfinite(read.beta) || read.beta < 0 ||
+        !std::isfinite(read.derivative_cutoff_hz) || read.derivative_cutoff_hz <= 0) {
+        return false;
+    }
+    *params = read;
+    return true;
+}
+
+void OneEuroFilter::Filter(const OneEuroParams& params, double dt, double x, double y,
+                           double* out_x, double* out_y) {
+    if (!primed_) {
+        primed_ = true;
+        x_ = x;
+        y_ = y;
+        dx_ = 0;
+        dy_ = 0;
+    } else {
+        double derivative_alpha = Alpha(params.derivative_cutoff_hz, dt);
+        dx_ += derivative_alpha * ((x - x_) / dt - dx_);
+        dy_ += derivative_alpha * ((y - y_) / dt - dy_);
+        double cutoff = params.min_cutoff_hz + params.beta * std::sqrt(dx_ * dx_ + dy_ * dy_);
+        double alpha = Alpha(cutoff, dt);
+        x_ += alpha * (x - x_);
+        y_ += alpha * (y - y_);
+    }
+    *out_x = x_;
+    *out_y = y_;
+}
+
+void SmoothingInputSink::Enable(SmoothedDevice device, const OneEuroParams& params) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (device == SmoothedDevice::kPen) {
+        pen_params_ = params;
+        pen_ = Track();
+        pen_enabled_.store(true, std::memory_order_release);
+    } else {
+        touch_params_ = params;
+        contact_count_ = 0;
+        touch_enabled_.store(true, std::memory_order_release);
+    }
+}
+
+void SmoothingInputSink::Disable(SmoothedDevice device) {
+    std::atomic<bool>& enabled =
+        device == SmoothedDevice::kPen ? pen_enabled_ : touch_enabled_;
+    enabled.store(false, std::memory_order_release);
+}
+
+double SmoothingInputSink::Interval(Track& track, TimePoint now) {
+    double arrival = std::chrono::duration<double>(now - track.last).count();
+    track.last = now;
+    if (track.interval < 0) {
+        // Nothing to measure yet; the filter passes the first sample through.
+        track.interval = 0;
+        return kMinInterval;
+    }
+    if (track.interval == 0) {
+        track.interval = (std::max)(arrival, kMinInterval);
+        return track.interval;
+    }
+    if (arrival > kPauseIntervals * track.interval) {
+        // The sender paused or the link stalled: let the filter catch up.
+        return arrival;
+    }
+    track.interval = (std::max)(track.interval + kIntervalWeight * (arrival - track.interval),
+                                kMinInterval);
+    return track.interval;
+}
+
+void SmoothingInputSink::SmoothPen(int screen_id, TimePoint now, double* x, double* y) {
+    if (pen_.screen_id != screen_id) {
+        pen_.screen_id = screen_id;
+        pen_.filter.Reset();
+    }
+    pen_.filter.Filter(pen_params_, Interval(pen_, now), *x, *y, x, y);
+}
+
+SmoothingInputSink::Track* SmoothingInputSink::FindContact(uint32_t touch_id) {
+    for (size_t i = 0; i < contact_count_; ++i) {
+        if (contacts_[i].touch_id == touch_id) {
+            return &contacts_[i];
+        }
+    }
+    return nullptr;
+}
+
+void SmoothingInputSink::SmoothTouch(TouchUpdate& update, TimePoint now) {
+    if (IsGestureContact(update.touch_id)) {
+        return;
+    }
+    Track* track = FindContact(update.touch_id);
+    if (track == nullptr) {
+        if (update.type == TouchUpdateType::kUp || contact_count_ == kMaxTouchContactsLimit) {
+            return;
+        }
+        // Moves of a contact that went down before smoothing was enabled
+        // start its filter too.
+        track = &contacts_[contact_count_++];
+        *track = Track();
+        track->touch_id = update.touch_id;
+        track->screen_id = update.screen_id;
+    }
+    if (update.type == TouchUpdateType::kDown || track->screen_id != update.screen_id) {
+        track->screen_id = update.screen_id;
+        track->filter.Reset();
+    }
+    track->filter.Filter(touch_params_, Interval(*track, now), update.x, update.y, &update.x,
+                         &update.y);
+    if (update.type == TouchUpdateType::kUp) {
+        *track = contacts_[--contact_count_];
+    }
+}
+
+void SmoothingInputSink::KeyEvent(uint16_t key_code, bool is_down) {
+    next_.KeyEvent(key_code, is_down);
+}
+
+void SmoothingInputSink::MouseMoveRelative(double dx, double dy) {
+    next_.MouseMoveRelative(dx, dy);
+}
+
+void SmoothingInputSink::MouseMoveAbsolute(double x, double y, int screen_id) {
+    next_.MouseMoveAbsolute(x, y, screen_id);
+}
+
+void SmoothingInputSink::MouseButton(int button_id, bool is_down) {
+    next_.MouseButton(button_id, is_down);
+}
+
+void SmoothingInputSink::MouseScroll(double dx, double dy) {
+    next_.MouseScroll(dx, dy);
+}
+
+void SmoothingInputSink::TouchEvent(int screen_id, double x, double y, uint32_t touch_id,
+                                    bool is_down) {
+    if (!touch_enabled_.load(std::memory_order_acquire)) {
+        next_.TouchEvent(screen_id, x, y, touch_id, is_down);
+        return;
+    }
+    TouchUpdate update;
+    update.type = is_down ? TouchUpdateType::kDown : TouchUpdateType::kUp;
+    update.screen_id = screen_id;
+    update.touch_id = touch_id;
+    update.x = x;
+    update.y = y;
+    TimePoint now = now_();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        SmoothTouch(update, now);
+    }
+    next_.TouchEvent(screen_id, update.x, update.y, touch_id, is_down);
+}
+
+void SmoothingInputSink::TouchMove(int screen_id, double x, double y, uint32_t touch_id) {
+    if (!touch_enabled_.load(std::memory_order_acquire)) {
+        next_.TouchMove(screen_id, x, y, touch_id);
+        return;
+    }
+    TouchUpdate update;
+    update.type = TouchUpdateType::kMove;
+    update.screen_id = screen_id;
+    update.touch_id = touch_id;
+    update.x = x;
+    update.y = y;
+    TimePoint now = now_();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        SmoothTouch(update, now);
+    }
+    next_.TouchMove(screen_id, update.x, update.y, touch_id);
+}
+
+void SmoothingInputSink::PenEvent(int screen_id, double x, double y, bool is_down,
+                                  bool has_button, double pressure, double rotation,
+                                  double tilt) {
+    if (pen_enabled_.load(std::memory_order_acquire)) {
+        TimePoint now = now_();
+        std::lock_guard<std::mutex> lock(mutex_);
+        SmoothPen(screen_id, now, &x, &y);
+    }
+    next_.PenEvent(screen_id, x, y, is_down, has_button, pressure, rotation, tilt);
+}
+
+void SmoothingInputSink::PenMove(int screen_id, double x, double y, bool has_button,
+                                 double pressure, double rotation, double tilt) {
+    if (pen_enabled_.load(std::memory_order_acquire)) {
+        TimePoint now = now_();
+        std::lock_guard<std::mutex> lock(mutex_);
+        SmoothPen(screen_id, now, &x, &y);
+    }
+    next_.PenMove(screen_id, x, y, has_button, pressure, rotation, tilt);
+}
+
+void SmoothingInputSink::PenMoveBatch(int screen_id, const PenSample* samples, size_t count) {
+    if (!pen_enabled_.load(std::memory_order_acquire)) {
+        next_.PenMoveBatch(screen_id, samples, count);
+        return;
+    }
+    TimePoint now = now_();
+    // The run was sampled since the previous arrival, so its samples are
+    // spread evenly over that time, the last one at |now|. Timing them all
+    // by |now| would wear the average interval down to kMinInterval. With
+    // no previous arrival there is nothing to spread over.
+    TimePoint start = now;
+    size_t total = count;
+    size_t index = 0;
+    PenSample chunk[kPenChunk];
+    while (count > 0) {
+        size_t size = (std::min)(count, kPenChunk);
+        std::copy(samples, samples + size, chunk);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (index == 0 && pen_.interval >= 0 && pen_.last < now) {
+                start = pen_.last;
+            }
+            for (size_t i = 0; i < size; ++i) {
+                ++index;
+                TimePoint at = start + (now - start) * static_cast<int64_t>(index) /
+                                           static_cast<int64_t>(total);
+                SmoothPen(screen_id, at, &chunk[i].x, &chunk[i].y);
+            }
+        }
+        next_.PenMoveBatch(screen_id, chunk, size);
+        samples += size;
+        count -= size;
+    }
+}
+
+void SmoothingInputSink::TouchFrame(const TouchUpdate* updates, size_t count) {
+    if (!touch_enabled_.load(std::memory_order_acquire)) {
+        next_.TouchFrame(updates, count);
+        return;
+    }
+    TimePoint now = now_();
+    TouchUpdate frame[kMaxTouchContactsLimit];
+    while (count > 0) {
+        size_t size = (std::min)(count, kMaxTouchContactsLimit);
+        std::copy(updates, updates + size, frame);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (size_t i = 0; i < size; ++i) {
+                SmoothTouch(frame[i], now);
+            }
+        }
+        next_.TouchFrame(frame, size);
+        updates += size;
+        count -= size;
+    }
+}
+
+void SmoothingInputSink::FlushTouchFrame() {
+    next_.FlushTouchFrame();
+}
+
+void SmoothingInputSink::KeyRepeat(uint16_t key_code) {
+    next_.KeyRepeat(key_code);
+}
+
+void SmoothingInputSink::TouchRepeat(uint32_t touch_id) {
+    next_.TouchRepeat(touch_id);
+}
+
+}  // namespace hardware_simulator
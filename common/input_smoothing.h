@@ -0,0 +1,141 @@
+#ifndef FLUTTER_PLUGIN_INPUT_SMOOTHING_H_
+#define FLUTTER_PLUGIN_INPUT_SMOOTHING_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string_view>
+#include <utility>
+
+#include "input_sink.h"
+#include "touch_contact_table.h"
+
+namespace hardware_simulator {
+
+struct SetInputSmoothingArgs;
+
+enum class SmoothedDevice : uint8_t { kPen, kTouch };
+
+// Parses "pen" or "touch".
+bool ParseSmoothedDevice(std::string_view name, SmoothedDevice* device);
+
+// One-Euro filter settings, with positions in screen fractions. The cutoff
+// starts at |min_cutoff_hz| for a still point, which sets how much jitter is
+// removed, and rises by |beta| per screen per second of speed, which sets
+// how little a fast stroke lags.
+struct OneEuroParams {
+    double min_cutoff_hz = 1.0;
+    double beta = 20.0;
+    // Smooths the speed estimate that steers the cutoff.
+    double derivative_cutoff_hz = 1.0;
+};
+
+// Reads setInputSmoothing arguments. Returns false for an unknown device, a
+// cutoff that is not positive or a negative beta.
+bool MakeSmoothingParams(const SetInputSmoothingArgs& args, SmoothedDevice* device,
+                         OneEuroParams* params);
+
+// Samples are never taken to be closer together than this.
+constexpr std::chrono::microseconds kMinSmoothingInterval{1000};
+
+// A One-Euro filter over 2D points: a low-pass filter whose cutoff follows
+// the filtered speed. Both axes share the cutoff so a diagonal stroke is
+// smoothed like a straight one.
+class OneEuroFilter {
+public:
+    // The next sample passes through and starts the filter over.
+    void Reset() { primed_ = false; }
+
+    // Smooths the sample at |x|, |y| taken |dt| seconds after the previous
+    // one; |dt| must be positive.
+    void Filter(const OneEuroParams& params, double dt, double x, double y, double* out_x,
+                double* out_y);
+
+private:
+    bool primed_ = false;
+    double x_ = 0;
+    double y_ = 0;
+    double dx_ = 0;
+    double dy_ = 0;
+};
+
+// InputSink that smooths pen and touch positions with a One-Euro filter per
+// pen and per contact before passing them on to |next|. Each device is off
+// until enabled; while off its calls pass straight through. Touch downs
+// pass through and start their contact's filter; the up lands where the
+// filtered contact is. Gesture contacts (kGestureTouchIdBase and up) are
+// already smooth and pass through. Everything else is untouched.
+//
+// Safe to call from several producer threads. Senders' clocks are not
+// comparable, so samples are timed by |now| as they arrive. A jittery link
+// delivers them in bursts and gaps, so the filter steps by the interval
+// arrivals average out to, and by the real one only after a pause.
+class SmoothingInputSink : public InputSink {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+
+    explicit SmoothingInputSink(InputSink& next, std::function<TimePoint()> now = Clock::now)
+        : next_(next), now_(std::move(now)) {}
+
+    SmoothingInputSink(const SmoothingInputSink&) = delete;
+    SmoothingInputSink& operator=(const SmoothingInputSink&) = delete;
+
+    // Smooths |device| with |params| from its next sample on.
+    void Enable(SmoothedDevice device, const OneEuroParams& params);
+    void Disable(SmoothedDevice device);
+
+    void KeyEvent(uint16_t key_code, bool is_down) override;
+    void MouseMoveRelative(double dx, double dy) override;
+    void MouseMoveAbsolute(double x, double y, int screen_id) override;
+    void MouseButton(int button_id, bool is_down) override;
+    void MouseScroll(double dx, double dy) override;
+    void TouchEvent(int screen_id, double x, double y, uint32_t touch_id, bool is_down) override;
+    void TouchMove(int screen_id, double x, double y, uint32_t touch_id) override;
+    void PenEvent(int screen_id, double x, double y, bool is_down, bool has_button,
+                  double pressure, double rotation, double tilt) override;
+    void PenMove(int screen_id, double x, double y, bool has_button,
+                 double pressure, double rotation, double tilt) override;
+    void PenMoveBatch(int screen_id, const PenSample* samples, size_t count) override;
+    void TouchFrame(const TouchUpdate* updates, size_t count) override;
+    void FlushTouchFrame() override;
+    void KeyRepeat(uint16_t key_code) override;
+    void TouchRepeat(uint32_t touch_id) override;
+
+private:
+    struct Track {
+        uint32_t touch_id = 0;
+        int screen_id = 0;
+        TimePoint last;
+        // Average time between samples, in seconds; 0 until two arrived,
+        // and below that before the first.
+        double interval = -1;
+        OneEuroFilter filter;
+    };
+
+    // How many seconds the filter steps for a sample of |track| at |now|.
+    static double Interval(Track& track, TimePoint now);
+    void SmoothPen(int screen_id, TimePoint now, double* x, double* y);
+    void SmoothTouch(TouchUpdate& update, TimePoint now);
+    Track* FindContact(uint32_t touch_id);
+
+    InputSink& next_;
+    std::function<TimePoint()> now_;
+    std::atomic<bool> pen_enabled_{false};
+    std::atomic<bool> touch_enabled_{false};
+
+    std::mutex mutex_;
+    OneEuroParams pen_params_;
+    OneEuroParams touch_params_;
+    Track pen_;
+    // Contacts being smoothed, in no particular order.
+    Track contacts_[kMaxTouchContactsLimit];
+    size_t contact_count_ = 0;
+};
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_INPUT_SMOOTHING_H_
@@ -0,0 +1,259 @@
+#ifndef FLUTTER_PLUGIN_KEY_CODES_H_
+#define FLUTTER_PLUGIN_KEY_CODES_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace hardware_simulator {
+
+// Flags of a KeyCodes entry.
+constexpr uint8_t kKeyExtended = 1 << 0;         // Set-1 scancode has the E0 prefix.
+constexpr uint8_t kKeyLayoutDependent = 1 << 1;  // Which key it is depends on the layout.
+
+// What one Windows virtual-key code, as sent by the Dart side, corresponds to
+// in each backend's key space. Zero means there is no equivalent.
+//
+// scancode and evdev are physical positions on a US keyboard. For keys
+// marked kKeyLayoutDependent (letters and punctuation) the virtual-key code
+// names the character rather than the position, so backends that can ask the
+// active layout should prefer it for those.
+struct KeyCodes {
+    uint16_t scancode = 0;   // PS/2 set 1, without the E0 prefix.
+    uint8_t flags = 0;
+    uint16_t evdev = 0;      // Linux KEY_*.
+    uint32_t keysym = 0;     // X11 XK_*, unshifted.
+    uint16_t hid_usage = 0;  // USB HID keyboard page (0x07).
+
+    constexpr bool extended() const { return (flags & kKeyExtended) != 0; }
+    constexpr bool layout_dependent() const { return (flags & kKeyLayoutDependent) != 0; }
+    // False for codes the table has no entry for. Every entry has an evdev
+    // code, so a listed key with no scancode really has no single one.
+    constexpr bool listed() const { return evdev != 0; }
+};
+
+namespace key_codes {
+
+struct Entry {
+    uint8_t vk;
+    uint16_t scancode;
+    uint8_t flags;
+    uint16_t evdev;
+    uint32_t keysym;
+    uint16_t hid_usage;
+};
+
+// Virtual-key code, set-1 scancode, flags, evdev code, keysym, HID usage.
+inline constexpr Entry kEntries[] = {
+    {0x08, 0x0E, 0, 14, 0xFF08, 0x2A},  // VK_BACK: KEY_BACKSPACE, XK_BackSpace
+    {0x09, 0x0F, 0, 15, 0xFF09, 0x2B},  // VK_TAB: KEY_TAB, XK_Tab
+    {0x0D, 0x1C, 0, 28, 0xFF0D, 0x28},  // VK_RETURN: KEY_ENTER, XK_Return
+    {0x10, 0x2A, 0, 42, 0xFFE1, 0xE1},  // VK_SHIFT: KEY_LEFTSHIFT, XK_Shift_L
+    {0x11, 0x1D, 0, 29, 0xFFE3, 0xE0},  // VK_CONTROL: KEY_LEFTCTRL, XK_Control_L
+    {0x12, 0x38, 0, 56, 0xFFE9, 0xE2},  // VK_MENU: KEY_LEFTALT, XK_Alt_L
+    {0x13, 0x00, 0, 119, 0xFF13, 0x48},  // VK_PAUSE: KEY_PAUSE, XK_Pause
+    {0x14, 0x3A, 0, 58, 0xFFE5, 0x39},  // VK_CAPITAL: KEY_CAPSLOCK, XK_Caps_Lock
+    {0x1B, 0x01, 0, 1, 0xFF1B, 0x29},  // VK_ESCAPE: KEY_ESC, XK_Escape
+    {0x20, 0x39, 0, 57, 0x0020, 0x2C},  // VK_SPACE: KEY_SPACE, XK_space
+    {0x21, 0x49, kKeyExtended, 104, 0xFF55, 0x4B},  // VK_PRIOR: KEY_PAGEUP, XK_Prior
+    {0x22, 0x51, kKeyExtended, 109, 0xFF56, 0x4E},  // VK_NEXT: KEY_PAGEDOWN, XK_Next
+    {0x23, 0x4F, kKeyExtended, 107, 0xFF57, 0x4D},  // VK_END: KEY_END, XK_End
+    {0x24, 0x47, kKeyExtended, 102, 0xFF50, 0x4A},  // VK_HOME: KEY_HOME, XK_Home
+    {0x25, 0x4B, kKeyExtended, 105, 0xFF51, 0x50},  // VK_LEFT: KEY_LEFT, XK_Left
+    {0x26, 0x48, kKeyExtended, 103, 0xFF52, 0x52},  // VK_UP: KEY_UP, XK_Up
+    {0x27, 0x4D, kKeyExtended, 106, 0xFF53, 0x4F},  // VK_RIGHT: KEY_RIGHT, XK_Right
+    {0x28, 0x50, kKeyExtended, 108, 0xFF54, 0x51},  // VK_DOWN: KEY_DOWN, XK_Down
+    {0x2C, 0x37, kKeyExtended, 99, 0xFF61, 0x46},  // VK_SNAPSHOT: KEY_SYSRQ, XK_Print
+    {0x2D, 0x52, kKeyExtended, 110, 0xFF63, 0x49},  // VK_INSERT: KEY_INSERT, XK_Insert
+    {0x2E, 0x53, kKeyExtended, 111, 0xFFFF, 0x4C},  // VK_DELETE: KEY_DELETE, XK_Delete
+    {0x31, 0x02, 0, 2, 0x0031, 0x1E},  // '1': KEY_1, XK_1
+    {0x32, 0x03, 0, 3, 0x0032, 0x1F},  // '2': KEY_2, XK_2
+    {0x33, 0x04, 0, 4, 0x0033, 0x20},  // '3': KEY_3, XK_3
+    {0x34, 0x05, 0, 5, 0x0034, 0x21},  // '4': KEY_4, XK_4
+    {0x35, 0x06, 0, 6, 0x0035, 0x22},  // '5': KEY_5, XK_5
+    {0x36, 0x07, 0, 7, 0x0036, 0x23},  // '6': KEY_6, XK_6
+    {0x37, 0x08, 0, 8, 0x0037, 0x24},  // '7': KEY_7, XK_7
+    {0x38, 0x09, 0, 9, 0x0038, 0x25},  // '8': KEY_8, XK_8
+    {0x39, 0x0A, 0, 10, 0x0039, 0x26},  // '9': KEY_9, XK_9
+    {0x30, 0x0B, 0, 11, 0x0030, 0x27},  // '0': KEY_0, XK_0
+    {0x41, 0x1E, kKeyLayoutDependent, 30, 0x0061, 0x04},  // 'A': KEY_A, XK_a
+    {0x42, 0x30, kKeyLayoutDependent, 48, 0x0062, 0x05},  // 'B': KEY_B, XK_b
+    {0x43, 0x2E, kKeyLayoutDependent, 46, 0x0063, 0x06},  // 'C': KEY_C, XK_c
+    {0x44, 0x20, kKeyLayoutDependent, 32, 0x0064, 0x07},  // 'D': KEY_D, XK_d
+    {0x45, 0x12, kKeyLayoutDependent, 18, 0x0065, 0x08},  // 'E': KEY_E, XK_e
+    {0x46, 0x21, kKeyLayoutDependent, 33, 0x0066, 0x09},  // 'F': KEY_F, XK_f
+    {0x47, 0x22, kKeyLayoutDependent, 34, 0x0067, 0x0A},  // 'G': KEY_G, XK_g
+    {0x48, 0x23, kKeyLayoutDependent, 35, 0x0068, 0x0B},  // 'H': KEY_H, XK_h
+    {0x49, 0x17, kKeyLayoutDependent, 23, 0x0069, 0x0C},  // 'I': KEY_I, XK_i
+    {0x4A, 0x24, kKeyLayoutDependent, 36, 0x006A, 0x0D},  // 'J': KEY_J, XK_j
+    {0x4B, 0x25, kKeyLayoutDependent, 37, 0x006B, 0x0E},  // 'K': KEY_K, XK_k
+    {0x4C, 0x26, kKeyLayoutDependent, 38, 0x006C, 0x0F},  // 'L': KEY_L, XK_l
+    {0x4D, 0x32, kKeyLayoutDependent, 50, 0x006D, 0x10},  // 'M': KEY_M, XK_m
+    {0x4E, 0x31, kKeyLayoutDependent, 49, 0x006E, 0x11},  // 'N': KEY_N, XK_n
+    {0x4F, 0x18, kKeyLayoutDependent, 24, 0x006F, 0x12},  // 'O': KEY_O, XK_o
+    {0x50, 0x19, kKeyLayoutDependent, 25, 0x0070, 0x13},  // 'P': KEY_P, XK_p
+    {0x51, 0x10, kKeyLayoutDependent, 16, 0x0071, 0x14},  // 'Q': KEY_Q, XK_q
+    {0x52, 0x13, kKeyLayoutDependent, 19, 0x0072, 0x15},  // 'R': KEY_R, XK_r
+    {0x53, 0x1F, kKeyLayoutDependent, 31, 0x0073, 0x16},  // 'S': KEY_S, XK_s
+    {0x54, 0x14, kKeyLayoutDependent, 20, 0x0074, 0x17},  // 'T': KEY_T, XK_t
+    {0x55, 0x16, kKeyLayoutDependent, 22, 0x0075, 0x18},  // 'U': KEY_U, XK_u
+    {0x56, 0x2F, kKeyLayoutDependent, 47, 0x0076, 0x19},  // 'V': KEY_V, XK_v
+    {0x57, 0x11, kKeyLayoutDependent, 17, 0x0077, 0x1A},  // 'W': KEY_W, XK_w
+    {0x58, 0x2D, kKeyLayoutDependent, 45, 0x0078, 0x1B},  // 'X': KEY_X, XK_x
+    {0x59, 0x15, kKeyLayoutDependent, 21, 0x0079, 0x1C},  // 'Y': KEY_Y, XK_y
+    {0x5A, 0x2C, kKeyLayoutDependent, 44, 0x007A, 0x1D},  // 'Z': KEY_Z, XK_z
+    {0x5B, 0x5B, kKeyExtended, 125, 0xFFEB, 0xE3},  // VK_LWIN: KEY_LEFTMETA, XK_Super_L
+    {0x5C, 0x5C, kKeyExtended, 126, 0xFFEC, 0xE7},  // VK_RWIN: KEY_RIGHTMETA, XK_Super_R
+    {0x5D, 0x5D, kKeyExtended, 127, 0xFF67, 0x65},  // VK_APPS: KEY_COMPOSE, XK_Menu
+    {0x60, 0x52, 0, 82, 0xFFB0, 0x62},  // VK_NUMPAD0: KEY_KP0, XK_KP_0
+    {0x61, 0x4F, 0, 79, 0xFFB1, 0x59},  // VK_NUMPAD1: KEY_KP1, XK_KP_1
+    {0x62, 0x50, 0, 80, 0xFFB2, 0x5A},  // VK_NUMPAD2: KEY_KP2, XK_KP_2
+    {0x63, 0x51, 0, 81, 0xFFB3, 0x5B},  // VK_NUMPAD3: KEY_KP3, XK_KP_3
+    {0x64, 0x4B, 0, 75, 0xFFB4, 0x5C},  // VK_NUMPAD4: KEY_KP4, XK_KP_4
+    {0x65, 0x4C, 0, 76, 0xFFB5, 0x5D},  // VK_NUMPAD5: KEY_KP5, XK_KP_5
+    {0x66, 0x4D, 0, 77, 0xFFB6, 0x5E},  // VK_NUMPAD6: KEY_KP6, XK_KP_6
+    {0x67, 0x47, 0, 71, 0xFFB7, 0x5F},  // VK_NUMPAD7: KEY_KP7, XK_KP_7
+    {0x68, 0x48, 0, 72, 0xFFB8, 0x60},  // VK_NUMPAD8: KEY_KP8, XK_KP_8
+    {0x69, 0x49, 0, 73, 0xFFB9, 0x61},  // VK_NUMPAD9: KEY_KP9, XK_KP_9
+    {0x6A, 0x37, 0, 55, 0xFFAA, 0x55},  // VK_MULTIPLY: KEY_KPASTERISK, XK_KP_Multiply
+    {0x6B, 0x4E, 0, 78, 0xFFAB, 0x57},  // VK_ADD: KEY_KPPLUS, XK_KP_Add
+    {0x6D, 0x4A, 0, 74, 0xFFAD, 0x56},  // VK_SUBTRACT: KEY_KPMINUS, XK_KP_Subtract
+    {0x6E, 0x53, 0, 83, 0xFFAE, 0x63},  // VK_DECIMAL: KEY_KPDOT, XK_KP_Decimal
+    {0x6F, 0x35, kKeyExtended, 98, 0xFFAF, 0x54},  // VK_DIVIDE: KEY_KPSLASH, XK_KP_Divide
+    {0x70, 0x3B, 0, 59, 0xFFBE, 0x3A},  // VK_F1: KEY_F1, XK_F1
+    {0x71, 0x3C, 0, 60, 0xFFBF, 0x3B},  // VK_F2: KEY_F2, XK_F2
+    {0x72, 0x3D, 0, 61, 0xFFC0, 0x3C},  // VK_F3: KEY_F3, XK_F3
+    {0x73, 0x3E, 0, 62, 0xFFC1, 0x3D},  // VK_F4: KEY_F4, XK_F4
+    {0x74, 0x3F, 0, 63, 0xFFC2, 0x3E},  // VK_F5: KEY_F5, XK_F5
+    {0x75, 0x40, 0, 64, 0xFFC3, 0x3F},  // VK_F6: KEY_F6, XK_F6
+    {0x76, 0x41, 0, 65, 0xFFC4, 0x40},  // VK_F7: KEY_F7, XK_F7
+    {0x77, 0x42, 0, 66, 0xFFC5, 0x41},  // VK_F8: KEY_F8, XK_F8
+    {0x78, 0x43, 0, 67, 0xFFC6, 0x42},  // VK_F9: KEY_F9, XK_F9
+    {0x79, 0x44, 0, 68, 0xFFC7, 0x43},  // VK_F10: KEY_F10, XK_F10
+    {0x7A, 0x57, 0, 87, 0xFFC8, 0x44},  // VK_F11: KEY_F11, XK_F11
+    {0x7B, 0x58, 0, 88, 0xFFC9, 0x45},  // VK_F12: KEY_F12, XK_F12
+    {0x7C, 0x64, 0, 183, 0xFFCA, 0x68},  // VK_F13: KEY_F13, XK_F13
+    {0x7D, 0x65, 0, 184, 0xFFCB, 0x69},  // VK_F14: KEY_F14, XK_F14
+    {0x7E, 0x66, 0, 185, 0xFFCC, 0x6A},  // VK_F15: KEY_F15, XK_F15
+    {0x7F, 0x67, 0, 186, 0xFFCD, 0x6B},  // VK_F16: KEY_F16, XK_F16
+    {0x80, 0x68, 0, 187, 0xFFCE, 0x6C},  // VK_F17: KEY_F17, XK_F17
+    {0x81, 0x69, 0, 188, 0xFFCF, 0x6D},  // VK_F18: KEY_F18, XK_F18
+    {0x82, 0x6A, 0, 189, 0xFFD0, 0x6E},  // VK_F19: KEY_F19, XK_F19
+    {0x83, 0x6B, 0, 190, 0xFFD1, 0x6F},  // VK_F20: KEY_F20, XK_F20
+    {0x84, 0x6C, 0, 191, 0xFFD2, 0x70},  // VK_F21: KEY_F21, XK_F21
+    {0x85, 0x6D, 0, 192, 0xFFD3, 0x71},  // VK_F22: KEY_F22, XK_F22
+    {0x86, 0x6E, 0, 193, 0xFFD4, 0x72},  // VK_F23: KEY_F23, XK_F23
+    {0x87, 0x76, 0, 194, 0xFFD5, 0x73},  // VK_F24: KEY_F24, XK_F24
+    {0x90, 0x45, 0, 69, 0xFF7F, 0x53},  // VK_NUMLOCK: KEY_NUMLOCK, XK_Num_Lock
+    {0x91, 0x46, 0, 70, 0xFF14, 0x47},  // VK_SCROLL: KEY_SCROLLLOCK, XK_Scroll_Lock
+    {0xA0, 0x2A, 0, 42, 0xFFE1, 0xE1},  // VK_LSHIFT: KEY_LEFTSHIFT, XK_Shift_L
+    {0xA1, 0x36, 0, 54, 0xFFE2, 0xE5},  // VK_RSHIFT: KEY_RIGHTSHIFT, XK_Shift_R
+    {0xA2, 0x1D, 0, 29, 0xFFE3, 0xE0},  // VK_LCONTROL: KEY_LEFTCTRL, XK_Control_L
+    {0xA3, 0x1D, kKeyExtended, 97, 0xFFE4, 0xE4},  // VK_RCONTROL: KEY_RIGHTCTRL, XK_Control_R
+    {0xA4, 0x38, 0, 56, 0xFFE9, 0xE2},  // VK_LMENU: KEY_LEFTALT, XK_Alt_L
+    {0xA5, 0x38, kKeyExtended, 100, 0xFFEA, 0xE6},  // VK_RMENU: KEY_RIGHTALT, XK_Alt_R
+    {0xAD, 0x20, kKeyExtended, 113, 0x1008FF12, 0x7F},  // VK_VOLUME_MUTE: KEY_MUTE, XK_XF86AudioMute
+    {0xAE, 0x2E, kKeyExtended, 114, 0x1008FF11, 0x81},  // VK_VOLUME_DOWN: KEY_VOLUMEDOWN, XK_XF86AudioLowerVolume
+    {0xAF, 0x30, kKeyExtended, 115, 0x1008FF13, 0x80},  // VK_VOLUME_UP: KEY_VOLUMEUP, XK_XF86AudioRaiseVolume
+    {0xB0, 0x19, kKeyExtended, 163, 0x1008FF17, 0x00},  // VK_MEDIA_NEXT_TRACK: KEY_NEXTSONG, XK_XF86AudioNext
+    {0xB1, 0x10, kKeyExtended, 165, 0x1008FF16, 0x00},  // VK_MEDIA_PREV_TRACK: KEY_PREVIOUSSONG, XK_XF86AudioPrev
+    {0xB2, 0x24, kKeyExtended, 166, 0x1008FF15, 0x00},  // VK_MEDIA_STOP: KEY_STOPCD, XK_XF86AudioStop
+    {0xB3, 0x22, kKeyExtended, 164, 0x1008FF14, 0x00},  // VK_MEDIA_PLAY_PAUSE: KEY_PLAYPAUSE, XK_XF86AudioPlay
+    {0xBA, 0x27, kKeyLayoutDependent, 39, 0x003B, 0x33},  // VK_OEM_1: KEY_SEMICOLON, XK_semicolon
+    {0xBB, 0x0D, kKeyLayoutDependent, 13, 0x003D, 0x2E},  // VK_OEM_PLUS: KEY_EQUAL, XK_equal
+    {0xBC, 0x33, kKeyLayoutDependent, 51, 0x002C, 0x36},  // VK_OEM_COMMA: KEY_COMMA, XK_comma
+    {0xBD, 0x0C, kKeyLayoutDependent, 12, 0x002D, 0x2D},  // VK_OEM_MINUS: KEY_MINUS, XK_minus
+    {0xBE, 0x34, kKeyLayoutDependent, 52, 0x002E, 0x37},  // VK_OEM_PERIOD: KEY_DOT, XK_period
+    {0xBF, 0x35, kKeyLayoutDependent, 53, 0x002F, 0x38},  // VK_OEM_2: KEY_SLASH, XK_slash
+    {0xC0, 0x29, kKeyLayoutDependent, 41, 0x0060, 0x35},  // VK_OEM_3: KEY_GRAVE, XK_grave
+    {0xDB, 0x1A, kKeyLayoutDependent, 26, 0x005B, 0x2F},  // VK_OEM_4: KEY_LEFTBRACE, XK_bracketleft
+    {0xDC, 0x2B, kKeyLayoutDependent, 43, 0x005C, 0x31},  // VK_OEM_5: KEY_BACKSLASH, XK_backslash
+    {0xDD, 0x1B, kKeyLayoutDependent, 27, 0x005D, 0x30},  // VK_OEM_6: KEY_RIGHTBRACE, XK_bracketright
+    {0xDE, 0x28, kKeyLayoutDependent, 40, 0x0027, 0x34},  // VK_OEM_7: KEY_APOSTROPHE, XK_apostrophe
+    {0xE2, 0x56, kKeyLayoutDependent, 86, 0x003C, 0x64},  // VK_OEM_102: KEY_102ND, XK_less
+};
+
+constexpr std::array<KeyCodes, 256> BuildTable() {
+    std::array<KeyCodes, 256> table{};
+    for (const auto& entry : kEntries) {
+        KeyCodes& codes = table[entry.vk];
+        codes.scancode = entry.scancode;
+        codes.flags = entry.flags;
+        codes.evdev = entry.evdev;
+        codes.keysym = entry.keysym;
+        codes.hid_usage = entry.hid_usage;
+    }
+    return table;
+}
+
+constexpr bool HasDuplicateKeys() {
+    std::array<bool, 256> seen{};
+    for (const auto& entry : kEntries) {
+        if (seen[entry.vk]) {
+            return true;
+        }
+        seen[entry.vk] = true;
+    }
+    return false;
+}
+static_assert(!HasDuplicateKeys(), "A virtual-key code is listed twice");
+
+inline constexpr std::array<KeyCodes, 256> kTable = BuildTable();
+
+struct KeysymEntry {
+    uint32_t keysym;
+    uint8_t vk;
+};
+
+inline constexpr size_t kEntryCount = sizeof(kEntries) / sizeof(kEntries[0]);
+
+// kEntries ordered by keysym for a binary search. Where a neutral and a sided
+// code share a keysym (VK_SHIFT and VK_LSHIFT, ...), only the sided one is
+// kept, as a low-level keyboard hook reports it.
+constexpr std::array<KeysymEntry, kEntryCount> BuildKeysymIndex() {
+    std::array<KeysymEntry, kEntryCount> index{};
+    for (size_t i = 0; i < kEntryCount; ++i) {
+        KeysymEntry entry{kEntries[i].keysym, kEntries[i].vk};
+        size_t j = i;
+        for (; j > 0 && index[j - 1].keysym > entry.keysym; --j) {
+            index[j] = index[j - 1];
+        }
+        index[j] = entry;
+    }
+    return index;
+}
+
+inline constexpr std::array<KeysymEntry, kEntryCount> kKeysymIndex = BuildKeysymIndex();
+
+}  // namespace key_codes
+
+// Translation of |vk|; all zero for codes without an entry.
+constexpr const KeyCodes& KeyCodesFor(uint16_t vk) {
+    return key_codes::kTable[vk < 256 ? vk : 0];
+}
+
+// Virtual-key code of an unshifted X11 keysym, or 0 for keysyms without one.
+// Sided modifier keysyms map to the sided codes (XK_Shift_L: VK_LSHIFT).
+constexpr uint8_t VirtualKeyForKeysym(uint32_t keysym) {
+    const auto& index = key_codes::kKeysymIndex;
+    size_t low = 0;
+    size_t high = index.size();
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (index[mid].keysym < keysym) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    // Equal keysyms keep table order, so the sided code is the last of them.
+    uint8_t vk = 0;
+    for (; low < index.size() && index[low].keysym == keysym; ++low) {
+        vk = index[low].vk;
+    }
+    return vk;
+}
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_KEY_CODES_H_
@@ -0,0 +1,97 @@
+#ifndef FLUTTER_PLUGIN_LOCKED_INPUT_SINK_H_
+#define FLUTTER_PLUGIN_LOCKED_INPUT_SINK_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "input_sink.h"
+
+namespace hardware_simulator {
+
+// InputSink that passes every call on to |next| under one lock, so a sink
+// that is not thread-safe can be fed from the platform thread and the input
+// ring consumer at once. Batches and frames are passed on whole, inside a
+// single lock, so they reach |next| unsplit.
+class LockedInputSink : public InputSink {
+public:
+    explicit LockedInputSink(InputSink& next) : next_(next) {}
+
+    LockedInputSink(const LockedInputSink&) = delete;
+    LockedInputSink& operator=(const LockedInputSink&) = delete;
+
+    void KeyEvent(uint16_t key_code, bool is_down) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        next_.KeyEvent(key_code, is_down);
+    }
+    void MouseMoveRelative(double dx, double dy) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        next_.MouseMoveRelative(dx, dy);
+    }
+    void MouseMoveAbsolute(double x, double y, int screen_id) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        next_.MouseMoveAbsolute(x, y, screen_id);
+    }
+    void MouseButton(int button_id, bool is_down) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        next_.MouseButton(button_id, is_down);
+    }
+    void MouseScroll(double dx, double dy) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        next_.MouseScroll(dx, dy);
+    }
+    void TouchEvent(int screen_id, double x, double y, uint32_t touch_id, bool is_down) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        next_.TouchEvent(screen_id, x, y, touch_id, is_down);
+    }
+    void TouchMove(int screen_id, double x, double y, uint32_t touch_id) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        next_.TouchMove(screen_id, x, y, touch_id);
+    }
+    void PenEvent(int screen_id, double x, double y, bool is_down, bool has_button,
+                  double pressure, double rotation, double tilt) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        next_.PenEvent(screen_id, x, y, is_down, has_button, pressure, rotation, tilt);
+    }
+    void PenMove(int screen_id, double x, double y, bool has_button,
+                 double pressure, double rotation, double tilt) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        next_.PenMove(screen_id, x, y, has_button, pressure, rotation, tilt);
+    }
+    void PenMoveBatch(int screen_id, const PenSample* samples, size_t count) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        next_.PenMoveBatch(screen_id, samples, count);
+    }
+    void TouchFrame(const TouchUpdate* updates, size_t count) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        next_.TouchFrame(updates, count);
+    }
+    void FlushTouchFrame() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        next_.FlushTouchFrame();
+    }
+    void KeyRepeat(uint16_t key_code) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        next_.KeyRepeat(key_code);
+    }
+    void TouchRepeat(uint32_t touch_id) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        next_.TouchRepeat(touch_id);
+    }
+
+    // Runs |fn| under the lock, for work that reaches |next|'s devices
+    // outside the InputSink calls, such as typing text on them.
+    template <typename Fn>
+    void WithLock(Fn&& fn) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fn();
+    }
+
+private:
+    InputSink& next_;
+    std::mutex mutex_;
+};
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_LOCKED_INPUT_SINK_H_
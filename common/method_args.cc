@@ -0,0 +1,38 @@
+#include "method_args.h"
+
+namespace hardware_simulator {
+
+const char* ArgErrorCodeName(ArgErrorCode code) {
+    switch (code) {
+    case ArgErrorCode::kOk:
+        return "Ok";
+    case ArgErrorCode::kNotAMap:
+        return "NullArguments";
+    case ArgErrorCode::kMissing:
+        return "MissingArgument";
+    case ArgErrorCode::kWrongType:
+        return "InvalidArgumentType";
+    case ArgErrorCode::kOutOfRange:
+        return "ArgumentOutOfRange";
+    }
+    return "InvalidArguments";
+}
+
+std::string ArgError::Message() const {
+    std::string name(key);
+    switch (code) {
+    case ArgErrorCode::kOk:
+        return "";
+    case ArgErrorCode::kNotAMap:
+        return "Arguments are null or not a map";
+    case ArgErrorCode::kMissing:
+        return "Missing argument '" + name + "'";
+    case ArgErrorCode::kWrongType:
+        return "Argument '" + name + "' has the wrong type";
+    case ArgErrorCode::kOutOfRange:
+        return "Argument '" + name + "' is out of range";
+    }
+    return "Invalid argument '" + name + "'";
+}
+
+}  // namespace hardware_simulator
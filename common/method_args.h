@@ -0,0 +1,241 @@
+#ifndef FLUTTER_PLUGIN_METHOD_ARGS_H_
+#define FLUTTER_PLUGIN_METHOD_ARGS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace hardware_simulator {
+
+// Typed decoding of method call argument maps.
+//
+// Each method declares a plain struct plus a constexpr Schema() listing its
+// keys (see method_schema.h). Decoding walks the incoming map once, matches
+// every key against the schema's compile-time key table, type-checks the
+// value straight into the struct member, and reports the first problem as an
+// ArgError instead of dereferencing a missing entry.
+
+enum class ArgErrorCode {
+    kOk = 0,
+    kNotAMap,      // Arguments were null or not a map.
+    kMissing,      // A required key was absent.
+    kWrongType,    // Present, but not convertible to the member type.
+    kOutOfRange,   // An integer that does not fit the member type.
+};
+
+struct ArgError {
+    ArgErrorCode code = ArgErrorCode::kOk;
+    std::string_view key;  // Points into the schema; empty for kNotAMap.
+
+    bool ok() const { return code == ArgErrorCode::kOk; }
+    // e.g. "Missing argument 'isDown'".
+    std::string Message() const;
+};
+
+// Stable error code for MethodResult::Error, e.g. "MissingArgument".
+const char* ArgErrorCodeName(ArgErrorCode code);
+
+template <typename Args, typename T>
+struct ArgField {
+    std::string_view key;
+    T Args::*member;
+    bool required;
+};
+
+template <typename Args, typename T>
+constexpr ArgField<Args, T> Required(std::string_view key, T Args::*member) {
+    return {key, member, true};
+}
+
+// Optional keys keep the struct's default member initializer when absent.
+template <typename Args, typename T>
+constexpr ArgField<Args, T> Optional(std::string_view key, T Args::*member) {
+    return {key, member, false};
+}
+
+// Reads values of any std::variant-based type with the standard codec's
+// scalar alternatives: flutter::EncodableValue on Windows, stand-ins in tests.
+template <typename Value>
+class VariantArgReader {
+public:
+    explicit VariantArgReader(const Value& value) : value_(value) {}
+
+    ArgErrorCode Read(bool* out) const {
+        if (const bool* v = std::get_if<bool>(&value_)) {
+            *out = *v;
+            return ArgErrorCode::kOk;
+        }
+        return ArgErrorCode::kWrongType;
+    }
+
+    ArgErrorCode Read(int32_t* out) const {
+        int64_t wide;
+        ArgErrorCode code = Read(&wide);
+        if (code != ArgErrorCode::kOk) {
+            return code;
+        }
+        if (wide < (std::numeric_limits<int32_t>::min)() || wide > (std::numeric_limits<int32_t>::max)()) {
+            return ArgErrorCode::kOutOfRange;
+        }
+        *out = static_cast<int32_t>(wide);
+        return ArgErrorCode::kOk;
+    }
+
+    // The standard codec sends Dart ints as int32 when they fit, int64 otherwise.
+    ArgErrorCode Read(int64_t* out) const {
+        if (const int32_t* v = std::get_if<int32_t>(&value_)) {
+            *out = *v;
+            return ArgErrorCode::kOk;
+        }
+        if (const int64_t* v = std::get_if<int64_t>(&value_)) {
+            *out = *v;
+            return ArgErrorCode::kOk;
+        }
+        return ArgErrorCode::kWrongType;
+    }
+
+    // Integers are accepted too, so `1` from Dart is as good as `1.0`.
+    ArgErrorCode Read(double* out) const {
+        if (const double* v = std::get_if<double>(&value_)) {
+            *out = *v;
+            return ArgErrorCode::kOk;
+        }
+        int64_t wide;
+        if (Read(&wide) == ArgErrorCode::kOk) {
+            *out = static_cast<double>(wide);
+            return ArgErrorCode::kOk;
+        }
+        return ArgErrorCode::kWrongType;
+    }
+
+    ArgErrorCode Read(std::string* out) const {
+        if (const std::string* v = std::get_if<std::string>(&value_)) {
+            *out = *v;
+            return ArgErrorCode::kOk;
+        }
+        return ArgErrorCode::kWrongType;
+    }
+
+    // Int32List and Float64List from Dart, when |Value| can carry them.
+    ArgErrorCode Read(std::vector<int32_t>* out) const { return ReadList(out); }
+    ArgErrorCode Read(std::vector<double>* out) const { return ReadList(out); }
+
+private:
+    template <typename T, typename... Types>
+    static constexpr bool HasAlternative(const std::variant<Types...>*) {
+        return (std::is_same_v<T, Types> || ...);
+    }
+
+    template <typename List>
+    ArgErrorCode ReadList(List* out) const {
+        if constexpr (HasAlternative<List>(static_cast<const Value*>(nullptr))) {
+            if (const List* v = std::get_if<List>(&value_)) {
+                *out = *v;
+                return ArgErrorCode::kOk;
+            }
+        }
+        return ArgErrorCode::kWrongType;
+    }
+
+    const Value& value_;
+};
+
+// Single-pass decoder for one Args struct. Feed it every map entry with
+// Visit(), then call Finish() for the result. Keys outside the schema are
+// ignored so newer Dart code keeps working against older plugins.
+template <typename Args>
+class ArgsDecoder {
+public:
+    static constexpr auto kFields = Args::Schema();
+    static constexpr size_t kFieldCount = std::tuple_size<decltype(kFields)>::value;
+    static_assert(kFieldCount <= 32, "ArgsDecoder tracks seen keys in a 32-bit mask");
+
+    explicit ArgsDecoder(Args* out) : out_(out) {}
+
+    // Returns false once an error was recorded; callers may stop iterating.
+    template <typename Reader>
+    bool Visit(std::string_view key, const Reader& value) {
+        VisitFields(key, value, std::make_index_sequence<kFieldCount>());
+        return error_.ok();
+    }
+
+    ArgError Finish() const {
+        if (!error_.ok()) {
+            return error_;
+        }
+        ArgError missing;
+        FindMissing(&missing, std::make_index_sequence<kFieldCount>());
+        return missing;
+    }
+
+private:
+    template <typename Reader, size_t... I>
+    void VisitFields(std::string_view key, const Reader& value, std::index_sequence<I...>) {
+        // Stops at the first key that matches; the length compare rejects
+        // almost every non-matching field without touching the characters.
+        (void)(... || VisitField<I>(key, value));
+    }
+
+    template <size_t I, typename Reader>
+    bool VisitField(std::string_view key, const Reader& value) {
+        const auto& field = std::get<I>(kFields);
+        if (key.size() != field.key.size() || key != field.key) {
+            return false;
+        }
+        ArgErrorCode code = value.Read(&(out_->*field.member));
+        if (code == ArgErrorCode::kOk) {
+            seen_ |= 1u << I;
+        } else {
+            error_ = {code, field.key};
+        }
+        return true;
+    }
+
+    template <size_t... I>
+    void FindMissing(ArgError* missing, std::index_sequence<I...>) const {
+        (void)(... || CheckPresent<I>(missing));
+    }
+
+    template <size_t I>
+    bool CheckPresent(ArgError* missing) const {
+        const auto& field = std::get<I>(kFields);
+        if (field.required && (seen_ & (1u << I)) == 0) {
+            *missing = {ArgErrorCode::kMissing, field.key};
+            return true;
+        }
+        return false;
+    }
+
+    Args* out_;
+    uint32_t seen_ = 0;
+    ArgError error_;
+};
+
+// Decodes a std::map keyed and valued by a std::variant-based type, such as
+// flutter::EncodableMap. A null |map| is reported as kNotAMap.
+template <typename Map, typename Args>
+ArgError DecodeVariantMapArgs(const Map* map, Args* out) {
+    if (map == nullptr) {
+        return {ArgErrorCode::kNotAMap, {}};
+    }
+    using Value = typename Map::mapped_type;
+    ArgsDecoder<Args> decoder(out);
+    for (const auto& entry : *map) {
+        const std::string* key = std::get_if<std::string>(&entry.first);
+        if (key != nullptr && !decoder.Visit(*key, VariantArgReader<Value>(entry.second))) {
+            break;
+        }
+    }
+    return decoder.Finish();
+}
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_METHOD_ARGS_H_
@@ -0,0 +1,217 @@
+#ifndef FLUTTER_PLUGIN_METHOD_DISPATCH_H_
+#define FLUTTER_PLUGIN_METHOD_DISPATCH_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace hardware_simulator {
+
+// Every method the Dart side can invoke on the "hardware_simulator" channel.
+// Shared by the Windows and Linux plugins so both resolve a method name with
+// a single hash probe instead of walking a chain of string compares.
+enum class MethodId : uint8_t {
+    kUnknown = 0,
+    kGetPlatformVersion,
+    kGetMonitorCount,
+    kKeyPress,
+    kMouseMoveR,
+    kMouseMoveA,
+    kMouseMoveToWindowPosition,
+    kMousePress,
+    kMouseScroll,
+    kHookCursorImage,
+    kUnhookCursorImage,
+    kHookCursorPosition,
+    kUnhookCursorPosition,
+    kAddDisplayCountChangedCallback,
+    kRemoveDisplayCountChangedCallback,
+    kCreateGameController,
+    kRemoveGameController,
+    kDoControlAction,
+    kRegisterService,
+    kUnregisterService,
+    kIsRunningAsSystem,
+    kShowNotification,
+    kTouchEvent,
+    kTouchMove,
+    kPenEvent,
+    kPenMove,
+    kClearAllPressedEvents,
+    kSetPrimaryDisplay,
+    kInitParsecVdd,
+    kCreateDisplay,
+    kRemoveDisplay,
+    kCheckVddStatus,
+    kGetAllDisplays,
+    kGetDisplayList,
+    kChangeDisplaySettings,
+    kGetDisplayConfigs,
+    kGetCustomDisplayConfigs,
+    kSetCustomDisplayConfigs,
+    kSetDisplayOrientation,
+    kGetDisplayOrientation,
+    kSetMultiDisplayMode,
+    kGetCurrentMultiDisplayMode,
+    kSetPrimaryDisplayOnly,
+    kRestoreDisplayConfiguration,
+    kHasPendingConfiguration,
+    kPutImmersiveModeEnabled,
+    kSetDragWindowContents,
+    kLockCursor,
+    kUnlockCursor,
+    kUpdateStaticMonitors,
+    kSetCursorMovedCoalescing,
+    kSetTouchContactLimit,
+    kSetKeyRepeatTiming,
+    kTypeText,
+    kSetInputRemap,
+    kSetShortcutCapturePolicy,
+    kSetInputLease,
+    kRenewInputLease,
+    kPerformGesture,
+    kSetInputSmoothing,
+};
+
+namespace method_dispatch {
+
+struct MethodEntry {
+    std::string_view name;
+    MethodId id;
+};
+
+inline constexpr MethodEntry kMethods[] = {
+    {"getPlatformVersion", MethodId::kGetPlatformVersion},
+    {"getMonitorCount", MethodId::kGetMonitorCount},
+    {"KeyPress", MethodId::kKeyPress},
+    {"mouseMoveR", MethodId::kMouseMoveR},
+    {"mouseMoveA", MethodId::kMouseMoveA},
+    {"mouseMoveToWindowPosition", MethodId::kMouseMoveToWindowPosition},
+    {"mousePress", MethodId::kMousePress},
+    {"mouseScroll", MethodId::kMouseScroll},
+    {"hookCursorImage", MethodId::kHookCursorImage},
+    {"unhookCursorImage", MethodId::kUnhookCursorImage},
+    {"hookCursorPosition", MethodId::kHookCursorPosition},
+    {"unhookCursorPosition", MethodId::kUnhookCursorPosition},
+    {"addDisplayCountChangedCallback", MethodId::kAddDisplayCountChangedCallback},
+    {"removeDisplayCountChangedCallback", MethodId::kRemoveDisplayCountChangedCallback},
+    {"createGameController", MethodId::kCreateGameController},
+    {"removeGameController", MethodId::kRemoveGameController},
+    {"doControlAction", MethodId::kDoControlAction},
+    {"registerService", MethodId::kRegisterService},
+    {"unregisterService", MethodId::kUnregisterService},
+    {"isRunningAsSystem", MethodId::kIsRunningAsSystem},
+    {"showNotification", MethodId::kShowNotification},
+    {"touchEvent", MethodId::kTouchEvent},
+    {"touchMove", MethodId::kTouchMove},
+    {"penEvent", MethodId::kPenEvent},
+    {"penMove", MethodId::kPenMove},
+    {"clearAllPressedEvents", MethodId::kClearAllPressedEvents},
+    {"setPrimaryDisplay", MethodId::kSetPrimaryDisplay},
+    {"initParsecVdd", MethodId::kInitParsecVdd},
+    {"createDisplay", MethodId::kCreateDisplay},
+    {"removeDisplay", MethodId::kRemoveDisplay},
+    {"checkVddStatus", MethodId::kCheckVddStatus},
+    {"getAllDisplays", MethodId::kGetAllDisplays},
+    {"getDisplayList", MethodId::kGetDisplayList},
+    {"changeDisplaySettings", MethodId::kChangeDisplaySettings},
+    {"getDisplayConfigs", MethodId::kGetDisplayConfigs},
+    {"getCustomDisplayConfigs", MethodId::kGetCustomDisplayConfigs},
+    {"setCustomDisplayConfigs", MethodId::kSetCustomDisplayConfigs},
+    {"setDisplayOrientation", MethodId::kSetDisplayOrientation},
+    {"getDisplayOrientation", MethodId::kGetDisplayOrientation},
+    {"setMultiDisplayMode", MethodId::kSetMultiDisplayMode},
+    {"getCurrentMultiDisplayMode", MethodId::kGetCurrentMultiDisplayMode},
+    {"setPrimaryDisplayOnly", MethodId::kSetPrimaryDisplayOnly},
+    {"restoreDisplayConfiguration", MethodId::kRestoreDisplayConfiguration},
+    {"hasPendingConfiguration", MethodId::kHasPendingConfiguration},
+    {"putImmersiveModeEnabled", MethodId::kPutImmersiveModeEnabled},
+    {"setDragWindowContents", MethodId::kSetDragWindowContents},
+    {"lockCursor", MethodId::kLockCursor},
+    {"unlockCursor", MethodId::kUnlockCursor},
+    {"updateStaticMonitors", MethodId::kUpdateStaticMonitors},
+    {"setCursorMovedCoalescing", MethodId::kSetCursorMovedCoalescing},
+    {"setTouchContactLimit", MethodId::kSetTouchContactLimit},
+    {"setKeyRepeatTiming", MethodId::kSetKeyRepeatTiming},
+    {"typeText", MethodId::kTypeText},
+    {"setInputRemap", MethodId::kSetInputRemap},
+    {"setShortcutCapturePolicy", MethodId::kSetShortcutCapturePolicy},
+    {"setInputLease", MethodId::kSetInputLease},
+    {"renewInputLease", MethodId::kRenewInputLease},
+    {"performGesture", MethodId::kPerformGesture},
+    {"setInputSmoothing", MethodId::kSetInputSmoothing},
+};
+
+inline constexpr size_t kMethodCount = sizeof(kMethods) / sizeof(kMethods[0]);
+
+// Power of two so the bucket index is a mask rather than a division.
+inline constexpr size_t kBucketCount = 1024;
+static_assert(kMethodCount < kBucketCount, "Grow kBucketCount with the method table");
+
+// Seeded FNV-1a. The seed is searched at compile time below so that every
+// method lands in its own bucket.
+constexpr uint32_t HashName(std::string_view name, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ seed;
+    for (char c : name) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+constexpr size_t BucketOf(std::string_view name, uint32_t seed) {
+    return HashName(name, seed) & (kBucketCount - 1);
+}
+
+constexpr bool IsCollisionFree(uint32_t seed) {
+    std::array<bool, kBucketCount> used{};
+    for (const auto& entry : kMethods) {
+        size_t bucket = BucketOf(entry.name, seed);
+        if (used[bucket]) {
+            return false;
+        }
+        used[bucket] = true;
+    }
+    return true;
+}
+
+constexpr uint32_t FindPerfectSeed() {
+    for (uint32_t seed = 0; seed < 65536; ++seed) {
+        if (IsCollisionFree(seed)) {
+            return seed;
+        }
+    }
+    return UINT32_MAX;
+}
+
+inline constexpr uint32_t kSeed = FindPerfectSeed();
+static_assert(kSeed != UINT32_MAX, "No collision-free seed for the method table");
+
+// Bucket -> index into kMethods plus one; zero marks an empty bucket.
+constexpr std::array<uint8_t, kBucketCount> BuildBuckets() {
+    std::array<uint8_t, kBucketCount> buckets{};
+    for (size_t i = 0; i < kMethodCount; ++i) {
+        buckets[BucketOf(kMethods[i].name, kSeed)] = static_cast<uint8_t>(i + 1);
+    }
+    return buckets;
+}
+
+inline constexpr std::array<uint8_t, kBucketCount> kBuckets = BuildBuckets();
+
+}  // namespace method_dispatch
+
+// Resolves a channel method name to its MethodId, or MethodId::kUnknown when
+// the name is not one the plugins handle. One hash, one string compare.
+constexpr MethodId LookupMethod(std::string_view name) {
+    uint8_t slot = method_dispatch::kBuckets[method_dispatch::BucketOf(name, method_dispatch::kSeed)];
+    if (slot == 0) {
+        return MethodId::kUnknown;
+    }
+    const auto& entry = method_dispatch::kMethods[slot - 1];
+    return entry.name == name ? entry.id : MethodId::kUnknown;
+}
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_METHOD_DISPATCH_H_
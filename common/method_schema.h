@@ -0,0 +1,404 @@
+#ifndef FLUTTER_PLUGIN_METHOD_SCHEMA_H_
+#define FLUTTER_PLUGIN_METHOD_SCHEMA_H_
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "method_args.h"
+
+namespace hardware_simulator {
+
+// Argument structs for the "hardware_simulator" channel, one per method (or
+// shared where two methods take the same map). Keys are exactly what
+// lib/hardware_simulator_method_channel.dart sends.
+
+struct KeyPressArgs {
+    int code = 0;
+    bool is_down = false;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(Required("code", &KeyPressArgs::code),
+                               Required("isDown", &KeyPressArgs::is_down));
+    }
+};
+
+// mouseMoveR deltas, or mouseMoveToWindowPosition window fractions.
+struct MouseXYArgs {
+    double x = 0;
+    double y = 0;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(Required("x", &MouseXYArgs::x),
+                               Required("y", &MouseXYArgs::y));
+    }
+};
+
+struct MouseMoveAArgs {
+    double x = 0;
+    double y = 0;
+    int screen_id = 0;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(Required("x", &MouseMoveAArgs::x),
+                               Required("y", &MouseMoveAArgs::y),
+                               Required("screenId", &MouseMoveAArgs::screen_id));
+    }
+};
+
+struct MousePressArgs {
+    int button_id = 0;
+    bool is_down = false;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(Required("buttonId", &MousePressArgs::button_id),
+                               Required("isDown", &MousePressArgs::is_down));
+    }
+};
+
+struct MouseScrollArgs {
+    double dx = 0;
+    double dy = 0;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(Required("dx", &MouseScrollArgs::dx),
+                               Required("dy", &MouseScrollArgs::dy));
+    }
+};
+
+struct TouchEventArgs {
+    int screen_id = 0;
+    double x = 0;
+    double y = 0;
+    int touch_id = 0;
+    bool is_down = false;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(Required("screenId", &TouchEventArgs::screen_id),
+                               Required("x", &TouchEventArgs::x),
+                               Required("y", &TouchEventArgs::y),
+                               Required("touchId", &TouchEventArgs::touch_id),
+                               Required("isDown", &TouchEventArgs::is_down));
+    }
+};
+
+struct TouchMoveArgs {
+    int screen_id = 0;
+    double x = 0;
+    double y = 0;
+    int touch_id = 0;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(Required("screenId", &TouchMoveArgs::screen_id),
+                               Required("x", &TouchMoveArgs::x),
+                               Required("y", &TouchMoveArgs::y),
+                               Required("touchId", &TouchMoveArgs::touch_id));
+    }
+};
+
+struct PenEventArgs {
+    int screen_id = 0;
+    double x = 0;
+    double y = 0;
+    bool is_down = false;
+    bool has_button = false;
+    double pressure = 0;
+    double rotation = 0;
+    double tilt = 0;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(Required("screenId", &PenEventArgs::screen_id),
+                               Required("x", &PenEventArgs::x),
+                               Required("y", &PenEventArgs::y),
+                               Required("isDown", &PenEventArgs::is_down),
+                               Required("hasButton", &PenEventArgs::has_button),
+                               Required("pressure", &PenEventArgs::pressure),
+                               Required("rotation", &PenEventArgs::rotation),
+                               Required("tilt", &PenEventArgs::tilt));
+    }
+};
+
+struct PenMoveArgs {
+    int screen_id = 0;
+    double x = 0;
+    double y = 0;
+    bool has_button = false;
+    double pressure = 0;
+    double rotation = 0;
+    double tilt = 0;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(Required("screenId", &PenMoveArgs::screen_id),
+                               Required("x", &PenMoveArgs::x),
+                               Required("y", &PenMoveArgs::y),
+                               Required("hasButton", &PenMoveArgs::has_button),
+                               Required("pressure", &PenMoveArgs::pressure),
+                               Required("rotation", &PenMoveArgs::rotation),
+                               Required("tilt", &PenMoveArgs::tilt));
+    }
+};
+
+// unhookCursorImage, hookCursorPosition, unhookCursorPosition and the display
+// count callbacks.
+struct CallbackIdArgs {
+    int callback_id = 0;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(Required("callbackID", &CallbackIdArgs::callback_id));
+    }
+};
+
+struct HookCursorImageArgs {
+    int callback_id = 0;
+    bool hook_all = false;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(Required("callbackID", &HookCursorImageArgs::callback_id),
+                               Required("hookAll", &HookCursorImageArgs::hook_all));
+    }
+};
+
+struct GameControllerIdArgs {
+    int id = 0;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(Required("id", &GameControllerIdArgs::id));
+    }
+};
+
+struct DoControlActionArgs {
+    int id = 0;
+    std::string action;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(Required("id", &DoControlActionArgs::id),
+                               Required("action", &DoControlActionArgs::action));
+    }
+};
+
+struct ShowNotificationArgs {
+    std::string content;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(Required("content", &ShowNotificationArgs::content));
+    }
+};
+
+struct SetPrimaryDisplayArgs {
+    int display_index = 0;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(Required("displayIndex", &SetPrimaryDisplayArgs::display_index));
+    }
+};
+
+// removeDisplay, getDisplayConfigs, getDisplayOrientation and
+// setPrimaryDisplayOnly.
+struct DisplayUidArgs {
+    int display_uid = 0;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(Required("displayUid", &DisplayUidArgs::display_uid));
+    }
+};
+
+// bitDepth is sent by newer clients but not applied.
+struct ChangeDisplaySettingsArgs {
+    int display_uid = 0;
+    int width = 0;
+    int height = 0;
+    int refresh_rate = 0;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(
+            Required("displayUid", &ChangeDisplaySettingsArgs::display_uid),
+            Required("width", &ChangeDisplaySettingsArgs::width),
+            Required("height", &ChangeDisplaySettingsArgs::height),
+            Required("refreshRate", &ChangeDisplaySettingsArgs::refresh_rate));
+    }
+};
+
+// (width, height, refreshRate) triples.
+struct CustomDisplayConfigsArgs {
+    std::vector<int32_t> configs;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(Required("configs", &CustomDisplayConfigsArgs::configs));
+    }
+};
+
+struct DisplayOrientationArgs {
+    int display_uid = 0;
+    int orientation = 0;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(
+            Required("displayUid", &DisplayOrientationArgs::display_uid),
+            Required("orientation", &DisplayOrientationArgs::orientation));
+    }
+};
+
+struct MultiDisplayModeArgs {
+    int mode = 0;
+    int primary_display_id = 0;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(
+            Required("mode", &MultiDisplayModeArgs::mode),
+            Optional("primaryDisplayId", &MultiDisplayModeArgs::primary_display_id));
+    }
+};
+
+// putImmersiveModeEnabled and setDragWindowContents.
+struct EnabledArgs {
+    bool enabled = false;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(Required("enabled", &EnabledArgs::enabled));
+    }
+};
+
+struct SetCursorMovedCoalescingArgs {
+    int rate_hz = 0;
+    bool include_buttons_and_wheel = false;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(
+            Optional("rateHz", &SetCursorMovedCoalescingArgs::rate_hz),
+            Optional("includeButtonsAndWheel", &SetCursorMovedCoalescingArgs::include_buttons_and_wheel));
+    }
+};
+
+struct TouchContactLimitArgs {
+    int max_contacts = 0;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(Required("maxContacts", &TouchContactLimitArgs::max_contacts));
+    }
+};
+
+// keyCode omitted: the timing of every key without its own.
+struct KeyRepeatTimingArgs {
+    int key_code = -1;
+    int delay_ms = 0;
+    int interval_ms = 0;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(
+            Optional("keyCode", &KeyRepeatTimingArgs::key_code),
+            Required("delayMs", &KeyRepeatTimingArgs::delay_ms),
+            Required("intervalMs", &KeyRepeatTimingArgs::interval_ms));
+    }
+};
+
+// Fields as in InputRemapSpec. Omitted fields are identity, so no arguments
+// at all clear the remap.
+struct InputRemapArgs {
+    std::vector<int32_t> key_map;
+    std::vector<int32_t> button_map;
+    double sensitivity_x = 1;
+    double sensitivity_y = 1;
+    std::vector<double> curve;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(
+            Optional("keyMap", &InputRemapArgs::key_map),
+            Optional("buttonMap", &InputRemapArgs::button_map),
+            Optional("sensitivityX", &InputRemapArgs::sensitivity_x),
+            Optional("sensitivityY", &InputRemapArgs::sensitivity_y),
+            Optional("curve", &InputRemapArgs::curve));
+    }
+};
+
+// timeoutMs 0 stops the lease.
+struct InputLeaseArgs {
+    int timeout_ms = 0;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(Required("timeoutMs", &InputLeaseArgs::timeout_ms));
+    }
+};
+
+// (key, modifiers) pairs as in ShortcutRule; useDefaults restores the rules
+// immersive mode started with.
+struct ShortcutCaptureArgs {
+    std::vector<int32_t> rules;
+    bool use_defaults = false;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(
+            Optional("rules", &ShortcutCaptureArgs::rules),
+            Optional("useDefaults", &ShortcutCaptureArgs::use_defaults));
+    }
+};
+
+// keysPerBatch omitted: the whole text in one batch.
+struct TypeTextArgs {
+    std::string text;
+    int keys_per_batch = 0;
+    int batch_interval_ms = 0;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(
+            Required("text", &TypeTextArgs::text),
+            Optional("keysPerBatch", &TypeTextArgs::keys_per_batch),
+            Optional("batchIntervalMs", &TypeTextArgs::batch_interval_ms));
+    }
+};
+
+// Points are fractions of screen screenId. endX/endY default to the start,
+// which is all a longPress needs; centerX/centerY only steer a pinch.
+// contacts and rateHz of 0 pick the gesture's defaults.
+struct PerformGestureArgs {
+    std::string type;
+    int screen_id = 0;
+    double start_x = 0;
+    double start_y = 0;
+    double end_x = std::numeric_limits<double>::quiet_NaN();
+    double end_y = std::numeric_limits<double>::quiet_NaN();
+    double center_x = 0.5;
+    double center_y = 0.5;
+    int duration_ms = 300;
+    int contacts = 0;
+    int rate_hz = 0;
+
+    static constexpr auto Schema() {
+        return std::make_tuple(
+            Required("type", &PerformGestureArgs::type),
+            Required("screenId", &PerformGestureArgs::screen_id),
+            Required("startX", &PerformGestureArgs::start_x),
+            Required("startY", &PerformGestureArgs::start_y),
+            Optional("endX", &PerformGestureArgs::end_x),
+            Optional("endY", &PerformGestureArgs::end_y),
+            Optional("centerX", &PerformGestureArgs::center_x),
+            Optional("centerY", &PerformGestureArgs::center_y),
+            Optional("durationMs", &PerformGestureArgs::duration_ms),
+            Optional("contacts", &PerformGestureArgs::contacts),
+            Optional("rateHz", &PerformGestureArgs::rate_hz));
+    }
+};
+
+// device is "pen" or "touch". Filter settings left out keep OneEuroParams's
+// defaults.
+struct SetInputSmoothingArgs {
+    std::string device;
+    bool enabled = true;
+    double min_cutoff_hz = std::numeric_limits<double>::quiet_NaN();
+    double beta = std::numeric_limits<double>::quiet_NaN();
+    double derivative_cutoff_hz = std::numeric_limits<double>::quiet_NaN();
+
+    static constexpr auto Schema() {
+        return std::make_tuple(
+            Required("device", &SetInputSmoothingArgs::device),
+            Optional("enabled", &SetInputSmoothingArgs::enabled),
+            Optional("minCutoffHz", &SetInputSmoothingArgs::min_cutoff_hz),
+            Optional("beta", &SetInputSmoothingArgs::beta),
+            Optional("derivativeCutoffHz", &SetInputSmoothingArgs::derivative_cutoff_hz));
+    }
+};
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_METHOD_SCHEMA_H_
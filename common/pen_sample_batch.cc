@@ -0,0 +1,215 @@
+#include "pen_sample_batch.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HARDWARE_SIMULATOR_PEN_SSE2 1
+#endif
+
+namespace hardware_simulator {
+
+namespace {
+
+constexpr float kPi = 3.14159265f;
+constexpr float kHalfPi = 1.57079633f;
+constexpr float kRadiansPerDegree = 0.0174532925f;
+constexpr float kDegreesPerRadian = 57.2957795f;
+constexpr float kMaxTilt = 90.0f;
+// Keeps 0 / 0 out of the arctangent of a vertical pen.
+constexpr float kTiny = 1e-30f;
+
+// Taylor coefficients of sin up to x^9: off by under 4e-6 for |x| <= pi/2.
+constexpr float kSin3 = -1.6666667e-1f;
+constexpr float kSin5 = 8.3333333e-3f;
+constexpr float kSin7 = -1.9841270e-4f;
+constexpr float kSin9 = 2.7557319e-6f;
+
+// atan(q) for 0 <= q <= 1, Abramowitz and Stegun 4.4.49: off by under 1e-5.
+constexpr float kAtan1 = 0.9998660f;
+constexpr float kAtan3 = -0.3302995f;
+constexpr float kAtan5 = 0.1801410f;
+constexpr float kAtan7 = -0.0851330f;
+constexpr float kAtan9 = 0.0208351f;
+
+// The scalar kernel, for builds without SSE2 and for the last samples of a
+// batch. Same operations as the vector one, lane by lane.
+
+float SinPoly(float x) {
+    float x2 = x * x;
+    return x * (1.0f + x2 * (kSin3 + x2 * (kSin5 + x2 * (kSin7 + x2 * kSin9))));
+}
+
+float AtanPoly(float q) {
+    float q2 = q * q;
+    return q * (kAtan1 + q2 * (kAtan3 + q2 * (kAtan5 + q2 * (kAtan7 + q2 * kAtan9))));
+}
+
+// atan2(y, x) for x >= 0, which holds as tilt is at most 90 degrees.
+float Atan2NonNegativeX(float y, float x) {
+    float abs_y = std::fabs(y);
+    float high = (std::max)(abs_y, x);
+    float low = (std::min)(abs_y, x);
+    float angle = AtanPoly(low / (std::max)(high, kTiny));
+    if (abs_y > x) {
+        angle = kHalfPi - angle;
+    }
+    return std::copysign(angle, y);
+}
+
+// Folds |a| in [-pi, 3pi/2] into [-pi/2, pi/2] without changing its sine.
+float FoldHigh(float a) { return a > kHalfPi ? kPi - a : a; }
+float FoldLow(float a) { return a < -kHalfPi ? -kPi - a : a; }
+
+void TiltScalar(float rotation, float tilt, float* tilt_x, float* tilt_y) {
+    if (!(tilt >= 0.0f && rotation >= 0.0f && rotation <= 360.0f)) {
+        *tilt_x = 0;
+        *tilt_y = 0;
+        return;
+    }
+    float t = (std::min)(tilt, kMaxTilt) * kRadiansPerDegree;
+    float sin_t = SinPoly(t);
+    float cos_t = SinPoly(kHalfPi - t);
+    float r = rotation * kRadiansPerDegree;
+    if (r > kPi) {
+        r -= 2 * kPi;
+    }
+    float sin_r = SinPoly(FoldLow(FoldHigh(r)));
+    float cos_r = SinPoly(FoldHigh(kHalfPi - r));
+    // As PenTiltFromPolar: atan2(sin(-r) * sin(t), cos(t)) and
+    // atan2(cos(-r) * sin(t), cos(t)).
+    *tilt_x = Atan2NonNegativeX(-sin_r * sin_t, cos_t) * kDegreesPerRadian;
+    *tilt_y = Atan2NonNegativeX(cos_r * sin_t, cos_t) * kDegreesPerRadian;
+}
+
+#ifdef HARDWARE_SIMULATOR_PEN_SSE2
+
+// SSE2 has no blend; |mask| lanes are all ones or all zeros.
+__m128 Select(__m128 mask, __m128 if_set, __m128 if_clear) {
+    return _mm_or_ps(_mm_and_ps(mask, if_set), _mm_andnot_ps(mask, if_clear));
+}
+
+__m128 SinPoly4(__m128 x) {
+    __m128 x2 = _mm_mul_ps(x, x);
+    __m128 p = _mm_add_ps(_mm_set1_ps(kSin7), _mm_mul_ps(x2, _mm_set1_ps(kSin9)));
+    p = _mm_add_ps(_mm_set1_ps(kSin5), _mm_mul_ps(x2, p));
+    p = _mm_add_ps(_mm_set1_ps(kSin3), _mm_mul_ps(x2, p));
+    p = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(x2, p));
+    return _mm_mul_ps(x, p);
+}
+
+__m128 AtanPoly4(__m128 q) {
+    __m128 q2 = _mm_mul_ps(q, q);
+    __m128 p = _mm_add_ps(_mm_set1_ps(kAtan7), _mm_mul_ps(q2, _mm_set1_ps(kAtan9)));
+    p = _mm_add_ps(_mm_set1_ps(kAtan5), _mm_mul_ps(q2, p));
+    p = _mm_add_ps(_mm_set1_ps(kAtan3), _mm_mul_ps(q2, p));
+    p = _mm_add_ps(_mm_set1_ps(kAtan1), _mm_mul_ps(q2, p));
+    return _mm_mul_ps(q, p);
+}
+
+__m128 Atan2NonNegativeX4(__m128 y, __m128 x) {
+    const __m128 sign_mask = _mm_set1_ps(-0.0f);
+    __m128 sign = _mm_and_ps(y, sign_mask);
+    __m128 abs_y = _mm_andnot_ps(sign_mask, y);
+    __m128 high = _mm_max_ps(abs_y, x);
+    __m128 low = _mm_min_ps(abs_y, x);
+    __m128 angle = AtanPoly4(_mm_div_ps(low, _mm_max_ps(high, _mm_set1_ps(kTiny))));
+    angle = Select(_mm_cmpgt_ps(abs_y, x), _mm_sub_ps(_mm_set1_ps(kHalfPi), angle), angle);
+    return _mm_or_ps(angle, sign);
+}
+
+__m128 FoldHigh4(__m128 a) {
+    const __m128 half_pi = _mm_set1_ps(kHalfPi);
+    return Select(_mm_cmpgt_ps(a, half_pi), _mm_sub_ps(_mm_set1_ps(kPi), a), a);
+}
+
+__m128 FoldLow4(__m128 a) {
+    const __m128 minus_half_pi = _mm_set1_ps(-kHalfPi);
+    return Select(_mm_cmplt_ps(a, minus_half_pi), _mm_sub_ps(_mm_set1_ps(-kPi), a), a);
+}
+
+void Tilt4(const float* rotation, const float* tilt, float* tilt_x, float* tilt_y) {
+    __m128 rotation_degrees = _mm_loadu_ps(rotation);
+    __m128 tilt_degrees = _mm_loadu_ps(tilt);
+    const __m128 zero = _mm_setzero_ps();
+    // NaN compares false, so it is invalid too.
+    __m128 valid = _mm_and_ps(_mm_cmpge_ps(tilt_degrees, zero),
+                              _mm_and_ps(_mm_cmpge_ps(rotation_degrees, zero),
+                                         _mm_cmple_ps(rotation_degrees, _mm_set1_ps(360.0f))));
+
+    const __m128 radians_per_degree = _mm_set1_ps(kRadiansPerDegree);
+    const __m128 half_pi = _mm_set1_ps(kHalfPi);
+    __m128 t = _mm_mul_ps(_mm_min_ps(tilt_degrees, _mm_set1_ps(kMaxTilt)), radians_per_degree);
+    __m128 sin_t = SinPoly4(t);
+    __m128 cos_t = SinPoly4(_mm_sub_ps(half_pi, t));
+
+    __m128 r = _mm_mul_ps(rotation_degrees, radians_per_degree);
+    r = _mm_sub_ps(r, _mm_and_ps(_mm_cmpgt_ps(r, _mm_set1_ps(kPi)), _mm_set1_ps(2 * kPi)));
+    __m128 sin_r = SinPoly4(FoldLow4(FoldHigh4(r)));
+    __m128 cos_r = SinPoly4(FoldHigh4(_mm_sub_ps(half_pi, r)));
+
+    const __m128 degrees_per_radian = _mm_set1_ps(kDegreesPerRadian);
+    const __m128 sign_mask = _mm_set1_ps(-0.0f);
+    __m128 x = Atan2NonNegativeX4(_mm_xor_ps(_mm_mul_ps(sin_r, sin_t), sign_mask), cos_t);
+    __m128 y = Atan2NonNegativeX4(_mm_mul_ps(cos_r, sin_t), cos_t);
+    _mm_storeu_ps(tilt_x, _mm_and_ps(valid, _mm_mul_ps(x, degrees_per_radian)));
+    _mm_storeu_ps(tilt_y, _mm_and_ps(valid, _mm_mul_ps(y, degrees_per_radian)));
+}
+
+#endif  // HARDWARE_SIMULATOR_PEN_SSE2
+
+}  // namespace
+
+void PolarToTiltDegrees(const float* rotation, const float* tilt, size_t count,
+                        float* tilt_x, float* tilt_y) {
+    size_t i = 0;
+#ifdef HARDWARE_SIMULATOR_PEN_SSE2
+    for (; i + 4 <= count; i += 4) {
+        Tilt4(rotation + i, tilt + i, tilt_x + i, tilt_y + i);
+    }
+#endif
+    for (; i < count; ++i) {
+        TiltScalar(rotation[i], tilt[i], &tilt_x[i], &tilt_y[i]);
+    }
+}
+
+void ConvertPenSamples(const AffineMap& map, const PenSample* samples, size_t count,
+                       int32_t pressure_max, ConvertedPenSamples* out) {
+    if (out->x.size() < count) {
+        out->x.resize(count);
+        out->y.resize(count);
+        out->pressure.resize(count);
+        out->tilt_x.resize(count);
+        out->tilt_y.resize(count);
+        out->scratch.resize(count * 4);
+    }
+    out->size = count;
+    float* rotation = out->scratch.data();
+    float* tilt = rotation + count;
+    float* tilt_x = tilt + count;
+    float* tilt_y = tilt_x + count;
+
+    for (size_t i = 0; i < count; ++i) {
+        const PenSample& sample = samples[i];
+        double x;
+        double y;
+        map.Apply(sample.x, sample.y, &x, &y);
+        out->x[i] = static_cast<int32_t>(x);
+        out->y[i] = static_cast<int32_t>(y);
+        float pressure = (std::min)(sample.pressure, 1.0f);
+        out->pressure[i] = pressure > 0
+            ? (std::max)(static_cast<int32_t>(pressure * pressure_max), 1)
+            : 0;
+        rotation[i] = sample.rotation;
+        tilt[i] = sample.tilt;
+    }
+
+    PolarToTiltDegrees(rotation, tilt, count, tilt_x, tilt_y);
+    for (size_t i = 0; i < count; ++i) {
+        out->tilt_x[i] = static_cast<int32_t>(tilt_x[i]);
+        out->tilt_y[i] = static_cast<int32_t>(tilt_y[i]);
+    }
+}
+
+}  // namespace hardware_simulator
@@ -0,0 +1,53 @@
+#ifndef FLUTTER_PLUGIN_PEN_SAMPLE_BATCH_H_
+#define FLUTTER_PLUGIN_PEN_SAMPLE_BATCH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "input_sink.h"
+#include "screen_transform.h"
+
+namespace hardware_simulator {
+
+// A run of pen samples converted for injection, one entry per sample.
+// Reused from batch to batch, so converting allocates nothing once it has
+// seen the largest batch.
+struct ConvertedPenSamples {
+    size_t size = 0;
+    std::vector<int32_t> x;
+    std::vector<int32_t> y;
+    // 1..pressure_max, or 0 when the sample reports no pressure.
+    std::vector<int32_t> pressure;
+    // Whole degrees, as PenTiltFromPolar gives them; 0 without tilt.
+    std::vector<int32_t> tilt_x;
+    std::vector<int32_t> tilt_y;
+
+    // Structure-of-arrays scratch for the vector kernels.
+    std::vector<float> scratch;
+};
+
+// Converts |count| samples on the screen |map| belongs to: positions to
+// |map|'s output space, 0..1 pressure to 1..|pressure_max|, and polar tilt
+// to X and Y tilt.
+//
+// This is the per-sample math of PenMove done for a whole batch at once.
+// Positions use the same double-precision multiply-adds as ScreenTransform.
+// Tilt runs four samples at a time in single precision with polynomial
+// sine, cosine and arctangent instead of libm calls; below 90 degrees of
+// tilt its angles stay within 0.01 degrees of the exact ones, so after
+// truncation to whole degrees a sample can differ from PenTiltFromPolar by
+// one where the exact angle is next to an integer. A pen lying flat has no
+// well-defined projection and may differ further.
+void ConvertPenSamples(const AffineMap& map, const PenSample* samples, size_t count,
+                       int32_t pressure_max, ConvertedPenSamples* out);
+
+// The tilt kernel on its own, in degrees before truncation. Samples with
+// negative |tilt| or |rotation| outside 0..360 get 0. Tilt beyond 90 is
+// taken as 90.
+void PolarToTiltDegrees(const float* rotation, const float* tilt, size_t count,
+                        float* tilt_x, float* tilt_y);
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_PEN_SAMPLE_BATCH_H_
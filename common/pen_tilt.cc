@@ -0,0 +1,29 @@
+#include "pen_tilt.h"
+
+#include <cmath>
+
+namespace hardware_simulator {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+}  // namespace
+
+bool PenTiltFromPolar(double rotation, double tilt, PenTilt* out) {
+    *out = PenTilt();
+    if (!(tilt >= 0.0 && rotation >= 0.0 && rotation <= 360.0)) {
+        return false;
+    }
+    double rotation_rads = rotation * (kPi / 180.0);
+    double tilt_rads = tilt * (kPi / 180.0);
+    double r = std::sin(tilt_rads);
+    double z = std::cos(tilt_rads);
+
+    // The pen's direction in polar coordinates, projected onto each plane.
+    out->x = static_cast<int32_t>(std::atan2(std::sin(-rotation_rads) * r, z) * 180.0 / kPi);
+    out->y = static_cast<int32_t>(std::atan2(std::cos(-rotation_rads) * r, z) * 180.0 / kPi);
+    return true;
+}
+
+}  // namespace hardware_simulator
@@ -0,0 +1,24 @@
+#ifndef FLUTTER_PLUGIN_PEN_TILT_H_
+#define FLUTTER_PLUGIN_PEN_TILT_H_
+
+#include <cstdint>
+
+namespace hardware_simulator {
+
+// Pen tilt as the angles between the pen and the screen normal in the X-Z
+// and Y-Z planes, in whole degrees. Positive X tilts the top of the pen
+// toward the right; positive Y toward the user.
+struct PenTilt {
+    int32_t x = 0;
+    int32_t y = 0;
+};
+
+// Converts the method channel's polar tilt: |tilt| degrees from vertical,
+// leaning toward |rotation| degrees clockwise. Returns false, leaving
+// |*out| zero, when |tilt| is negative or |rotation| is outside 0..360,
+// which callers send when the pen reports no tilt.
+bool PenTiltFromPolar(double rotation, double tilt, PenTilt* out);
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_PEN_TILT_H_
@@ -0,0 +1,219 @@
+#include "pressed_input_tracker.h"
+
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace hardware_simulator {
+
+namespace {
+
+// Index of the lowest set bit of a non-zero word.
+int LowestBit(uint64_t word) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+// Calls |visit| with the index of every set bit of |words|.
+template <size_t N, typename Visit>
+void ForEachBit(const uint64_t (&words)[N], Visit&& visit) {
+    for (size_t w = 0; w < N; ++w) {
+        for (uint64_t word = words[w]; word != 0; word &= word - 1) {
+            visit(w * 64 + static_cast<size_t>(LowestBit(word)));
+        }
+    }
+}
+
+}  // namespace
+
+void PressedInputTracker::Location::Store(int screen, double x, double y) {
+    float coordinates[2] = {static_cast<float>(x), static_cast<float>(y)};
+    uint64_t packed;
+    std::memcpy(&packed, coordinates, sizeof(packed));
+    screen_id.store(screen, std::memory_order_relaxed);
+    position.store(packed, std::memory_order_relaxed);
+}
+
+void PressedInputTracker::Location::Load(int* screen, double* x, double* y) const {
+    uint64_t packed = position.load(std::memory_order_relaxed);
+    float coordinates[2];
+    std::memcpy(coordinates, &packed, sizeof(coordinates));
+    *screen = screen_id.load(std::memory_order_relaxed);
+    *x = coordinates[0];
+    *y = coordinates[1];
+}
+
+PressedInputTracker::PressedInputTracker() {
+    for (auto& word : keys_) {
+        word.store(0, std::memory_order_relaxed);
+    }
+    for (auto& word : contact_slots_) {
+        word.store(0, std::memory_order_relaxed);
+    }
+}
+
+void PressedInputTracker::KeyEvent(uint16_t key_code, bool is_down) {
+    if (key_code >= kTrackedKeyCount) {
+        return;
+    }
+    uint64_t bit = uint64_t{1} << (key_code % kWordBits);
+    auto& word = keys_[key_code / kWordBits];
+    if (is_down) {
+        word.fetch_or(bit, std::memory_order_relaxed);
+    } else {
+        word.fetch_and(~bit, std::memory_order_relaxed);
+    }
+}
+
+bool PressedInputTracker::IsKeyDown(uint16_t key_code) const {
+    if (key_code >= kTrackedKeyCount) {
+        return false;
+    }
+    uint64_t bit = uint64_t{1} << (key_code % kWordBits);
+    return (keys_[key_code / kWordBits].load(std::memory_order_relaxed) & bit) != 0;
+}
+
+void PressedInputTracker::MouseButton(int button_id, bool is_down) {
+    if (button_id < 1 || button_id > kTrackedMouseButtonCount) {
+        return;
+    }
+    uint32_t bit = 1u << (button_id - 1);
+    if (is_down) {
+        mouse_buttons_.fetch_or(bit, std::memory_order_relaxed);
+    } else {
+        mouse_buttons_.fetch_and(~bit, std::memory_order_relaxed);
+    }
+}
+
+bool PressedInputTracker::IsMouseButtonDown(int button_id) const {
+    if (button_id < 1 || button_id > kTrackedMouseButtonCount) {
+        return false;
+    }
+    return (mouse_buttons_.load(std::memory_order_relaxed) & (1u << (button_id - 1))) != 0;
+}
+
+int PressedInputTracker::FindContact(uint32_t touch_id) const {
+    uint64_t slots[kContactWords];
+    for (size_t w = 0; w < kContactWords; ++w) {
+        slots[w] = contact_slots_[w].load(std::memory_order_acquire);
+    }
+    int found = -1;
+    ForEachBit(slots, [&](size_t slot) {
+        if (found < 0 && contacts_[slot].touch_id.load(std::memory_order_relaxed) == touch_id) {
+            found = static_cast<int>(slot);
+        }
+    });
+    return found;
+}
+
+bool PressedInputTracker::TouchEvent(int screen_id, double x, double y, uint32_t touch_id, bool is_down) {
+    int slot = FindContact(touch_id);
+    if (!is_down) {
+        if (slot >= 0) {
+            contact_slots_[slot / kWordBits].fetch_and(~(uint64_t{1} << (slot % kWordBits)),
+                                                       std::memory_order_release);
+        }
+        return true;
+    }
+    if (slot < 0) {
+        for (size_t w = 0; w < kContactWords && slot < 0; ++w) {
+            uint64_t vacant = ~contact_slots_[w].load(std::memory_order_relaxed);
+            if (vacant != 0) {
+                slot = static_cast<int>(w * kWordBits) + LowestBit(vacant);
+            }
+        }
+        if (slot < 0) {
+            return false;
+        }
+    }
+    Contact& contact = contacts_[slot];
+    contact.touch_id.store(touch_id, std::memory_order_relaxed);
+    contact.location.Store(screen_id, x, y);
+    // Publishes the slot's contents to readers that see the bit.
+    contact_slots_[slot / kWordBits].fetch_or(uint64_t{1} << (slot % kWordBits),
+                                              std::memory_order_release);
+    return true;
+}
+
+void PressedInputTracker::TouchMove(int screen_id, double x, double y, uint32_t touch_id) {
+    int slot = FindContact(touch_id);
+    if (slot >= 0) {
+        contacts_[slot].location.Store(screen_id, x, y);
+    }
+}
+
+bool PressedInputTracker::IsTouchDown(uint32_t touch_id) const {
+    return FindContact(touch_id) >= 0;
+}
+
+void PressedInputTracker::PenEvent(int screen_id, double x, double y, bool is_down) {
+    pen_.Store(screen_id, x, y);
+    pen_down_.store(is_down, std::memory_order_release);
+}
+
+void PressedInputTracker::PenMove(int screen_id, double x, double y) {
+    pen_.Store(screen_id, x, y);
+}
+
+bool PressedInputTracker::IsPenDown() const {
+    return pen_down_.load(std::memory_order_acquire);
+}
+
+size_t PressedInputTracker::ReleaseAll(InputSink& sink) {
+    size_t released = 0;
+
+    uint64_t keys[kKeyWords];
+    for (size_t w = 0; w < kKeyWords; ++w) {
+        keys[w] = keys_[w].exchange(0, std::memory_order_relaxed);
+    }
+    ForEachBit(keys, [&](size_t key_code) {
+        sink.KeyEvent(static_cast<uint16_t>(key_code), false);
+        ++released;
+    });
+
+    uint32_t buttons = mouse_buttons_.exchange(0, std::memory_order_relaxed);
+    for (int button = 1; button <= kTrackedMouseButtonCount; ++button) {
+        if (buttons & (1u << (button - 1))) {
+            sink.MouseButton(button, false);
+            ++released;
+        }
+    }
+
+    released += ReleaseTouches(sink);
+
+    if (pen_down_.exchange(false, std::memory_order_acquire)) {
+        int screen_id;
+        double x;
+        double y;
+        pen_.Load(&screen_id, &x, &y);
+        sink.PenEvent(screen_id, x, y, false, false, 0, 0, 0);
+        ++released;
+    }
+    return released;
+}
+
+size_t PressedInputTracker::ReleaseTouches(InputSink& sink) {
+    size_t released = 0;
+    uint64_t slots[kContactWords];
+    for (size_t w = 0; w < kContactWords; ++w) {
+        slots[w] = contact_slots_[w].exchange(0, std::memory_order_acquire);
+    }
+    ForEachBit(slots, [&](size_t slot) {
+        int screen_id;
+        double x;
+        double y;
+        contacts_[slot].location.Load(&screen_id, &x, &y);
+        sink.TouchEvent(screen_id, x, y, contacts_[slot].touch_id.load(std::memory_order_relaxed), false);
+        ++released;
+    });
+    return released;
+}
+
+}  // namespace hardware_simulator
@@ -0,0 +1,93 @@
+#ifndef FLUTTER_PLUGIN_PRESSED_INPUT_TRACKER_H_
+#define FLUTTER_PLUGIN_PRESSED_INPUT_TRACKER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "input_sink.h"
+#include "touch_contact_table.h"
+
+namespace hardware_simulator {
+
+// Virtual-key codes and mouse button ids (1..5) the tracker covers.
+constexpr size_t kTrackedKeyCount = 256;
+constexpr int kTrackedMouseButtonCount = 5;
+
+// Everything the plugin has pressed and not yet released: keys, mouse
+// buttons, touch contacts and the pen.
+//
+// Keys are a 256-bit bitset and buttons a bitmask, updated with atomic
+// fetch_or/fetch_and; contacts and the pen live in fixed arrays of atomics.
+// Reads are wait-free from any thread. Contacts and the pen are written by
+// one thread at a time, the injecting one; keys and buttons by any.
+//
+// ReleaseAll() takes every pressed input in O(number pressed) and sends the
+// matching ups, so nothing has to ask the OS what might be down.
+class PressedInputTracker {
+public:
+    PressedInputTracker();
+
+    PressedInputTracker(const PressedInputTracker&) = delete;
+    PressedInputTracker& operator=(const PressedInputTracker&) = delete;
+
+    // Codes outside the tracked range are ignored.
+    void KeyEvent(uint16_t key_code, bool is_down);
+    bool IsKeyDown(uint16_t key_code) const;
+
+    void MouseButton(int button_id, bool is_down);
+    bool IsMouseButtonDown(int button_id) const;
+
+    // Contacts are released at their last position. Returns false when
+    // kMaxTouchContactsLimit contacts are already down.
+    bool TouchEvent(int screen_id, double x, double y, uint32_t touch_id, bool is_down);
+    void TouchMove(int screen_id, double x, double y, uint32_t touch_id);
+    bool IsTouchDown(uint32_t touch_id) const;
+
+    void PenEvent(int screen_id, double x, double y, bool is_down);
+    void PenMove(int screen_id, double x, double y);
+    bool IsPenDown() const;
+
+    // Forgets every pressed input and sends |sink| an up for each: keys,
+    // mouse buttons, touch contacts, then the pen. Returns how many.
+    size_t ReleaseAll(InputSink& sink);
+
+    // Forgets the touch contacts alone and sends |sink| an up for each.
+    // Returns how many.
+    size_t ReleaseTouches(InputSink& sink);
+
+private:
+    static constexpr size_t kWordBits = 64;
+    static constexpr size_t kKeyWords = kTrackedKeyCount / kWordBits;
+    static constexpr size_t kContactWords = kMaxTouchContactsLimit / kWordBits;
+
+    // Last position of a contact or the pen. x and y are packed as two floats
+    // so they are read and written together.
+    struct Location {
+        std::atomic<int32_t> screen_id{0};
+        std::atomic<uint64_t> position{0};
+
+        void Store(int screen, double x, double y);
+        void Load(int* screen, double* x, double* y) const;
+    };
+
+    struct Contact {
+        std::atomic<uint32_t> touch_id{0};
+        Location location;
+    };
+
+    // Slot holding |touch_id|, or -1.
+    int FindContact(uint32_t touch_id) const;
+
+    std::atomic<uint64_t> keys_[kKeyWords];
+    std::atomic<uint32_t> mouse_buttons_{0};
+    // Bit n set: contacts_[n] is down.
+    std::atomic<uint64_t> contact_slots_[kContactWords];
+    Contact contacts_[kMaxTouchContactsLimit];
+    std::atomic<bool> pen_down_{false};
+    Location pen_;
+};
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_PRESSED_INPUT_TRACKER_H_
@@ -0,0 +1,88 @@
+#include "screen_transform.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace hardware_simulator {
+
+namespace {
+
+// Desktop-oriented fraction of a screen for caller fraction (u, v), as an
+// affine map of (u, v).
+AffineMap Orientation(ScreenRotation rotation) {
+    switch (rotation) {
+        case ScreenRotation::k90:
+            return {1, 0, -1, 0, 1, 0};  // (1 - v, u)
+        case ScreenRotation::k180:
+            return {1, -1, 0, 1, 0, -1};  // (1 - u, 1 - v)
+        case ScreenRotation::k270:
+            return {0, 0, 1, 1, -1, 0};  // (v, 1 - u)
+        case ScreenRotation::kNone:
+            break;
+    }
+    return {0, 1, 0, 0, 0, 1};
+}
+
+// |outer| applied after |inner|.
+AffineMap Compose(const AffineMap& outer, const AffineMap& inner) {
+    AffineMap map;
+    map.x0 = outer.x0 + outer.xx * inner.x0 + outer.xy * inner.y0;
+    map.xx = outer.xx * inner.xx + outer.xy * inner.yx;
+    map.xy = outer.xx * inner.xy + outer.xy * inner.yy;
+    map.y0 = outer.y0 + outer.yx * inner.x0 + outer.yy * inner.y0;
+    map.yx = outer.yx * inner.xx + outer.yy * inner.yx;
+    map.yy = outer.yx * inner.xy + outer.yy * inner.yy;
+    return map;
+}
+
+// Maps a desktop-oriented fraction of |screen| to desktop pixels, then those
+// to (pixel - origin) * scale on each axis.
+AffineMap ScreenToOutput(const ScreenRect& screen, double origin_x, double origin_y,
+                         double scale_x, double scale_y) {
+    double width = screen.right - screen.left;
+    double height = screen.bottom - screen.top;
+    AffineMap map;
+    map.x0 = (screen.left - origin_x) * scale_x;
+    map.xx = width * scale_x;
+    map.y0 = (screen.top - origin_y) * scale_y;
+    map.yy = height * scale_y;
+    return Compose(map, Orientation(screen.rotation));
+}
+
+double Ratio(double numerator, double denominator) {
+    return denominator > 0 ? numerator / denominator : 0;
+}
+
+}  // namespace
+
+ScreenTransform::ScreenTransform(std::vector<ScreenRect> screens, const ScreenMetrics& metrics)
+    : screens_(std::move(screens)) {
+    // The virtual desktop spans every screen and always includes the origin.
+    int32_t left = 0;
+    int32_t top = 0;
+    int32_t right = 0;
+    int32_t bottom = 0;
+    for (const auto& screen : screens_) {
+        left = (std::min)(left, screen.left);
+        top = (std::min)(top, screen.top);
+        right = (std::max)(right, screen.right);
+        bottom = (std::max)(bottom, screen.bottom);
+    }
+
+    double primary_scale_x = Ratio(65535.0, metrics.primary_width);
+    double primary_scale_y = Ratio(65535.0, metrics.primary_height);
+    double virtual_scale_x = Ratio(metrics.virtual_width, right - left);
+    double virtual_scale_y = Ratio(metrics.virtual_height, bottom - top);
+
+    primary_normalized_.reserve(screens_.size());
+    virtual_desktop_.reserve(screens_.size());
+    for (const auto& screen : screens_) {
+        primary_normalized_.push_back(ScreenToOutput(screen, 0, 0, primary_scale_x, primary_scale_y));
+        virtual_desktop_.push_back(ScreenToOutput(screen, left, top, virtual_scale_x, virtual_scale_y));
+    }
+}
+
+ScreenTransformPublisher::ScreenTransformPublisher()
+    : SnapshotPublisher(std::make_shared<const ScreenTransform>(std::vector<ScreenRect>(), ScreenMetrics())) {}
+
+}  // namespace hardware_simulator
@@ -0,0 +1,119 @@
+#ifndef FLUTTER_PLUGIN_SCREEN_TRANSFORM_H_
+#define FLUTTER_PLUGIN_SCREEN_TRANSFORM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "snapshot_publisher.h"
+
+namespace hardware_simulator {
+
+// Clockwise quarter turns between the orientation the caller's 0..1
+// positions are given in and the screen as laid out on the desktop. kNone
+// when the caller already works in desktop orientation, which is the case for
+// positions taken from a captured desktop image.
+enum class ScreenRotation : uint8_t {
+    kNone = 0,
+    k90 = 1,
+    k180 = 2,
+    k270 = 3,
+};
+
+// One screen in desktop pixels, as enumerated by the platform.
+struct ScreenRect {
+    int32_t left = 0;
+    int32_t top = 0;
+    int32_t right = 0;
+    int32_t bottom = 0;
+    bool is_primary = false;
+    ScreenRotation rotation = ScreenRotation::kNone;
+};
+
+// The sizes the output coordinate spaces are measured against, read once
+// when a snapshot is built (GetSystemMetrics on Windows). Taking them in the
+// injecting process's DPI context folds DPI virtualization into the maps.
+struct ScreenMetrics {
+    double primary_width = 0;
+    double primary_height = 0;
+    double virtual_width = 0;
+    double virtual_height = 0;
+};
+
+// out_x = x0 + xx * u + xy * v,  out_y = y0 + yx * u + yy * v
+struct AffineMap {
+    double x0 = 0;
+    double xx = 0;
+    double xy = 0;
+    double y0 = 0;
+    double yx = 0;
+    double yy = 0;
+
+    void Apply(double u, double v, double* out_x, double* out_y) const {
+        *out_x = x0 + xx * u + xy * v;
+        *out_y = y0 + yx * u + yy * v;
+    }
+};
+
+// Immutable mapping from (screen index, 0..1 position) to injection
+// coordinates, built once per display change. Each screen has one
+// precomputed affine map per output space, so mapping a position is a
+// bounds check and two multiply-adds.
+class ScreenTransform {
+public:
+    ScreenTransform(std::vector<ScreenRect> screens, const ScreenMetrics& metrics);
+
+    size_t screen_count() const { return screens_.size(); }
+    const std::vector<ScreenRect>& screens() const { return screens_; }
+
+    // SendInput MOUSEEVENTF_ABSOLUTE coordinates: 0..65535 across the primary
+    // screen, measured from the desktop origin.
+    bool ToPrimaryNormalized(int screen, double x, double y, int32_t* out_x, int32_t* out_y) const {
+        return Map(primary_normalized_, screen, x, y, out_x, out_y);
+    }
+
+    // Pixels of the virtual desktop, measured from the corner of the bounds
+    // of all screens and the origin. Used for touch and pen injection.
+    bool ToVirtualDesktop(int screen, double x, double y, int32_t* out_x, int32_t* out_y) const {
+        return Map(virtual_desktop_, screen, x, y, out_x, out_y);
+    }
+
+    // The map ToVirtualDesktop applies to |screen|, or null, for callers that
+    // convert many positions at once.
+    const AffineMap* VirtualDesktopMap(int screen) const {
+        if (screen < 0 || static_cast<size_t>(screen) >= virtual_desktop_.size()) {
+            return nullptr;
+        }
+        return &virtual_desktop_[screen];
+    }
+
+private:
+    static bool Map(const std::vector<AffineMap>& maps, int screen, double x, double y,
+                    int32_t* out_x, int32_t* out_y) {
+        if (screen < 0 || static_cast<size_t>(screen) >= maps.size()) {
+            return false;
+        }
+        double mapped_x;
+        double mapped_y;
+        maps[screen].Apply(x, y, &mapped_x, &mapped_y);
+        *out_x = static_cast<int32_t>(mapped_x);
+        *out_y = static_cast<int32_t>(mapped_y);
+        return true;
+    }
+
+    std::vector<ScreenRect> screens_;
+    std::vector<AffineMap> primary_normalized_;
+    std::vector<AffineMap> virtual_desktop_;
+};
+
+// Publishes ScreenTransform snapshots to injection threads. Starts out with
+// no screens.
+class ScreenTransformPublisher : public SnapshotPublisher<ScreenTransform> {
+public:
+    ScreenTransformPublisher();
+};
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_SCREEN_TRANSFORM_H_
@@ -0,0 +1,172 @@
+#include "shortcut_policy.h"
+
+#include <utility>
+
+namespace hardware_simulator {
+
+namespace {
+
+// Sided and side-agnostic state bits of a modifier key, or 0.
+constexpr uint16_t ModifierBitsFor(uint8_t key) {
+    switch (key) {
+        case 0x10:  // VK_SHIFT
+        case 0xA0:  // VK_LSHIFT
+            return kShortcutLeftShift | kShortcutShift;
+        case 0xA1:  // VK_RSHIFT
+            return kShortcutRightShift | kShortcutShift;
+        case 0x11:  // VK_CONTROL
+        case 0xA2:  // VK_LCONTROL
+            return kShortcutLeftCtrl | kShortcutCtrl;
+        case 0xA3:  // VK_RCONTROL
+            return kShortcutRightCtrl | kShortcutCtrl;
+        case 0x12:  // VK_MENU
+        case 0xA4:  // VK_LMENU
+            return kShortcutLeftAlt | kShortcutAlt;
+        case 0xA5:  // VK_RMENU
+            return kShortcutRightAlt | kShortcutAlt;
+        case 0x5B:  // VK_LWIN
+            return kShortcutLeftWin | kShortcutWin;
+        case 0x5C:  // VK_RWIN
+            return kShortcutRightWin | kShortcutWin;
+        default:
+            return 0;
+    }
+}
+
+// The side-agnostic bit that goes with each sided one.
+uint16_t WithSideAgnostic(uint16_t sided) {
+    uint16_t state = sided;
+    if (sided & (kShortcutLeftCtrl | kShortcutRightCtrl)) state |= kShortcutCtrl;
+    if (sided & (kShortcutLeftShift | kShortcutRightShift)) state |= kShortcutShift;
+    if (sided & (kShortcutLeftAlt | kShortcutRightAlt)) state |= kShortcutAlt;
+    if (sided & (kShortcutLeftWin | kShortcutRightWin)) state |= kShortcutWin;
+    return state;
+}
+
+void SetBit(uint64_t (&bits)[4], uint8_t key, bool set) {
+    uint64_t bit = uint64_t{1} << (key % 64);
+    if (set) {
+        bits[key / 64] |= bit;
+    } else {
+        bits[key / 64] &= ~bit;
+    }
+}
+
+bool TestBit(const uint64_t (&bits)[4], uint8_t key) {
+    return (bits[key / 64] >> (key % 64)) & 1;
+}
+
+}  // namespace
+
+std::vector<ShortcutRule> DefaultShortcutRules() {
+    return {
+        {0x5B, 0},                            // VK_LWIN
+        {0x5C, 0},                            // VK_RWIN
+        {0xA4, 0},                            // VK_LMENU
+        {0xA5, 0},                            // VK_RMENU
+        {0xA3, 0},                            // VK_RCONTROL
+        {0x09, kShortcutAlt},                 // Alt+Tab
+        {0x73, kShortcutAlt},                 // Alt+F4
+        {0x1B, kShortcutCtrl | kShortcutAlt}, // Ctrl+Alt+Esc
+    };
+}
+
+bool DecodeShortcutRules(const std::vector<int32_t>& pairs, std::vector<ShortcutRule>* rules) {
+    if (pairs.size() % 2 != 0) {
+        return false;
+    }
+    std::vector<ShortcutRule> decoded;
+    decoded.reserve(pairs.size() / 2);
+    for (size_t i = 0; i < pairs.size(); i += 2) {
+        int32_t key = pairs[i];
+        int32_t modifiers = pairs[i + 1];
+        if (key < 1 || key > 255 || modifiers < 0 || (modifiers & ~kShortcutModifierMask) != 0) {
+            return false;
+        }
+        decoded.push_back({static_cast<uint8_t>(key), static_cast<uint16_t>(modifiers)});
+    }
+    *rules = std::move(decoded);
+    return true;
+}
+
+ShortcutPolicy::ShortcutPolicy() {
+    SetRules(DefaultShortcutRules());
+}
+
+bool ShortcutPolicy::SetRules(const std::vector<ShortcutRule>& rules) {
+    if (rules.size() > 0xFFFF) {
+        return false;
+    }
+    uint16_t counts[256] = {};
+    for (const auto& rule : rules) {
+        if (rule.key == 0 || (rule.modifiers & ~kShortcutModifierMask) != 0) {
+            return false;
+        }
+        ++counts[rule.key];
+    }
+
+    first_[0] = 0;
+    for (size_t key = 0; key < 256; ++key) {
+        first_[key + 1] = static_cast<uint16_t>(first_[key] + counts[key]);
+    }
+    masks_.assign(rules.size(), 0);
+    uint16_t next[256];
+    for (size_t key = 0; key < 256; ++key) {
+        next[key] = first_[key];
+    }
+    for (const auto& rule : rules) {
+        masks_[next[rule.key]++] = rule.modifiers;
+    }
+    return true;
+}
+
+bool ShortcutPolicy::Matches(uint8_t key) const {
+    for (uint16_t i = first_[key]; i < first_[key + 1]; ++i) {
+        if ((modifiers_ & masks_[i]) == masks_[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+ShortcutDecision ShortcutPolicy::OnKey(uint8_t key, bool is_down, bool capture) {
+    ShortcutDecision decision;
+    bool was_down = TestBit(down_, key);
+    if (is_down) {
+        decision.changed = !was_down;
+        if (was_down) {
+            decision.block = TestBit(blocked_, key);
+        } else {
+            decision.block = capture && Matches(key);
+            SetBit(blocked_, key, decision.block);
+        }
+    } else {
+        decision.changed = was_down;
+        // An up without a down (the hook started while it was held) follows
+        // the rules as they stand.
+        decision.block = was_down ? TestBit(blocked_, key) : capture && Matches(key);
+        SetBit(blocked_, key, false);
+    }
+    SetBit(down_, key, is_down);
+
+    uint16_t bits = ModifierBitsFor(key);
+    if (bits != 0) {
+        // Keep only the sided bits, then derive the side-agnostic ones, so
+        // releasing one Shift leaves Shift set while the other is held.
+        uint16_t sided = modifiers_ & ~(kShortcutCtrl | kShortcutShift | kShortcutAlt | kShortcutWin);
+        uint16_t side = bits & ~(kShortcutCtrl | kShortcutShift | kShortcutAlt | kShortcutWin);
+        sided = is_down ? (sided | side) : (sided & ~side);
+        modifiers_ = WithSideAgnostic(sided);
+    }
+    return decision;
+}
+
+void ShortcutPolicy::Reset() {
+    modifiers_ = 0;
+    for (size_t w = 0; w < 4; ++w) {
+        down_[w] = 0;
+        blocked_[w] = 0;
+    }
+}
+
+}  // namespace hardware_simulator
@@ -0,0 +1,95 @@
+#ifndef FLUTTER_PLUGIN_SHORTCUT_POLICY_H_
+#define FLUTTER_PLUGIN_SHORTCUT_POLICY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hardware_simulator {
+
+// Modifier bits of a shortcut rule and of the tracked modifier state. The low
+// four are side-agnostic; the state always has both the sided bit and its
+// side-agnostic one set, so a rule can ask for "Alt" or for "right Alt".
+constexpr uint16_t kShortcutCtrl = 1 << 0;
+constexpr uint16_t kShortcutShift = 1 << 1;
+constexpr uint16_t kShortcutAlt = 1 << 2;
+constexpr uint16_t kShortcutWin = 1 << 3;
+constexpr uint16_t kShortcutLeftCtrl = 1 << 4;
+constexpr uint16_t kShortcutRightCtrl = 1 << 5;
+constexpr uint16_t kShortcutLeftShift = 1 << 6;
+constexpr uint16_t kShortcutRightShift = 1 << 7;
+constexpr uint16_t kShortcutLeftAlt = 1 << 8;
+constexpr uint16_t kShortcutRightAlt = 1 << 9;
+constexpr uint16_t kShortcutLeftWin = 1 << 10;
+constexpr uint16_t kShortcutRightWin = 1 << 11;
+constexpr uint16_t kShortcutModifierMask = 0x0FFF;
+
+// Capture |key| (a virtual-key code) while at least |modifiers| are held.
+// Extra modifiers still match, so Alt+Tab also captures Alt+Shift+Tab.
+struct ShortcutRule {
+    uint8_t key = 0;
+    uint16_t modifiers = 0;
+};
+
+// What immersive mode has always captured: both Win keys, both Alt keys
+// (Flutter on Windows loses Alt when it is pressed quickly), right Ctrl,
+// Alt+Tab, Alt+F4 and Ctrl+Alt+Esc.
+std::vector<ShortcutRule> DefaultShortcutRules();
+
+// Rules from (key, modifiers) pairs as they come from Dart. Returns false for
+// an odd length or a value out of range.
+bool DecodeShortcutRules(const std::vector<int32_t>& pairs, std::vector<ShortcutRule>* rules);
+
+struct ShortcutDecision {
+    bool block = false;
+    // The key went down or up, as opposed to an auto-repeated down or an up
+    // for a key that was never seen going down.
+    bool changed = false;
+};
+
+// Decides which keys a low-level keyboard hook swallows.
+//
+// Rules are compiled into per-key lists of modifier masks, and the modifier
+// state is tracked from the events themselves rather than asked of the OS,
+// so a decision is a table lookup and one AND-compare per rule for the key.
+// Once a key's down is blocked its repeats and its up are too, and a key
+// that went down unblocked is released unblocked, whatever changed since.
+//
+// Not thread-safe: the hook runs on the thread that installed it, which is
+// also where the rules are set.
+class ShortcutPolicy {
+public:
+    ShortcutPolicy();
+
+    // Returns false, keeping the old rules, when a rule has no key or unknown
+    // modifier bits, or there are more than 65535 rules.
+    bool SetRules(const std::vector<ShortcutRule>& rules);
+
+    // Feeds one key event. |capture| is whether shortcuts should be captured
+    // right now (the target window has focus); modifiers are tracked either
+    // way. Generic modifier codes (VK_CONTROL, ...) count as the left key.
+    ShortcutDecision OnKey(uint8_t key, bool is_down, bool capture);
+
+    uint16_t modifiers() const { return modifiers_; }
+    bool IsKeyDown(uint8_t key) const { return (down_[key / 64] >> (key % 64)) & 1; }
+    // Down, and swallowed since its down.
+    bool IsKeyBlocked(uint8_t key) const { return (blocked_[key / 64] >> (key % 64)) & 1; }
+
+    // Forgets held keys, e.g. when the hook is reinstalled.
+    void Reset();
+
+private:
+    bool Matches(uint8_t key) const;
+
+    // Modifier masks of the rules for key k: masks_[first_[k] .. first_[k + 1]).
+    std::vector<uint16_t> masks_;
+    uint16_t first_[257];
+
+    uint16_t modifiers_ = 0;
+    uint64_t down_[4] = {};
+    uint64_t blocked_[4] = {};
+};
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_SHORTCUT_POLICY_H_
@@ -0,0 +1,43 @@
+#ifndef FLUTTER_PLUGIN_SNAPSHOT_PUBLISHER_H_
+#define FLUTTER_PLUGIN_SNAPSHOT_PUBLISHER_H_
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace hardware_simulator {
+
+// Publishes immutable snapshots of rarely changing state (screen layout,
+// remap tables) to injection threads.
+//
+// Current() hands out a counted reference with an atomic load, so a reader
+// keeps its snapshot alive for as long as it holds it and a snapshot is
+// freed once the last reader lets go of it. Hold the reference for as long
+// as anything points into the snapshot: a pointer or reference taken from
+// a temporary is left dangling by the next Publish().
+template <typename T>
+class SnapshotPublisher {
+public:
+    explicit SnapshotPublisher(std::shared_ptr<const T> initial) { Publish(std::move(initial)); }
+
+    SnapshotPublisher(const SnapshotPublisher&) = delete;
+    SnapshotPublisher& operator=(const SnapshotPublisher&) = delete;
+
+    // Never null.
+    std::shared_ptr<const T> Current() const { return std::atomic_load_explicit(&current_, std::memory_order_acquire); }
+
+    // Null snapshots are ignored.
+    void Publish(std::shared_ptr<const T> snapshot) {
+        if (!snapshot) {
+            return;
+        }
+        std::atomic_store_explicit(&current_, std::move(snapshot), std::memory_order_release);
+    }
+
+private:
+    std::shared_ptr<const T> current_;
+};
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_SNAPSHOT_PUBLISHER_H_
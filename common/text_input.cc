@@ -0,0 +1,159 @@
+#include "text_input.h"
+
+#include <algorithm>
+
+#include "key_codes.h"
+
+namespace hardware_simulator {
+
+namespace {
+
+constexpr uint32_t kReplacementCharacter = 0xFFFD;
+constexpr uint16_t kVkBack = 0x08;
+constexpr uint16_t kVkTab = 0x09;
+constexpr uint16_t kVkReturn = 0x0D;
+
+bool IsContinuation(uint8_t byte, uint8_t low = 0x80, uint8_t high = 0xBF) {
+    return byte >= low && byte <= high;
+}
+
+// Decodes the sequence at |text|[0..|size|). Sets |*length| to the bytes it
+// takes, which for a malformed sequence is its longest valid prefix (at least
+// one byte), and returns false for one.
+bool DecodeOne(const uint8_t* text, size_t size, uint32_t* code_point, size_t* length) {
+    uint8_t lead = text[0];
+    *length = 1;
+    if (lead < 0x80) {
+        *code_point = lead;
+        return true;
+    }
+
+    size_t count;
+    uint32_t value;
+    // Range of the second byte, which rules out overlong forms, surrogates
+    // and code points past U+10FFFF.
+    uint8_t low = 0x80;
+    uint8_t high = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        count = 2;
+        value = lead & 0x1F;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        count = 3;
+        value = lead & 0x0F;
+        if (lead == 0xE0) low = 0xA0;
+        if (lead == 0xED) high = 0x9F;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        count = 4;
+        value = lead & 0x07;
+        if (lead == 0xF0) low = 0x90;
+        if (lead == 0xF4) high = 0x8F;
+    } else {
+        return false;
+    }
+
+    for (size_t i = 1; i < count; ++i) {
+        if (i >= size || !IsContinuation(text[i], i == 1 ? low : 0x80, i == 1 ? high : 0xBF)) {
+            return false;
+        }
+        value = (value << 6) | (text[i] & 0x3F);
+        *length = i + 1;
+    }
+    *code_point = value;
+    return true;
+}
+
+void AppendKey(TypedKeyKind kind, uint32_t code, std::vector<TypedKey>* keys) {
+    TypedKey key;
+    key.kind = kind;
+    key.code = code;
+    keys->push_back(key);
+}
+
+}  // namespace
+
+size_t DecodeTypedText(const char* utf8, size_t size, std::vector<TypedKey>* keys) {
+    const uint8_t* text = reinterpret_cast<const uint8_t*>(utf8);
+    size_t replaced = 0;
+    size_t i = 0;
+    while (i < size) {
+        uint32_t code_point;
+        size_t length;
+        if (!DecodeOne(text + i, size - i, &code_point, &length)) {
+            AppendKey(TypedKeyKind::kCharacter, kReplacementCharacter, keys);
+            ++replaced;
+            i += length;
+            continue;
+        }
+        i += length;
+
+        switch (code_point) {
+            case '\r':
+                if (i < size && text[i] == '\n') {
+                    ++i;
+                }
+                AppendKey(TypedKeyKind::kKey, kVkReturn, keys);
+                break;
+            case '\n':
+                AppendKey(TypedKeyKind::kKey, kVkReturn, keys);
+                break;
+            case '\t':
+                AppendKey(TypedKeyKind::kKey, kVkTab, keys);
+                break;
+            case '\b':
+                AppendKey(TypedKeyKind::kKey, kVkBack, keys);
+                break;
+            default:
+                if (code_point >= 0x20 && code_point != 0x7F) {
+                    AppendKey(TypedKeyKind::kCharacter, code_point, keys);
+                }
+                break;
+        }
+    }
+    return replaced;
+}
+
+size_t EncodeUtf16(uint32_t code_point, uint16_t units[2]) {
+    if (code_point < 0x10000) {
+        units[0] = static_cast<uint16_t>(code_point);
+        return 1;
+    }
+    code_point -= 0x10000;
+    units[0] = static_cast<uint16_t>(0xD800 + (code_point >> 10));
+    units[1] = static_cast<uint16_t>(0xDC00 + (code_point & 0x3FF));
+    return 2;
+}
+
+uint32_t KeysymForTypedKey(const TypedKey& key) {
+    if (key.kind == TypedKeyKind::kKey) {
+        return KeyCodesFor(static_cast<uint16_t>(key.code)).keysym;
+    }
+    if ((key.code >= 0x20 && key.code <= 0x7E) || (key.code >= 0xA0 && key.code <= 0xFF)) {
+        return key.code;
+    }
+    return 0x01000000 | key.code;
+}
+
+bool TypeNextBatch(const std::vector<TypedKey>& keys, const TextPacing& pacing,
+                   TextSink& sink, size_t* typed) {
+    size_t batch = pacing.keys_per_batch > 0 ? pacing.keys_per_batch : keys.size();
+    size_t count = (std::min)(batch, keys.size() - *typed);
+    size_t sent = sink.TypeKeys(keys.data() + *typed, count);
+    *typed += sent;
+    return sent == count;
+}
+
+size_t TypeText(const std::vector<TypedKey>& keys, const TextPacing& pacing,
+                TextSink& sink, const TextPacingWait& wait) {
+    size_t typed = 0;
+    while (typed < keys.size()) {
+        if (typed > 0 && pacing.batch_interval.count() > 0 && !wait(pacing.batch_interval)) {
+            break;
+        }
+        if (!TypeNextBatch(keys, pacing, sink, &typed)) {
+            break;
+        }
+    }
+    return typed;
+}
+
+}  // namespace hardware_simulator
@@ -0,0 +1,76 @@
+#ifndef FLUTTER_PLUGIN_TEXT_INPUT_H_
+#define FLUTTER_PLUGIN_TEXT_INPUT_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace hardware_simulator {
+
+enum class TypedKeyKind : uint8_t {
+    kCharacter,  // code = Unicode code point, typed regardless of layout.
+    kKey,        // code = virtual-key code, pressed and released.
+};
+
+// One step of typed text. Line breaks, tabs and backspaces are typed as the
+// keys that produce them, since applications treat a Return key press and an
+// injected "\r" character differently.
+struct TypedKey {
+    TypedKeyKind kind = TypedKeyKind::kCharacter;
+    uint32_t code = 0;
+
+    bool operator==(const TypedKey& other) const {
+        return kind == other.kind && code == other.code;
+    }
+};
+
+// Decodes |size| bytes of UTF-8 into |keys|. "\r\n", "\r" and "\n" become one
+// Return, "\t" Tab and "\b" Backspace; other control characters are dropped.
+// Malformed sequences, surrogates and overlong forms are typed as U+FFFD.
+// Returns how many were replaced.
+size_t DecodeTypedText(const char* utf8, size_t size, std::vector<TypedKey>* keys);
+
+// Splits |code_point| into UTF-16 code units. Returns how many (1 or 2).
+size_t EncodeUtf16(uint32_t code_point, uint16_t units[2]);
+
+// The X11 keysym that types |key|: Latin-1 characters are their own keysym,
+// other characters the Unicode keysym range.
+uint32_t KeysymForTypedKey(const TypedKey& key);
+
+// How fast text is typed. Without a batch size the whole text is one batch.
+struct TextPacing {
+    size_t keys_per_batch = 0;
+    std::chrono::microseconds batch_interval{0};
+};
+
+// Platform backend that types keys, one batch per call.
+class TextSink {
+public:
+    virtual ~TextSink() = default;
+
+    // Types |count| keys in order, each pressed and released. Returns how
+    // many were typed.
+    virtual size_t TypeKeys(const TypedKey* keys, size_t count) = 0;
+};
+
+// Waits |interval| between two batches. Returns false to stop typing.
+using TextPacingWait = std::function<bool(std::chrono::microseconds interval)>;
+
+// Types the batch of |keys| that starts at |*typed| and advances |*typed|
+// past what |sink| typed. Returns false when that was not the whole batch.
+// For backends that pace batches with their own timers rather than a
+// blocking |wait|.
+bool TypeNextBatch(const std::vector<TypedKey>& keys, const TextPacing& pacing,
+                   TextSink& sink, size_t* typed);
+
+// Feeds |keys| to |sink| batch by batch, calling |wait| between batches.
+// Stops early when a batch is not typed completely or |wait| returns false.
+// Returns how many keys were typed.
+size_t TypeText(const std::vector<TypedKey>& keys, const TextPacing& pacing,
+                TextSink& sink, const TextPacingWait& wait);
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_TEXT_INPUT_H_
@@ -0,0 +1,212 @@
+#ifndef FLUTTER_PLUGIN_TOUCH_CONTACT_TABLE_H_
+#define FLUTTER_PLUGIN_TOUCH_CONTACT_TABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hardware_simulator {
+
+// Touch contacts the OS accepts at once by default. Windows synthetic
+// pointer devices go up to 256; Linux multitouch slots are device defined.
+constexpr size_t kDefaultMaxTouchContacts = 10;
+constexpr size_t kMaxTouchContactsLimit = 256;
+
+// Where a contact is in its down/move/up life, as of the frame being built.
+enum class TouchPhase : uint8_t {
+    kDown,  // Touched down since the last submitted frame.
+    kMove,  // Still in contact.
+    kUp,    // Lifted since the last submitted frame; gone after EndFrame().
+};
+
+// Active touch contacts keyed by the caller's touch id.
+//
+// Contacts are kept densely packed in slots [0, size()), so a frame is
+// submitted straight from contacts() with no gaps or stale entries. Finding
+// a contact goes through a small open-addressing index, so Down/Move/Up are
+// O(1) whatever the number of contacts. Removing a contact moves the last one
+// into its slot.
+//
+// |Contact| is the per-platform contact record (POINTER_TYPE_INFO on
+// Windows); the table only stores and moves it.
+template <typename Contact>
+class TouchContactTable {
+public:
+    // |max_contacts| is clamped to [1, kMaxTouchContactsLimit].
+    explicit TouchContactTable(size_t max_contacts = kDefaultMaxTouchContacts) {
+        Reset(max_contacts);
+    }
+
+    // |max_contacts| clamped the way the constructor and Reset() clamp it.
+    static size_t ClampMaxContacts(size_t max_contacts) {
+        if (max_contacts < 1) {
+            return 1;
+        }
+        return max_contacts > kMaxTouchContactsLimit ? kMaxTouchContactsLimit : max_contacts;
+    }
+
+    // Drops every contact and changes the limit.
+    void Reset(size_t max_contacts) {
+        max_contacts_ = ClampMaxContacts(max_contacts);
+        size_t buckets = 4;
+        while (buckets < max_contacts_ * 2) {
+            buckets <<= 1;
+        }
+        index_.assign(buckets, kEmptyBucket);
+        bucket_mask_ = buckets - 1;
+        contacts_.clear();
+        contacts_.reserve(max_contacts_);
+        ids_.clear();
+        ids_.reserve(max_contacts_);
+        phases_.clear();
+        phases_.reserve(max_contacts_);
+    }
+
+    size_t max_contacts() const { return max_contacts_; }
+    size_t size() const { return contacts_.size(); }
+    bool empty() const { return contacts_.empty(); }
+
+    Contact* contacts() { return contacts_.data(); }
+    const Contact* contacts() const { return contacts_.data(); }
+    uint32_t touch_id(size_t slot) const { return ids_[slot]; }
+    TouchPhase phase(size_t slot) const { return phases_[slot]; }
+
+    // Slot of |touch_id|, or -1.
+    int SlotOf(uint32_t touch_id) const {
+        size_t bucket = FindBucket(touch_id);
+        return index_[bucket] == kEmptyBucket ? -1 : static_cast<int>(index_[bucket]);
+    }
+
+    Contact* Find(uint32_t touch_id) {
+        int slot = SlotOf(touch_id);
+        return slot < 0 ? nullptr : &contacts_[slot];
+    }
+
+    // Starts a contact, or restarts one that is already known. Returns
+    // nullptr when the table is full.
+    Contact* Down(uint32_t touch_id) {
+        size_t bucket = FindBucket(touch_id);
+        if (index_[bucket] != kEmptyBucket) {
+            phases_[index_[bucket]] = TouchPhase::kDown;
+            return &contacts_[index_[bucket]];
+        }
+        if (contacts_.size() >= max_contacts_) {
+            return nullptr;
+        }
+        index_[bucket] = static_cast<uint16_t>(contacts_.size());
+        contacts_.emplace_back();
+        ids_.push_back(touch_id);
+        phases_.push_back(TouchPhase::kDown);
+        return &contacts_.back();
+    }
+
+    // Moves a contact that is down. A contact that has not been submitted
+    // yet stays kDown. Returns nullptr for unknown or lifted contacts.
+    Contact* Move(uint32_t touch_id) {
+        int slot = SlotOf(touch_id);
+        if (slot < 0 || phases_[slot] == TouchPhase::kUp) {
+            return nullptr;
+        }
+        if (phases_[slot] != TouchPhase::kDown) {
+            phases_[slot] = TouchPhase::kMove;
+        }
+        return &contacts_[slot];
+    }
+
+    // Lifts a contact. It is still part of the next frame, so the OS sees
+    // the up, and is removed by EndFrame(). Returns nullptr when unknown.
+    Contact* Up(uint32_t touch_id) {
+        int slot = SlotOf(touch_id);
+        if (slot < 0) {
+            return nullptr;
+        }
+        phases_[slot] = TouchPhase::kUp;
+        return &contacts_[slot];
+    }
+
+    // Call after a frame was submitted: lifted contacts are removed and new
+    // ones become ordinary moving contacts.
+    void EndFrame() {
+        for (size_t slot = contacts_.size(); slot-- > 0;) {
+            if (phases_[slot] == TouchPhase::kUp) {
+                RemoveSlot(slot);
+            } else {
+                phases_[slot] = TouchPhase::kMove;
+            }
+        }
+    }
+
+    // Forgets |touch_id| without an up. Returns false when unknown.
+    bool Remove(uint32_t touch_id) {
+        int slot = SlotOf(touch_id);
+        if (slot < 0) {
+            return false;
+        }
+        RemoveSlot(static_cast<size_t>(slot));
+        return true;
+    }
+
+    void Clear() { Reset(max_contacts_); }
+
+private:
+    static constexpr uint16_t kEmptyBucket = 0xFFFF;
+
+    size_t HomeBucket(uint32_t touch_id) const {
+        // Fibonacci hashing; touch ids are often small and sequential.
+        return static_cast<size_t>((touch_id * 2654435769u) >> 16) & bucket_mask_;
+    }
+
+    // Bucket holding |touch_id|, or the empty bucket where it would go.
+    size_t FindBucket(uint32_t touch_id) const {
+        size_t bucket = HomeBucket(touch_id);
+        while (index_[bucket] != kEmptyBucket && ids_[index_[bucket]] != touch_id) {
+            bucket = (bucket + 1) & bucket_mask_;
+        }
+        return bucket;
+    }
+
+    void RemoveSlot(size_t slot) {
+        EraseBucket(FindBucket(ids_[slot]));
+
+        size_t last = contacts_.size() - 1;
+        if (slot != last) {
+            contacts_[slot] = contacts_[last];
+            ids_[slot] = ids_[last];
+            phases_[slot] = phases_[last];
+            index_[FindBucket(ids_[slot])] = static_cast<uint16_t>(slot);
+        }
+        contacts_.pop_back();
+        ids_.pop_back();
+        phases_.pop_back();
+    }
+
+    // Linear-probing delete: shifts later entries of the cluster back so
+    // lookups never need tombstones.
+    void EraseBucket(size_t hole) {
+        index_[hole] = kEmptyBucket;
+        size_t bucket = (hole + 1) & bucket_mask_;
+        while (index_[bucket] != kEmptyBucket) {
+            size_t home = HomeBucket(ids_[index_[bucket]]);
+            // Move the entry into the hole unless its home lies cyclically
+            // in (hole, bucket].
+            bool home_after_hole = ((bucket - home) & bucket_mask_) < ((bucket - hole) & bucket_mask_);
+            if (!home_after_hole) {
+                index_[hole] = index_[bucket];
+                index_[bucket] = kEmptyBucket;
+                hole = bucket;
+            }
+            bucket = (bucket + 1) & bucket_mask_;
+        }
+    }
+
+    size_t max_contacts_ = kDefaultMaxTouchContacts;
+    size_t bucket_mask_ = 0;
+    std::vector<uint16_t> index_;
+    std::vector<Contact> contacts_;
+    std::vector<uint32_t> ids_;
+    std::vector<TouchPhase> phases_;
+};
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_TOUCH_CONTACT_TABLE_H_
@@ -0,0 +1,117 @@
+#include "touch_frame.h"
+
+#include "touch_contact_table.h"
+
+namespace hardware_simulator {
+
+void TouchFrameBuilder::Stage(const TouchUpdate& update, InputSink& sink) {
+    for (TouchUpdate& staged : updates_) {
+        if (staged.touch_id != update.touch_id) {
+            continue;
+        }
+        if (update.type == TouchUpdateType::kMove && staged.type == TouchUpdateType::kMove) {
+            staged.screen_id = update.screen_id;
+            staged.x = update.x;
+            staged.y = update.y;
+            return;
+        }
+        Commit(sink);
+        break;
+    }
+    if (updates_.size() == kMaxTouchContactsLimit) {
+        Commit(sink);
+    }
+    updates_.push_back(update);
+}
+
+void TouchFrameBuilder::Commit(InputSink& sink) {
+    if (updates_.empty()) {
+        return;
+    }
+    sink.TouchFrame(updates_.data(), updates_.size());
+    updates_.clear();
+}
+
+void TouchFrameSink::KeyEvent(uint16_t key_code, bool is_down) {
+    frame_.Commit(next_);
+    next_.KeyEvent(key_code, is_down);
+}
+
+void TouchFrameSink::MouseMoveRelative(double dx, double dy) {
+    frame_.Commit(next_);
+    next_.MouseMoveRelative(dx, dy);
+}
+
+void TouchFrameSink::MouseMoveAbsolute(double x, double y, int screen_id) {
+    frame_.Commit(next_);
+    next_.MouseMoveAbsolute(x, y, screen_id);
+}
+
+void TouchFrameSink::MouseButton(int button_id, bool is_down) {
+    frame_.Commit(next_);
+    next_.MouseButton(button_id, is_down);
+}
+
+void TouchFrameSink::MouseScroll(double dx, double dy) {
+    frame_.Commit(next_);
+    next_.MouseScroll(dx, dy);
+}
+
+void TouchFrameSink::TouchEvent(int screen_id, double x, double y, uint32_t touch_id, bool is_down) {
+    TouchUpdate update;
+    update.type = is_down ? TouchUpdateType::kDown : TouchUpdateType::kUp;
+    update.screen_id = screen_id;
+    update.touch_id = touch_id;
+    update.x = x;
+    update.y = y;
+    frame_.Stage(update, next_);
+}
+
+void TouchFrameSink::TouchMove(int screen_id, double x, double y, uint32_t touch_id) {
+    TouchUpdate update;
+    update.type = TouchUpdateType::kMove;
+    update.screen_id = screen_id;
+    update.touch_id = touch_id;
+    update.x = x;
+    update.y = y;
+    frame_.Stage(update, next_);
+}
+
+void TouchFrameSink::PenEvent(int screen_id, double x, double y, bool is_down, bool has_button,
+                              double pressure, double rotation, double tilt) {
+    frame_.Commit(next_);
+    next_.PenEvent(screen_id, x, y, is_down, has_button, pressure, rotation, tilt);
+}
+
+void TouchFrameSink::PenMove(int screen_id, double x, double y, bool has_button,
+                             double pressure, double rotation, double tilt) {
+    frame_.Commit(next_);
+    next_.PenMove(screen_id, x, y, has_button, pressure, rotation, tilt);
+}
+
+void TouchFrameSink::PenMoveBatch(int screen_id, const PenSample* samples, size_t count) {
+    frame_.Commit(next_);
+    next_.PenMoveBatch(screen_id, samples, count);
+}
+
+void TouchFrameSink::TouchFrame(const TouchUpdate* updates, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        frame_.Stage(updates[i], next_);
+    }
+}
+
+void TouchFrameSink::FlushTouchFrame() {
+    frame_.Commit(next_);
+}
+
+void TouchFrameSink::KeyRepeat(uint16_t key_code) {
+    frame_.Commit(next_);
+    next_.KeyRepeat(key_code);
+}
+
+void TouchFrameSink::TouchRepeat(uint32_t touch_id) {
+    frame_.Commit(next_);
+    next_.TouchRepeat(touch_id);
+}
+
+}  // namespace hardware_simulator
@@ -0,0 +1,72 @@
+#ifndef FLUTTER_PLUGIN_TOUCH_FRAME_H_
+#define FLUTTER_PLUGIN_TOUCH_FRAME_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "input_sink.h"
+
+namespace hardware_simulator {
+
+// Gathers touch updates into frames for InputSink::TouchFrame, so a gesture
+// with several contacts costs one injection per frame rather than one per
+// contact update.
+//
+// A frame holds each contact at most once. A move of a contact already
+// moving in the frame only updates its position. Anything else for a
+// contact already in the frame, such as a move right after its down, or its
+// up, commits the frame first and starts the next one, so the OS sees every
+// down and up in order and at its own position.
+class TouchFrameBuilder {
+public:
+    bool empty() const { return updates_.empty(); }
+    size_t size() const { return updates_.size(); }
+
+    // Adds |update|, committing the frame to |sink| first when it can't hold
+    // both.
+    void Stage(const TouchUpdate& update, InputSink& sink);
+
+    // Hands the frame to |sink|, unless it is empty, and starts a new one.
+    void Commit(InputSink& sink);
+
+private:
+    std::vector<TouchUpdate> updates_;
+};
+
+// InputSink that gathers touch calls into frames and passes everything on
+// to |next|. A frame is committed on FlushTouchFrame(), and before any other
+// call so input keeps its order across devices. Sits in front of the
+// platform sink on the injector thread. Not thread-safe.
+class TouchFrameSink : public InputSink {
+public:
+    explicit TouchFrameSink(InputSink& next) : next_(next) {}
+
+    TouchFrameSink(const TouchFrameSink&) = delete;
+    TouchFrameSink& operator=(const TouchFrameSink&) = delete;
+
+    void KeyEvent(uint16_t key_code, bool is_down) override;
+    void MouseMoveRelative(double dx, double dy) override;
+    void MouseMoveAbsolute(double x, double y, int screen_id) override;
+    void MouseButton(int button_id, bool is_down) override;
+    void MouseScroll(double dx, double dy) override;
+    void TouchEvent(int screen_id, double x, double y, uint32_t touch_id, bool is_down) override;
+    void TouchMove(int screen_id, double x, double y, uint32_t touch_id) override;
+    void PenEvent(int screen_id, double x, double y, bool is_down, bool has_button,
+                  double pressure, double rotation, double tilt) override;
+    void PenMove(int screen_id, double x, double y, bool has_button,
+                 double pressure, double rotation, double tilt) override;
+    void PenMoveBatch(int screen_id, const PenSample* samples, size_t count) override;
+    void TouchFrame(const TouchUpdate* updates, size_t count) override;
+    void FlushTouchFrame() override;
+    void KeyRepeat(uint16_t key_code) override;
+    void TouchRepeat(uint32_t touch_id) override;
+
+private:
+    InputSink& next_;
+    TouchFrameBuilder frame_;
+};
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_TOUCH_FRAME_H_
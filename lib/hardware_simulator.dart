@@ -1,6 +1,9 @@
 import 'hardware_simulator_platform_interface.dart';
 import 'display_data.dart';
 
+export 'input_batch.dart';
+export 'hardware_simulator_platform_interface.dart' show SmoothedDevice, TouchGesture;
+
 class HWKeyboard {
   HWKeyboard();
   void performKeyEvent(int keyCode, bool isDown) {
@@ -109,6 +112,143 @@ class HardwareSimulator {
     return HardwareSimulatorPlatform.instance.unlockCursor();
   }
 
+  // While the cursor is locked, raw mouse packets are summed and delivered as
+  // one onCursorMoved per interval. rateHz 0 follows the display refresh rate,
+  // a negative rateHz delivers every packet. With includeButtonsAndWheel the
+  // raw button and wheel changes ride along in the same message.
+  static Future<void> setCursorMovedCoalescing(
+      {int rateHz = 0, bool includeButtonsAndWheel = false}) {
+    return HardwareSimulatorPlatform.instance.setCursorMovedCoalescing(
+        rateHz: rateHz, includeButtonsAndWheel: includeButtonsAndWheel);
+  }
+
+  // Number of simultaneous touch contacts (default 10, at most 256). Active
+  // touches are lifted, so call this before streaming touch input. Returns
+  // the limit in effect.
+  static Future<int> setTouchContactLimit(int maxContacts) {
+    return HardwareSimulatorPlatform.instance.setTouchContactLimit(maxContacts);
+  }
+
+  // Auto-repeat of held keys: first after [delayMs], then every [intervalMs]
+  // (0 never repeats). Applies to [keyCode] or, when omitted, to every key
+  // without its own timing, from the next press. Default 500 ms / 50 ms.
+  static Future<void> setKeyRepeatTiming(
+      {int? keyCode, required int delayMs, required int intervalMs}) {
+    return HardwareSimulatorPlatform.instance.setKeyRepeatTiming(
+        keyCode: keyCode, delayMs: delayMs, intervalMs: intervalMs);
+  }
+
+  // Remaps client input natively before it is injected, replacing remaps
+  // done in Dart before each call. [keyMap] maps a virtual-key code to the
+  // keys it presses, in order (a chord of up to four; empty swallows the
+  // key). [buttonMap] maps a mouse button to another, or to 0 to swallow it.
+  // Relative mouse motion is multiplied by [sensitivityX]/[sensitivityY] and
+  // by the gain of [curve], (speed, gain) points with speed in counts per
+  // move. The profile replaces the previous one at once; keys held across
+  // the swap are released as what they were pressed as. Call without
+  // arguments to remove it.
+  static Future<void> setInputRemap(
+      {Map<int, List<int>>? keyMap,
+      Map<int, int>? buttonMap,
+      double sensitivityX = 1,
+      double sensitivityY = 1,
+      List<(double, double)>? curve}) {
+    return HardwareSimulatorPlatform.instance.setInputRemap(
+        keyMap: keyMap,
+        buttonMap: buttonMap,
+        sensitivityX: sensitivityX,
+        sensitivityY: sensitivityY,
+        curve: curve);
+  }
+
+  // Releases every pressed key, button, touch contact and the pen natively
+  // when renewInputLease is not called for [timeoutMs], e.g. because the
+  // remote client's connection dropped mid-press. The lease starts now;
+  // after it lapses, the next renewal starts it again. 0 stops it.
+  static Future<void> setInputLease(int timeoutMs) {
+    return HardwareSimulatorPlatform.instance.setInputLease(timeoutMs);
+  }
+
+  // Heartbeat for setInputLease, typically on each keep-alive from the
+  // remote client.
+  static Future<void> renewInputLease() {
+    return HardwareSimulatorPlatform.instance.renewInputLease();
+  }
+
+  // Keys captured by immersive mode while the app has focus, reported through
+  // onKeyBlocked instead of reaching the system. Each rule is a virtual-key
+  // code and the SHORTCUT_* modifiers that must be held with it (more may
+  // be); bits 4..11 ask for a side: left/right Ctrl, Shift, Alt, Win. Null
+  // restores the defaults: Win, Alt, right Ctrl, Alt+Tab, Alt+F4 and
+  // Ctrl+Alt+Esc.
+  static Future<void> setShortcutCapturePolicy(List<(int, int)>? rules) {
+    return HardwareSimulatorPlatform.instance.setShortcutCapturePolicy(rules);
+  }
+
+  // ignore: constant_identifier_names
+  static const int SHORTCUT_CTRL = 1 << 0;
+  // ignore: constant_identifier_names
+  static const int SHORTCUT_SHIFT = 1 << 1;
+  // ignore: constant_identifier_names
+  static const int SHORTCUT_ALT = 1 << 2;
+  // ignore: constant_identifier_names
+  static const int SHORTCUT_WIN = 1 << 3;
+
+  // Types [text] independent of the keyboard layout, in one platform call
+  // rather than a KeyPress per character. Line breaks, tabs and backspaces
+  // are typed as their keys. With [keysPerBatch], the text is sent that many
+  // characters at a time, [batchIntervalMs] apart, so slow targets keep up.
+  // Resolves to the number of characters typed.
+  static Future<int> typeText(String text,
+      {int? keysPerBatch, int? batchIntervalMs}) {
+    return HardwareSimulatorPlatform.instance.typeText(text,
+        keysPerBatch: keysPerBatch, batchIntervalMs: batchIntervalMs);
+  }
+
+  // Plays a touch gesture natively, at [rateHz] frames a second (120 by
+  // default), so its timing doesn't depend on the Dart event loop. Points are
+  // fractions of screen [screenId]; the end defaults to the start, and a pinch
+  // turns its [contacts] (2 by default) around [centerX], [centerY] as
+  // contact 0 goes from start to end. Resolves to the number of frames
+  // injected once the contacts are up again.
+  static Future<int> performGesture(TouchGesture type, int screenId,
+      double startX, double startY,
+      {double? endX,
+      double? endY,
+      int durationMs = 300,
+      int? contacts,
+      double? centerX,
+      double? centerY,
+      int? rateHz}) {
+    return HardwareSimulatorPlatform.instance.performGesture(
+        type, screenId, startX, startY,
+        endX: endX,
+        endY: endY,
+        durationMs: durationMs,
+        contacts: contacts,
+        centerX: centerX,
+        centerY: centerY,
+        rateHz: rateHz);
+  }
+
+  // Smooths pen or touch positions natively with a One-Euro filter before
+  // they are injected, to steady jittery input such as samples relayed over a
+  // network. Positions are screen fractions: [minCutoffHz] sets how much
+  // jitter a still pen or finger loses, [beta] how little fast strokes lag,
+  // per screen per second of speed. Settings left out keep the native
+  // defaults. Off until enabled.
+  static Future<void> setInputSmoothing(SmoothedDevice device,
+      {bool enabled = true,
+      double? minCutoffHz,
+      double? beta,
+      double? derivativeCutoffHz}) {
+    return HardwareSimulatorPlatform.instance.setInputSmoothing(device,
+        enabled: enabled,
+        minCutoffHz: minCutoffHz,
+        beta: beta,
+        derivativeCutoffHz: derivativeCutoffHz);
+  }
+
   static void addCursorMoved(CursorMovedCallback callback) {
     HardwareSimulatorPlatform.instance.addCursorMoved(callback);
   }
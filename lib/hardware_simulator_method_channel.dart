@@ -4,6 +4,7 @@ import 'package:flutter/foundation.dart';
 import 'package:flutter/services.dart';
 import 'package:pointer_lock/pointer_lock.dart';
 import 'dart:async';
+import 'dart:typed_data';
 
 import 'hardware_simulator_platform_interface.dart';
 import 'display_data.dart';
@@ -24,6 +25,29 @@ class MethodChannelHardwareSimulator extends HardwareSimulatorPlatform {
         for (var callback in cursorMovedCallbacks) {
           callback(call.arguments['dx'], call.arguments['dy']);
         }
+        // Present only when setCursorMovedCoalescing folds them in.
+        final wheelDx = call.arguments['wheelDx'];
+        final wheelDy = call.arguments['wheelDy'];
+        if (wheelDx != null || wheelDy != null) {
+          for (var callback in cursorWheelCallbacks) {
+            callback(wheelDx ?? 0.0, wheelDy ?? 0.0);
+          }
+        }
+        final int buttonsDown = call.arguments['buttonsDown'] ?? 0;
+        final int buttonsUp = call.arguments['buttonsUp'] ?? 0;
+        for (int bit = 0; (buttonsDown | buttonsUp) >> bit != 0; bit++) {
+          // mouse left button id 1, right button id 3
+          if (buttonsDown & (1 << bit) != 0) {
+            for (var callback in cursorPressedCallbacks) {
+              callback(bit + 1, true);
+            }
+          }
+          if (buttonsUp & (1 << bit) != 0) {
+            for (var callback in cursorPressedCallbacks) {
+              callback(bit + 1, false);
+            }
+          }
+        }
       } else if (call.method == "onCursorButton") {
         for (var callback in cursorPressedCallbacks) {
           callback(call.arguments['buttonId'], call.arguments['isDown']);
@@ -122,6 +146,167 @@ class MethodChannelHardwareSimulator extends HardwareSimulatorPlatform {
     }
   }
 
+  @override
+  Future<void> setCursorMovedCoalescing(
+      {int rateHz = 0, bool includeButtonsAndWheel = false}) async {
+    if (!Platform.isWindows) {
+      return;
+    }
+    await methodChannel.invokeMethod('setCursorMovedCoalescing', {
+      'rateHz': rateHz,
+      'includeButtonsAndWheel': includeButtonsAndWheel,
+    });
+  }
+
+  @override
+  Future<int> setTouchContactLimit(int maxContacts) async {
+    if (!Platform.isWindows) {
+      return 10;
+    }
+    final limit = await methodChannel
+        .invokeMethod<int>('setTouchContactLimit', {'maxContacts': maxContacts});
+    return limit ?? 10;
+  }
+
+  @override
+  Future<void> setKeyRepeatTiming(
+      {int? keyCode, required int delayMs, required int intervalMs}) async {
+    if (!Platform.isWindows) {
+      return;
+    }
+    await methodChannel.invokeMethod('setKeyRepeatTiming', {
+      if (keyCode != null) 'keyCode': keyCode,
+      'delayMs': delayMs,
+      'intervalMs': intervalMs,
+    });
+  }
+
+  @override
+  Future<void> setInputRemap(
+      {Map<int, List<int>>? keyMap,
+      Map<int, int>? buttonMap,
+      double sensitivityX = 1,
+      double sensitivityY = 1,
+      List<(double, double)>? curve}) async {
+    if (!Platform.isWindows) {
+      return;
+    }
+    // Rows of a source key and four zero-padded targets.
+    const chordKeys = 4;
+    final keyRows = Int32List((keyMap?.length ?? 0) * (chordKeys + 1));
+    var row = 0;
+    keyMap?.forEach((source, targets) {
+      keyRows[row] = source;
+      for (var i = 0; i < targets.length && i < chordKeys; i++) {
+        keyRows[row + 1 + i] = targets[i];
+      }
+      row += chordKeys + 1;
+    });
+    await methodChannel.invokeMethod('setInputRemap', {
+      'keyMap': keyRows,
+      'buttonMap': Int32List.fromList([
+        for (final entry in (buttonMap ?? const <int, int>{}).entries) ...[
+          entry.key,
+          entry.value
+        ]
+      ]),
+      'sensitivityX': sensitivityX,
+      'sensitivityY': sensitivityY,
+      'curve': Float64List.fromList(
+          [for (final (speed, gain) in curve ?? const []) ...[speed, gain]]),
+    });
+  }
+
+  @override
+  Future<void> setInputLease(int timeoutMs) async {
+    if (!Platform.isWindows) {
+      return;
+    }
+    await methodChannel.invokeMethod('setInputLease', {'timeoutMs': timeoutMs});
+  }
+
+  @override
+  Future<void> renewInputLease() async {
+    if (!Platform.isWindows) {
+      return;
+    }
+    await methodChannel.invokeMethod('renewInputLease');
+  }
+
+  @override
+  Future<void> setShortcutCapturePolicy(List<(int, int)>? rules) async {
+    if (!Platform.isWindows && !Platform.isLinux) {
+      return;
+    }
+    await methodChannel.invokeMethod('setShortcutCapturePolicy', {
+      if (rules == null) 'useDefaults': true,
+      if (rules != null)
+        'rules': Int32List.fromList(
+            [for (final (key, modifiers) in rules) ...[key, modifiers]]),
+    });
+  }
+
+  @override
+  Future<int> typeText(String text,
+      {int? keysPerBatch, int? batchIntervalMs}) async {
+    if (!Platform.isWindows && !Platform.isLinux) {
+      return 0;
+    }
+    final typed = await methodChannel.invokeMethod<int>('typeText', {
+      'text': text,
+      if (keysPerBatch != null) 'keysPerBatch': keysPerBatch,
+      if (batchIntervalMs != null) 'batchIntervalMs': batchIntervalMs,
+    });
+    return typed ?? 0;
+  }
+
+  @override
+  Future<int> performGesture(
+      TouchGesture type, int screenId, double startX, double startY,
+      {double? endX,
+      double? endY,
+      int durationMs = 300,
+      int? contacts,
+      double? centerX,
+      double? centerY,
+      int? rateHz}) async {
+    if (!Platform.isWindows && !Platform.isLinux) {
+      return 0;
+    }
+    final frames = await methodChannel.invokeMethod<int>('performGesture', {
+      'type': type.name,
+      'screenId': screenId,
+      'startX': startX,
+      'startY': startY,
+      if (endX != null) 'endX': endX,
+      if (endY != null) 'endY': endY,
+      'durationMs': durationMs,
+      if (contacts != null) 'contacts': contacts,
+      if (centerX != null) 'centerX': centerX,
+      if (centerY != null) 'centerY': centerY,
+      if (rateHz != null) 'rateHz': rateHz,
+    });
+    return frames ?? 0;
+  }
+
+  @override
+  Future<void> setInputSmoothing(SmoothedDevice device,
+      {bool enabled = true,
+      double? minCutoffHz,
+      double? beta,
+      double? derivativeCutoffHz}) async {
+    if (!Platform.isWindows && !Platform.isLinux) {
+      return;
+    }
+    await methodChannel.invokeMethod('setInputSmoothing', {
+      'device': device.name,
+      'enabled': enabled,
+      if (minCutoffHz != null) 'minCutoffHz': minCutoffHz,
+      if (beta != null) 'beta': beta,
+      if (derivativeCutoffHz != null) 'derivativeCutoffHz': derivativeCutoffHz,
+    });
+  }
+
   @override
   Future<int?> getMonitorCount() async {
     if (kIsWeb || Platform.isAndroid || Platform.isIOS) {
@@ -508,8 +693,19 @@ class MethodChannelHardwareSimulator extends HardwareSimulatorPlatform {
 
   @override
   Future<bool> setCustomDisplayConfigs(List<Map<String, dynamic>> configs) async {
+    // Sent as (width, height, refreshRate) triples; incomplete entries are
+    // skipped.
     return await methodChannel.invokeMethod('setCustomDisplayConfigs', {
-      'configs': configs,
+      'configs': Int32List.fromList([
+        for (final config in configs)
+          if (config['width'] is int &&
+              config['height'] is int &&
+              config['refreshRate'] is int) ...[
+            config['width'] as int,
+            config['height'] as int,
+            config['refreshRate'] as int,
+          ]
+      ]),
     });
   }
 
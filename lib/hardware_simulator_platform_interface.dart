@@ -6,6 +6,10 @@ import 'package:plugin_platform_interface/plugin_platform_interface.dart';
 import 'hardware_simulator_method_channel.dart';
 import 'display_data.dart';
 
+enum TouchGesture { pinch, swipe, drag, longPress }
+
+enum SmoothedDevice { pen, touch }
+
 typedef CursorMovedCallback = void Function(double x, double y);
 typedef CursorPressedCallback = void Function(int button, bool isDown);
 typedef KeyboardPressedCallback = void Function(int button, bool isDown);
@@ -77,6 +81,69 @@ abstract class HardwareSimulatorPlatform extends PlatformInterface {
     print("unlockCursor called but not supported.");
   }
 
+  Future<void> setCursorMovedCoalescing(
+      {int rateHz = 0, bool includeButtonsAndWheel = false}) async {
+    print("setCursorMovedCoalescing called but not supported.");
+  }
+
+  Future<int> setTouchContactLimit(int maxContacts) async {
+    print("setTouchContactLimit called but not supported.");
+    return 10;
+  }
+
+  Future<void> setKeyRepeatTiming(
+      {int? keyCode, required int delayMs, required int intervalMs}) async {
+    print("setKeyRepeatTiming called but not supported.");
+  }
+
+  Future<void> setInputRemap(
+      {Map<int, List<int>>? keyMap,
+      Map<int, int>? buttonMap,
+      double sensitivityX = 1,
+      double sensitivityY = 1,
+      List<(double, double)>? curve}) async {
+    print("setInputRemap called but not supported.");
+  }
+
+  Future<void> setInputLease(int timeoutMs) async {
+    print("setInputLease called but not supported.");
+  }
+
+  Future<void> renewInputLease() async {
+    print("renewInputLease called but not supported.");
+  }
+
+  Future<void> setShortcutCapturePolicy(List<(int, int)>? rules) async {
+    print("setShortcutCapturePolicy called but not supported.");
+  }
+
+  Future<int> typeText(String text,
+      {int? keysPerBatch, int? batchIntervalMs}) async {
+    print("typeText called but not supported.");
+    return 0;
+  }
+
+  Future<int> performGesture(
+      TouchGesture type, int screenId, double startX, double startY,
+      {double? endX,
+      double? endY,
+      int durationMs = 300,
+      int? contacts,
+      double? centerX,
+      double? centerY,
+      int? rateHz}) async {
+    print("performGesture called but not supported.");
+    return 0;
+  }
+
+  Future<void> setInputSmoothing(SmoothedDevice device,
+      {bool enabled = true,
+      double? minCutoffHz,
+      double? beta,
+      double? derivativeCutoffHz}) async {
+    print("setInputSmoothing called but not supported.");
+  }
+
   void addCursorMoved(CursorMovedCallback callback) async {
     print("addCursorMoved called but not supported.");
   }
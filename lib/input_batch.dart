@@ -0,0 +1,181 @@
+import 'dart:math' as math;
+import 'dart:typed_data';
+
+import 'package:flutter/services.dart';
+
+/// Packs many keyboard, mouse, touch and pen events into one binary message.
+///
+/// Each event is a fixed 48-byte record (see common/input_record.h), so a
+/// frame's worth of input crosses the platform channel once instead of once
+/// per event, and the native side decodes it without building any maps.
+/// Currently handled by the Windows and Linux plugins.
+///
+/// ```dart
+/// final batch = InputBatch();
+/// batch.addMouseMoveRelative(3, -2);
+/// batch.addKeyEvent(0x41, true);
+/// await batch.flush();
+/// ```
+class InputBatch {
+  static const BasicMessageChannel<ByteData?> channel =
+      BasicMessageChannel<ByteData?>(
+          'hardware_simulator/input_batch', BinaryCodec());
+
+  static const int _magic = 0x42495348; // "HSIB"
+  static const int _version = 1;
+  static const int _headerSize = 8;
+  static const int recordSize = 48;
+  static const int maxRecords = 0xffff;
+
+  // Record types, mirroring InputRecordType in common/input_record.h.
+  static const int _typeKey = 1;
+  static const int _typeMouseMoveRelative = 2;
+  static const int _typeMouseMoveAbsolute = 3;
+  static const int _typeMouseButton = 4;
+  static const int _typeMouseScroll = 5;
+  static const int _typeTouchEvent = 6;
+  static const int _typeTouchMove = 7;
+  static const int _typePenEvent = 8;
+  static const int _typePenMove = 9;
+
+  static const int _flagDown = 1 << 0;
+  static const int _flagButton = 1 << 1;
+  static const int _flagFrameEnd = 1 << 3;
+
+  static final Stopwatch _clock = Stopwatch()..start();
+
+  InputBatch({int initialCapacity = 64})
+      : _bytes = Uint8List(_headerSize + initialCapacity * recordSize);
+
+  Uint8List _bytes;
+  int _count = 0;
+
+  /// Number of events added since the last [flush].
+  int get length => _count;
+  bool get isEmpty => _count == 0;
+
+  void addKeyEvent(int keyCode, bool isDown) {
+    _add(_typeKey, code: keyCode, flags: isDown ? _flagDown : 0);
+  }
+
+  void addMouseMoveRelative(double deltax, double deltay) {
+    _add(_typeMouseMoveRelative, x: deltax, y: deltay);
+  }
+
+  // x, y is the percentage of the screen ranged from 0 - 1.
+  void addMouseMoveAbsl(double percentx, double percenty, int screenId) {
+    _add(_typeMouseMoveAbsolute, x: percentx, y: percenty, screenId: screenId);
+  }
+
+  // mouse left button id 1, right button id 3
+  void addMouseClick(int buttonId, bool isDown) {
+    _add(_typeMouseButton, code: buttonId, flags: isDown ? _flagDown : 0);
+  }
+
+  void addMouseScroll(double dx, double dy) {
+    _add(_typeMouseScroll, x: dx, y: dy);
+  }
+
+  void addTouchEvent(
+      double x, double y, int touchId, bool isDown, int screenId) {
+    _add(_typeTouchEvent,
+        x: x,
+        y: y,
+        touchId: touchId,
+        screenId: screenId,
+        flags: isDown ? _flagDown : 0);
+  }
+
+  void addTouchMove(double x, double y, int touchId, int screenId) {
+    _add(_typeTouchMove, x: x, y: y, touchId: touchId, screenId: screenId);
+  }
+
+  /// Ends the touch frame at the last touch event added. The touch events of
+  /// a frame are injected together, each contact once at its latest
+  /// position; without this a whole message is one frame.
+  void endTouchFrame() {
+    if (_count == 0) return;
+    final offset = _headerSize + (_count - 1) * recordSize;
+    final type = _bytes[offset];
+    if (type == _typeTouchEvent || type == _typeTouchMove) {
+      _bytes[offset + 1] |= _flagFrameEnd;
+    }
+  }
+
+  void addPenEvent(double x, double y, bool isDown, bool hasButton,
+      double pressure, double rotation, double tilt, int screenId) {
+    _add(_typePenEvent,
+        x: x,
+        y: y,
+        screenId: screenId,
+        flags: (isDown ? _flagDown : 0) | (hasButton ? _flagButton : 0),
+        pressure: pressure,
+        rotation: rotation,
+        tilt: tilt);
+  }
+
+  void addPenMove(double x, double y, bool hasButton, double pressure,
+      double rotation, double tilt, int screenId) {
+    _add(_typePenMove,
+        x: x,
+        y: y,
+        screenId: screenId,
+        flags: hasButton ? _flagButton : 0,
+        pressure: pressure,
+        rotation: rotation,
+        tilt: tilt);
+  }
+
+  /// Returns the encoded message and resets the batch for reuse.
+  ByteData takeMessage() {
+    final header = ByteData.sublistView(_bytes, 0, _headerSize);
+    header.setUint32(0, _magic, Endian.little);
+    header.setUint16(4, _version, Endian.little);
+    header.setUint16(6, _count, Endian.little);
+    final message = Uint8List.fromList(
+        Uint8List.sublistView(_bytes, 0, _headerSize + _count * recordSize));
+    _count = 0;
+    return message.buffer.asByteData();
+  }
+
+  /// Sends every queued event in one platform-channel message.
+  Future<void> flush() async {
+    if (_count == 0) return;
+    await channel.send(takeMessage());
+  }
+
+  void _add(int type,
+      {int code = 0,
+      int flags = 0,
+      int screenId = 0,
+      int touchId = 0,
+      double x = 0,
+      double y = 0,
+      double pressure = 0,
+      double rotation = 0,
+      double tilt = 0}) {
+    if (_count == maxRecords) {
+      throw StateError('InputBatch holds at most $maxRecords events');
+    }
+    final offset = _headerSize + _count * recordSize;
+    if (offset + recordSize > _bytes.length) {
+      final grown =
+          Uint8List(math.max(_bytes.length * 2, offset + recordSize));
+      grown.setRange(0, _bytes.length, _bytes);
+      _bytes = grown;
+    }
+    final record = ByteData.sublistView(_bytes, offset, offset + recordSize);
+    record.setUint8(0, type);
+    record.setUint8(1, flags);
+    record.setUint16(2, code, Endian.little);
+    record.setInt32(4, screenId, Endian.little);
+    record.setUint32(8, touchId, Endian.little);
+    record.setFloat32(12, pressure, Endian.little);
+    record.setFloat32(16, rotation, Endian.little);
+    record.setFloat32(20, tilt, Endian.little);
+    record.setInt64(24, _clock.elapsedMicroseconds, Endian.little);
+    record.setFloat64(32, x, Endian.little);
+    record.setFloat64(40, y, Endian.little);
+    _count++;
+  }
+}
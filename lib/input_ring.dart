@@ -0,0 +1,228 @@
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:typed_data';
+
+typedef _OpenNative = Pointer<Void> Function(Uint32 capacity);
+typedef _OpenDart = Pointer<Void> Function(int capacity);
+typedef _CloseNative = Void Function(Pointer<Void> ring);
+typedef _CloseDart = void Function(Pointer<Void> ring);
+typedef _QueryNative = Uint32 Function(Pointer<Void> ring);
+typedef _QueryDart = int Function(Pointer<Void> ring);
+typedef _SlotsNative = Pointer<Uint8> Function(Pointer<Void> ring);
+typedef _CommitNative = Void Function(Pointer<Void> ring, Uint32 count);
+typedef _CommitDart = void Function(Pointer<Void> ring, int count);
+
+/// Injects keyboard, mouse, touch and pen events through a shared-memory ring
+/// buffer instead of the platform channel.
+///
+/// Records are written straight into native memory through dart:ffi and a
+/// native thread feeds them to the same injection functions the method channel
+/// uses, so an event never waits for the platform thread. The records use the
+/// 48-byte layout of [InputBatch] (see common/input_record.h).
+///
+/// The ring has a single producer: use it from one isolate only. Currently
+/// backed by the Windows and Linux plugins; [open] returns null where the
+/// platform has no ring, or on Linux when /dev/uinput is not writable. Not
+/// exported from hardware_simulator.dart because dart:ffi is not available on
+/// the web, import `package:hardware_simulator/input_ring.dart`.
+///
+/// ```dart
+/// final ring = InputRing.open();
+/// ring?.addMouseMoveRelative(3, -2);
+/// ```
+class InputRing {
+  static const int recordSize = 48;
+
+  // Record types, mirroring InputRecordType in common/input_record.h.
+  static const int _typeKey = 1;
+  static const int _typeMouseMoveRelative = 2;
+  static const int _typeMouseMoveAbsolute = 3;
+  static const int _typeMouseButton = 4;
+  static const int _typeMouseScroll = 5;
+  static const int _typeTouchEvent = 6;
+  static const int _typeTouchMove = 7;
+  static const int _typePenEvent = 8;
+  static const int _typePenMove = 9;
+
+  static const int _flagDown = 1 << 0;
+  static const int _flagButton = 1 << 1;
+
+  static final Stopwatch _clock = Stopwatch()..start();
+
+  static DynamicLibrary? _library;
+
+  static DynamicLibrary? _loadLibrary() {
+    if (_library != null) return _library;
+    if (Platform.isWindows) {
+      _library = DynamicLibrary.open('hardware_simulator_plugin.dll');
+    } else if (Platform.isLinux) {
+      _library = DynamicLibrary.open('libhardware_simulator_plugin.so');
+    }
+    return _library;
+  }
+
+  /// Opens the process-wide ring, or returns null when it is not supported.
+  ///
+  /// With [autoCommit] every add* call publishes its event immediately. Turn
+  /// it off to publish a frame's worth of events at once with [commit].
+  static InputRing? open({int capacity = 1024, bool autoCommit = true}) {
+    final library = _loadLibrary();
+    if (library == null) return null;
+    final open = library.lookupFunction<_OpenNative, _OpenDart>(
+        'hardware_simulator_input_ring_open');
+    final handle = open(capacity);
+    if (handle == nullptr) return null;
+    final ringCapacity = library.lookupFunction<_QueryNative, _QueryDart>(
+        'hardware_simulator_input_ring_capacity')(handle);
+    final slots = library.lookupFunction<_SlotsNative, _SlotsNative>(
+        'hardware_simulator_input_ring_slots')(handle);
+    return InputRing._(library, handle, autoCommit,
+        ByteData.sublistView(slots.asTypedList(ringCapacity * recordSize)));
+  }
+
+  InputRing._(
+      DynamicLibrary library, this._handle, this.autoCommit, this._records)
+      : _close = library.lookupFunction<_CloseNative, _CloseDart>(
+            'hardware_simulator_input_ring_close'),
+        _reserve = library.lookupFunction<_QueryNative, _QueryDart>(
+            'hardware_simulator_input_ring_reserve',
+            isLeaf: true),
+        _writeIndex = library.lookupFunction<_QueryNative, _QueryDart>(
+            'hardware_simulator_input_ring_write_index',
+            isLeaf: true),
+        _commit = library.lookupFunction<_CommitNative, _CommitDart>(
+            'hardware_simulator_input_ring_commit',
+            isLeaf: true);
+
+  final Pointer<Void> _handle;
+  final bool autoCommit;
+  final _CloseDart _close;
+  final _QueryDart _reserve;
+  final _QueryDart _writeIndex;
+  final _CommitDart _commit;
+  // View of the native slots; writes land directly in the ring.
+  final ByteData _records;
+
+  int _index = 0;
+  int _reserved = 0;
+  int _pending = 0;
+  bool _closed = false;
+
+  void addKeyEvent(int keyCode, bool isDown) {
+    _add(_typeKey, code: keyCode, flags: isDown ? _flagDown : 0);
+  }
+
+  void addMouseMoveRelative(double deltax, double deltay) {
+    _add(_typeMouseMoveRelative, x: deltax, y: deltay);
+  }
+
+  // x, y is the percentage of the screen ranged from 0 - 1.
+  void addMouseMoveAbsl(double percentx, double percenty, int screenId) {
+    _add(_typeMouseMoveAbsolute, x: percentx, y: percenty, screenId: screenId);
+  }
+
+  // mouse left button id 1, right button id 3
+  void addMouseClick(int buttonId, bool isDown) {
+    _add(_typeMouseButton, code: buttonId, flags: isDown ? _flagDown : 0);
+  }
+
+  void addMouseScroll(double dx, double dy) {
+    _add(_typeMouseScroll, x: dx, y: dy);
+  }
+
+  void addTouchEvent(
+      double x, double y, int touchId, bool isDown, int screenId) {
+    _add(_typeTouchEvent,
+        x: x,
+        y: y,
+        touchId: touchId,
+        screenId: screenId,
+        flags: isDown ? _flagDown : 0);
+  }
+
+  void addTouchMove(double x, double y, int touchId, int screenId) {
+    _add(_typeTouchMove, x: x, y: y, touchId: touchId, screenId: screenId);
+  }
+
+  void addPenEvent(double x, double y, bool isDown, bool hasButton,
+      double pressure, double rotation, double tilt, int screenId) {
+    _add(_typePenEvent,
+        x: x,
+        y: y,
+        screenId: screenId,
+        flags: (isDown ? _flagDown : 0) | (hasButton ? _flagButton : 0),
+        pressure: pressure,
+        rotation: rotation,
+        tilt: tilt);
+  }
+
+  void addPenMove(double x, double y, bool hasButton, double pressure,
+      double rotation, double tilt, int screenId) {
+    _add(_typePenMove,
+        x: x,
+        y: y,
+        screenId: screenId,
+        flags: hasButton ? _flagButton : 0,
+        pressure: pressure,
+        rotation: rotation,
+        tilt: tilt);
+  }
+
+  /// Publishes every event added since the last commit.
+  void commit() {
+    if (_pending == 0) return;
+    _commit(_handle, _pending);
+    _pending = 0;
+  }
+
+  /// Publishes pending events and shuts the ring down once they are injected.
+  void close() {
+    if (_closed) return;
+    commit();
+    _closed = true;
+    _close(_handle);
+  }
+
+  void _add(int type,
+      {int code = 0,
+      int flags = 0,
+      int screenId = 0,
+      int touchId = 0,
+      double x = 0,
+      double y = 0,
+      double pressure = 0,
+      double rotation = 0,
+      double tilt = 0}) {
+    if (_closed) {
+      throw StateError('InputRing is closed');
+    }
+    if (_reserved == 0) {
+      // Publish what we have so the consumer can free slots, then claim the
+      // next contiguous run.
+      commit();
+      _reserved = _reserve(_handle);
+      _index = _writeIndex(_handle);
+      if (_reserved == 0) {
+        // Also once the plugin went away: the ring then takes nothing more
+        // and only needs closing.
+        throw StateError('InputRing is full or its plugin has gone away');
+      }
+    }
+    final offset = _index * recordSize;
+    _records.setUint8(offset, type);
+    _records.setUint8(offset + 1, flags);
+    _records.setUint16(offset + 2, code, Endian.little);
+    _records.setInt32(offset + 4, screenId, Endian.little);
+    _records.setUint32(offset + 8, touchId, Endian.little);
+    _records.setFloat32(offset + 12, pressure, Endian.little);
+    _records.setFloat32(offset + 16, rotation, Endian.little);
+    _records.setFloat32(offset + 20, tilt, Endian.little);
+    _records.setInt64(offset + 24, _clock.elapsedMicroseconds, Endian.little);
+    _records.setFloat64(offset + 32, x, Endian.little);
+    _records.setFloat64(offset + 40, y, Endian.little);
+    _index++;
+    _reserved--;
+    _pending++;
+    if (autoCommit) commit();
+  }
+}
@@ -0,0 +1,175 @@
+#include <benchmark/benchmark.h>
+#include <flutter_linux/flutter_linux.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "input_ring.h"
+#include "method_dispatch.h"
+
+// End-to-end latency of one key event from the sender until the injection
+// sink sees it, over the FFI ring versus the MethodChannel route. The channel
+// side encodes with the standard codec and hops onto a GMainContext thread
+// the way a platform message reaches the GTK main loop, then decodes and
+// looks up the arguments as the handler does.
+
+namespace hardware_simulator {
+namespace {
+
+class CountingSink : public InputSink {
+public:
+    std::atomic<uint64_t> delivered{0};
+
+    void KeyEvent(uint16_t key_code, bool is_down) override { Count(); }
+    void MouseMoveRelative(double dx, double dy) override { Count(); }
+    void MouseMoveAbsolute(double x, double y, int screen_id) override { Count(); }
+    void MouseButton(int button_id, bool is_down) override { Count(); }
+    void MouseScroll(double dx, double dy) override { Count(); }
+    void TouchEvent(int screen_id, double x, double y, uint32_t touch_id, bool is_down) override { Count(); }
+    void TouchMove(int screen_id, double x, double y, uint32_t touch_id) override { Count(); }
+    void PenEvent(int screen_id, double x, double y, bool is_down, bool has_button,
+                  double pressure, double rotation, double tilt) override { Count(); }
+    void PenMove(int screen_id, double x, double y, bool has_button,
+                 double pressure, double rotation, double tilt) override { Count(); }
+    void KeyRepeat(uint16_t key_code) override { Count(); }
+    void TouchRepeat(uint32_t touch_id) override { Count(); }
+
+    void WaitFor(uint64_t count) const {
+        while (delivered.load(std::memory_order_acquire) < count) {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    void Count() { delivered.fetch_add(1, std::memory_order_release); }
+};
+
+InputRecord KeyRecord(uint64_t i) {
+    InputRecord record = {};
+    record.type = static_cast<uint8_t>(InputRecordType::kKey);
+    record.code = 0x41;
+    record.flags = (i & 1) == 0 ? kInputRecordDown : 0;
+    return record;
+}
+
+// Argument: consumer spin iterations before parking. 0 measures the
+// condition-variable wake-up on every event.
+void BM_InputRingLatency(benchmark::State& state) {
+    InputRing ring(1024);
+    CountingSink sink;
+    InputRingConsumer consumer(ring, sink, static_cast<int>(state.range(0)));
+    uint64_t sent = 0;
+    for (auto _ : state) {
+        ring.TryPush(KeyRecord(sent));
+        consumer.Notify();
+        sink.WaitFor(++sent);
+    }
+    consumer.Stop();
+    state.SetItemsProcessed(static_cast<int64_t>(sent));
+}
+BENCHMARK(BM_InputRingLatency)->Arg(0)->Arg(InputRingConsumer::kDefaultSpinIterations)->UseRealTime();
+
+// A frame's worth of events committed at once.
+void BM_InputRingBurst(benchmark::State& state) {
+    const uint32_t burst = static_cast<uint32_t>(state.range(0));
+    InputRing ring(1024);
+    CountingSink sink;
+    InputRingConsumer consumer(ring, sink);
+    uint64_t sent = 0;
+    for (auto _ : state) {
+        uint32_t index = ring.WriteIndex();
+        uint32_t count = ring.Reserve() < burst ? ring.Reserve() : burst;
+        for (uint32_t i = 0; i < count; ++i) {
+            ring.slots()[index + i] = KeyRecord(sent + i);
+        }
+        ring.Commit(count);
+        consumer.Notify();
+        sent += count;
+        sink.WaitFor(sent);
+    }
+    consumer.Stop();
+    state.SetItemsProcessed(static_cast<int64_t>(sent));
+}
+BENCHMARK(BM_InputRingBurst)->Arg(16)->Arg(64)->UseRealTime();
+
+// Stand-in for the GTK platform thread that runs method call handlers.
+class PlatformThread {
+public:
+    PlatformThread()
+        : context_(g_main_context_new()),
+          loop_(g_main_loop_new(context_, FALSE)),
+          thread_([this] {
+              g_main_context_push_thread_default(context_);
+              g_main_loop_run(loop_);
+              g_main_context_pop_thread_default(context_);
+          }) {
+        while (!g_main_loop_is_running(loop_)) {
+            std::this_thread::yield();
+        }
+    }
+
+    ~PlatformThread() {
+        g_main_loop_quit(loop_);
+        thread_.join();
+        g_main_loop_unref(loop_);
+        g_main_context_unref(context_);
+    }
+
+    GMainContext* context() const { return context_; }
+
+private:
+    GMainContext* context_;
+    GMainLoop* loop_;
+    std::thread thread_;
+};
+
+struct ChannelMessage {
+    FlMessageCodec* codec;
+    GBytes* bytes;
+    CountingSink* sink;
+};
+
+gboolean HandleChannelMessage(gpointer user_data) {
+    ChannelMessage* message = static_cast<ChannelMessage*>(user_data);
+    g_autoptr(GError) error = nullptr;
+    g_autoptr(FlValue) call = fl_message_codec_decode_message(message->codec, message->bytes, &error);
+    const gchar* method = fl_value_get_string(fl_value_get_list_value(call, 0));
+    FlValue* args = fl_value_get_list_value(call, 1);
+    if (LookupMethod(method) == MethodId::kKeyPress) {
+        message->sink->KeyEvent(
+            static_cast<uint16_t>(fl_value_get_int(fl_value_lookup_string(args, "code"))),
+            fl_value_get_bool(fl_value_lookup_string(args, "isDown")));
+    }
+    g_bytes_unref(message->bytes);
+    delete message;
+    return G_SOURCE_REMOVE;
+}
+
+void BM_MethodChannelLatency(benchmark::State& state) {
+    g_autoptr(FlStandardMessageCodec) codec = fl_standard_message_codec_new();
+    CountingSink sink;
+    PlatformThread platform;
+    uint64_t sent = 0;
+    for (auto _ : state) {
+        g_autoptr(FlValue) call = fl_value_new_list();
+        fl_value_append_take(call, fl_value_new_string("KeyPress"));
+        FlValue* args = fl_value_new_map();
+        fl_value_set_string_take(args, "code", fl_value_new_int(0x41));
+        fl_value_set_string_take(args, "isDown", fl_value_new_bool((sent & 1) == 0));
+        fl_value_append_take(call, args);
+
+        g_autoptr(GError) error = nullptr;
+        ChannelMessage* message = new ChannelMessage{
+            FL_MESSAGE_CODEC(codec),
+            fl_message_codec_encode_message(FL_MESSAGE_CODEC(codec), call, &error),
+            &sink};
+        g_main_context_invoke(platform.context(), HandleChannelMessage, message);
+        sink.WaitFor(++sent);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(sent));
+}
+BENCHMARK(BM_MethodChannelLatency)->UseRealTime();
+
+}  // namespace
+}  // namespace hardware_simulator
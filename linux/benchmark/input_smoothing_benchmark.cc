@@ -0,0 +1,227 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "input_smoothing.h"
+
+// Accuracy and latency of the One-Euro stage on pen strokes as they arrive
+// over a lossy network, and what the stage costs per sample.
+//
+// A trace is replayed through a SmoothingInputSink on a virtual clock that
+// reads each sample's arrival time, and the output is compared with the
+// stroke the sender drew, at 1920 pixels per screen:
+//   still_px  RMS error while the pen holds still, which is the jitter left.
+//   lag_ms    The delay, up to 100 ms, that best lines the output up with
+//             a fast move, which is the latency smoothing adds.
+//   move_px   RMS error of the move once delayed by lag_ms.
+
+namespace hardware_simulator {
+namespace {
+
+constexpr double kPixelsPerScreen = 1920;
+
+struct TraceSample {
+    int64_t sent_us;
+    int64_t arrived_us;
+    double x;
+    double y;
+};
+
+// Where the sender's pen was |t| seconds into the stroke: a hold, a fast
+// move across a fifth of the screen, another hold, then slow handwriting.
+void Stroke(double t, double* x, double* y) {
+    constexpr double kPi = 3.14159265358979323846;
+    *y = 0.5;
+    if (t < 1) {
+        *x = 0.3;
+    } else if (t < 1.5) {
+        *x = 0.3 + 0.2 * (1 - std::cos(kPi * (t - 1) / 0.5)) / 2;
+    } else if (t < 2.5) {
+        *x = 0.5;
+    } else {
+        *x = 0.5 + 0.01 * std::sin(2 * kPi * (t - 2.5));
+        *y = 0.5 + 0.01 * std::cos(2 * kPi * (t - 2.5)) - 0.01;
+    }
+}
+
+bool Holding(double t) {
+    return (t >= 0.3 && t < 1) || (t >= 1.8 && t < 2.5);
+}
+
+bool Moving(double t) {
+    return t >= 1 && t < 1.5;
+}
+
+// A recorded-style trace: a 3.5 s stroke sampled at |rate_hz| with digitizer
+// and rounding noise, then delivered in order over a link with jittery
+// delay that now and then loses a packet and resends it, so the samples
+// behind it arrive in a burst. Fixed seed, so every run sees the same trace.
+std::vector<TraceSample> NetworkTrace(int rate_hz, double noise_px) {
+    std::mt19937 random(1234);
+    std::normal_distribution<double> noise(0, noise_px / kPixelsPerScreen);
+    std::exponential_distribution<double> jitter_ms(1 / 4.0);
+    std::bernoulli_distribution lost(0.02);
+
+    std::vector<TraceSample> trace;
+    int64_t arrived_us = 0;
+    for (int i = 0; i < 7 * rate_hz / 2; ++i) {
+        TraceSample sample;
+        sample.sent_us = int64_t{1000000} * i / rate_hz;
+        Stroke(sample.sent_us / 1e6, &sample.x, &sample.y);
+        sample.x += noise(random);
+        sample.y += noise(random);
+        double delay_ms = 20 + jitter_ms(random) + (lost(random) ? 60 : 0);
+        arrived_us = (std::max)(arrived_us, sample.sent_us + static_cast<int64_t>(delay_ms * 1000));
+        sample.arrived_us = arrived_us;
+        trace.push_back(sample);
+    }
+    return trace;
+}
+
+// Keeps the pen positions it is handed.
+class PenTraceSink : public InputSink {
+public:
+    void KeyEvent(uint16_t, bool) override {}
+    void MouseMoveRelative(double, double) override {}
+    void MouseMoveAbsolute(double, double, int) override {}
+    void MouseButton(int, bool) override {}
+    void MouseScroll(double, double) override {}
+    void TouchEvent(int, double, double, uint32_t, bool) override {}
+    void TouchMove(int, double, double, uint32_t) override {}
+    void PenEvent(int, double, double, bool, bool, double, double, double) override {}
+    void PenMove(int, double x, double y, bool, double, double, double) override {
+        x_[count_] = x;
+        y_[count_] = y;
+        ++count_;
+    }
+    void KeyRepeat(uint16_t) override {}
+    void TouchRepeat(uint32_t) override {}
+
+    void Reset(size_t size) {
+        x_.resize(size);
+        y_.resize(size);
+        count_ = 0;
+    }
+    double x(size_t i) const { return x_[i]; }
+    double y(size_t i) const { return y_[i]; }
+
+private:
+    std::vector<double> x_;
+    std::vector<double> y_;
+    size_t count_ = 0;
+};
+
+// Keeps only the last pen position.
+class LastPenSink : public PenTraceSink {
+public:
+    void PenMove(int, double x, double, bool, double, double, double) override { last_x = x; }
+
+    double last_x = 0;
+};
+
+// RMS distance, in pixels, between the output and where the stroke was
+// |delay_us| before each sample was sent, over the samples sent while
+// |during| holds.
+double RmsErrorPx(const std::vector<TraceSample>& trace, const PenTraceSink& out,
+                  int64_t delay_us, bool (*during)(double t)) {
+    double sum = 0;
+    size_t count = 0;
+    for (size_t i = 0; i < trace.size(); ++i) {
+        double t = trace[i].sent_us / 1e6;
+        if (!during(t)) {
+            continue;
+        }
+        double x, y;
+        Stroke(t - delay_us / 1e6, &x, &y);
+        sum += (out.x(i) - x) * (out.x(i) - x) + (out.y(i) - y) * (out.y(i) - y);
+        ++count;
+    }
+    return std::sqrt(sum / count) * kPixelsPerScreen;
+}
+
+void ReportAccuracy(benchmark::State& state, const std::vector<TraceSample>& trace,
+                    const PenTraceSink& out) {
+    int64_t best_delay_us = 0;
+    double best_error = RmsErrorPx(trace, out, 0, Moving);
+    for (int64_t delay_us = 250; delay_us <= 100000; delay_us += 250) {
+        double error = RmsErrorPx(trace, out, delay_us, Moving);
+        if (error < best_error) {
+            best_error = error;
+            best_delay_us = delay_us;
+        }
+    }
+    state.counters["still_px"] = RmsErrorPx(trace, out, 0, Holding);
+    state.counters["lag_ms"] = best_delay_us / 1000.0;
+    state.counters["move_px"] = best_error;
+    state.SetItemsProcessed(state.iterations() * trace.size());
+}
+
+// Args: sender rate in Hz, noise in pixels.
+void BM_UnsmoothedTrace(benchmark::State& state) {
+    std::vector<TraceSample> trace = NetworkTrace(state.range(0), state.range(1));
+    PenTraceSink out;
+    for (auto _ : state) {
+        out.Reset(trace.size());
+        for (const TraceSample& sample : trace) {
+            out.PenMove(0, sample.x, sample.y, false, 0.5, -1, -1);
+        }
+        benchmark::ClobberMemory();
+    }
+    ReportAccuracy(state, trace, out);
+}
+BENCHMARK(BM_UnsmoothedTrace)->Args({120, 3})->Args({120, 8});
+
+// Args: sender rate in Hz, noise in pixels, min cutoff in tenths of a Hz,
+// beta in tenths.
+void BM_SmoothedTrace(benchmark::State& state) {
+    std::vector<TraceSample> trace = NetworkTrace(state.range(0), state.range(1));
+    OneEuroParams params;
+    params.min_cutoff_hz = state.range(2) / 10.0;
+    params.beta = state.range(3) / 10.0;
+    SmoothingInputSink::TimePoint now;
+    PenTraceSink out;
+    SmoothingInputSink smoothing(out, [&now] { return now; });
+    for (auto _ : state) {
+        smoothing.Enable(SmoothedDevice::kPen, params);
+        out.Reset(trace.size());
+        for (const TraceSample& sample : trace) {
+            now = SmoothingInputSink::TimePoint(std::chrono::microseconds(sample.arrived_us));
+            smoothing.PenMove(0, sample.x, sample.y, false, 0.5, -1, -1);
+        }
+        benchmark::ClobberMemory();
+    }
+    ReportAccuracy(state, trace, out);
+}
+BENCHMARK(BM_SmoothedTrace)
+    ->Args({120, 3, 10, 200})
+    ->Args({120, 8, 10, 200})
+    ->Args({120, 8, 10, 0})
+    ->Args({120, 8, 10, 400})
+    ->Args({120, 8, 5, 200})
+    ->Args({240, 8, 10, 200});
+
+// Arg: whether pen smoothing is on. Off is the cost every pen sample pays
+// for the stage being there.
+void BM_SmoothingSinkPenMove(benchmark::State& state) {
+    LastPenSink out;
+    SmoothingInputSink smoothing(out);
+    if (state.range(0)) {
+        smoothing.Enable(SmoothedDevice::kPen, OneEuroParams());
+    }
+    double x = 0;
+    for (auto _ : state) {
+        x = x < 1 ? x + 0.001 : 0;
+        smoothing.PenMove(0, x, 0.5, false, 0.5, -1, -1);
+    }
+    benchmark::DoNotOptimize(out.last_x);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SmoothingSinkPenMove)->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace hardware_simulator
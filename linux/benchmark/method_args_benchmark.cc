@@ -0,0 +1,93 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <variant>
+
+#include "method_args.h"
+#include "method_schema.h"
+
+// Compares the Windows handler's old argument access, one
+// `args->find(EncodableValue("key"))->second` plus std::get per argument,
+// with the schema decoder's single pass over the same map.
+
+namespace hardware_simulator {
+namespace {
+
+// Same scalar alternatives, in the same order, as flutter::EncodableValue,
+// which only ships with the Windows embedding. Map lookups and temporary keys
+// behave the same way.
+struct Value : std::variant<std::monostate, bool, int32_t, int64_t, double, std::string> {
+    using variant::variant;
+    Value(const char* s) : variant(std::string(s)) {}
+};
+using ValueMap = std::map<Value, Value>;
+
+ValueMap PenMoveMap() {
+    return {{"screenId", 0},     {"x", 0.25},        {"y", 0.75},  {"hasButton", false},
+            {"pressure", 0.5},   {"rotation", 90.0}, {"tilt", 30.0}};
+}
+
+void BM_FindPerKeyPenMove(benchmark::State& state) {
+    const ValueMap map = PenMoveMap();
+    const ValueMap* args = &map;
+    for (auto _ : state) {
+        auto screenId = (args->find(Value("screenId")))->second;
+        auto x = (args->find(Value("x")))->second;
+        auto y = (args->find(Value("y")))->second;
+        auto hasButton = (args->find(Value("hasButton")))->second;
+        auto pressure = (args->find(Value("pressure")))->second;
+        auto rotation = (args->find(Value("rotation")))->second;
+        auto tilt = (args->find(Value("tilt")))->second;
+        PenMoveArgs pen;
+        pen.screen_id = static_cast<int>(std::get<int32_t>(screenId));
+        pen.x = std::get<double>(x);
+        pen.y = std::get<double>(y);
+        pen.has_button = std::get<bool>(hasButton);
+        pen.pressure = std::get<double>(pressure);
+        pen.rotation = std::get<double>(rotation);
+        pen.tilt = std::get<double>(tilt);
+        benchmark::DoNotOptimize(pen);
+    }
+}
+BENCHMARK(BM_FindPerKeyPenMove);
+
+void BM_DecodeArgsPenMove(benchmark::State& state) {
+    const ValueMap map = PenMoveMap();
+    for (auto _ : state) {
+        PenMoveArgs pen;
+        ArgError error = DecodeVariantMapArgs(&map, &pen);
+        benchmark::DoNotOptimize(error);
+        benchmark::DoNotOptimize(pen);
+    }
+}
+BENCHMARK(BM_DecodeArgsPenMove);
+
+void BM_FindPerKeyKeyPress(benchmark::State& state) {
+    const ValueMap map = {{"code", 0x41}, {"isDown", true}};
+    const ValueMap* args = &map;
+    for (auto _ : state) {
+        auto keyCode = (args->find(Value("code")))->second;
+        auto isDown = (args->find(Value("isDown")))->second;
+        KeyPressArgs key;
+        key.code = std::get<int32_t>(keyCode);
+        key.is_down = std::get<bool>(isDown);
+        benchmark::DoNotOptimize(key);
+    }
+}
+BENCHMARK(BM_FindPerKeyKeyPress);
+
+void BM_DecodeArgsKeyPress(benchmark::State& state) {
+    const ValueMap map = {{"code", 0x41}, {"isDown", true}};
+    for (auto _ : state) {
+        KeyPressArgs key;
+        ArgError error = DecodeVariantMapArgs(&map, &key);
+        benchmark::DoNotOptimize(error);
+        benchmark::DoNotOptimize(key);
+    }
+}
+BENCHMARK(BM_DecodeArgsKeyPress);
+
+}  // namespace
+}  // namespace hardware_simulator
@@ -0,0 +1,85 @@
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "method_dispatch.h"
+
+// Compares the hashed method lookup against the `compare(...) == 0` chain
+// HandleMethodCall used before. At 1-2 kHz input rates the per-call budget is
+// 500 us - 1 ms; these numbers show how much of it dispatch alone consumes.
+
+namespace hardware_simulator {
+namespace {
+
+// Mirrors the order of the old else-if chain, so a name's position is the
+// number of string compares it used to pay.
+std::vector<std::string> ChainOrder() {
+  std::vector<std::string> names;
+  for (const auto& entry : method_dispatch::kMethods) {
+    names.emplace_back(entry.name);
+  }
+  return names;
+}
+
+MethodId CompareChain(const std::vector<std::string>& names, const std::string& method) {
+  for (size_t i = 0; i < names.size(); ++i) {
+    if (method.compare(names[i]) == 0) {
+      return method_dispatch::kMethods[i].id;
+    }
+  }
+  return MethodId::kUnknown;
+}
+
+const char* const kHotMethods[] = {"KeyPress", "mouseMoveR", "touchMove", "penMove"};
+
+void BM_CompareChain(benchmark::State& state) {
+  const auto names = ChainOrder();
+  const std::string method = kHotMethods[state.range(0)];
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(CompareChain(names, method));
+  }
+  state.SetLabel(method);
+}
+BENCHMARK(BM_CompareChain)->DenseRange(0, 3);
+
+void BM_LookupMethod(benchmark::State& state) {
+  const std::string method = kHotMethods[state.range(0)];
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(LookupMethod(method));
+  }
+  state.SetLabel(method);
+}
+BENCHMARK(BM_LookupMethod)->DenseRange(0, 3);
+
+// Linux hands the handler a C string, so include the strlen.
+void BM_StrcmpChain(benchmark::State& state) {
+  const auto names = ChainOrder();
+  const char* method = kHotMethods[state.range(0)];
+  for (auto _ : state) {
+    MethodId id = MethodId::kUnknown;
+    for (size_t i = 0; i < names.size(); ++i) {
+      if (strcmp(method, names[i].c_str()) == 0) {
+        id = method_dispatch::kMethods[i].id;
+        break;
+      }
+    }
+    benchmark::DoNotOptimize(id);
+  }
+  state.SetLabel(method);
+}
+BENCHMARK(BM_StrcmpChain)->DenseRange(0, 3);
+
+void BM_LookupMethodCString(benchmark::State& state) {
+  const char* method = kHotMethods[state.range(0)];
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(method);
+    benchmark::DoNotOptimize(LookupMethod(method));
+  }
+  state.SetLabel(method);
+}
+BENCHMARK(BM_LookupMethodCString)->DenseRange(0, 3);
+
+}  // namespace
+}  // namespace hardware_simulator
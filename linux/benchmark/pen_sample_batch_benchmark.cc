@@ -0,0 +1,83 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "pen_sample_batch.h"
+#include "pen_tilt.h"
+#include "screen_transform.h"
+
+// Compares performPenMove's per-sample math, with libm trigonometry for the
+// tilt of every sample, against converting a whole run at once.
+
+namespace hardware_simulator {
+namespace {
+
+constexpr int32_t kPressureMax = 4095;
+
+const ScreenTransform& Screens() {
+    static const ScreenTransform* screens = [] {
+        ScreenMetrics metrics;
+        metrics.primary_width = 3840;
+        metrics.primary_height = 2160;
+        metrics.virtual_width = 65535;
+        metrics.virtual_height = 65535;
+        return new ScreenTransform(
+            {{0, 0, 3840, 2160, true}, {3840, 0, 5760, 1080, false}}, metrics);
+    }();
+    return *screens;
+}
+
+// A stroke circling the pen around as it goes.
+std::vector<PenSample> Stroke(size_t count) {
+    std::vector<PenSample> samples(count);
+    for (size_t i = 0; i < count; ++i) {
+        samples[i].x = static_cast<double>(i) / count;
+        samples[i].y = 0.5;
+        samples[i].pressure = 0.2f + 0.6f * i / count;
+        samples[i].rotation = static_cast<float>(i * 360 / count);
+        samples[i].tilt = static_cast<float>(i % 60);
+    }
+    return samples;
+}
+
+struct ScalarPenSample {
+    int32_t x, y, pressure;
+    PenTilt tilt;
+};
+
+void BM_PerSamplePenMath(benchmark::State& state) {
+    std::vector<PenSample> samples = Stroke(state.range(0));
+    std::vector<ScalarPenSample> out(samples.size());
+    const ScreenTransform& screens = Screens();
+    for (auto _ : state) {
+        for (size_t i = 0; i < samples.size(); ++i) {
+            const PenSample& sample = samples[i];
+            screens.ToVirtualDesktop(0, sample.x, sample.y, &out[i].x, &out[i].y);
+            out[i].pressure = std::clamp(
+                static_cast<int32_t>(sample.pressure * kPressureMax), 1, kPressureMax);
+            PenTiltFromPolar(sample.rotation, sample.tilt, &out[i].tilt);
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * samples.size());
+}
+BENCHMARK(BM_PerSamplePenMath)->Arg(8)->Arg(64)->Arg(256);
+
+void BM_BatchedPenMath(benchmark::State& state) {
+    std::vector<PenSample> samples = Stroke(state.range(0));
+    ConvertedPenSamples out;
+    const AffineMap& map = *Screens().VirtualDesktopMap(0);
+    for (auto _ : state) {
+        ConvertPenSamples(map, samples.data(), samples.size(), kPressureMax, &out);
+        benchmark::DoNotOptimize(out.tilt_x.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * samples.size());
+}
+BENCHMARK(BM_BatchedPenMath)->Arg(8)->Arg(64)->Arg(256);
+
+}  // namespace
+}  // namespace hardware_simulator
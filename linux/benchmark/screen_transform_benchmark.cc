@@ -0,0 +1,126 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "screen_transform.h"
+
+// Compares the Windows plugin's old per-event coordinate mapping, which
+// copied the monitor list, recomputed the desktop bounds and read the screen
+// metrics for every event, with a lookup in a published ScreenTransform.
+
+namespace hardware_simulator {
+namespace {
+
+struct Rect {
+    int32_t left, top, right, bottom;
+};
+struct Monitor {
+    Rect rect;
+    bool is_primary;
+};
+
+std::vector<Monitor> g_monitors = {
+    {{0, 0, 3840, 2160}, true},
+    {{-1920, 600, 0, 1680}, false},
+    {{3840, -400, 4920, 1520}, false},
+};
+
+// Stands in for GetSystemMetrics: an opaque call the compiler cannot hoist.
+__attribute__((noinline)) int SystemMetric(int index) {
+    static const int metrics[] = {3840, 2160, 6840, 2560};
+    benchmark::ClobberMemory();
+    return metrics[index];
+}
+
+std::vector<Monitor> GetMonitors() { return g_monitors; }
+
+bool LegacyTouchToScreen(int index, double x, double y, int32_t* out_x, int32_t* out_y) {
+    auto monitors = GetMonitors();
+    if (index < 0 || index >= static_cast<int>(monitors.size())) {
+        return false;
+    }
+    Rect bounds = {0, 0, 0, 0};
+    for (const auto& monitor : monitors) {
+        bounds.left = std::min(bounds.left, monitor.rect.left);
+        bounds.top = std::min(bounds.top, monitor.rect.top);
+        bounds.right = std::max(bounds.right, monitor.rect.right);
+        bounds.bottom = std::max(bounds.bottom, monitor.rect.bottom);
+    }
+    const Rect& screen = monitors[index].rect;
+    double global_x = (screen.left - bounds.left + (screen.right - screen.left) * x) /
+                      (bounds.right - bounds.left);
+    double global_y = (screen.top - bounds.top + (screen.bottom - screen.top) * y) /
+                      (bounds.bottom - bounds.top);
+    *out_x = static_cast<int32_t>(global_x * SystemMetric(2));
+    *out_y = static_cast<int32_t>(global_y * SystemMetric(3));
+    return true;
+}
+
+ScreenTransformPublisher& Publisher() {
+    static ScreenTransformPublisher* publisher = [] {
+        auto* p = new ScreenTransformPublisher();
+        std::vector<ScreenRect> screens;
+        for (const auto& monitor : g_monitors) {
+            ScreenRect screen;
+            screen.left = monitor.rect.left;
+            screen.top = monitor.rect.top;
+            screen.right = monitor.rect.right;
+            screen.bottom = monitor.rect.bottom;
+            screen.is_primary = monitor.is_primary;
+            screens.push_back(screen);
+        }
+        ScreenMetrics metrics;
+        metrics.primary_width = SystemMetric(0);
+        metrics.primary_height = SystemMetric(1);
+        metrics.virtual_width = SystemMetric(2);
+        metrics.virtual_height = SystemMetric(3);
+        p->Publish(std::make_shared<const ScreenTransform>(std::move(screens), metrics));
+        return p;
+    }();
+    return *publisher;
+}
+
+void BM_LegacyTouchToScreen(benchmark::State& state) {
+    double x = 0;
+    for (auto _ : state) {
+        int32_t out_x = 0, out_y = 0;
+        LegacyTouchToScreen(2, x, 0.5, &out_x, &out_y);
+        benchmark::DoNotOptimize(out_x);
+        benchmark::DoNotOptimize(out_y);
+        x = x < 1 ? x + 0.001 : 0;
+    }
+}
+BENCHMARK(BM_LegacyTouchToScreen);
+
+void BM_SnapshotTouchToScreen(benchmark::State& state) {
+    ScreenTransformPublisher& publisher = Publisher();
+    double x = 0;
+    for (auto _ : state) {
+        int32_t out_x = 0, out_y = 0;
+        publisher.Current()->ToVirtualDesktop(2, x, 0.5, &out_x, &out_y);
+        benchmark::DoNotOptimize(out_x);
+        benchmark::DoNotOptimize(out_y);
+        x = x < 1 ? x + 0.001 : 0;
+    }
+}
+BENCHMARK(BM_SnapshotTouchToScreen);
+
+// Several injecting threads at once. Every read takes a reference on the
+// same snapshot, so this shows what the shared count costs under contention.
+void BM_SnapshotTouchToScreenContended(benchmark::State& state) {
+    ScreenTransformPublisher& publisher = Publisher();
+    double x = 0;
+    for (auto _ : state) {
+        int32_t out_x = 0, out_y = 0;
+        publisher.Current()->ToVirtualDesktop(1, x, 0.5, &out_x, &out_y);
+        benchmark::DoNotOptimize(out_x);
+        x = x < 1 ? x + 0.001 : 0;
+    }
+}
+BENCHMARK(BM_SnapshotTouchToScreenContended)->Threads(4);
+
+}  // namespace
+}  // namespace hardware_simulator
@@ -0,0 +1,121 @@
+#ifndef FLUTTER_PLUGIN_FL_VALUE_ARGS_H_
+#define FLUTTER_PLUGIN_FL_VALUE_ARGS_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "method_args.h"
+
+namespace hardware_simulator {
+
+// ArgsDecoder reader for the Linux embedding's FlValue. Dart ints always
+// arrive as 64-bit FL_VALUE_TYPE_INT here.
+class FlValueArgReader {
+ public:
+  explicit FlValueArgReader(FlValue* value) : value_(value) {}
+
+  ArgErrorCode Read(bool* out) const {
+    if (fl_value_get_type(value_) != FL_VALUE_TYPE_BOOL) {
+      return ArgErrorCode::kWrongType;
+    }
+    *out = fl_value_get_bool(value_);
+    return ArgErrorCode::kOk;
+  }
+
+  ArgErrorCode Read(int32_t* out) const {
+    int64_t wide;
+    ArgErrorCode code = Read(&wide);
+    if (code != ArgErrorCode::kOk) {
+      return code;
+    }
+    if (wide < std::numeric_limits<int32_t>::min() ||
+        wide > std::numeric_limits<int32_t>::max()) {
+      return ArgErrorCode::kOutOfRange;
+    }
+    *out = static_cast<int32_t>(wide);
+    return ArgErrorCode::kOk;
+  }
+
+  ArgErrorCode Read(int64_t* out) const {
+    if (fl_value_get_type(value_) != FL_VALUE_TYPE_INT) {
+      return ArgErrorCode::kWrongType;
+    }
+    *out = fl_value_get_int(value_);
+    return ArgErrorCode::kOk;
+  }
+
+  ArgErrorCode Read(double* out) const {
+    switch (fl_value_get_type(value_)) {
+      case FL_VALUE_TYPE_FLOAT:
+        *out = fl_value_get_float(value_);
+        return ArgErrorCode::kOk;
+      case FL_VALUE_TYPE_INT:
+        *out = static_cast<double>(fl_value_get_int(value_));
+        return ArgErrorCode::kOk;
+      default:
+        return ArgErrorCode::kWrongType;
+    }
+  }
+
+  ArgErrorCode Read(std::string* out) const {
+    if (fl_value_get_type(value_) != FL_VALUE_TYPE_STRING) {
+      return ArgErrorCode::kWrongType;
+    }
+    *out = fl_value_get_string(value_);
+    return ArgErrorCode::kOk;
+  }
+
+  ArgErrorCode Read(std::vector<int32_t>* out) const {
+    if (fl_value_get_type(value_) != FL_VALUE_TYPE_INT32_LIST) {
+      return ArgErrorCode::kWrongType;
+    }
+    const int32_t* values = fl_value_get_int32_list(value_);
+    out->assign(values, values + fl_value_get_length(value_));
+    return ArgErrorCode::kOk;
+  }
+
+  ArgErrorCode Read(std::vector<double>* out) const {
+    if (fl_value_get_type(value_) != FL_VALUE_TYPE_FLOAT_LIST) {
+      return ArgErrorCode::kWrongType;
+    }
+    const double* values = fl_value_get_float_list(value_);
+    out->assign(values, values + fl_value_get_length(value_));
+    return ArgErrorCode::kOk;
+  }
+
+ private:
+  FlValue* value_;
+};
+
+// Decodes the method call argument map |args| in one pass.
+template <typename Args>
+ArgError DecodeFlValueArgs(FlValue* args, Args* out) {
+  if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return {ArgErrorCode::kNotAMap, {}};
+  }
+  ArgsDecoder<Args> decoder(out);
+  size_t length = fl_value_get_length(args);
+  for (size_t i = 0; i < length; ++i) {
+    FlValue* key = fl_value_get_map_key(args, i);
+    if (fl_value_get_type(key) == FL_VALUE_TYPE_STRING &&
+        !decoder.Visit(fl_value_get_string(key),
+                       FlValueArgReader(fl_value_get_map_value(args, i)))) {
+      break;
+    }
+  }
+  return decoder.Finish();
+}
+
+// Error response for a failed decode, matching the Windows plugin's codes.
+inline FlMethodResponse* ArgErrorResponse(const ArgError& error) {
+  return FL_METHOD_RESPONSE(fl_method_error_response_new(
+      ArgErrorCodeName(error.code), error.Message().c_str(), nullptr));
+}
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_FL_VALUE_ARGS_H_
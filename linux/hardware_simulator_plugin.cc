@@ -1,23 +1,510 @@
 #include "include/hardware_simulator/hardware_simulator_plugin.h"
 
 #include <flutter_linux/flutter_linux.h>
+#include <gdk/gdkx.h>
 #include <gtk/gtk.h>
 #include <sys/utsname.h>
 
-#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <utility>
+#include <vector>
 
+#include "fl_value_args.h"
+#include "gesture.h"
 #include "hardware_simulator_plugin_private.h"
+#include "input_batch.h"
+#include "input_ring_ffi.h"
+#include "input_sink.h"
+#include "input_smoothing.h"
+#include "keyboard_grab.h"
+#include "locked_input_sink.h"
+#include "method_dispatch.h"
+#include "method_schema.h"
+#include "screen_transform.h"
+#include "shortcut_policy.h"
+#include "text_input.h"
+#include "uinput_input_sink.h"
+#include "uinput_text_sink.h"
 
 #define HARDWARE_SIMULATOR_PLUGIN(obj) \
   (G_TYPE_CHECK_INSTANCE_CAST((obj), hardware_simulator_plugin_get_type(), \
                               HardwareSimulatorPlugin))
 
+// A performGesture call, answered once its gesture has played.
+struct GestureRun {
+  hardware_simulator::GesturePlayer player;
+  FlMethodCall* method_call;
+  // g_get_monotonic_time() of the first frame, 0 before it.
+  gint64 start_time = 0;
+};
+
+// A typeText call, answered once its last batch is typed.
+struct TextRun {
+  std::vector<hardware_simulator::TypedKey> keys;
+  hardware_simulator::TextPacing pacing;
+  size_t typed = 0;
+  FlMethodCall* method_call;
+};
+
 struct _HardwareSimulatorPlugin {
   GObject parent_instance;
+
+  FlPluginRegistrar* registrar;
+  // Weak: the channel's handler holds the plugin, so a strong ref back would
+  // keep both alive after the engine goes away. Null once the channel is.
+  FlMethodChannel* channel;
+
+  // Immersive mode: the grab and the window whose events feed it, both null
+  // while it is off.
+  hardware_simulator::KeyboardGrab* keyboard_grab;
+  GdkWindow* grab_window;
+  // What the next and the current grab capture.
+  std::vector<hardware_simulator::ShortcutRule>* shortcut_rules;
+
+  // The monitor layout absolute positions are mapped against.
+  hardware_simulator::ScreenTransformPublisher* screens;
+  // The virtual input devices, created at registration or, failing that, on
+  // first use.
+  hardware_simulator::UinputInputSink* input_sink;
+  // In front of them: the input ring feeds them from its own thread.
+  hardware_simulator::LockedInputSink* locked_sink;
+  // In front of that for client input: smooths pen and touch positions when
+  // enabled.
+  hardware_simulator::SmoothingInputSink* smoothing_sink;
+  // performGesture calls in order of arrival. The front one is playing,
+  // frame by frame from GLib timeouts on the platform thread, where all other
+  // input is injected too.
+  std::deque<GestureRun>* gestures;
+  guint gesture_source;
+  // Types text on the virtual keyboard, under the locked sink's lock.
+  hardware_simulator::LockedKeyboardWriter* text_writer;
+  hardware_simulator::UinputTextSink* text_sink;
+  // typeText calls in order of arrival, typed batch by batch from GLib
+  // timeouts like gestures.
+  std::deque<TextRun>* texts;
+  guint text_source;
 };
 
 G_DEFINE_TYPE(HardwareSimulatorPlugin, hardware_simulator_plugin, g_object_get_type())
 
+// Reports a captured key as the Windows plugin does.
+static void on_key_blocked(HardwareSimulatorPlugin* self, uint8_t vk,
+                           bool is_down) {
+  if (self->channel == nullptr) {
+    return;
+  }
+  g_autoptr(FlValue) message = fl_value_new_map();
+  fl_value_set_string_take(message, "keyCode", fl_value_new_int(vk));
+  fl_value_set_string_take(message, "isDown", fl_value_new_bool(is_down));
+  fl_method_channel_invoke_method(self->channel, "onKeyBlocked", message,
+                                  nullptr, nullptr, nullptr);
+}
+
+// Runs before GDK translates the event, so a captured key never reaches the
+// view.
+static GdkFilterReturn keyboard_grab_filter(GdkXEvent* xevent, GdkEvent* event,
+                                            gpointer user_data) {
+  HardwareSimulatorPlugin* self = HARDWARE_SIMULATOR_PLUGIN(user_data);
+  return self->keyboard_grab->FilterEvent(static_cast<XEvent*>(xevent))
+             ? GDK_FILTER_REMOVE
+             : GDK_FILTER_CONTINUE;
+}
+
+static void stop_keyboard_grab(HardwareSimulatorPlugin* self) {
+  if (self->keyboard_grab == nullptr) {
+    return;
+  }
+  gdk_window_remove_filter(self->grab_window, keyboard_grab_filter, self);
+  // Reports the ups of captured keys still held.
+  delete self->keyboard_grab;
+  self->keyboard_grab = nullptr;
+  g_clear_object(&self->grab_window);
+}
+
+// Returns whether immersive mode is now as requested. It needs X11: Wayland
+// compositors do not let clients grab the keyboard.
+static bool set_immersive_mode(HardwareSimulatorPlugin* self, bool enabled) {
+  if (!enabled) {
+    stop_keyboard_grab(self);
+    return true;
+  }
+  if (self->keyboard_grab != nullptr) {
+    return true;
+  }
+  FlView* view = fl_plugin_registrar_get_view(self->registrar);
+  if (view == nullptr) {
+    return false;
+  }
+  GdkWindow* window = gtk_widget_get_window(gtk_widget_get_toplevel(GTK_WIDGET(view)));
+  if (window == nullptr || !GDK_IS_X11_WINDOW(window)) {
+    return false;
+  }
+
+  self->keyboard_grab = new hardware_simulator::KeyboardGrab(
+      GDK_WINDOW_XDISPLAY(window), GDK_WINDOW_XID(window),
+      [self](uint8_t vk, bool is_down) { on_key_blocked(self, vk, is_down); });
+  self->keyboard_grab->policy().SetRules(*self->shortcut_rules);
+  self->grab_window = GDK_WINDOW(g_object_ref(window));
+  gdk_window_add_filter(window, keyboard_grab_filter, self);
+  self->keyboard_grab->Enable();
+  return true;
+}
+
+FlMethodResponse* put_immersive_mode_enabled(HardwareSimulatorPlugin* self,
+                                             FlValue* args) {
+  hardware_simulator::EnabledArgs immersive;
+  hardware_simulator::ArgError error = hardware_simulator::DecodeFlValueArgs(args, &immersive);
+  if (!error.ok()) {
+    return hardware_simulator::ArgErrorResponse(error);
+  }
+  g_autoptr(FlValue) result = fl_value_new_bool(set_immersive_mode(self, immersive.enabled));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+FlMethodResponse* set_shortcut_capture_policy(HardwareSimulatorPlugin* self,
+                                              FlValue* args) {
+  hardware_simulator::ShortcutCaptureArgs capture;
+  hardware_simulator::ArgError error = hardware_simulator::DecodeFlValueArgs(args, &capture);
+  if (!error.ok()) {
+    return hardware_simulator::ArgErrorResponse(error);
+  }
+  std::vector<hardware_simulator::ShortcutRule> rules = hardware_simulator::DefaultShortcutRules();
+  if (!capture.use_defaults && !hardware_simulator::DecodeShortcutRules(capture.rules, &rules)) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "InvalidShortcutRule",
+        "rules must be (key, modifiers) pairs with keys in 1..255 and known modifier bits",
+        nullptr));
+  }
+  if (self->keyboard_grab != nullptr) {
+    self->keyboard_grab->policy().SetRules(rules);
+  }
+  *self->shortcut_rules = std::move(rules);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+// Screen ids index GDK's monitors, in device pixels.
+static void publish_screen_layout(HardwareSimulatorPlugin* self,
+                                  GdkScreen* screen) {
+  GdkDisplay* display = gdk_screen_get_display(screen);
+  std::vector<hardware_simulator::ScreenRect> screens;
+  int count = gdk_display_get_n_monitors(display);
+  for (int i = 0; i < count; ++i) {
+    GdkMonitor* monitor = gdk_display_get_monitor(display, i);
+    GdkRectangle geometry;
+    gdk_monitor_get_geometry(monitor, &geometry);
+    int scale = gdk_monitor_get_scale_factor(monitor);
+    hardware_simulator::ScreenRect rect;
+    rect.left = geometry.x * scale;
+    rect.top = geometry.y * scale;
+    rect.right = (geometry.x + geometry.width) * scale;
+    rect.bottom = (geometry.y + geometry.height) * scale;
+    rect.is_primary = gdk_monitor_is_primary(monitor);
+    screens.push_back(rect);
+  }
+  self->screens->Publish(
+      hardware_simulator::MakeUinputScreenTransform(std::move(screens)));
+}
+
+static void monitors_changed_cb(GdkScreen* screen, gpointer user_data) {
+  publish_screen_layout(HARDWARE_SIMULATOR_PLUGIN(user_data), screen);
+}
+
+// Finds |keysym| on group 0 of the active layout, at its lowest level.
+static bool lookup_keysym(uint32_t keysym,
+                          hardware_simulator::KeyPosition* position) {
+  GdkKeymap* keymap = gdk_keymap_get_for_display(gdk_display_get_default());
+  GdkKeymapKey* keys = nullptr;
+  gint count = 0;
+  if (keymap == nullptr ||
+      !gdk_keymap_get_entries_for_keyval(keymap, keysym, &keys, &count)) {
+    return false;
+  }
+  const GdkKeymapKey* best = nullptr;
+  for (gint i = 0; i < count; ++i) {
+    // X keycodes are evdev codes plus 8. Levels above AltGr+Shift need
+    // modifiers the virtual keyboard doesn't model.
+    if (keys[i].group != 0 || keys[i].level > 3 || keys[i].keycode < 8) {
+      continue;
+    }
+    if (best == nullptr || keys[i].level < best->level) {
+      best = &keys[i];
+    }
+  }
+  if (best != nullptr) {
+    position->evdev = static_cast<uint16_t>(best->keycode - 8);
+    position->shift = (best->level & 1) != 0;
+    position->alt_gr = (best->level & 2) != 0;
+  }
+  g_free(keys);
+  return best != nullptr;
+}
+
+// Null when the devices can't be created, usually for lack of write access
+// to /dev/uinput.
+static hardware_simulator::InputSink* get_input_sink(
+    HardwareSimulatorPlugin* self) {
+  if (self->input_sink != nullptr) {
+    return self->smoothing_sink;
+  }
+  self->input_sink = hardware_simulator::UinputInputSink::Create(*self->screens).release();
+  if (self->input_sink == nullptr) {
+    return nullptr;
+  }
+  self->locked_sink = new hardware_simulator::LockedInputSink(*self->input_sink);
+  self->smoothing_sink = new hardware_simulator::SmoothingInputSink(*self->locked_sink);
+  self->text_writer = new hardware_simulator::LockedKeyboardWriter(
+      *self->input_sink, *self->locked_sink);
+  self->text_sink = new hardware_simulator::UinputTextSink(*self->text_writer,
+                                                           lookup_keysym);
+  // Rings opened by lib/input_ring.dart drain on their own thread.
+  hardware_simulator::SetInputRingSink(self->smoothing_sink);
+  GdkScreen* screen = gdk_screen_get_default();
+  if (screen != nullptr) {
+    publish_screen_layout(self, screen);
+    g_signal_connect_object(screen, "monitors-changed",
+                            G_CALLBACK(monitors_changed_cb), self,
+                            static_cast<GConnectFlags>(0));
+  }
+  return self->smoothing_sink;
+}
+
+static FlMethodResponse* input_unavailable_response() {
+  return FL_METHOD_RESPONSE(fl_method_error_response_new(
+      "InputUnavailable",
+      "Can't create virtual input devices; /dev/uinput must be writable",
+      nullptr));
+}
+
+// Decodes |args| and has |inject| apply them to the virtual devices.
+template <typename Args, typename Inject>
+static FlMethodResponse* inject_input(HardwareSimulatorPlugin* self,
+                                      FlValue* args, Inject inject) {
+  Args decoded;
+  hardware_simulator::ArgError error = hardware_simulator::DecodeFlValueArgs(args, &decoded);
+  if (!error.ok()) {
+    return hardware_simulator::ArgErrorResponse(error);
+  }
+  hardware_simulator::InputSink* sink = get_input_sink(self);
+  if (sink == nullptr) {
+    return input_unavailable_response();
+  }
+  inject(*sink, decoded);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+static FlMethodResponse* set_input_smoothing(HardwareSimulatorPlugin* self,
+                                            FlValue* args) {
+  hardware_simulator::SetInputSmoothingArgs smoothing;
+  hardware_simulator::ArgError error = hardware_simulator::DecodeFlValueArgs(args, &smoothing);
+  if (!error.ok()) {
+    return hardware_simulator::ArgErrorResponse(error);
+  }
+  hardware_simulator::SmoothedDevice device;
+  hardware_simulator::OneEuroParams params;
+  if (!hardware_simulator::MakeSmoothingParams(smoothing, &device, &params)) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "InvalidSmoothing",
+        "device must be pen or touch, cutoffs positive and beta not negative",
+        nullptr));
+  }
+  if (get_input_sink(self) == nullptr) {
+    return input_unavailable_response();
+  }
+  if (smoothing.enabled) {
+    self->smoothing_sink->Enable(device, params);
+  } else {
+    self->smoothing_sink->Disable(device);
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+static gboolean gesture_frame_cb(gpointer user_data);
+
+// Replies to the front gesture with how many frames it injected.
+static void finish_gesture(HardwareSimulatorPlugin* self) {
+  GestureRun& run = self->gestures->front();
+  g_autoptr(FlValue) result =
+      fl_value_new_int(static_cast<int64_t>(run.player.frames_injected()));
+  g_autoptr(FlMethodResponse) response =
+      FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  fl_method_call_respond(run.method_call, response, nullptr);
+  g_object_unref(run.method_call);
+  self->gestures->pop_front();
+}
+
+// Plays the front gesture up to now and arms a timeout for its next frame.
+// Each deadline is counted from the gesture's start, so a late wakeup skips
+// frames instead of stretching the gesture. A finished gesture hands over to
+// the next one at once.
+static void play_gestures(HardwareSimulatorPlugin* self) {
+  while (!self->gestures->empty()) {
+    GestureRun& run = self->gestures->front();
+    gint64 now = g_get_monotonic_time();
+    if (run.start_time == 0) {
+      run.start_time = now;
+    }
+    if (run.player.Advance(std::chrono::microseconds(now - run.start_time),
+                           *self->smoothing_sink)) {
+      gint64 delay = run.start_time + run.player.NextFrameTime().count() - now;
+      // Rounded up, since waking early would find nothing due.
+      guint delay_ms = delay > 0 ? static_cast<guint>((delay + 999) / 1000) : 0;
+      self->gesture_source = g_timeout_add(delay_ms, gesture_frame_cb, self);
+      return;
+    }
+    finish_gesture(self);
+  }
+}
+
+static gboolean gesture_frame_cb(gpointer user_data) {
+  HardwareSimulatorPlugin* self = HARDWARE_SIMULATOR_PLUGIN(user_data);
+  self->gesture_source = 0;
+  play_gestures(self);
+  return G_SOURCE_REMOVE;
+}
+
+// Queues the gesture behind any still playing. Returns null once queued: the
+// call is answered when the gesture ends.
+static FlMethodResponse* perform_gesture(HardwareSimulatorPlugin* self,
+                                         FlMethodCall* method_call) {
+  hardware_simulator::PerformGestureArgs gesture;
+  hardware_simulator::ArgError error = hardware_simulator::DecodeFlValueArgs(
+      fl_method_call_get_args(method_call), &gesture);
+  if (!error.ok()) {
+    return hardware_simulator::ArgErrorResponse(error);
+  }
+  hardware_simulator::GestureSpec spec;
+  if (!hardware_simulator::MakeGestureSpec(gesture, &spec)) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "InvalidGesture", "type must be pinch, swipe, drag or longPress",
+        nullptr));
+  }
+  if (get_input_sink(self) == nullptr) {
+    return input_unavailable_response();
+  }
+  self->gestures->push_back(
+      GestureRun{hardware_simulator::GesturePlayer(spec),
+                 FL_METHOD_CALL(g_object_ref(method_call))});
+  if (self->gestures->size() == 1) {
+    play_gestures(self);
+  }
+  return nullptr;
+}
+
+// Lifts the contacts of the playing gesture and drops the queue unanswered.
+static void cancel_gestures(HardwareSimulatorPlugin* self) {
+  if (self->gesture_source != 0) {
+    g_source_remove(self->gesture_source);
+    self->gesture_source = 0;
+  }
+  for (GestureRun& run : *self->gestures) {
+    if (self->smoothing_sink != nullptr) {
+      run.player.Cancel(*self->smoothing_sink);
+    }
+    g_object_unref(run.method_call);
+  }
+  self->gestures->clear();
+}
+
+static gboolean text_batch_cb(gpointer user_data);
+
+// Replies to the front typeText call with how many keys it typed.
+static void finish_text(HardwareSimulatorPlugin* self) {
+  TextRun& run = self->texts->front();
+  g_autoptr(FlValue) result = fl_value_new_int(static_cast<int64_t>(run.typed));
+  g_autoptr(FlMethodResponse) response =
+      FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  fl_method_call_respond(run.method_call, response, nullptr);
+  g_object_unref(run.method_call);
+  self->texts->pop_front();
+}
+
+// Types the front text's next batch and arms a timeout for the one after.
+// A finished text hands over to the next one at once.
+static void type_texts(HardwareSimulatorPlugin* self) {
+  while (!self->texts->empty()) {
+    TextRun& run = self->texts->front();
+    if (run.typed < run.keys.size() &&
+        hardware_simulator::TypeNextBatch(run.keys, run.pacing,
+                                          *self->text_sink, &run.typed) &&
+        run.typed < run.keys.size()) {
+      auto interval = std::chrono::duration_cast<std::chrono::milliseconds>(
+          run.pacing.batch_interval);
+      self->text_source = g_timeout_add(static_cast<guint>(interval.count()),
+                                        text_batch_cb, self);
+      return;
+    }
+    finish_text(self);
+  }
+}
+
+static gboolean text_batch_cb(gpointer user_data) {
+  HardwareSimulatorPlugin* self = HARDWARE_SIMULATOR_PLUGIN(user_data);
+  self->text_source = 0;
+  type_texts(self);
+  return G_SOURCE_REMOVE;
+}
+
+// Queues the text behind any still being typed. Returns null once queued:
+// the call is answered when the text is typed.
+static FlMethodResponse* type_text(HardwareSimulatorPlugin* self,
+                                   FlMethodCall* method_call) {
+  hardware_simulator::TypeTextArgs text;
+  hardware_simulator::ArgError error = hardware_simulator::DecodeFlValueArgs(
+      fl_method_call_get_args(method_call), &text);
+  if (!error.ok()) {
+    return hardware_simulator::ArgErrorResponse(error);
+  }
+  if (get_input_sink(self) == nullptr) {
+    return input_unavailable_response();
+  }
+  TextRun run;
+  hardware_simulator::DecodeTypedText(text.text.data(), text.text.size(),
+                                      &run.keys);
+  run.pacing.keys_per_batch =
+      text.keys_per_batch > 0 ? static_cast<size_t>(text.keys_per_batch) : 0;
+  run.pacing.batch_interval =
+      std::chrono::milliseconds(std::max(text.batch_interval_ms, 0));
+  run.method_call = FL_METHOD_CALL(g_object_ref(method_call));
+  self->texts->push_back(std::move(run));
+  if (self->texts->size() == 1) {
+    type_texts(self);
+  }
+  return nullptr;
+}
+
+// Drops the queued texts unanswered. Every batch releases what it presses,
+// so there is nothing to lift.
+static void cancel_texts(HardwareSimulatorPlugin* self) {
+  if (self->text_source != 0) {
+    g_source_remove(self->text_source);
+    self->text_source = 0;
+  }
+  for (TextRun& run : *self->texts) {
+    g_object_unref(run.method_call);
+  }
+  self->texts->clear();
+}
+
+// Batched input events arrive as raw bytes and are decoded in place. Pen
+// move runs reach the devices as one batch and touch updates as frames.
+static void input_batch_cb(FlBinaryMessenger* messenger, const gchar* channel,
+                           GBytes* message,
+                           FlBinaryMessengerResponseHandle* response_handle,
+                           gpointer user_data) {
+  HardwareSimulatorPlugin* self = HARDWARE_SIMULATOR_PLUGIN(user_data);
+  hardware_simulator::InputSink* sink = get_input_sink(self);
+  if (sink != nullptr && message != nullptr) {
+    gsize size = 0;
+    const uint8_t* data =
+        static_cast<const uint8_t*>(g_bytes_get_data(message, &size));
+    hardware_simulator::DecodeInputBatch(data, size, *sink);
+  }
+  fl_binary_messenger_send_response(messenger, response_handle, nullptr,
+                                    nullptr);
+}
+
 // Called when a method call is received from Flutter.
 static void hardware_simulator_plugin_handle_method_call(
     HardwareSimulatorPlugin* self,
@@ -25,14 +512,107 @@ static void hardware_simulator_plugin_handle_method_call(
   g_autoptr(FlMethodResponse) response = nullptr;
 
   const gchar* method = fl_method_call_get_name(method_call);
+  FlValue* args = fl_method_call_get_args(method_call);
 
-  if (strcmp(method, "getPlatformVersion") == 0) {
-    response = get_platform_version();
-  } else {
-    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  switch (hardware_simulator::LookupMethod(method)) {
+    case hardware_simulator::MethodId::kGetPlatformVersion:
+      response = get_platform_version();
+      break;
+    case hardware_simulator::MethodId::kKeyPress:
+      response = inject_input<hardware_simulator::KeyPressArgs>(
+          self, args,
+          [](hardware_simulator::InputSink& sink, const hardware_simulator::KeyPressArgs& key) {
+            sink.KeyEvent(static_cast<uint16_t>(key.code), key.is_down);
+          });
+      break;
+    case hardware_simulator::MethodId::kMouseMoveR:
+      response = inject_input<hardware_simulator::MouseXYArgs>(
+          self, args,
+          [](hardware_simulator::InputSink& sink, const hardware_simulator::MouseXYArgs& delta) {
+            sink.MouseMoveRelative(delta.x, delta.y);
+          });
+      break;
+    case hardware_simulator::MethodId::kMouseMoveA:
+      response = inject_input<hardware_simulator::MouseMoveAArgs>(
+          self, args,
+          [](hardware_simulator::InputSink& sink,
+             const hardware_simulator::MouseMoveAArgs& position) {
+            sink.MouseMoveAbsolute(position.x, position.y, position.screen_id);
+          });
+      break;
+    case hardware_simulator::MethodId::kMousePress:
+      response = inject_input<hardware_simulator::MousePressArgs>(
+          self, args,
+          [](hardware_simulator::InputSink& sink,
+             const hardware_simulator::MousePressArgs& button) {
+            sink.MouseButton(button.button_id, button.is_down);
+          });
+      break;
+    case hardware_simulator::MethodId::kMouseScroll:
+      response = inject_input<hardware_simulator::MouseScrollArgs>(
+          self, args,
+          [](hardware_simulator::InputSink& sink,
+             const hardware_simulator::MouseScrollArgs& scroll) {
+            sink.MouseScroll(scroll.dx, scroll.dy);
+          });
+      break;
+    case hardware_simulator::MethodId::kTouchEvent:
+      response = inject_input<hardware_simulator::TouchEventArgs>(
+          self, args,
+          [](hardware_simulator::InputSink& sink,
+             const hardware_simulator::TouchEventArgs& touch) {
+            sink.TouchEvent(touch.screen_id, touch.x, touch.y,
+                            static_cast<uint32_t>(touch.touch_id), touch.is_down);
+          });
+      break;
+    case hardware_simulator::MethodId::kTouchMove:
+      response = inject_input<hardware_simulator::TouchMoveArgs>(
+          self, args,
+          [](hardware_simulator::InputSink& sink,
+             const hardware_simulator::TouchMoveArgs& touch) {
+            sink.TouchMove(touch.screen_id, touch.x, touch.y,
+                           static_cast<uint32_t>(touch.touch_id));
+          });
+      break;
+    case hardware_simulator::MethodId::kPenEvent:
+      response = inject_input<hardware_simulator::PenEventArgs>(
+          self, args,
+          [](hardware_simulator::InputSink& sink, const hardware_simulator::PenEventArgs& pen) {
+            sink.PenEvent(pen.screen_id, pen.x, pen.y, pen.is_down, pen.has_button,
+                          pen.pressure, pen.rotation, pen.tilt);
+          });
+      break;
+    case hardware_simulator::MethodId::kPenMove:
+      response = inject_input<hardware_simulator::PenMoveArgs>(
+          self, args,
+          [](hardware_simulator::InputSink& sink, const hardware_simulator::PenMoveArgs& pen) {
+            sink.PenMove(pen.screen_id, pen.x, pen.y, pen.has_button, pen.pressure,
+                         pen.rotation, pen.tilt);
+          });
+      break;
+    case hardware_simulator::MethodId::kTypeText:
+      response = type_text(self, method_call);
+      break;
+    case hardware_simulator::MethodId::kPerformGesture:
+      response = perform_gesture(self, method_call);
+      break;
+    case hardware_simulator::MethodId::kSetInputSmoothing:
+      response = set_input_smoothing(self, args);
+      break;
+    case hardware_simulator::MethodId::kPutImmersiveModeEnabled:
+      response = put_immersive_mode_enabled(self, args);
+      break;
+    case hardware_simulator::MethodId::kSetShortcutCapturePolicy:
+      response = set_shortcut_capture_policy(self, args);
+      break;
+    default:
+      response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+      break;
   }
 
-  fl_method_call_respond(method_call, response, nullptr);
+  if (response != nullptr) {
+    fl_method_call_respond(method_call, response, nullptr);
+  }
 }
 
 FlMethodResponse* get_platform_version() {
@@ -44,6 +624,51 @@ FlMethodResponse* get_platform_version() {
 }
 
 static void hardware_simulator_plugin_dispose(GObject* object) {
+  HardwareSimulatorPlugin* self = HARDWARE_SIMULATOR_PLUGIN(object);
+  stop_keyboard_grab(self);
+  delete self->shortcut_rules;
+  self->shortcut_rules = nullptr;
+  if (self->input_sink != nullptr && gdk_screen_get_default() != nullptr) {
+    g_signal_handlers_disconnect_by_data(gdk_screen_get_default(), self);
+  }
+  if (self->registrar != nullptr) {
+    fl_binary_messenger_set_message_handler_on_channel(
+        fl_plugin_registrar_get_messenger(self->registrar),
+        hardware_simulator::kInputBatchChannel, nullptr, nullptr, nullptr);
+  }
+  if (self->gestures != nullptr) {
+    cancel_gestures(self);
+    delete self->gestures;
+    self->gestures = nullptr;
+  }
+  if (self->texts != nullptr) {
+    cancel_texts(self);
+    delete self->texts;
+    self->texts = nullptr;
+  }
+  if (self->input_sink != nullptr) {
+    hardware_simulator::SetInputRingSink(nullptr);
+  }
+  delete self->text_sink;
+  self->text_sink = nullptr;
+  delete self->text_writer;
+  self->text_writer = nullptr;
+  delete self->smoothing_sink;
+  self->smoothing_sink = nullptr;
+  delete self->locked_sink;
+  self->locked_sink = nullptr;
+  // Destroying the devices releases whatever they hold.
+  delete self->input_sink;
+  self->input_sink = nullptr;
+  delete self->screens;
+  self->screens = nullptr;
+  if (self->channel != nullptr) {
+    g_object_remove_weak_pointer(G_OBJECT(self->channel),
+                                 reinterpret_cast<gpointer*>(&self->channel));
+    self->channel = nullptr;
+  }
+  g_clear_object(&self->registrar);
+
   G_OBJECT_CLASS(hardware_simulator_plugin_parent_class)->dispose(object);
 }
 
@@ -51,7 +676,13 @@ static void hardware_simulator_plugin_class_init(HardwareSimulatorPluginClass* k
   G_OBJECT_CLASS(klass)->dispose = hardware_simulator_plugin_dispose;
 }
 
-static void hardware_simulator_plugin_init(HardwareSimulatorPlugin* self) {}
+static void hardware_simulator_plugin_init(HardwareSimulatorPlugin* self) {
+  self->shortcut_rules = new std::vector<hardware_simulator::ShortcutRule>(
+      hardware_simulator::DefaultShortcutRules());
+  self->screens = new hardware_simulator::ScreenTransformPublisher();
+  self->gestures = new std::deque<GestureRun>();
+  self->texts = new std::deque<TextRun>();
+}
 
 static void method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
                            gpointer user_data) {
@@ -62,12 +693,23 @@ static void method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
 void hardware_simulator_plugin_register_with_registrar(FlPluginRegistrar* registrar) {
   HardwareSimulatorPlugin* plugin = HARDWARE_SIMULATOR_PLUGIN(
       g_object_new(hardware_simulator_plugin_get_type(), nullptr));
+  plugin->registrar = FL_PLUGIN_REGISTRAR(g_object_ref(registrar));
 
   g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
   g_autoptr(FlMethodChannel) channel =
       fl_method_channel_new(fl_plugin_registrar_get_messenger(registrar),
                             "hardware_simulator",
                             FL_METHOD_CODEC(codec));
+  plugin->channel = channel;
+  g_object_add_weak_pointer(G_OBJECT(channel),
+                            reinterpret_cast<gpointer*>(&plugin->channel));
+  // The plugin removes the handler when it goes away, so it needs no ref.
+  fl_binary_messenger_set_message_handler_on_channel(
+      fl_plugin_registrar_get_messenger(registrar),
+      hardware_simulator::kInputBatchChannel, input_batch_cb, plugin, nullptr);
+  // Created now rather than on first use so input rings can open; calls
+  // retry if this fails.
+  get_input_sink(plugin);
   fl_method_channel_set_method_call_handler(channel, method_call_cb,
                                             g_object_ref(plugin),
                                             g_object_unref);
@@ -8,3 +8,11 @@
 
 // Handles the getPlatformVersion method call.
 FlMethodResponse *get_platform_version();
+
+// Handles the putImmersiveModeEnabled method call.
+FlMethodResponse *put_immersive_mode_enabled(HardwareSimulatorPlugin *self,
+                                             FlValue *args);
+
+// Handles the setShortcutCapturePolicy method call.
+FlMethodResponse *set_shortcut_capture_policy(HardwareSimulatorPlugin *self,
+                                              FlValue *args);
@@ -0,0 +1,182 @@
+#include "keyboard_grab.h"
+
+#include <X11/XKBlib.h>
+#include <X11/extensions/XInput2.h>
+
+#include <utility>
+
+#include "key_codes.h"
+
+namespace hardware_simulator {
+
+KeyboardGrab::KeyboardGrab(Display* display, Window window,
+                           BlockedKeyCallback callback)
+    : display_(display), window_(window), callback_(std::move(callback)) {
+  int event_base;
+  int error_base;
+  if (!XQueryExtension(display_, "XInputExtension", &xi_opcode_, &event_base,
+                       &error_base)) {
+    xi_opcode_ = -1;
+  }
+}
+
+KeyboardGrab::~KeyboardGrab() { Disable(); }
+
+void KeyboardGrab::Enable() {
+  if (enabled_) {
+    return;
+  }
+  enabled_ = true;
+
+  // Add to the window's event mask rather than replace it; GDK owns it.
+  XWindowAttributes attributes;
+  if (XGetWindowAttributes(display_, window_, &attributes)) {
+    XSelectInput(display_, window_,
+                 attributes.your_event_mask | FocusChangeMask | KeyPressMask |
+                     KeyReleaseMask);
+  }
+  // Held keys then repeat as presses alone, which the policy keeps blocked,
+  // rather than as release/press pairs.
+  XkbSetDetectableAutoRepeat(display_, True, nullptr);
+
+  if (HasFocus()) {
+    TryGrab();
+  }
+}
+
+void KeyboardGrab::Disable() {
+  if (!enabled_) {
+    return;
+  }
+  enabled_ = false;
+  Ungrab();
+}
+
+bool KeyboardGrab::FilterEvent(XEvent* event) {
+  switch (event->type) {
+    case FocusIn:
+    case FocusOut:
+      OnFocusChange(event->type == FocusIn, event->xfocus.mode,
+                    event->xfocus.detail);
+      return false;
+    case KeyPress:
+    case KeyRelease:
+      return OnKeycode(event->xkey.keycode, event->type == KeyPress);
+    case GenericEvent:
+      break;
+    default:
+      return false;
+  }
+
+  XGenericEventCookie& cookie = event->xcookie;
+  if (cookie.extension != xi_opcode_ || cookie.data == nullptr) {
+    return false;
+  }
+  switch (cookie.evtype) {
+    case XI_FocusIn:
+    case XI_FocusOut: {
+      const auto* focus = static_cast<const XIFocusInEvent*>(cookie.data);
+      OnFocusChange(cookie.evtype == XI_FocusIn, focus->mode, focus->detail);
+      return false;
+    }
+    case XI_KeyPress:
+    case XI_KeyRelease: {
+      const auto* key = static_cast<const XIDeviceEvent*>(cookie.data);
+      return OnKeycode(static_cast<unsigned int>(key->detail),
+                       cookie.evtype == XI_KeyPress);
+    }
+    default:
+      return false;
+  }
+}
+
+void KeyboardGrab::OnFocusChange(bool focus_in, int mode, int detail) {
+  // NotifyGrab and NotifyUngrab come from grabs, ours included. Focus moving
+  // while we hold the grab arrives as NotifyWhileGrabbed.
+  if (mode == NotifyGrab || mode == NotifyUngrab) {
+    return;
+  }
+  if (focus_in) {
+    if (enabled_) {
+      TryGrab();
+    }
+  } else if (detail != NotifyInferior) {
+    Ungrab();
+  }
+}
+
+bool KeyboardGrab::OnKeycode(unsigned int keycode, bool is_down) {
+  // The grab fails while another client holds one, e.g. the window manager
+  // mid Alt+Tab; a key reaching the window means it has focus.
+  if (enabled_ && !grabbed_) {
+    TryGrab();
+  }
+  KeySym keysym =
+      XkbKeycodeToKeysym(display_, static_cast<KeyCode>(keycode), 0, 0);
+  return OnKey(static_cast<uint32_t>(keysym), is_down);
+}
+
+bool KeyboardGrab::OnKey(uint32_t keysym, bool is_down) {
+  uint8_t vk = VirtualKeyForKeysym(keysym);
+  if (vk == 0) {
+    return false;
+  }
+  ShortcutDecision decision = policy_.OnKey(vk, is_down, enabled_);
+  if (decision.block && decision.changed && callback_) {
+    callback_(vk, is_down);
+  }
+  return decision.block;
+}
+
+bool KeyboardGrab::HasFocus() const {
+  Window focus = None;
+  int revert_to = 0;
+  XGetInputFocus(display_, &focus, &revert_to);
+  // The focus may be on a child of the toplevel.
+  while (focus != None && focus != PointerRoot) {
+    if (focus == window_) {
+      return true;
+    }
+    Window root = None;
+    Window parent = None;
+    Window* children = nullptr;
+    unsigned int count = 0;
+    if (!XQueryTree(display_, focus, &root, &parent, &children, &count)) {
+      return false;
+    }
+    if (children != nullptr) {
+      XFree(children);
+    }
+    if (parent == root) {
+      return false;
+    }
+    focus = parent;
+  }
+  return false;
+}
+
+void KeyboardGrab::TryGrab() {
+  if (grabbed_) {
+    return;
+  }
+  // owner_events so keys still go to whichever of our windows has focus.
+  grabbed_ = XGrabKeyboard(display_, window_, True, GrabModeAsync,
+                           GrabModeAsync, CurrentTime) == GrabSuccess;
+}
+
+void KeyboardGrab::Ungrab() {
+  if (grabbed_) {
+    XUngrabKeyboard(display_, CurrentTime);
+    XFlush(display_);
+    grabbed_ = false;
+  }
+  // Releases now go to another window, so end what was reported as held.
+  for (int key = 1; key < 256; ++key) {
+    if (policy_.IsKeyBlocked(static_cast<uint8_t>(key)) && callback_) {
+      callback_(static_cast<uint8_t>(key), false);
+    }
+  }
+  policy_.Reset();
+}
+
+}  // namespace hardware_simulator
@@ -0,0 +1,72 @@
+#ifndef FLUTTER_PLUGIN_KEYBOARD_GRAB_H_
+#define FLUTTER_PLUGIN_KEYBOARD_GRAB_H_
+
+#include <X11/Xlib.h>
+
+#include <cstdint>
+#include <functional>
+
+#include "shortcut_policy.h"
+
+namespace hardware_simulator {
+
+// Immersive mode on X11, the counterpart of the Windows SmartKeyboardBlocker.
+//
+// While enabled and |window| has focus, the keyboard is actively grabbed,
+// which pre-empts the window manager's passive grabs on Super, Alt+Tab and
+// the like. Keys the ShortcutPolicy captures are reported to the callback
+// and should be dropped rather than delivered to the app. Focus moving to
+// another window releases the grab, so other apps keep their shortcuts.
+//
+// Plain Xlib, so it runs against Xvfb without GTK. Not thread-safe: call it
+// on the thread that reads |display|'s events.
+class KeyboardGrab {
+ public:
+  // Virtual-key code, as onKeyBlocked reports it on Windows.
+  using BlockedKeyCallback = std::function<void(uint8_t vk, bool is_down)>;
+
+  KeyboardGrab(Display* display, Window window, BlockedKeyCallback callback);
+  ~KeyboardGrab();
+
+  KeyboardGrab(const KeyboardGrab&) = delete;
+  KeyboardGrab& operator=(const KeyboardGrab&) = delete;
+
+  ShortcutPolicy& policy() { return policy_; }
+
+  // Grabs at once if |window| has focus, otherwise on its next FocusIn.
+  void Enable();
+  // Releases the grab, reporting an up for every captured key still held.
+  void Disable();
+
+  bool enabled() const { return enabled_; }
+  bool grabbed() const { return grabbed_; }
+
+  // Feeds an event delivered to |window|: core, or XInput 2 with its cookie
+  // data fetched, as GDK gets keys and focus changes when the server has
+  // it. Returns true for a captured key, which the caller must not pass on.
+  bool FilterEvent(XEvent* event);
+
+  // Decision for one key by its unshifted keysym; FilterEvent after the
+  // keycode is translated.
+  bool OnKey(uint32_t keysym, bool is_down);
+
+ private:
+  // Core and XInput 2 focus events share the mode and detail values.
+  void OnFocusChange(bool focus_in, int mode, int detail);
+  bool OnKeycode(unsigned int keycode, bool is_down);
+  bool HasFocus() const;
+  void TryGrab();
+  void Ungrab();
+
+  Display* display_;
+  Window window_;
+  BlockedKeyCallback callback_;
+  int xi_opcode_ = -1;
+  ShortcutPolicy policy_;
+  bool enabled_ = false;
+  bool grabbed_ = false;
+};
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_KEYBOARD_GRAB_H_
@@ -0,0 +1,258 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "auto_repeat.h"
+
+namespace hardware_simulator {
+namespace test {
+
+namespace {
+
+using std::chrono::milliseconds;
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+std::string Describe(const HeldInput& input) {
+  if (input.type == HeldInputType::kKey) {
+    return "key " + std::to_string(input.id);
+  }
+  char touch[64];
+  snprintf(touch, sizeof(touch), "touch %u %g,%g screen=%d", input.id, input.x,
+           input.y, input.screen_id);
+  return touch;
+}
+
+// Drives a RepeatSchedule on a virtual clock that starts at zero.
+class VirtualTime {
+ public:
+  explicit VirtualTime(RepeatSchedule* schedule) : schedule_(schedule) {}
+
+  RepeatSchedule::TimePoint now() const { return now_; }
+
+  // Advances to |ms| after the start, collecting every repeat on the way at
+  // the exact deadline it was due, and returns them as "<ms>: <input>".
+  std::vector<std::string> AdvanceTo(int ms) {
+    std::vector<std::string> fired;
+    const RepeatSchedule::TimePoint end = Start() + milliseconds(ms);
+    for (auto deadline = schedule_->NextDeadline();
+         deadline && *deadline <= end; deadline = schedule_->NextDeadline()) {
+      now_ = *deadline;
+      std::vector<HeldInput> due;
+      schedule_->CollectDue(now_, &due);
+      for (const auto& input : due) {
+        fired.push_back(std::to_string(Ms()) + ": " + Describe(input));
+      }
+    }
+    now_ = end;
+    return fired;
+  }
+
+  int Ms() const {
+    return static_cast<int>(
+        std::chrono::duration_cast<milliseconds>(now_ - Start()).count());
+  }
+
+ private:
+  static RepeatSchedule::TimePoint Start() { return {}; }
+
+  RepeatSchedule* schedule_;
+  RepeatSchedule::TimePoint now_{};
+};
+
+RepeatTiming Timing(int delay_ms, int interval_ms) {
+  RepeatTiming timing;
+  timing.delay = milliseconds(delay_ms);
+  timing.interval = milliseconds(interval_ms);
+  return timing;
+}
+
+}  // namespace
+
+TEST(RepeatSchedule, RepeatsAfterTheDelayAtTheInterval) {
+  RepeatSchedule schedule;
+  schedule.SetDefaultKeyTiming(Timing(500, 50));
+  VirtualTime time(&schedule);
+
+  schedule.KeyDown(65, time.now());
+  EXPECT_THAT(time.AdvanceTo(499), IsEmpty());
+  EXPECT_THAT(time.AdvanceTo(600),
+              ElementsAre("500: key 65", "550: key 65", "600: key 65"));
+
+  EXPECT_TRUE(schedule.IsKeyHeld(65));
+  EXPECT_TRUE(schedule.KeyUp(65));
+  EXPECT_FALSE(schedule.IsKeyHeld(65));
+  EXPECT_THAT(time.AdvanceTo(2000), IsEmpty());
+  EXPECT_FALSE(schedule.NextDeadline());
+}
+
+TEST(RepeatSchedule, RepeatsEveryHeldKeyWithItsOwnTiming) {
+  RepeatSchedule schedule;
+  schedule.SetDefaultKeyTiming(Timing(500, 100));
+  schedule.SetKeyTiming(16, Timing(200, 0));  // Shift: never repeats.
+  schedule.SetKeyTiming(40, Timing(100, 40));
+  VirtualTime time(&schedule);
+
+  schedule.KeyDown(16, time.now());
+  time.AdvanceTo(50);
+  schedule.KeyDown(40, time.now());
+  time.AdvanceTo(100);
+  schedule.KeyDown(65, time.now());
+
+  EXPECT_THAT(time.AdvanceTo(700),
+              ElementsAre("150: key 40", "190: key 40", "230: key 40",
+                          "270: key 40", "310: key 40", "350: key 40",
+                          "390: key 40", "430: key 40", "470: key 40",
+                          "510: key 40", "550: key 40", "590: key 40",
+                          "600: key 65", "630: key 40", "670: key 40",
+                          "700: key 65"));
+  EXPECT_EQ(schedule.held_count(), 3u);
+}
+
+TEST(RepeatSchedule, ADownForAHeldKeyKeepsItsSchedule) {
+  RepeatSchedule schedule;
+  schedule.SetDefaultKeyTiming(Timing(500, 50));
+  VirtualTime time(&schedule);
+
+  schedule.KeyDown(65, time.now());
+  time.AdvanceTo(400);
+  schedule.KeyDown(65, time.now());
+  EXPECT_THAT(time.AdvanceTo(500), ElementsAre("500: key 65"));
+
+  // A new press after a release starts over.
+  schedule.KeyUp(65);
+  schedule.KeyDown(65, time.now());
+  EXPECT_THAT(time.AdvanceTo(1000), ElementsAre("1000: key 65"));
+}
+
+TEST(RepeatSchedule, TouchRepeatsAtTheLatestPositionAndMovesPostponeIt) {
+  RepeatSchedule schedule;
+  schedule.SetTouchTiming(Timing(300, 300));
+  VirtualTime time(&schedule);
+
+  schedule.TouchDown(7, 1, 0.25, 0.5, time.now());
+  EXPECT_THAT(time.AdvanceTo(300), ElementsAre("300: touch 7 0.25,0.5 screen=1"));
+
+  time.AdvanceTo(500);
+  schedule.TouchMove(7, 0, 0.75, 0.5, time.now());
+  // The repeat due at 600 moved to 800.
+  EXPECT_THAT(time.AdvanceTo(1100), ElementsAre("800: touch 7 0.75,0.5 screen=0",
+                                                "1100: touch 7 0.75,0.5 screen=0"));
+
+  // Touch and key ids do not collide.
+  schedule.KeyDown(7, time.now());
+  EXPECT_TRUE(schedule.TouchUp(7));
+  EXPECT_FALSE(schedule.TouchUp(7));
+  EXPECT_EQ(schedule.held_count(), 1u);
+  schedule.TouchMove(9, 0, 0, 0, time.now());
+  EXPECT_EQ(schedule.held_count(), 1u);
+}
+
+TEST(RepeatSchedule, DoesNotBurstAfterFallingBehind) {
+  RepeatSchedule schedule;
+  schedule.SetDefaultKeyTiming(Timing(100, 10));
+  VirtualTime time(&schedule);
+  schedule.KeyDown(65, time.now());
+
+  // The collector was late by 95 ms: one repeat, then on the interval again.
+  std::vector<HeldInput> due;
+  schedule.CollectDue(time.now() + milliseconds(195), &due);
+  EXPECT_EQ(due.size(), 1u);
+  EXPECT_EQ(*schedule.NextDeadline(), time.now() + milliseconds(205));
+}
+
+TEST(RepeatSchedule, RestartAndReleaseAll) {
+  RepeatSchedule schedule;
+  schedule.SetDefaultKeyTiming(Timing(500, 50));
+  VirtualTime time(&schedule);
+  schedule.KeyDown(65, time.now());
+  schedule.TouchDown(3, 0, 0.5, 0.5, time.now());
+
+  time.AdvanceTo(1000);
+  schedule.Restart(time.now());
+  EXPECT_EQ(*schedule.NextDeadline(), time.now() + milliseconds(300));
+
+  auto released = schedule.ReleaseAll();
+  EXPECT_EQ(released.size(), 2u);
+  EXPECT_EQ(schedule.held_count(), 0u);
+  EXPECT_FALSE(schedule.NextDeadline());
+}
+
+// The threaded scheduler against the real clock, with loose bounds.
+class AutoRepeatSchedulerTest : public testing::Test {
+ protected:
+  AutoRepeatSchedulerTest()
+      : scheduler_([this](const HeldInput& input) {
+          std::lock_guard<std::mutex> lock(mutex_);
+          repeats_.push_back(Describe(input));
+          repeated_.notify_all();
+        }) {}
+
+  bool WaitForRepeats(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return repeated_.wait_for(lock, std::chrono::seconds(5),
+                              [&] { return repeats_.size() >= count; });
+  }
+
+  std::vector<std::string> repeats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return repeats_;
+  }
+
+  std::mutex mutex_;
+  std::condition_variable repeated_;
+  std::vector<std::string> repeats_;
+  AutoRepeatScheduler scheduler_;
+};
+
+TEST_F(AutoRepeatSchedulerTest, DoesNotWakeWhileIdle) {
+  std::this_thread::sleep_for(milliseconds(100));
+  EXPECT_EQ(scheduler_.wakeups(), 0u);
+
+  scheduler_.SetKeyTiming(65, Timing(500, 50));
+  scheduler_.KeyDown(65);
+  scheduler_.KeyUp(65);
+  std::this_thread::sleep_for(milliseconds(100));
+  // At most the early wakeup for the released key's deadline.
+  EXPECT_LE(scheduler_.wakeups(), 1u);
+  EXPECT_THAT(repeats(), IsEmpty());
+}
+
+TEST_F(AutoRepeatSchedulerTest, WakesForAnEarlierDeadline) {
+  scheduler_.SetKeyTiming(65, Timing(60000, 1000));
+  scheduler_.SetKeyTiming(66, Timing(10, 10));
+  scheduler_.KeyDown(65);
+  scheduler_.KeyDown(66);
+
+  ASSERT_TRUE(WaitForRepeats(3));
+  scheduler_.KeyUp(66);
+  EXPECT_THAT(repeats(), testing::Each(std::string("key 66")));
+}
+
+TEST_F(AutoRepeatSchedulerTest, DisablingStopsRepeatsButKeepsTracking) {
+  scheduler_.SetTouchTiming(Timing(10, 10));
+  scheduler_.TouchDown(1, 0, 0.5, 0.5);
+  ASSERT_TRUE(WaitForRepeats(1));
+
+  scheduler_.SetEnabled(false);
+  size_t before = repeats().size();
+  std::this_thread::sleep_for(milliseconds(100));
+  // One repeat may already have been collected when it was disabled.
+  EXPECT_LE(repeats().size(), before + 1);
+
+  scheduler_.SetEnabled(true);
+  ASSERT_TRUE(WaitForRepeats(before + 2));
+  auto released = scheduler_.ReleaseAll();
+  ASSERT_EQ(released.size(), 1u);
+  EXPECT_EQ(released[0].id, 1u);
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
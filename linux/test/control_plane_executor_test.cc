@@ -0,0 +1,223 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "control_plane_executor.h"
+
+namespace hardware_simulator {
+namespace test {
+
+namespace {
+
+using testing::ElementsAre;
+
+// Plays the platform thread: RunPendingReplies is called from the test
+// thread once the executor asked to be woken.
+class FakePlatformThread {
+ public:
+  std::function<void()> WakeCallback() {
+    return [this] {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++wakes_;
+      woken_.notify_all();
+    };
+  }
+
+  // Waits for a wake-up, then runs replies until |count| have run.
+  void RunReplies(ControlPlaneExecutor& executor, size_t count) {
+    size_t ran = 0;
+    while (ran < count) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ASSERT_TRUE(woken_.wait_for(lock, std::chrono::seconds(5),
+                                    [this] { return wakes_ > 0; }));
+        wakes_ = 0;
+      }
+      ran += executor.RunPendingReplies();
+    }
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable woken_;
+  int wakes_ = 0;
+};
+
+}  // namespace
+
+TEST(ControlPlaneExecutor, RunsWorkOffThreadAndRepliesOnThePlatformThread) {
+  FakePlatformThread platform;
+  ControlPlaneExecutor executor(2, platform.WakeCallback());
+
+  const std::thread::id platform_id = std::this_thread::get_id();
+  std::thread::id work_id;
+  std::thread::id reply_id;
+  int reply_value = 0;
+  executor.Submit(
+      0,
+      [&] {
+        work_id = std::this_thread::get_id();
+        return 42;
+      },
+      [&](int value) {
+        reply_id = std::this_thread::get_id();
+        reply_value = value;
+      });
+
+  platform.RunReplies(executor, 1);
+  EXPECT_NE(work_id, platform_id);
+  EXPECT_EQ(reply_id, platform_id);
+  EXPECT_EQ(reply_value, 42);
+}
+
+TEST(ControlPlaneExecutor, RepliesForVoidWork) {
+  FakePlatformThread platform;
+  ControlPlaneExecutor executor(1, platform.WakeCallback());
+  bool replied = false;
+  executor.Submit(0, [] {}, [&] { replied = true; });
+  platform.RunReplies(executor, 1);
+  EXPECT_TRUE(replied);
+}
+
+TEST(ControlPlaneExecutor, SerializesJobsWithinALane) {
+  FakePlatformThread platform;
+  ControlPlaneExecutor executor(4, platform.WakeCallback());
+
+  std::atomic<int> running{0};
+  std::atomic<int> max_running{0};
+  std::mutex order_mutex;
+  std::vector<int> order;
+  constexpr int kJobs = 20;
+  for (int i = 0; i < kJobs; ++i) {
+    executor.Submit(
+        7,
+        [&, i] {
+          int now = ++running;
+          int seen = max_running.load();
+          while (now > seen && !max_running.compare_exchange_weak(seen, now)) {
+          }
+          std::this_thread::sleep_for(std::chrono::microseconds(200));
+          {
+            std::lock_guard<std::mutex> lock(order_mutex);
+            order.push_back(i);
+          }
+          --running;
+        },
+        [] {});
+  }
+  platform.RunReplies(executor, kJobs);
+
+  EXPECT_EQ(max_running.load(), 1);
+  ASSERT_EQ(order.size(), static_cast<size_t>(kJobs));
+  for (int i = 0; i < kJobs; ++i) {
+    EXPECT_EQ(order[i], i);
+  }
+}
+
+TEST(ControlPlaneExecutor, SlowLaneDoesNotBlockOtherLanes) {
+  FakePlatformThread platform;
+  ControlPlaneExecutor executor(2, platform.WakeCallback());
+
+  std::mutex mutex;
+  std::condition_variable changed;
+  bool fast_done = false;
+  bool slow_saw_fast = false;
+
+  // The slow job only finishes once the fast lane got through.
+  executor.Submit(
+      1,
+      [&] {
+        std::unique_lock<std::mutex> lock(mutex);
+        slow_saw_fast = changed.wait_for(lock, std::chrono::seconds(5),
+                                         [&] { return fast_done; });
+      },
+      [] {});
+  executor.Submit(
+      2,
+      [&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        fast_done = true;
+        changed.notify_all();
+      },
+      [] {});
+
+  platform.RunReplies(executor, 2);
+  EXPECT_TRUE(slow_saw_fast);
+}
+
+TEST(ControlPlaneExecutor, RepliesKeepCompletionOrder) {
+  FakePlatformThread platform;
+  ControlPlaneExecutor executor(1, platform.WakeCallback());
+  std::vector<std::string> replies;
+  executor.Submit(0, [] { return std::string("first"); },
+                  [&](std::string value) { replies.push_back(value); });
+  executor.Submit(0, [] { return std::string("second"); },
+                  [&](std::string value) { replies.push_back(value); });
+  platform.RunReplies(executor, 2);
+  EXPECT_THAT(replies, ElementsAre("first", "second"));
+}
+
+TEST(ControlPlaneExecutor, LaneGoesOnAfterAJobThrows) {
+  FakePlatformThread platform;
+  ControlPlaneExecutor executor(1, platform.WakeCallback());
+  bool replied = false;
+  executor.Submit(0, [] { throw std::runtime_error("bad argument"); });
+  executor.Submit(0, [] {}, [&] { replied = true; });
+  platform.RunReplies(executor, 1);
+  EXPECT_TRUE(replied);
+}
+
+TEST(ControlPlaneExecutor, DestructorWaitsForRunningJobs) {
+  std::atomic<bool> finished{false};
+  std::atomic<bool> started{false};
+  {
+    ControlPlaneExecutor executor(1, nullptr);
+    executor.Submit(0, [&] {
+      started = true;
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      finished = true;
+    });
+    while (!started) {
+      std::this_thread::yield();
+    }
+  }
+  EXPECT_TRUE(finished);
+}
+
+TEST(ControlPlaneExecutor, DestructorAnswersJobsThatNeverRan) {
+  std::atomic<bool> started{false};
+  bool replied = false;
+  bool ran = false;
+  bool cancelled = false;
+  {
+    ControlPlaneExecutor executor(1, nullptr);
+    executor.Submit(
+        0,
+        [&] {
+          started = true;
+          std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        },
+        [&] { replied = true; });
+    executor.SubmitCancellable(
+        0, [&] { ran = true; },
+        [&] { cancelled = true; });
+    while (!started) {
+      std::this_thread::yield();
+    }
+  }
+  // The running job's reply is delivered, and the queued job is cancelled.
+  EXPECT_TRUE(replied);
+  EXPECT_FALSE(ran);
+  EXPECT_TRUE(cancelled);
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include "cursor_motion_accumulator.h"
+
+namespace hardware_simulator {
+namespace test {
+
+namespace {
+
+RawMouseSample Move(int32_t dx, int32_t dy, int64_t timestamp_us) {
+  RawMouseSample sample;
+  sample.dx = dx;
+  sample.dy = dy;
+  sample.timestamp_us = timestamp_us;
+  return sample;
+}
+
+}  // namespace
+
+TEST(CursorMotionAccumulator, SumsPacketsWithinOneInterval) {
+  // 8 kHz mouse, 60 Hz delivery.
+  CursorMotionAccumulator accumulator(16667);
+  CursorMotion flushed;
+  int64_t now = 1000000;
+
+  // The first packet after an idle period goes out immediately.
+  EXPECT_FALSE(accumulator.Add(Move(1, 1, now), &flushed));
+  ASSERT_TRUE(accumulator.ShouldFlush(now));
+  ASSERT_TRUE(accumulator.Flush(now, &flushed));
+  EXPECT_EQ(flushed.sample_count, 1u);
+
+  for (int i = 0; i < 100; ++i) {
+    now += 125;
+    EXPECT_FALSE(accumulator.Add(Move(1, -2, now), &flushed));
+    EXPECT_FALSE(accumulator.ShouldFlush(now)) << i;
+  }
+  ASSERT_TRUE(accumulator.ShouldFlush(1016667));
+  ASSERT_TRUE(accumulator.Flush(1016667, &flushed));
+  EXPECT_EQ(flushed.dx, 100);
+  EXPECT_EQ(flushed.dy, -200);
+  EXPECT_EQ(flushed.sample_count, 100u);
+  EXPECT_EQ(flushed.first_timestamp_us, 1000125);
+  EXPECT_EQ(flushed.last_timestamp_us, 1012500);
+  EXPECT_FALSE(accumulator.HasPending());
+  EXPECT_FALSE(accumulator.Flush(1016667, &flushed));
+}
+
+TEST(CursorMotionAccumulator, ZeroIntervalFlushesEverySample) {
+  CursorMotionAccumulator accumulator;
+  CursorMotion flushed;
+  accumulator.Add(Move(5, 6, 10), &flushed);
+  ASSERT_TRUE(accumulator.ShouldFlush(10));
+  ASSERT_TRUE(accumulator.Flush(10, &flushed));
+  EXPECT_EQ(flushed.dx, 5);
+  EXPECT_EQ(flushed.sample_count, 1u);
+  EXPECT_FALSE(accumulator.ShouldFlush(10));
+}
+
+TEST(CursorMotionAccumulator, IntervalRestartsAtEachFlush) {
+  CursorMotionAccumulator accumulator(1000);
+  CursorMotion flushed;
+  accumulator.Add(Move(1, 0, 100), &flushed);
+  ASSERT_TRUE(accumulator.Flush(1000, &flushed));
+
+  accumulator.Add(Move(1, 0, 1500), &flushed);
+  EXPECT_FALSE(accumulator.ShouldFlush(1999));
+  EXPECT_TRUE(accumulator.ShouldFlush(2000));
+}
+
+TEST(CursorMotionAccumulator, SumsWheelAndMergesDistinctButtons) {
+  CursorMotionAccumulator accumulator(16667);
+  CursorMotion flushed;
+
+  RawMouseSample left_down = Move(0, 0, 10);
+  left_down.buttons_down = kMouseButtonLeft;
+  RawMouseSample scroll = Move(0, 0, 20);
+  scroll.wheel = 120;
+  scroll.hwheel = -120;
+  RawMouseSample right_down = Move(2, 2, 30);
+  right_down.buttons_down = kMouseButtonRight;
+  right_down.wheel = 120;
+
+  EXPECT_FALSE(accumulator.Add(left_down, &flushed));
+  EXPECT_FALSE(accumulator.Add(scroll, &flushed));
+  EXPECT_FALSE(accumulator.Add(right_down, &flushed));
+
+  ASSERT_TRUE(accumulator.Flush(40, &flushed));
+  EXPECT_EQ(flushed.wheel, 240);
+  EXPECT_EQ(flushed.hwheel, -120);
+  EXPECT_EQ(flushed.buttons_down, kMouseButtonLeft | kMouseButtonRight);
+  EXPECT_EQ(flushed.buttons_up, 0u);
+  EXPECT_EQ(flushed.sample_count, 3u);
+}
+
+TEST(CursorMotionAccumulator, FlushesBeforeSameButtonChangesTwice) {
+  CursorMotionAccumulator accumulator(16667);
+  CursorMotion flushed;
+
+  RawMouseSample down = Move(3, 0, 10);
+  down.buttons_down = kMouseButtonLeft;
+  RawMouseSample up = Move(4, 0, 20);
+  up.buttons_up = kMouseButtonLeft;
+
+  EXPECT_FALSE(accumulator.Add(down, &flushed));
+  ASSERT_TRUE(accumulator.Add(up, &flushed));
+  // The click's press is delivered on its own, with the motion before it.
+  EXPECT_EQ(flushed.buttons_down, kMouseButtonLeft);
+  EXPECT_EQ(flushed.buttons_up, 0u);
+  EXPECT_EQ(flushed.dx, 3);
+  EXPECT_EQ(flushed.sample_count, 1u);
+
+  ASSERT_TRUE(accumulator.Flush(30, &flushed));
+  EXPECT_EQ(flushed.buttons_down, 0u);
+  EXPECT_EQ(flushed.buttons_up, kMouseButtonLeft);
+  EXPECT_EQ(flushed.dx, 4);
+  EXPECT_EQ(flushed.first_timestamp_us, 20);
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
@@ -0,0 +1,63 @@
+#include <flutter_linux/flutter_linux.h>
+#include <gtest/gtest.h>
+
+#include "fl_value_args.h"
+#include "method_schema.h"
+
+namespace hardware_simulator {
+namespace test {
+
+TEST(FlValueArgs, DecodesTouchEvent) {
+  g_autoptr(FlValue) args = fl_value_new_map();
+  fl_value_set_string_take(args, "screenId", fl_value_new_int(1));
+  fl_value_set_string_take(args, "x", fl_value_new_float(0.5));
+  fl_value_set_string_take(args, "y", fl_value_new_int(1));
+  fl_value_set_string_take(args, "touchId", fl_value_new_int(7));
+  fl_value_set_string_take(args, "isDown", fl_value_new_bool(TRUE));
+
+  TouchEventArgs touch;
+  ArgError error = DecodeFlValueArgs(args, &touch);
+  ASSERT_TRUE(error.ok()) << error.Message();
+  EXPECT_EQ(touch.screen_id, 1);
+  EXPECT_EQ(touch.x, 0.5);
+  EXPECT_EQ(touch.y, 1.0);
+  EXPECT_EQ(touch.touch_id, 7);
+  EXPECT_TRUE(touch.is_down);
+}
+
+TEST(FlValueArgs, DecodesTypedLists) {
+  const int32_t key_map[] = {65, 66, 0, 0, 0};
+  const double curve[] = {0, 1, 10, 2};
+  g_autoptr(FlValue) args = fl_value_new_map();
+  fl_value_set_string_take(args, "keyMap", fl_value_new_int32_list(key_map, 5));
+  fl_value_set_string_take(args, "curve", fl_value_new_float_list(curve, 4));
+
+  InputRemapArgs remap;
+  ArgError error = DecodeFlValueArgs(args, &remap);
+  ASSERT_TRUE(error.ok()) << error.Message();
+  EXPECT_EQ(remap.key_map, (std::vector<int32_t>{65, 66, 0, 0, 0}));
+  EXPECT_EQ(remap.curve, (std::vector<double>{0, 1, 10, 2}));
+
+  fl_value_set_string_take(args, "buttonMap", fl_value_new_int(1));
+  EXPECT_EQ(DecodeFlValueArgs(args, &remap).code, ArgErrorCode::kWrongType);
+}
+
+TEST(FlValueArgs, ReportsTypedErrors) {
+  KeyPressArgs key;
+  EXPECT_EQ(DecodeFlValueArgs(nullptr, &key).code, ArgErrorCode::kNotAMap);
+
+  g_autoptr(FlValue) args = fl_value_new_map();
+  fl_value_set_string_take(args, "code", fl_value_new_int(65));
+  ArgError missing = DecodeFlValueArgs(args, &key);
+  EXPECT_EQ(missing.code, ArgErrorCode::kMissing);
+  EXPECT_EQ(missing.key, "isDown");
+
+  fl_value_set_string_take(args, "isDown", fl_value_new_string("yes"));
+  g_autoptr(FlMethodResponse) response = ArgErrorResponse(DecodeFlValueArgs(args, &key));
+  ASSERT_TRUE(FL_IS_METHOD_ERROR_RESPONSE(response));
+  EXPECT_STREQ(fl_method_error_response_get_code(FL_METHOD_ERROR_RESPONSE(response)),
+               "InvalidArgumentType");
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
@@ -0,0 +1,170 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <vector>
+
+#include "gesture.h"
+#include "method_schema.h"
+#include "recording_input_sink.h"
+
+namespace hardware_simulator {
+namespace test {
+
+namespace {
+
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+using testing::ElementsAre;
+
+GestureSpec Swipe(GestureType type, milliseconds duration, int rate_hz) {
+  GestureSpec spec;
+  spec.type = type;
+  spec.start_x = 0.1;
+  spec.start_y = 0.5;
+  spec.end_x = 0.5;
+  spec.end_y = 0.5;
+  spec.duration = duration;
+  spec.rate_hz = rate_hz;
+  return spec;
+}
+
+// Plays |player| on a virtual clock that jumps straight to every deadline.
+std::vector<int64_t> PlayInstantly(GesturePlayer& player, InputSink& sink) {
+  std::vector<int64_t> waits;
+  PlayGesture(player, sink, [&waits](microseconds at) {
+    waits.push_back(at.count());
+    return true;
+  });
+  return waits;
+}
+
+}  // namespace
+
+TEST(GesturePlayer, SwipesOnAFixedSchedule) {
+  FrameRecordingSink sink;
+  GesturePlayer player(Swipe(GestureType::kSwipe, milliseconds(40), 100));
+
+  // A swipe lifts with the last move, still at speed.
+  EXPECT_THAT(PlayInstantly(player, sink),
+              ElementsAre(10000, 20000, 30000, 40000));
+  EXPECT_EQ(player.frames_injected(), 6u);
+  EXPECT_THAT(
+      sink.events,
+      ElementsAre("touch frame 1", "touch 4294967040 down 0.1 0.5 screen=0",
+                  "touch frame 1", "touch 4294967040 move 0.2 0.5 screen=0",
+                  "touch frame 1", "touch 4294967040 move 0.3 0.5 screen=0",
+                  "touch frame 1", "touch 4294967040 move 0.4 0.5 screen=0",
+                  "touch frame 1", "touch 4294967040 move 0.5 0.5 screen=0",
+                  "touch frame 1", "touch 4294967040 up 0.5 0.5 screen=0"));
+}
+
+TEST(GesturePlayer, DragRestsAFrameBeforeLifting) {
+  FrameRecordingSink sink;
+  GesturePlayer player(Swipe(GestureType::kDrag, milliseconds(20), 100));
+
+  EXPECT_THAT(PlayInstantly(player, sink), ElementsAre(10000, 20000, 30000));
+  EXPECT_EQ(sink.events.back(), "touch 4294967040 up 0.5 0.5 screen=0");
+}
+
+TEST(GesturePlayer, SkipsFramesTheClockMissed) {
+  FrameRecordingSink sink;
+  GesturePlayer player(Swipe(GestureType::kSwipe, milliseconds(40), 100));
+
+  EXPECT_TRUE(player.Advance(microseconds(0), sink));
+  EXPECT_EQ(player.NextFrameTime(), microseconds(10000));
+  // Late by more than two frames: only the one due now is injected.
+  EXPECT_TRUE(player.Advance(microseconds(35000), sink));
+  EXPECT_EQ(player.NextFrameTime(), microseconds(40000));
+  EXPECT_FALSE(player.Advance(microseconds(90000), sink));
+  EXPECT_FALSE(player.Advance(microseconds(100000), sink));
+
+  EXPECT_THAT(
+      sink.events,
+      ElementsAre("touch frame 1", "touch 4294967040 down 0.1 0.5 screen=0",
+                  "touch frame 1", "touch 4294967040 move 0.4 0.5 screen=0",
+                  "touch frame 1", "touch 4294967040 move 0.5 0.5 screen=0",
+                  "touch frame 1", "touch 4294967040 up 0.5 0.5 screen=0"));
+}
+
+TEST(GesturePlayer, PinchesContactsAroundTheCenter) {
+  FrameRecordingSink sink;
+  GestureSpec spec;
+  spec.type = GestureType::kPinch;
+  spec.start_x = 0.45;
+  spec.start_y = 0.5;
+  spec.end_x = 0.25;
+  spec.end_y = 0.5;
+  spec.contacts = 2;
+  GesturePlayer player(spec);
+
+  EXPECT_FALSE(player.Advance(microseconds(0), sink));
+  EXPECT_THAT(
+      sink.events,
+      ElementsAre("touch frame 2", "touch 4294967040 down 0.45 0.5 screen=0",
+                  "touch 4294967041 down 0.55 0.5 screen=0", "touch frame 2",
+                  "touch 4294967040 move 0.25 0.5 screen=0",
+                  "touch 4294967041 move 0.75 0.5 screen=0", "touch frame 2",
+                  "touch 4294967040 up 0.25 0.5 screen=0",
+                  "touch 4294967041 up 0.75 0.5 screen=0"));
+}
+
+TEST(GesturePlayer, LongPressHoldsTheStartWithSpacedContacts) {
+  FrameRecordingSink sink;
+  GestureSpec spec = Swipe(GestureType::kLongPress, milliseconds(20), 100);
+  spec.contacts = 2;
+  GesturePlayer player(spec);
+
+  PlayInstantly(player, sink);
+  EXPECT_EQ(player.frames_injected(), 4u);
+  EXPECT_THAT(sink.events,
+              testing::Each(testing::AnyOf(
+                  testing::StartsWith("touch frame"),
+                  testing::StartsWith("touch 4294967040 move 0.085 0.5"),
+                  testing::StartsWith("touch 4294967041 move 0.115 0.5"),
+                  testing::HasSubstr("down"), testing::HasSubstr("up"))));
+  EXPECT_EQ(sink.events.back(), "touch 4294967041 up 0.115 0.5 screen=0");
+}
+
+TEST(GesturePlayer, CancelLiftsTheContactsWhereTheyAre) {
+  FrameRecordingSink sink;
+  GesturePlayer player(Swipe(GestureType::kSwipe, milliseconds(40), 100));
+  int waits = 0;
+
+  size_t frames =
+      PlayGesture(player, sink, [&waits](microseconds) { return ++waits < 3; });
+
+  EXPECT_EQ(frames, 4u);
+  EXPECT_TRUE(player.done());
+  EXPECT_EQ(sink.events.back(), "touch 4294967040 up 0.3 0.5 screen=0");
+  player.Cancel(sink);
+  EXPECT_EQ(player.frames_injected(), 4u);
+}
+
+TEST(MakeGestureSpec, FillsDefaultsAndClamps) {
+  PerformGestureArgs args;
+  args.type = "pinch";
+  args.start_x = 0.4;
+  args.start_y = 0.6;
+  GestureSpec spec;
+  ASSERT_TRUE(MakeGestureSpec(args, &spec));
+  EXPECT_EQ(spec.type, GestureType::kPinch);
+  EXPECT_EQ(spec.end_x, 0.4);
+  EXPECT_EQ(spec.end_y, 0.6);
+  EXPECT_EQ(spec.contacts, 2);
+  EXPECT_EQ(spec.rate_hz, kDefaultGestureRateHz);
+  EXPECT_EQ(spec.duration, milliseconds(300));
+
+  args.type = "longPress";
+  args.contacts = 50;
+  args.rate_hz = 5000;
+  ASSERT_TRUE(MakeGestureSpec(args, &spec));
+  EXPECT_EQ(spec.contacts, static_cast<int>(kDefaultMaxTouchContacts));
+  EXPECT_EQ(spec.rate_hz, kMaxGestureRateHz);
+
+  args.type = "flick";
+  EXPECT_FALSE(MakeGestureSpec(args, &spec));
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
@@ -0,0 +1,211 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "input_batch.h"
+#include "recording_input_sink.h"
+
+namespace hardware_simulator {
+namespace test {
+
+namespace {
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+InputRecord MakeRecord(InputRecordType type) {
+  InputRecord record = {};
+  record.type = static_cast<uint8_t>(type);
+  return record;
+}
+
+InputRecord Key(uint16_t code, bool is_down) {
+  InputRecord record = MakeRecord(InputRecordType::kKey);
+  record.code = code;
+  record.flags = is_down ? kInputRecordDown : 0;
+  return record;
+}
+
+InputRecord Touch(InputRecordType type, uint32_t touch_id, double x, double y,
+                  bool is_down) {
+  InputRecord record = MakeRecord(type);
+  record.touch_id = touch_id;
+  record.screen_id = 1;
+  record.x = x;
+  record.y = y;
+  record.flags = is_down ? kInputRecordDown : 0;
+  return record;
+}
+
+InputRecord PenMove(int32_t screen_id, double x) {
+  InputRecord record = MakeRecord(InputRecordType::kPenMove);
+  record.screen_id = screen_id;
+  record.x = x;
+  record.pressure = 0.5f;
+  return record;
+}
+
+}  // namespace
+
+TEST(InputBatch, DecodesEveryRecordTypeInOrder) {
+  std::vector<InputRecord> records;
+  records.push_back(Key(0x41, true));
+  records.push_back(Key(0x41, false));
+
+  InputRecord rel = MakeRecord(InputRecordType::kMouseMoveRelative);
+  rel.x = 3;
+  rel.y = -4;
+  records.push_back(rel);
+
+  InputRecord abs = MakeRecord(InputRecordType::kMouseMoveAbsolute);
+  abs.x = 0.25;
+  abs.y = 0.75;
+  abs.screen_id = 2;
+  records.push_back(abs);
+
+  InputRecord button = MakeRecord(InputRecordType::kMouseButton);
+  button.code = 3;
+  button.flags = kInputRecordDown;
+  records.push_back(button);
+
+  InputRecord scroll = MakeRecord(InputRecordType::kMouseScroll);
+  scroll.y = -120;
+  records.push_back(scroll);
+
+  records.push_back(Touch(InputRecordType::kTouchEvent, 7, 0.5, 0.5, true));
+  records.push_back(Touch(InputRecordType::kTouchMove, 7, 0.6, 0.5, true));
+
+  InputRecord pen = MakeRecord(InputRecordType::kPenMove);
+  pen.x = 0.1;
+  pen.y = 0.2;
+  pen.flags = kInputRecordButton;
+  pen.pressure = 0.5f;
+  pen.rotation = 90.0f;
+  pen.tilt = 30.0f;
+  records.push_back(pen);
+
+  std::vector<uint8_t> message;
+  EncodeInputBatch(records.data(), records.size(), &message);
+  ASSERT_EQ(message.size(), kInputBatchHeaderSize + records.size() * kInputRecordSize);
+
+  RecordingInputSink sink;
+  EXPECT_EQ(DecodeInputBatch(message.data(), message.size(), sink), InputBatchStatus::kOk);
+  EXPECT_THAT(sink.events,
+              ElementsAre("key 65 down", "key 65 up", "move_rel 3 -4",
+                          "move_abs 0.25 0.75 screen=2", "button 3 down",
+                          "scroll 0 -120", "touch 7 down 0.5 0.5 screen=1",
+                          "touch 7 move 0.6 0.5 screen=1",
+                          "pen move 0.1 0.2 screen=0 button=1 pressure=0.5 "
+                          "rotation=90 tilt=30"));
+}
+
+TEST(InputBatch, DecodesUnalignedBuffers) {
+  InputRecord record = Key(0x20, true);
+  std::vector<uint8_t> message;
+  EncodeInputBatch(&record, 1, &message);
+
+  std::vector<uint8_t> shifted(message.size() + 1);
+  memcpy(shifted.data() + 1, message.data(), message.size());
+
+  RecordingInputSink sink;
+  EXPECT_EQ(DecodeInputBatch(shifted.data() + 1, message.size(), sink), InputBatchStatus::kOk);
+  EXPECT_THAT(sink.events, ElementsAre("key 32 down"));
+}
+
+TEST(InputBatch, RejectsMalformedMessagesWithoutDispatching) {
+  InputRecord records[] = {Key(0x41, true), Key(0x41, false)};
+  std::vector<uint8_t> message;
+  EncodeInputBatch(records, 2, &message);
+  RecordingInputSink sink;
+
+  EXPECT_EQ(DecodeInputBatch(nullptr, 0, sink), InputBatchStatus::kTruncated);
+  EXPECT_EQ(DecodeInputBatch(message.data(), 4, sink), InputBatchStatus::kTruncated);
+  EXPECT_EQ(DecodeInputBatch(message.data(), message.size() - 1, sink),
+            InputBatchStatus::kTruncated);
+
+  std::vector<uint8_t> bad_magic = message;
+  bad_magic[0] ^= 0xff;
+  EXPECT_EQ(DecodeInputBatch(bad_magic.data(), bad_magic.size(), sink), InputBatchStatus::kBadMagic);
+
+  std::vector<uint8_t> bad_version = message;
+  bad_version[4] = 99;
+  EXPECT_EQ(DecodeInputBatch(bad_version.data(), bad_version.size(), sink),
+            InputBatchStatus::kUnsupportedVersion);
+
+  EXPECT_THAT(sink.events, IsEmpty());
+}
+
+TEST(InputBatch, SkipsUnknownRecordTypes) {
+  InputRecord records[] = {MakeRecord(static_cast<InputRecordType>(200)), Key(0x0d, true)};
+  std::vector<uint8_t> message;
+  EncodeInputBatch(records, 2, &message);
+
+  RecordingInputSink sink;
+  EXPECT_EQ(DecodeInputBatch(message.data(), message.size(), sink), InputBatchStatus::kOk);
+  EXPECT_THAT(sink.events, ElementsAre("key 13 down"));
+}
+
+TEST(InputBatch, GroupsPenMovesOnOneScreenIntoRuns) {
+  InputRecord records[] = {PenMove(0, 0.1), PenMove(0, 0.2), Key(0x41, true),
+                           PenMove(0, 0.3), PenMove(1, 0.4), PenMove(1, 0.5)};
+  std::vector<uint8_t> message;
+  EncodeInputBatch(records, 6, &message);
+
+  PenRunRecordingSink sink;
+  EXPECT_EQ(DecodeInputBatch(message.data(), message.size(), sink), InputBatchStatus::kOk);
+  const char* kRest = " button=0 pressure=0.5 rotation=0 tilt=0";
+  EXPECT_THAT(sink.events,
+              ElementsAre("pen run 2 screen=0", "pen move 0.1 0 screen=0" + std::string(kRest),
+                          "pen move 0.2 0 screen=0" + std::string(kRest), "key 65 down",
+                          "pen run 1 screen=0", "pen move 0.3 0 screen=0" + std::string(kRest),
+                          "pen run 2 screen=1", "pen move 0.4 0 screen=1" + std::string(kRest),
+                          "pen move 0.5 0 screen=1" + std::string(kRest)));
+}
+
+TEST(InputBatch, SplitsLongPenRuns) {
+  std::vector<InputRecord> records(100, PenMove(0, 0.5));
+  std::vector<uint8_t> message;
+  EncodeInputBatch(records.data(), records.size(), &message);
+
+  PenRunRecordingSink sink;
+  EXPECT_EQ(DecodeInputBatch(message.data(), message.size(), sink), InputBatchStatus::kOk);
+  EXPECT_EQ(sink.events.size(), 102u);
+  EXPECT_EQ(sink.events[0], "pen run 64 screen=0");
+  EXPECT_EQ(sink.events[65], "pen run 36 screen=0");
+}
+
+TEST(InputBatch, GroupsTouchUpdatesIntoFrames) {
+  std::vector<InputRecord> records;
+  for (int step = 1; step <= 2; ++step) {
+    records.push_back(Touch(InputRecordType::kTouchMove, 1, step * 0.1, 0, false));
+    records.push_back(Touch(InputRecordType::kTouchMove, 2, step * 0.2, 0, false));
+  }
+  records.back().flags |= kInputRecordFrameEnd;
+  records.push_back(Touch(InputRecordType::kTouchMove, 1, 0.5, 0, false));
+  records.push_back(Key(0x41, true));
+  records.push_back(Touch(InputRecordType::kTouchEvent, 2, 0.5, 0, false));
+  std::vector<uint8_t> message;
+  EncodeInputBatch(records.data(), records.size(), &message);
+
+  FrameRecordingSink sink;
+  EXPECT_EQ(DecodeInputBatch(message.data(), message.size(), sink), InputBatchStatus::kOk);
+  EXPECT_THAT(sink.events,
+              ElementsAre("touch frame 2", "touch 1 move 0.2 0 screen=1",
+                          "touch 2 move 0.4 0 screen=1", "touch frame 1",
+                          "touch 1 move 0.5 0 screen=1", "key 65 down", "touch frame 1",
+                          "touch 2 up 0.5 0 screen=1"));
+}
+
+TEST(InputBatch, EmptyBatchIsValid) {
+  std::vector<uint8_t> message;
+  EncodeInputBatch(nullptr, 0, &message);
+  RecordingInputSink sink;
+  EXPECT_EQ(DecodeInputBatch(message.data(), message.size(), sink), InputBatchStatus::kOk);
+  EXPECT_THAT(sink.events, IsEmpty());
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
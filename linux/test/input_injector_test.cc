@@ -0,0 +1,232 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "input_injector.h"
+#include "recording_input_sink.h"
+
+namespace hardware_simulator {
+namespace test {
+
+namespace {
+
+using testing::ElementsAre;
+
+InputRecord Key(uint16_t code, bool is_down) {
+  InputRecord record = {};
+  record.type = static_cast<uint8_t>(InputRecordType::kKey);
+  record.code = code;
+  record.flags = is_down ? kInputRecordDown : 0;
+  return record;
+}
+
+// Checks, on the injector thread, that every producer's records arrive in
+// the order that producer posted them. A producer is the key code, its
+// sequence number the relative x.
+class SequenceCheckingSink : public RecordingInputSink {
+ public:
+  explicit SequenceCheckingSink(size_t producers)
+      : next_(producers, 0), counts_(producers, 0) {}
+
+  void MouseMoveRelative(double dx, double dy) override {
+    size_t producer = static_cast<size_t>(dy);
+    int64_t sequence = static_cast<int64_t>(dx);
+    if (sequence != next_[producer]) {
+      ++out_of_order;
+    }
+    next_[producer] = sequence + 1;
+    ++counts_[producer];
+    thread = std::this_thread::get_id();
+  }
+
+  const std::vector<int64_t>& counts() const { return counts_; }
+
+  int out_of_order = 0;
+  std::thread::id thread;
+
+ private:
+  std::vector<int64_t> next_;
+  std::vector<int64_t> counts_;
+};
+
+}  // namespace
+
+TEST(InputQueue, RoundsCapacityUpToPowerOfTwo) {
+  EXPECT_EQ(InputQueue(0).capacity(), 2u);
+  EXPECT_EQ(InputQueue(100).capacity(), 128u);
+}
+
+TEST(InputQueue, PopsInPushOrderAndRejectsWhenFull) {
+  InputQueue queue(4);
+  InputRecord record;
+  EXPECT_TRUE(queue.IsEmpty());
+  EXPECT_FALSE(queue.TryPop(&record));
+
+  for (uint16_t i = 0; i < 4; ++i) {
+    EXPECT_TRUE(queue.TryPush(Key(i, true)));
+  }
+  EXPECT_FALSE(queue.TryPush(Key(9, true)));
+
+  ASSERT_TRUE(queue.TryPop(&record));
+  EXPECT_EQ(record.code, 0);
+  EXPECT_TRUE(queue.TryPush(Key(9, true)));
+
+  std::vector<uint16_t> codes;
+  while (queue.TryPop(&record)) {
+    codes.push_back(record.code);
+  }
+  EXPECT_THAT(codes, ElementsAre(1, 2, 3, 9));
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST(InputInjector, InjectsQueuedSinkCallsInOrderOnItsOwnThread) {
+  RecordingInputSink sink;
+  InputInjector injector(sink);
+  QueuedInputSink queued(injector);
+
+  queued.KeyEvent(65, true);
+  queued.MouseMoveAbsolute(0.5, 0.25, 1);
+  queued.MouseButton(3, false);
+  queued.TouchEvent(0, 0.5, 0.5, 7, true);
+  queued.PenMove(0, 0.25, 0.75, true, 0.5, 90, 30);
+  queued.KeyRepeat(65);
+  queued.TouchRepeat(7);
+  queued.KeyEvent(65, false);
+  injector.WaitUntilIdle();
+
+  EXPECT_THAT(sink.events,
+              ElementsAre("key 65 down", "move_abs 0.5 0.25 screen=1",
+                          "button 3 up", "touch 7 down 0.5 0.5 screen=0",
+                          "pen move 0.25 0.75 screen=0 button=1 "
+                          "pressure=0.5 rotation=90 tilt=30",
+                          "key 65 repeat", "touch 7 repeat", "key 65 up"));
+}
+
+TEST(InputInjector, RunsTasksInOrderWithRecordsOnItsThread) {
+  RecordingInputSink sink;
+  InputInjector injector(sink);
+  QueuedInputSink queued(injector);
+  std::thread::id task_thread;
+
+  queued.KeyEvent(65, true);
+  injector.PostTask([&] {
+    task_thread = std::this_thread::get_id();
+    sink.events.push_back("task");
+  });
+  queued.KeyEvent(65, false);
+  injector.WaitUntilIdle();
+
+  EXPECT_THAT(sink.events, ElementsAre("key 65 down", "task", "key 65 up"));
+  EXPECT_NE(task_thread, std::this_thread::get_id());
+}
+
+// Runs posted by QueuedInputSink::PenMoveBatch reach the injector's sink as
+// PenMoveBatch calls, every sample once and in order, and no run spans a
+// screen change. Where a run is split depends on when the injector parks,
+// which varies with the machine and scheduling, so that is not checked.
+TEST(InputInjector, KeepsPostedPenRunsInOrder) {
+  PenRunRecordingSink sink;
+  InputInjector injector(sink);
+  QueuedInputSink queued(injector);
+  RecordingInputSink expected;
+  PenSample samples[PenRunBuilder::kMaxSize];
+  for (size_t i = 0; i < PenRunBuilder::kMaxSize; ++i) {
+    samples[i].x = static_cast<double>(i) / PenRunBuilder::kMaxSize;
+    samples[i].pressure = 0.5f;
+  }
+  for (int round = 0; round < 50; ++round) {
+    queued.PenMoveBatch(1, samples, PenRunBuilder::kMaxSize);
+    queued.PenMove(0, 0.5, 0.5, false, 0.5, -1, -1);
+    queued.KeyEvent(65, true);
+    expected.PenMoveBatch(1, samples, PenRunBuilder::kMaxSize);
+    expected.PenMove(0, 0.5, 0.5, false, 0.5, -1, -1);
+    expected.KeyEvent(65, true);
+  }
+  injector.WaitUntilIdle();
+
+  std::vector<std::string> delivered;
+  for (size_t i = 0; i < sink.events.size(); ++i) {
+    const std::string& event = sink.events[i];
+    if (event.rfind("pen run ", 0) != 0) {
+      EXPECT_EQ(event.rfind("pen move", 0), std::string::npos)
+          << "pen move outside a run: " << event;
+      delivered.push_back(event);
+      continue;
+    }
+    size_t count = 0;
+    int screen = 0;
+    ASSERT_EQ(std::sscanf(event.c_str(), "pen run %zu screen=%d", &count, &screen), 2);
+    ASSERT_GT(count, 0u);
+    ASSERT_LE(count, PenRunBuilder::kMaxSize);
+    ASSERT_LE(i + count, sink.events.size() - 1);
+    std::string on_screen = " screen=" + std::to_string(screen) + " ";
+    for (size_t j = 1; j <= count; ++j) {
+      EXPECT_NE(sink.events[i + j].find(on_screen), std::string::npos)
+          << "run on screen " << screen << " holds " << sink.events[i + j];
+      delivered.push_back(sink.events[i + j]);
+    }
+    i += count;
+  }
+  EXPECT_EQ(delivered, expected.events);
+}
+
+TEST(InputInjector, StopInjectsWhatIsAlreadyQueued) {
+  RecordingInputSink sink;
+  {
+    InputInjector injector(sink, 64, 0);
+    for (uint16_t i = 0; i < 50; ++i) {
+      injector.Post(Key(i, true));
+    }
+    injector.Stop();
+    injector.Post(Key(99, true));
+  }
+  ASSERT_EQ(sink.events.size(), 50u);
+  EXPECT_EQ(sink.events.back(), "key 49 down");
+}
+
+// Several producers hammer a small queue so Post() keeps running into a full
+// queue; every record must arrive exactly once and in per-producer order.
+TEST(InputInjector, StressManyProducersKeepPerProducerOrder) {
+  constexpr size_t kProducers = 4;
+  constexpr int64_t kPerProducer = 50000;
+  SequenceCheckingSink sink(kProducers);
+  InputInjector injector(sink, 64);
+  QueuedInputSink queued(injector);
+
+  std::atomic<bool> go{false};
+  std::vector<std::thread> producers;
+  std::vector<std::thread::id> producer_ids;
+  for (size_t p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&, p] {
+      while (!go.load()) {
+        std::this_thread::yield();
+      }
+      for (int64_t i = 0; i < kPerProducer; ++i) {
+        queued.MouseMoveRelative(static_cast<double>(i), static_cast<double>(p));
+      }
+    });
+    producer_ids.push_back(producers.back().get_id());
+  }
+  go = true;
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  injector.WaitUntilIdle();
+
+  EXPECT_EQ(sink.out_of_order, 0);
+  for (size_t p = 0; p < kProducers; ++p) {
+    EXPECT_EQ(sink.counts()[p], kPerProducer) << "producer " << p;
+  }
+  EXPECT_NE(sink.thread, std::this_thread::get_id());
+  for (const auto& id : producer_ids) {
+    EXPECT_NE(sink.thread, id);
+  }
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
@@ -0,0 +1,130 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "input_lease.h"
+#include "pressed_input_tracker.h"
+#include "recording_input_sink.h"
+
+namespace hardware_simulator {
+namespace test {
+
+namespace {
+
+using std::chrono::milliseconds;
+using testing::UnorderedElementsAre;
+
+InputLease::TimePoint At(int ms) { return InputLease::TimePoint{} + milliseconds(ms); }
+
+}  // namespace
+
+TEST(InputLease, LapsesOnceWhenTheHeartbeatIsLate) {
+  InputLease lease;
+  EXPECT_FALSE(lease.Deadline());
+  EXPECT_FALSE(lease.Expire(At(100000)));
+
+  lease.Start(milliseconds(100), At(0));
+  EXPECT_EQ(lease.Deadline(), At(100));
+  lease.Renew(At(60));
+  EXPECT_FALSE(lease.Expire(At(100)));
+  EXPECT_EQ(lease.Deadline(), At(160));
+
+  EXPECT_TRUE(lease.Expire(At(160)));
+  EXPECT_TRUE(lease.lapsed());
+  EXPECT_FALSE(lease.Deadline());
+  EXPECT_FALSE(lease.Expire(At(1000)));
+
+  // The next heartbeat renews it.
+  lease.Renew(At(1000));
+  EXPECT_FALSE(lease.lapsed());
+  EXPECT_EQ(lease.Deadline(), At(1100));
+}
+
+TEST(InputLease, IgnoresStaleHeartbeatsAndDisarms) {
+  InputLease lease;
+  lease.Start(milliseconds(100), At(50));
+  lease.Renew(At(20));
+  EXPECT_EQ(lease.Deadline(), At(150));
+
+  lease.Start(milliseconds(0), At(60));
+  EXPECT_FALSE(lease.armed());
+  EXPECT_FALSE(lease.Deadline());
+  EXPECT_FALSE(lease.Expire(At(100000)));
+}
+
+class InputLeaseWatchdogTest : public testing::Test {
+ protected:
+  InputLeaseWatchdogTest()
+      : watchdog_([this] {
+          std::lock_guard<std::mutex> lock(mutex_);
+          ++expired_;
+          tracker_.ReleaseAll(recorder_);
+          changed_.notify_all();
+        }) {}
+
+  bool WaitForExpiry(int count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return changed_.wait_for(lock, std::chrono::seconds(5),
+                             [&] { return expired_ >= count; });
+  }
+
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  int expired_ = 0;
+  PressedInputTracker tracker_;
+  RecordingInputSink recorder_;
+  InputLeaseWatchdog watchdog_;
+};
+
+TEST_F(InputLeaseWatchdogTest, ReleasesEverythingHeldWhenTheLeaseLapses) {
+  tracker_.KeyEvent(65, true);
+  tracker_.MouseButton(1, true);
+  tracker_.TouchEvent(0, 0.5, 0.5, 7, true);
+
+  auto start = std::chrono::steady_clock::now();
+  watchdog_.Start(milliseconds(30));
+  ASSERT_TRUE(WaitForExpiry(1));
+  EXPECT_GE(std::chrono::steady_clock::now() - start, milliseconds(30));
+  EXPECT_TRUE(watchdog_.lapsed());
+  std::lock_guard<std::mutex> lock(mutex_);
+  EXPECT_THAT(recorder_.events,
+              UnorderedElementsAre("key 65 up", "button 1 up",
+                                   "touch 7 up 0.5 0.5 screen=0"));
+}
+
+TEST_F(InputLeaseWatchdogTest, HeartbeatsKeepItAliveWithoutWakingTheThread) {
+  watchdog_.Start(milliseconds(100));
+  auto end = std::chrono::steady_clock::now() + milliseconds(300);
+  while (std::chrono::steady_clock::now() < end) {
+    watchdog_.Renew();
+    std::this_thread::sleep_for(milliseconds(1));
+  }
+  EXPECT_EQ(watchdog_.expirations(), 0u);
+  // About one wakeup per timeout, not one per heartbeat.
+  EXPECT_LE(watchdog_.wakeups(), 8u);
+
+  // Heartbeats stop: it lapses, then the next one revives it.
+  ASSERT_TRUE(WaitForExpiry(1));
+  watchdog_.Renew();
+  EXPECT_FALSE(watchdog_.lapsed());
+  ASSERT_TRUE(WaitForExpiry(2));
+}
+
+TEST_F(InputLeaseWatchdogTest, DoesNotWakeWhileDisarmed) {
+  watchdog_.Renew();
+  std::this_thread::sleep_for(milliseconds(100));
+  EXPECT_EQ(watchdog_.wakeups(), 0u);
+
+  watchdog_.Start(milliseconds(20));
+  watchdog_.Start(milliseconds(0));
+  std::this_thread::sleep_for(milliseconds(100));
+  EXPECT_EQ(watchdog_.expirations(), 0u);
+  EXPECT_LE(watchdog_.wakeups(), 2u);
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
@@ -0,0 +1,184 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+
+#include "input_remap.h"
+#include "recording_input_sink.h"
+
+namespace hardware_simulator {
+namespace test {
+
+namespace {
+
+using testing::ElementsAre;
+
+std::shared_ptr<const InputRemap> Build(const InputRemapSpec& spec) {
+  auto remap = std::make_shared<InputRemap>();
+  EXPECT_EQ(InputRemap::Build(spec, remap.get()), RemapStatus::kOk);
+  return remap;
+}
+
+}  // namespace
+
+TEST(InputRemap, PassesEverythingThroughWithoutAProfile) {
+  RecordingInputSink recorder;
+  RemappingInputSink sink(recorder);
+  sink.KeyEvent(65, true);
+  sink.KeyEvent(65, false);
+  sink.KeyEvent(300, true);
+  sink.MouseButton(1, true);
+  sink.MouseMoveRelative(3, -4);
+  sink.TouchEvent(0, 0.5, 0.5, 7, true);
+  EXPECT_THAT(recorder.events,
+              ElementsAre("key 65 down", "key 65 up", "key 300 down",
+                          "button 1 down", "move_rel 3 -4",
+                          "touch 7 down 0.5 0.5 screen=0"));
+}
+
+TEST(InputRemap, PressesChordsInOrderAndReleasesThemInReverse) {
+  InputRemapSpec spec;
+  // F1 -> Ctrl+Shift+Esc, A -> B, CapsLock swallowed.
+  spec.key_map = {0x70, 0xA2, 0xA0, 0x1B, 0,  //
+                  0x41, 0x42, 0,    0,    0,  //
+                  0x14, 0,    0,    0,    0};
+
+  RecordingInputSink recorder;
+  RemappingInputSink sink(recorder);
+  sink.Publish(Build(spec));
+  sink.KeyEvent(0x70, true);
+  sink.KeyEvent(0x70, false);
+  sink.KeyEvent(0x41, true);
+  sink.KeyEvent(0x41, false);
+  sink.KeyEvent(0x14, true);
+  sink.KeyEvent(0x14, false);
+  EXPECT_THAT(recorder.events,
+              ElementsAre("key 162 down", "key 160 down", "key 27 down",
+                          "key 27 up", "key 160 up", "key 162 up",
+                          "key 66 down", "key 66 up"));
+}
+
+TEST(InputRemap, SwapsAndSwallowsButtons) {
+  InputRemapSpec spec;
+  spec.button_map = {1, 3, 3, 1, 2, 0};
+  RecordingInputSink recorder;
+  RemappingInputSink sink(recorder);
+  sink.Publish(Build(spec));
+  sink.MouseButton(1, true);
+  sink.MouseButton(1, false);
+  sink.MouseButton(2, true);
+  sink.MouseButton(2, false);
+  sink.MouseButton(3, true);
+  sink.MouseButton(4, true);
+  EXPECT_THAT(recorder.events,
+              ElementsAre("button 3 down", "button 3 up", "button 1 down",
+                          "button 4 down"));
+}
+
+TEST(InputRemap, ReleasesWhatWasPressedAcrossAProfileSwap) {
+  InputRemapSpec a_to_b;
+  a_to_b.key_map = {0x41, 0x42, 0, 0, 0};
+  a_to_b.button_map = {1, 3};
+  InputRemapSpec a_to_c;
+  a_to_c.key_map = {0x41, 0x43, 0, 0, 0};
+
+  RecordingInputSink recorder;
+  RemappingInputSink sink(recorder);
+  sink.Publish(Build(a_to_b));
+  sink.KeyEvent(0x41, true);
+  sink.MouseButton(1, true);
+  sink.Publish(Build(a_to_c));
+  // Client-side typematic keeps pressing what the key went down as.
+  sink.KeyEvent(0x41, true);
+  sink.KeyEvent(0x41, false);
+  sink.MouseButton(1, false);
+  sink.KeyEvent(0x41, true);
+  EXPECT_THAT(recorder.events,
+              ElementsAre("key 66 down", "button 3 down", "key 66 down",
+                          "key 66 up", "button 3 up", "key 67 down"));
+}
+
+TEST(InputRemap, ScalesMotionAlongTheSensitivityCurve) {
+  InputRemapSpec spec;
+  spec.sensitivity_x = 2;
+  spec.sensitivity_y = 0.5;
+  // Unity gain up to 5 counts, rising to 3x at 25 and held beyond.
+  spec.curve = {5, 1, 25, 3};
+  InputRemap remap;
+  ASSERT_EQ(InputRemap::Build(spec, &remap), RemapStatus::kOk);
+  EXPECT_FALSE(remap.is_identity());
+
+  double dx = 0;
+  double dy = 0;
+  remap.ScaleMotion(3, 4, &dx, &dy);  // Speed 5.
+  EXPECT_DOUBLE_EQ(dx, 6);
+  EXPECT_DOUBLE_EQ(dy, 2);
+  remap.ScaleMotion(0, 15, &dx, &dy);  // Speed 15: gain 2.
+  EXPECT_DOUBLE_EQ(dx, 0);
+  EXPECT_DOUBLE_EQ(dy, 15);
+  remap.ScaleMotion(0, 15.5, &dx, &dy);  // Between table entries.
+  EXPECT_NEAR(dy, 15.5 * 0.5 * 2.05, 1e-9);
+  remap.ScaleMotion(300, 400, &dx, &dy);  // Past the table.
+  EXPECT_DOUBLE_EQ(dx, 1800);
+  EXPECT_DOUBLE_EQ(dy, 600);
+  remap.ScaleMotion(0, 0, &dx, &dy);
+  EXPECT_DOUBLE_EQ(dx, 0);
+}
+
+TEST(InputRemap, RejectsMalformedSpecsAndKeepsTheOldTables) {
+  InputRemapSpec good;
+  good.key_map = {0x41, 0x42, 0, 0, 0};
+  InputRemap remap;
+  ASSERT_EQ(InputRemap::Build(good, &remap), RemapStatus::kOk);
+
+  InputRemapSpec spec;
+  spec.key_map = {0x41, 0x42};
+  EXPECT_EQ(InputRemap::Build(spec, &remap), RemapStatus::kBadKeyMap);
+  spec.key_map = {0x41, 0x42, 0, 0, 0, 0x41, 0x43, 0, 0, 0};
+  EXPECT_EQ(InputRemap::Build(spec, &remap), RemapStatus::kBadKeyMap);
+  spec.key_map = {0x41, 0x100, 0, 0, 0};
+  EXPECT_EQ(InputRemap::Build(spec, &remap), RemapStatus::kBadKeyMap);
+
+  spec = InputRemapSpec();
+  spec.button_map = {1, 6};
+  EXPECT_EQ(InputRemap::Build(spec, &remap), RemapStatus::kBadButtonMap);
+  spec.button_map = {1, 2, 1, 3};
+  EXPECT_EQ(InputRemap::Build(spec, &remap), RemapStatus::kBadButtonMap);
+
+  spec = InputRemapSpec();
+  spec.sensitivity_x = -1;
+  EXPECT_EQ(InputRemap::Build(spec, &remap), RemapStatus::kBadSensitivity);
+  spec.sensitivity_x = NAN;
+  EXPECT_EQ(InputRemap::Build(spec, &remap), RemapStatus::kBadSensitivity);
+
+  spec = InputRemapSpec();
+  spec.curve = {10, 1, 5, 2};
+  EXPECT_EQ(InputRemap::Build(spec, &remap), RemapStatus::kBadCurve);
+  spec.curve = {10, 1, 20};
+  EXPECT_EQ(InputRemap::Build(spec, &remap), RemapStatus::kBadCurve);
+
+  EXPECT_EQ(remap.KeyTarget(0x41).count, 1);
+  EXPECT_EQ(remap.KeyTarget(0x41).keys[0], 0x42);
+}
+
+TEST(InputRemap, LeavesRepeatsAndOtherInputAlone) {
+  InputRemapSpec spec;
+  spec.key_map = {0x41, 0x42, 0, 0, 0};
+  RecordingInputSink recorder;
+  RemappingInputSink sink(recorder);
+  sink.Publish(Build(spec));
+  // Repeats come from the auto-repeat scheduler, after remapping.
+  sink.KeyRepeat(0x42);
+  sink.MouseScroll(0, 120);
+  sink.MouseMoveAbsolute(0.5, 0.5, 1);
+  EXPECT_THAT(recorder.events,
+              ElementsAre("key 66 repeat", "scroll 0 120",
+                          "move_abs 0.5 0.5 screen=1"));
+  recorder.events.clear();
+  sink.KeyEvent(0x41, false);  // Never pressed: released as mapped now.
+  EXPECT_THAT(recorder.events, ElementsAre("key 66 up"));
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
@@ -0,0 +1,208 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "input_retry.h"
+
+namespace hardware_simulator {
+namespace test {
+
+namespace {
+
+using std::chrono::microseconds;
+using testing::ElementsAre;
+
+// Stands in for SendInput: rejects everything while the "desktop" is lost
+// and accepts again once a thread has reacquired it, optionally only after a
+// number of reacquires.
+class FaultyBackend {
+ public:
+  void LoseContext(int reacquires_needed) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lost_ = true;
+    reacquires_needed_ = reacquires_needed;
+  }
+
+  void Reacquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++reacquires_;
+    if (lost_ && --reacquires_needed_ <= 0) {
+      lost_ = false;
+    }
+    reacquire_threads_.push_back(std::this_thread::get_id());
+  }
+
+  InputRetryEngine::Attempt Event(int id) {
+    return [this, id] {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++attempts_;
+      if (lost_) {
+        return false;
+      }
+      delivered_.push_back(id);
+      return true;
+    };
+  }
+
+  std::vector<int> delivered() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return delivered_;
+  }
+  int attempts() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return attempts_;
+  }
+  int reacquires() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reacquires_;
+  }
+  std::vector<std::thread::id> reacquire_threads() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reacquire_threads_;
+  }
+
+ private:
+  std::mutex mutex_;
+  bool lost_ = false;
+  int reacquires_needed_ = 0;
+  int reacquires_ = 0;
+  int attempts_ = 0;
+  std::vector<int> delivered_;
+  std::vector<std::thread::id> reacquire_threads_;
+};
+
+RetryPolicy FastPolicy() {
+  RetryPolicy policy;
+  policy.max_attempts = 4;
+  policy.initial_backoff = microseconds(100);
+  policy.max_backoff = microseconds(400);
+  return policy;
+}
+
+}  // namespace
+
+TEST(RetryPolicy, BackoffDoublesUpToTheCap) {
+  RetryPolicy policy;
+  policy.initial_backoff = microseconds(1000);
+  policy.max_backoff = microseconds(5000);
+  std::vector<int64_t> backoffs;
+  for (int i = 0; i < 6; ++i) {
+    backoffs.push_back(policy.BackoffBefore(i).count());
+  }
+  EXPECT_THAT(backoffs, ElementsAre(0, 1000, 2000, 4000, 5000, 5000));
+}
+
+TEST(InputRetryEngine, DeliversInlineWithoutTheWorker) {
+  FaultyBackend backend;
+  InputRetryEngine engine(FastPolicy(), [&] { backend.Reacquire(); });
+  EXPECT_TRUE(engine.Inject(backend.Event(1)));
+  EXPECT_TRUE(engine.Inject(backend.Event(2)));
+  EXPECT_THAT(backend.delivered(), ElementsAre(1, 2));
+  EXPECT_EQ(backend.reacquires(), 0);
+  EXPECT_EQ(engine.retries(), 0u);
+}
+
+TEST(InputRetryEngine, ReacquiresOnTheWorkerAndRetries) {
+  FaultyBackend backend;
+  InputRetryEngine engine(FastPolicy(), [&] { backend.Reacquire(); });
+  backend.LoseContext(2);
+
+  EXPECT_FALSE(engine.Inject(backend.Event(1)));
+  engine.WaitUntilIdle();
+
+  EXPECT_THAT(backend.delivered(), ElementsAre(1));
+  // One failed inline attempt, one failed retry, then success.
+  EXPECT_EQ(backend.attempts(), 3);
+  EXPECT_EQ(engine.retries(), 2u);
+  EXPECT_EQ(engine.dropped(), 0u);
+  for (const auto& id : backend.reacquire_threads()) {
+    EXPECT_NE(id, std::this_thread::get_id());
+  }
+}
+
+TEST(InputRetryEngine, LaterEventsQueueBehindARetry) {
+  FaultyBackend backend;
+  InputRetryEngine engine(FastPolicy(), [&] { backend.Reacquire(); });
+  backend.LoseContext(3);
+
+  engine.Inject(backend.Event(1));
+  // The context may already be back, but these must not overtake event 1.
+  engine.Inject(backend.Event(2));
+  engine.Inject(backend.Event(3));
+  engine.WaitUntilIdle();
+
+  EXPECT_THAT(backend.delivered(), ElementsAre(1, 2, 3));
+}
+
+TEST(InputRetryEngine, InjectingThreadCatchesUpAfterAWorkerReacquire) {
+  FaultyBackend backend;
+  InputRetryEngine engine(FastPolicy(), [&] { backend.Reacquire(); });
+  backend.LoseContext(1);
+  engine.Inject(backend.Event(1));
+  engine.WaitUntilIdle();
+  int worker_reacquires = backend.reacquires();
+
+  EXPECT_TRUE(engine.Inject(backend.Event(2)));
+  ASSERT_EQ(backend.reacquires(), worker_reacquires + 1);
+  EXPECT_EQ(backend.reacquire_threads().back(), std::this_thread::get_id());
+  // Only once per worker reacquire.
+  EXPECT_TRUE(engine.Inject(backend.Event(3)));
+  EXPECT_EQ(backend.reacquires(), worker_reacquires + 1);
+}
+
+TEST(InputRetryEngine, GivesUpAfterMaxAttemptsAndFailsFastAfterwards) {
+  FaultyBackend backend;
+  RetryPolicy policy = FastPolicy();
+  InputRetryEngine engine(policy, [&] { backend.Reacquire(); });
+  backend.LoseContext(1000);
+
+  auto start = std::chrono::steady_clock::now();
+  engine.Inject(backend.Event(1));
+  engine.Inject(backend.Event(2));
+  engine.Inject(backend.Event(3));
+  engine.WaitUntilIdle();
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  EXPECT_THAT(backend.delivered(), ElementsAre());
+  EXPECT_EQ(engine.dropped(), 3u);
+  // Event 1 used the full policy, 2 and 3 a single attempt each.
+  EXPECT_EQ(engine.retries(), static_cast<uint64_t>(policy.max_attempts + 2));
+  EXPECT_LT(elapsed, std::chrono::seconds(2));
+
+  // Once the context is back, events are delivered again.
+  backend.LoseContext(2);
+  engine.Inject(backend.Event(4));
+  engine.WaitUntilIdle();
+  EXPECT_THAT(backend.delivered(), ElementsAre(4));
+}
+
+TEST(InputRetryEngine, BoundsTheBacklog) {
+  FaultyBackend backend;
+  RetryPolicy policy = FastPolicy();
+  policy.max_pending = 2;
+  policy.initial_backoff = microseconds(20000);
+  policy.max_backoff = microseconds(20000);
+  InputRetryEngine engine(policy, [&] { backend.Reacquire(); });
+  backend.LoseContext(3);
+
+  engine.Inject(backend.Event(1));
+  // Let the worker take event 1 before the backlog fills up.
+  while (backend.attempts() < 2) {
+    std::this_thread::yield();
+  }
+  for (int id = 2; id <= 6; ++id) {
+    engine.Inject(backend.Event(id));
+  }
+  engine.WaitUntilIdle();
+
+  // Event 1 is on the worker; of 2..6 only the newest two were kept.
+  EXPECT_THAT(backend.delivered(), ElementsAre(1, 5, 6));
+  EXPECT_EQ(engine.dropped(), 3u);
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
@@ -0,0 +1,203 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+
+#include "input_ring.h"
+#include "input_ring_ffi.h"
+#include "recording_input_sink.h"
+
+namespace hardware_simulator {
+namespace test {
+
+namespace {
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+InputRecord Key(uint16_t code, bool is_down) {
+  InputRecord record = {};
+  record.type = static_cast<uint8_t>(InputRecordType::kKey);
+  record.code = code;
+  record.flags = is_down ? kInputRecordDown : 0;
+  return record;
+}
+
+InputRecord TouchMove(uint32_t touch_id, double x, double y) {
+  InputRecord record = {};
+  record.type = static_cast<uint8_t>(InputRecordType::kTouchMove);
+  record.touch_id = touch_id;
+  record.x = x;
+  record.y = y;
+  return record;
+}
+
+InputRecord PenMove(int32_t screen_id, double x) {
+  InputRecord record = {};
+  record.type = static_cast<uint8_t>(InputRecordType::kPenMove);
+  record.screen_id = screen_id;
+  record.x = x;
+  return record;
+}
+
+}  // namespace
+
+TEST(InputRing, RoundsCapacityUpToPowerOfTwo) {
+  EXPECT_EQ(InputRing(0).capacity(), 2u);
+  EXPECT_EQ(InputRing(5).capacity(), 8u);
+  EXPECT_EQ(InputRing(64).capacity(), 64u);
+}
+
+TEST(InputRing, RejectsPushWhenFullUntilDrained) {
+  InputRing ring(4);
+  for (uint16_t i = 0; i < 4; ++i) {
+    EXPECT_TRUE(ring.TryPush(Key(i, true)));
+  }
+  EXPECT_FALSE(ring.TryPush(Key(9, true)));
+  EXPECT_EQ(ring.Reserve(), 0u);
+
+  RecordingInputSink sink;
+  EXPECT_EQ(ring.Drain(sink, 3), 3u);
+  EXPECT_THAT(sink.events, ElementsAre("key 0 down", "key 1 down", "key 2 down"));
+  EXPECT_TRUE(ring.TryPush(Key(9, true)));
+  EXPECT_EQ(ring.Drain(sink), 2u);
+  EXPECT_EQ(sink.events.back(), "key 9 down");
+  EXPECT_TRUE(ring.IsEmpty());
+}
+
+TEST(InputRing, ReserveStopsAtTheWrapPoint) {
+  InputRing ring(8);
+  RecordingInputSink sink;
+  for (int i = 0; i < 6; ++i) {
+    ring.TryPush(Key(1, true));
+  }
+  ring.Drain(sink);
+
+  // Six slots are free but only two follow the write index before wrapping.
+  EXPECT_EQ(ring.WriteIndex(), 6u);
+  EXPECT_EQ(ring.Reserve(), 2u);
+
+  ring.slots()[6] = Key(6, true);
+  ring.slots()[7] = Key(7, true);
+  ring.Commit(2);
+  EXPECT_EQ(ring.WriteIndex(), 0u);
+  EXPECT_EQ(ring.Reserve(), 6u);
+}
+
+TEST(InputRing, UncommittedSlotsAreNotDelivered) {
+  InputRing ring(8);
+  ring.slots()[ring.WriteIndex()] = Key(1, true);
+
+  RecordingInputSink sink;
+  EXPECT_EQ(ring.Drain(sink), 0u);
+  ring.Commit(1);
+  EXPECT_EQ(ring.Drain(sink), 1u);
+  EXPECT_THAT(sink.events, ElementsAre("key 1 down"));
+}
+
+TEST(InputRing, DrainsPenMoveRunsAsBatches) {
+  InputRing ring(8);
+  ring.TryPush(PenMove(0, 0.1));
+  ring.TryPush(PenMove(0, 0.2));
+  ring.TryPush(Key(1, true));
+  ring.TryPush(PenMove(0, 0.3));
+  ring.TryPush(PenMove(1, 0.4));
+
+  PenRunRecordingSink sink;
+  EXPECT_EQ(ring.Drain(sink), 5u);
+  EXPECT_THAT(sink.events,
+              ElementsAre("pen run 2 screen=0", testing::StartsWith("pen move 0.1 "),
+                          testing::StartsWith("pen move 0.2 "), "key 1 down",
+                          "pen run 1 screen=0", testing::StartsWith("pen move 0.3 "),
+                          "pen run 1 screen=1", testing::StartsWith("pen move 0.4 ")));
+}
+
+TEST(InputRingConsumer, DeliversEveryRecordInOrderAcrossWraps) {
+  constexpr int kRecords = 20000;
+  InputRing ring(16);
+  RecordingInputSink sink;
+  {
+    // Zero spins so the consumer parks constantly and every wake-up path runs.
+    InputRingConsumer consumer(ring, sink, 0);
+    for (int i = 0; i < kRecords; ++i) {
+      while (!ring.TryPush(Key(static_cast<uint16_t>(i), (i & 1) == 0))) {
+        std::this_thread::yield();
+      }
+      consumer.Notify();
+    }
+    consumer.Stop();
+  }
+
+  ASSERT_EQ(sink.events.size(), static_cast<size_t>(kRecords));
+  for (int i = 0; i < kRecords; ++i) {
+    std::string expected = "key " + std::to_string(static_cast<uint16_t>(i)) +
+                           ((i & 1) == 0 ? " down" : " up");
+    ASSERT_EQ(sink.events[i], expected) << "at record " << i;
+  }
+}
+
+TEST(InputRingConsumer, StopDeliversCommittedRecords) {
+  InputRing ring(8);
+  RecordingInputSink sink;
+  InputRingConsumer consumer(ring, sink);
+  ring.TryPush(TouchMove(3, 0.5, 0.25));
+  consumer.Stop();
+  EXPECT_THAT(sink.events, ElementsAre("touch 3 move 0.5 0.25 screen=0"));
+}
+
+TEST(InputRingFfi, OpensOnlyOnceASinkIsSet) {
+  EXPECT_EQ(hardware_simulator_input_ring_open(8), nullptr);
+
+  RecordingInputSink sink;
+  SetInputRingSink(&sink);
+  HardwareSimulatorInputRing* ring = hardware_simulator_input_ring_open(8);
+  ASSERT_NE(ring, nullptr);
+  EXPECT_EQ(hardware_simulator_input_ring_open(64), ring);
+  EXPECT_EQ(hardware_simulator_input_ring_capacity(ring), 8u);
+
+  // What lib/input_ring.dart does: fill reserved slots, then commit them.
+  auto* slots = static_cast<InputRecord*>(hardware_simulator_input_ring_slots(ring));
+  ASSERT_GE(hardware_simulator_input_ring_reserve(ring), 2u);
+  uint32_t index = hardware_simulator_input_ring_write_index(ring);
+  slots[index] = Key(0x41, true);
+  slots[index + 1] = Key(0x41, false);
+  hardware_simulator_input_ring_commit(ring, 2);
+
+  hardware_simulator_input_ring_close(ring);
+  SetInputRingSink(nullptr);
+  EXPECT_THAT(sink.events, ElementsAre("key 65 down", "key 65 up"));
+}
+
+// Dart may still hold the handle and the slots when the plugin goes away.
+TEST(InputRingFfi, ClearingTheSinkDetachesTheRingUntilClosed) {
+  RecordingInputSink sink;
+  SetInputRingSink(&sink);
+  HardwareSimulatorInputRing* ring = hardware_simulator_input_ring_open(8);
+  ASSERT_NE(ring, nullptr);
+  auto* slots = static_cast<InputRecord*>(hardware_simulator_input_ring_slots(ring));
+  uint32_t index = hardware_simulator_input_ring_write_index(ring);
+  slots[index] = Key(0x41, true);
+  hardware_simulator_input_ring_commit(ring, 1);
+  SetInputRingSink(nullptr);
+  EXPECT_THAT(sink.events, ElementsAre("key 65 down"));
+  EXPECT_EQ(hardware_simulator_input_ring_open(8), nullptr);
+
+  EXPECT_EQ(hardware_simulator_input_ring_reserve(ring), 0u);
+  slots[hardware_simulator_input_ring_write_index(ring)] = Key(0x42, true);
+  hardware_simulator_input_ring_commit(ring, 1);
+  EXPECT_EQ(hardware_simulator_input_ring_capacity(ring), 8u);
+  hardware_simulator_input_ring_close(ring);
+  EXPECT_THAT(sink.events, ElementsAre("key 65 down"));
+
+  // A new sink gets a ring of its own.
+  RecordingInputSink next;
+  SetInputRingSink(&next);
+  HardwareSimulatorInputRing* reopened = hardware_simulator_input_ring_open(8);
+  ASSERT_NE(reopened, nullptr);
+  hardware_simulator_input_ring_close(reopened);
+  SetInputRingSink(nullptr);
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
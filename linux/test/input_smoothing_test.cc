@@ -0,0 +1,292 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include "gesture.h"
+#include "input_smoothing.h"
+#include "method_schema.h"
+#include "recording_input_sink.h"
+
+namespace hardware_simulator {
+namespace test {
+
+namespace {
+
+using std::chrono::milliseconds;
+using testing::DoubleNear;
+using testing::ElementsAre;
+
+struct Point {
+  double x;
+  double y;
+};
+
+// Records the position of every touch and pen call besides the event line.
+class PointSink : public RecordingInputSink {
+ public:
+  void TouchEvent(int screen_id, double x, double y, uint32_t touch_id,
+                  bool is_down) override {
+    points.push_back({x, y});
+    RecordingInputSink::TouchEvent(screen_id, x, y, touch_id, is_down);
+  }
+  void TouchMove(int screen_id, double x, double y,
+                 uint32_t touch_id) override {
+    points.push_back({x, y});
+    RecordingInputSink::TouchMove(screen_id, x, y, touch_id);
+  }
+  void PenEvent(int screen_id, double x, double y, bool is_down,
+                bool has_button, double pressure, double rotation,
+                double tilt) override {
+    points.push_back({x, y});
+    RecordingInputSink::PenEvent(screen_id, x, y, is_down, has_button,
+                                 pressure, rotation, tilt);
+  }
+  void PenMove(int screen_id, double x, double y, bool has_button,
+               double pressure, double rotation, double tilt) override {
+    points.push_back({x, y});
+    RecordingInputSink::PenMove(screen_id, x, y, has_button, pressure,
+                                rotation, tilt);
+  }
+
+  std::vector<Point> points;
+};
+
+// A SmoothingInputSink on a virtual clock.
+class SmoothingTest : public testing::Test {
+ protected:
+  SmoothingTest() : smoothing_(sink_, [this] { return now_; }) {}
+
+  void Advance(milliseconds delta) { now_ += delta; }
+
+  PointSink sink_;
+  SmoothingInputSink::TimePoint now_;
+  SmoothingInputSink smoothing_;
+};
+
+}  // namespace
+
+TEST(ParseSmoothedDevice, KnowsPenAndTouch) {
+  SmoothedDevice device;
+  ASSERT_TRUE(ParseSmoothedDevice("pen", &device));
+  EXPECT_EQ(device, SmoothedDevice::kPen);
+  ASSERT_TRUE(ParseSmoothedDevice("touch", &device));
+  EXPECT_EQ(device, SmoothedDevice::kTouch);
+  EXPECT_FALSE(ParseSmoothedDevice("mouse", &device));
+}
+
+TEST(MakeSmoothingParams, KeepsDefaultsForWhatIsLeftOut) {
+  SetInputSmoothingArgs args;
+  args.device = "touch";
+  args.beta = 7;
+  SmoothedDevice device;
+  OneEuroParams params;
+  ASSERT_TRUE(MakeSmoothingParams(args, &device, &params));
+  EXPECT_EQ(device, SmoothedDevice::kTouch);
+  EXPECT_EQ(params.min_cutoff_hz, OneEuroParams().min_cutoff_hz);
+  EXPECT_EQ(params.beta, 7);
+
+  args.min_cutoff_hz = 0;
+  EXPECT_FALSE(MakeSmoothingParams(args, &device, &params));
+  args.min_cutoff_hz = 1;
+  args.beta = -1;
+  EXPECT_FALSE(MakeSmoothingParams(args, &device, &params));
+  args.beta = 0;
+  args.device = "mouse";
+  EXPECT_FALSE(MakeSmoothingParams(args, &device, &params));
+}
+
+TEST_F(SmoothingTest, PassesThroughUntilEnabled) {
+  smoothing_.TouchEvent(0, 0.5, 0.5, 1, true);
+  Advance(milliseconds(10));
+  smoothing_.TouchMove(0, 0.6, 0.5, 1);
+  smoothing_.PenMove(1, 0.2, 0.3, false, 0.5, 0, 0);
+  smoothing_.MouseMoveAbsolute(0.1, 0.1, 0);
+
+  EXPECT_THAT(sink_.events,
+              ElementsAre("touch 1 down 0.5 0.5 screen=0",
+                          "touch 1 move 0.6 0.5 screen=0",
+                          "pen move 0.2 0.3 screen=1 button=0 pressure=0.5 "
+                          "rotation=0 tilt=0",
+                          "move_abs 0.1 0.1 screen=0"));
+}
+
+TEST_F(SmoothingTest, StillContactsStaySteadyThroughJitter) {
+  smoothing_.Enable(SmoothedDevice::kTouch, OneEuroParams());
+  smoothing_.TouchEvent(0, 0.5, 0.5, 1, true);
+  for (int i = 1; i <= 100; ++i) {
+    Advance(milliseconds(10));
+    smoothing_.TouchMove(0, 0.5 + (i % 2 ? 0.002 : -0.002), 0.5, 1);
+  }
+
+  ASSERT_EQ(sink_.points.size(), 101u);
+  EXPECT_EQ(sink_.points[0].x, 0.5);
+  for (size_t i = 50; i < sink_.points.size(); ++i) {
+    EXPECT_THAT(sink_.points[i].x, DoubleNear(0.5, 0.0005));
+  }
+}
+
+TEST_F(SmoothingTest, BetaKeepsFastStrokesClose) {
+  OneEuroParams fixed_cutoff;
+  fixed_cutoff.beta = 0;
+  double lag[2];
+  for (int run = 0; run < 2; ++run) {
+    smoothing_.Enable(SmoothedDevice::kPen,
+                      run == 0 ? fixed_cutoff : OneEuroParams());
+    sink_.points.clear();
+    // One screen per second, sampled at 100 Hz.
+    for (int i = 0; i <= 50; ++i) {
+      Advance(milliseconds(10));
+      smoothing_.PenMove(0, i * 0.01, 0.5, false, 0.5, 0, 0);
+    }
+    lag[run] = 0.5 - sink_.points.back().x;
+  }
+
+  EXPECT_GT(lag[0], 0.05);
+  EXPECT_LT(lag[1], lag[0] / 4);
+}
+
+// Samples that a stalled link delivers in a burst step the filter by the
+// usual interval, not by the near-zero time between their arrivals.
+TEST_F(SmoothingTest, StepsBurstsByTheAverageInterval) {
+  smoothing_.Enable(SmoothedDevice::kPen, OneEuroParams());
+  PointSink steady_sink;
+  SmoothingInputSink::TimePoint steady_now = now_;
+  SmoothingInputSink steady(steady_sink, [&steady_now] { return steady_now; });
+  steady.Enable(SmoothedDevice::kPen, OneEuroParams());
+  for (int i = 0; i < 60; ++i) {
+    double x = 0.1 + 0.004 * i;
+    steady.PenMove(0, x, 0.5, false, 0.5, -1, -1);
+    steady_now += milliseconds(8);
+    // The link stalls for 40 ms every 20 samples, then catches up.
+    if (i % 20 < 15) {
+      smoothing_.PenMove(0, x, 0.5, false, 0.5, -1, -1);
+      Advance(milliseconds(8));
+      continue;
+    }
+    smoothing_.PenMove(0, x, 0.5, false, 0.5, -1, -1);
+    if (i % 20 == 19) {
+      Advance(milliseconds(40));
+    }
+  }
+
+  ASSERT_EQ(sink_.points.size(), 60u);
+  for (size_t i = 0; i < 60; ++i) {
+    EXPECT_THAT(sink_.points[i].x, DoubleNear(steady_sink.points[i].x, 0.01));
+  }
+}
+
+TEST_F(SmoothingTest, LiftsWhereTheFilteredContactIs) {
+  smoothing_.Enable(SmoothedDevice::kTouch, OneEuroParams());
+  smoothing_.TouchEvent(0, 0.2, 0.2, 7, true);
+  Advance(milliseconds(10));
+  smoothing_.TouchMove(0, 0.3, 0.2, 7);
+  Advance(milliseconds(10));
+  smoothing_.TouchEvent(0, 0.3, 0.2, 7, false);
+  Advance(milliseconds(10));
+  smoothing_.TouchEvent(0, 0.9, 0.9, 7, true);
+
+  ASSERT_EQ(sink_.points.size(), 4u);
+  EXPECT_GT(sink_.points[1].x, 0.2);
+  EXPECT_LT(sink_.points[1].x, 0.3);
+  EXPECT_GT(sink_.points[2].x, sink_.points[1].x);
+  EXPECT_LT(sink_.points[2].x, 0.3);
+  // A new down starts over where it lands.
+  EXPECT_EQ(sink_.points[3].x, 0.9);
+}
+
+TEST_F(SmoothingTest, GestureContactsPassThrough) {
+  smoothing_.Enable(SmoothedDevice::kTouch, OneEuroParams());
+  TouchUpdate update;
+  update.touch_id = kGestureTouchIdBase;
+  update.type = TouchUpdateType::kDown;
+  update.x = 0.1;
+  smoothing_.TouchFrame(&update, 1);
+  Advance(milliseconds(10));
+  update.type = TouchUpdateType::kMove;
+  update.x = 0.4;
+  smoothing_.TouchFrame(&update, 1);
+
+  ASSERT_EQ(sink_.points.size(), 2u);
+  EXPECT_EQ(sink_.points[1].x, 0.4);
+}
+
+TEST_F(SmoothingTest, DisablingPassesThroughAgain) {
+  smoothing_.Enable(SmoothedDevice::kPen, OneEuroParams());
+  smoothing_.PenMove(0, 0.1, 0.1, false, 0.5, 0, 0);
+  Advance(milliseconds(10));
+  smoothing_.Disable(SmoothedDevice::kPen);
+  smoothing_.PenMove(0, 0.4, 0.1, false, 0.5, 0, 0);
+
+  ASSERT_EQ(sink_.points.size(), 2u);
+  EXPECT_EQ(sink_.points[1].x, 0.4);
+}
+
+// With no earlier arrival to spread it over, a first batch is timed as
+// samples arriving together.
+TEST_F(SmoothingTest, SmoothsPenBatchesLikeSamplesArrivingTogether) {
+  OneEuroParams params;
+  smoothing_.Enable(SmoothedDevice::kPen, params);
+  PenSample samples[100];
+  for (int i = 0; i < 100; ++i) {
+    samples[i].x = 0.1 + 0.003 * i;
+    samples[i].y = 0.5 + (i % 2 ? 0.001 : 0);
+  }
+  smoothing_.PenMoveBatch(0, samples, 100);
+
+  PointSink single_sink;
+  SmoothingInputSink::TimePoint now;
+  SmoothingInputSink single(single_sink, [&now] { return now; });
+  single.Enable(SmoothedDevice::kPen, params);
+  for (const PenSample& sample : samples) {
+    single.PenMove(0, sample.x, sample.y, false, 0, -1, -1);
+  }
+
+  ASSERT_EQ(sink_.points.size(), 100u);
+  ASSERT_EQ(single_sink.points.size(), 100u);
+  for (size_t i = 0; i < 100; ++i) {
+    EXPECT_DOUBLE_EQ(sink_.points[i].x, single_sink.points[i].x);
+    EXPECT_DOUBLE_EQ(sink_.points[i].y, single_sink.points[i].y);
+  }
+  EXPECT_LT(sink_.points.back().x, samples[99].x);
+}
+
+// A 100 Hz stroke the client batches 8 samples at a time, one batch every
+// 80 ms, is filtered like the same samples arriving one by one.
+TEST_F(SmoothingTest, SpreadsPenBatchesOverTheTimeSinceTheLastArrival) {
+  OneEuroParams params;
+  smoothing_.Enable(SmoothedDevice::kPen, params);
+  PointSink single_sink;
+  SmoothingInputSink::TimePoint single_now = now_;
+  SmoothingInputSink single(single_sink, [&single_now] { return single_now; });
+  single.Enable(SmoothedDevice::kPen, params);
+  PenSample samples[80];
+  for (int i = 0; i < 80; ++i) {
+    samples[i].x = 0.1 + 0.004 * i;
+    samples[i].y = 0.5;
+  }
+  // The first sample arrives alone and starts both filters.
+  smoothing_.PenMoveBatch(0, samples, 1);
+  single.PenMove(0, samples[0].x, samples[0].y, false, 0, -1, -1);
+  for (int batch = 0; batch < 10; ++batch) {
+    const PenSample* run = samples + 1 + batch * 8;
+    size_t size = batch < 9 ? 8 : 7;
+    for (size_t i = 0; i < size; ++i) {
+      single_now += milliseconds(10);
+      single.PenMove(0, run[i].x, run[i].y, false, 0, -1, -1);
+    }
+    Advance(milliseconds(10 * size));
+    smoothing_.PenMoveBatch(0, run, size);
+  }
+
+  ASSERT_EQ(sink_.points.size(), 80u);
+  ASSERT_EQ(single_sink.points.size(), 80u);
+  for (size_t i = 0; i < 80; ++i) {
+    EXPECT_THAT(sink_.points[i].x, DoubleNear(single_sink.points[i].x, 1e-9));
+  }
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
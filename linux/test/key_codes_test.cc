@@ -0,0 +1,127 @@
+#include <X11/XF86keysym.h>
+#include <X11/keysym.h>
+#include <gtest/gtest.h>
+#include <linux/input-event-codes.h>
+
+#include <map>
+#include <utility>
+
+#include "key_codes.h"
+
+namespace hardware_simulator {
+namespace test {
+
+// The tables against the system's own definitions, one key from each group.
+static_assert(KeyCodesFor(0x41).scancode == 0x1E, "A");
+static_assert(KeyCodesFor(0x41).evdev == KEY_A, "A");
+static_assert(KeyCodesFor(0x41).keysym == XK_a, "A");
+static_assert(KeyCodesFor(0x41).hid_usage == 0x04, "A");
+static_assert(KeyCodesFor(0x41).layout_dependent(), "A");
+static_assert(KeyCodesFor(0x5A).evdev == KEY_Z, "Z");
+static_assert(KeyCodesFor(0x5A).hid_usage == 0x1D, "Z");
+static_assert(KeyCodesFor(0x30).evdev == KEY_0, "0");
+static_assert(KeyCodesFor(0x30).hid_usage == 0x27, "0");
+static_assert(KeyCodesFor(0x31).evdev == KEY_1, "1");
+static_assert(KeyCodesFor(0x0D).evdev == KEY_ENTER, "VK_RETURN");
+static_assert(KeyCodesFor(0x0D).keysym == XK_Return, "VK_RETURN");
+static_assert(KeyCodesFor(0x13).scancode == 0, "VK_PAUSE has no single scancode");
+static_assert(KeyCodesFor(0x13).evdev == KEY_PAUSE, "VK_PAUSE");
+static_assert(KeyCodesFor(0x13).listed(), "VK_PAUSE");
+static_assert(!KeyCodesFor(0x07).listed(), "0x07 is unassigned");
+static_assert(KeyCodesFor(0x25).extended(), "VK_LEFT");
+static_assert(KeyCodesFor(0x25).evdev == KEY_LEFT, "VK_LEFT");
+static_assert(KeyCodesFor(0x25).keysym == XK_Left, "VK_LEFT");
+static_assert(KeyCodesFor(0x2E).keysym == XK_Delete, "VK_DELETE");
+static_assert(KeyCodesFor(0x5B).extended(), "VK_LWIN");
+static_assert(KeyCodesFor(0x5B).evdev == KEY_LEFTMETA, "VK_LWIN");
+static_assert(KeyCodesFor(0x5D).evdev == KEY_COMPOSE, "VK_APPS");
+static_assert(KeyCodesFor(0x60).evdev == KEY_KP0, "VK_NUMPAD0");
+static_assert(KeyCodesFor(0x60).keysym == XK_KP_0, "VK_NUMPAD0");
+static_assert(KeyCodesFor(0x69).evdev == KEY_KP9, "VK_NUMPAD9");
+static_assert(KeyCodesFor(0x6F).extended(), "VK_DIVIDE");
+static_assert(KeyCodesFor(0x6F).evdev == KEY_KPSLASH, "VK_DIVIDE");
+static_assert(KeyCodesFor(0x70).evdev == KEY_F1, "VK_F1");
+static_assert(KeyCodesFor(0x70).keysym == XK_F1, "VK_F1");
+static_assert(KeyCodesFor(0x7B).evdev == KEY_F12, "VK_F12");
+static_assert(KeyCodesFor(0x87).evdev == KEY_F24, "VK_F24");
+static_assert(KeyCodesFor(0x87).keysym == XK_F24, "VK_F24");
+static_assert(KeyCodesFor(0x87).hid_usage == 0x73, "VK_F24");
+static_assert(KeyCodesFor(0xA3).extended(), "VK_RCONTROL");
+static_assert(KeyCodesFor(0xA3).evdev == KEY_RIGHTCTRL, "VK_RCONTROL");
+static_assert(KeyCodesFor(0xA5).keysym == XK_Alt_R, "VK_RMENU");
+static_assert(KeyCodesFor(0xAD).evdev == KEY_MUTE, "VK_VOLUME_MUTE");
+static_assert(KeyCodesFor(0xAD).keysym == XF86XK_AudioMute, "VK_VOLUME_MUTE");
+static_assert(KeyCodesFor(0xB3).evdev == KEY_PLAYPAUSE, "VK_MEDIA_PLAY_PAUSE");
+static_assert(KeyCodesFor(0xBA).evdev == KEY_SEMICOLON, "VK_OEM_1");
+static_assert(KeyCodesFor(0xC0).keysym == XK_grave, "VK_OEM_3");
+static_assert(KeyCodesFor(0xE2).evdev == KEY_102ND, "VK_OEM_102");
+static_assert(KeyCodesFor(0x00).evdev == 0 && KeyCodesFor(0x00).keysym == 0,
+              "Unmapped codes are all zero");
+static_assert(KeyCodesFor(0x1234).evdev == 0, "Out of range codes are unmapped");
+static_assert(VirtualKeyForKeysym(XK_a) == 0x41, "XK_a");
+static_assert(VirtualKeyForKeysym(XK_Super_L) == 0x5B, "XK_Super_L");
+static_assert(VirtualKeyForKeysym(XK_Shift_L) == 0xA0, "Sided, not VK_SHIFT");
+static_assert(VirtualKeyForKeysym(XK_Alt_L) == 0xA4, "Sided, not VK_MENU");
+static_assert(VirtualKeyForKeysym(XF86XK_AudioMute) == 0xAD, "XF86XK_AudioMute");
+static_assert(VirtualKeyForKeysym(XK_A) == 0, "Shifted keysyms are not looked up");
+static_assert(VirtualKeyForKeysym(0) == 0, "NoSymbol");
+
+TEST(KeyCodes, EveryEntryHasALinuxEquivalent) {
+  for (const auto& entry : key_codes::kEntries) {
+    const KeyCodes& codes = KeyCodesFor(entry.vk);
+    EXPECT_NE(codes.evdev, 0) << std::hex << int(entry.vk);
+    EXPECT_NE(codes.keysym, 0u) << std::hex << int(entry.vk);
+  }
+}
+
+TEST(KeyCodes, KeysymsMapBackToTheirKey) {
+  for (const auto& entry : key_codes::kEntries) {
+    uint8_t vk = VirtualKeyForKeysym(entry.keysym);
+    // Neutral modifiers come back as their left key.
+    EXPECT_EQ(KeyCodesFor(vk).keysym, entry.keysym) << std::hex << int(entry.vk);
+    if (entry.vk != 0x10 && entry.vk != 0x11 && entry.vk != 0x12) {
+      EXPECT_EQ(vk, entry.vk) << std::hex << int(entry.vk);
+    }
+  }
+}
+
+// Below the multimedia range, evdev codes were assigned as the set-1 make
+// codes of the non-extended keys.
+TEST(KeyCodes, EvdevMatchesTheScancodeOfBasicKeys) {
+  for (const auto& entry : key_codes::kEntries) {
+    const KeyCodes& codes = KeyCodesFor(entry.vk);
+    if (!codes.extended() && codes.scancode != 0 && codes.scancode < 0x59) {
+      EXPECT_EQ(codes.evdev, codes.scancode) << std::hex << int(entry.vk);
+    }
+  }
+}
+
+// Two virtual-key codes may only share a physical key when one is the
+// left/right-neutral alias of the other (VK_SHIFT and VK_LSHIFT, ...).
+TEST(KeyCodes, PhysicalKeysAreUniqueApartFromNeutralModifiers) {
+  const std::map<uint8_t, uint8_t> aliases = {
+      {0x10, 0xA0}, {0x11, 0xA2}, {0x12, 0xA4}};
+  std::map<std::pair<uint16_t, bool>, uint8_t> by_scancode;
+  std::map<uint16_t, uint8_t> by_evdev;
+  for (const auto& entry : key_codes::kEntries) {
+    auto alias = aliases.find(entry.vk);
+    if (alias != aliases.end()) {
+      EXPECT_EQ(KeyCodesFor(entry.vk).evdev, KeyCodesFor(alias->second).evdev);
+      continue;
+    }
+    const KeyCodes& codes = KeyCodesFor(entry.vk);
+    if (codes.scancode != 0) {
+      auto inserted = by_scancode.emplace(
+          std::make_pair(codes.scancode, codes.extended()), entry.vk);
+      EXPECT_TRUE(inserted.second)
+          << std::hex << int(entry.vk) << " and "
+          << int(inserted.first->second);
+    }
+    auto inserted = by_evdev.emplace(codes.evdev, entry.vk);
+    EXPECT_TRUE(inserted.second)
+        << std::hex << int(entry.vk) << " and " << int(inserted.first->second);
+  }
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
@@ -0,0 +1,168 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+// After gtest: Xlib defines None, which gtest uses as a name.
+#include <X11/Xlib.h>
+#include <X11/extensions/XTest.h>
+#include <X11/keysym.h>
+
+#include "keyboard_grab.h"
+
+// These drive a real X server with XTest keys, e.g. under Xvfb:
+// $ xvfb-run build/linux/x64/debug/plugins/hardware_simulator/hardware_simulator_test
+// Without a display they are skipped.
+
+namespace hardware_simulator {
+namespace test {
+
+namespace {
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+class KeyboardGrabTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    display_ = XOpenDisplay(nullptr);
+    if (display_ == nullptr) {
+      GTEST_SKIP() << "No X display";
+    }
+    int event_base, error_base, major, minor;
+    if (!XTestQueryExtension(display_, &event_base, &error_base, &major,
+                             &minor)) {
+      GTEST_SKIP() << "No XTest extension";
+    }
+    window_ = CreateFocusedWindow();
+  }
+
+  void TearDown() override {
+    if (display_ != nullptr) {
+      XCloseDisplay(display_);
+    }
+  }
+
+  Window CreateFocusedWindow() {
+    Window window = XCreateSimpleWindow(display_, DefaultRootWindow(display_),
+                                        0, 0, 64, 64, 0, 0, 0);
+    XSelectInput(display_, window, StructureNotifyMask);
+    XMapWindow(display_, window);
+    XEvent event;
+    do {
+      XNextEvent(display_, &event);
+    } while (event.type != MapNotify || event.xmap.window != window);
+    XSetInputFocus(display_, window, RevertToParent, CurrentTime);
+    XSync(display_, False);
+    return window;
+  }
+
+  void Key(KeySym keysym, bool is_down) {
+    XTestFakeKeyEvent(display_, XKeysymToKeycode(display_, keysym), is_down,
+                      CurrentTime);
+  }
+
+  // Runs the events that arrived through |grab|; returns the keys it let
+  // through, e.g. "a down".
+  std::vector<std::string> Pump(KeyboardGrab& grab) {
+    XSync(display_, False);
+    std::vector<std::string> passed;
+    while (XPending(display_) > 0) {
+      XEvent event;
+      XNextEvent(display_, &event);
+      if (!grab.FilterEvent(&event) &&
+          (event.type == KeyPress || event.type == KeyRelease)) {
+        passed.push_back(
+            std::string(XKeysymToString(XLookupKeysym(&event.xkey, 0))) +
+            (event.type == KeyPress ? " down" : " up"));
+      }
+    }
+    return passed;
+  }
+
+  KeyboardGrab::BlockedKeyCallback Recorder() {
+    return [this](uint8_t vk, bool is_down) {
+      blocked_.push_back(std::to_string(vk) + (is_down ? " down" : " up"));
+    };
+  }
+
+  Display* display_ = nullptr;
+  Window window_ = None;
+  std::vector<std::string> blocked_;
+};
+
+}  // namespace
+
+TEST_F(KeyboardGrabTest, CapturesShortcutsWhileFocused) {
+  KeyboardGrab grab(display_, window_, Recorder());
+  grab.Enable();
+  EXPECT_TRUE(grab.grabbed());
+
+  Key(XK_Super_L, true);
+  Key(XK_Super_L, false);
+  Key(XK_Alt_L, true);
+  Key(XK_Tab, true);
+  Key(XK_Tab, false);
+  Key(XK_Alt_L, false);
+  Key(XK_a, true);
+  Key(XK_a, false);
+  EXPECT_THAT(Pump(grab), ElementsAre("a down", "a up"));
+  EXPECT_THAT(blocked_, ElementsAre("91 down", "91 up", "164 down", "9 down",
+                                    "9 up", "164 up"));
+}
+
+TEST_F(KeyboardGrabTest, FollowsTheConfiguredRules) {
+  KeyboardGrab grab(display_, window_, Recorder());
+  ASSERT_TRUE(grab.policy().SetRules({{0x41, kShortcutCtrl}}));
+  grab.Enable();
+
+  Key(XK_Super_L, true);
+  Key(XK_Super_L, false);
+  Key(XK_Control_L, true);
+  Key(XK_a, true);
+  Key(XK_a, false);
+  Key(XK_Control_L, false);
+  EXPECT_THAT(Pump(grab), ElementsAre("Super_L down", "Super_L up",
+                                      "Control_L down", "Control_L up"));
+  EXPECT_THAT(blocked_, ElementsAre("65 down", "65 up"));
+}
+
+TEST_F(KeyboardGrabTest, LetsGoWhenFocusMovesAway) {
+  KeyboardGrab grab(display_, window_, Recorder());
+  grab.Enable();
+  Key(XK_Super_L, true);
+  Pump(grab);
+  ASSERT_THAT(blocked_, ElementsAre("91 down"));
+
+  // The held key is reported released; the other window gets the rest.
+  Window other = CreateFocusedWindow();
+  Pump(grab);
+  EXPECT_FALSE(grab.grabbed());
+  EXPECT_THAT(blocked_, ElementsAre("91 down", "91 up"));
+  Key(XK_Super_L, false);
+  Pump(grab);
+  EXPECT_THAT(blocked_, ElementsAre("91 down", "91 up"));
+
+  // Back in focus, the grab is taken again.
+  XSetInputFocus(display_, window_, RevertToParent, CurrentTime);
+  Pump(grab);
+  EXPECT_TRUE(grab.grabbed());
+  XDestroyWindow(display_, other);
+}
+
+TEST_F(KeyboardGrabTest, DisablingReleasesTheKeyboard) {
+  KeyboardGrab grab(display_, window_, Recorder());
+  grab.Enable();
+  ASSERT_TRUE(grab.grabbed());
+  grab.Disable();
+  EXPECT_FALSE(grab.grabbed());
+
+  Key(XK_Super_L, true);
+  Key(XK_Super_L, false);
+  EXPECT_THAT(Pump(grab), ElementsAre("Super_L down", "Super_L up"));
+  EXPECT_THAT(blocked_, IsEmpty());
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
@@ -0,0 +1,54 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "locked_input_sink.h"
+#include "recording_input_sink.h"
+
+namespace hardware_simulator {
+namespace test {
+
+namespace {
+
+using testing::ElementsAre;
+
+constexpr int kCallsPerThread = 20000;
+
+}  // namespace
+
+TEST(LockedInputSink, PassesFramesAndBatchesOnWhole) {
+  FrameRecordingSink sink;
+  LockedInputSink locked(sink);
+  TouchUpdate updates[2];
+  updates[0].type = TouchUpdateType::kDown;
+  updates[0].touch_id = 1;
+  updates[1].type = TouchUpdateType::kDown;
+  updates[1].touch_id = 2;
+  locked.TouchFrame(updates, 2);
+  locked.KeyEvent(0x41, true);
+
+  EXPECT_THAT(sink.events,
+              ElementsAre("touch frame 2", "touch 1 down 0 0 screen=0",
+                          "touch 2 down 0 0 screen=0", "key 65 down"));
+}
+
+// RecordingInputSink is not thread-safe: without the lock, the two threads'
+// push_backs would lose events or corrupt the vector.
+TEST(LockedInputSink, SerializesCallsFromSeveralThreads) {
+  RecordingInputSink sink;
+  LockedInputSink locked(sink);
+  auto press = [&locked](uint16_t key) {
+    for (int i = 0; i < kCallsPerThread; ++i) {
+      locked.KeyEvent(key, (i & 1) == 0);
+    }
+  };
+  std::thread other(press, 0x42);
+  press(0x41);
+  other.join();
+
+  EXPECT_EQ(sink.events.size(), 2u * kCallsPerThread);
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "method_args.h"
+#include "method_schema.h"
+
+namespace hardware_simulator {
+namespace test {
+
+namespace {
+
+// Same scalar alternatives, in the same order, as flutter::EncodableValue,
+// which is only part of the Windows embedding.
+struct Value : std::variant<std::monostate, bool, int32_t, int64_t, double, std::string> {
+  using variant::variant;
+  Value(const char* s) : variant(std::string(s)) {}
+};
+using ValueMap = std::map<Value, Value>;
+
+// With the typed list alternatives that EncodableValue also has.
+struct ListValue : std::variant<std::monostate, bool, int32_t, int64_t, double,
+                                std::string, std::vector<int32_t>,
+                                std::vector<double>> {
+  using variant::variant;
+  ListValue(const char* s) : variant(std::string(s)) {}
+};
+using ListValueMap = std::map<ListValue, ListValue>;
+
+}  // namespace
+
+TEST(MethodArgs, DecodesEveryField) {
+  ValueMap map = {{"screenId", 2},      {"x", 0.25},       {"y", 0.75},
+                  {"isDown", true},     {"hasButton", false}, {"pressure", 0.5},
+                  {"rotation", 90.0},   {"tilt", 30.0}};
+  PenEventArgs args;
+  ArgError error = DecodeVariantMapArgs(&map, &args);
+  ASSERT_TRUE(error.ok()) << error.Message();
+  EXPECT_EQ(args.screen_id, 2);
+  EXPECT_EQ(args.x, 0.25);
+  EXPECT_EQ(args.y, 0.75);
+  EXPECT_TRUE(args.is_down);
+  EXPECT_FALSE(args.has_button);
+  EXPECT_EQ(args.pressure, 0.5);
+  EXPECT_EQ(args.rotation, 90.0);
+  EXPECT_EQ(args.tilt, 30.0);
+}
+
+TEST(MethodArgs, ReportsNullArguments) {
+  KeyPressArgs args;
+  ArgError error = DecodeVariantMapArgs(static_cast<const ValueMap*>(nullptr), &args);
+  EXPECT_EQ(error.code, ArgErrorCode::kNotAMap);
+  EXPECT_STREQ(ArgErrorCodeName(error.code), "NullArguments");
+}
+
+TEST(MethodArgs, ReportsFirstMissingRequiredKey) {
+  ValueMap map = {{"code", 65}};
+  KeyPressArgs args;
+  ArgError error = DecodeVariantMapArgs(&map, &args);
+  EXPECT_EQ(error.code, ArgErrorCode::kMissing);
+  EXPECT_EQ(error.key, "isDown");
+  EXPECT_EQ(error.Message(), "Missing argument 'isDown'");
+  EXPECT_STREQ(ArgErrorCodeName(error.code), "MissingArgument");
+}
+
+TEST(MethodArgs, ReportsWrongType) {
+  ValueMap map = {{"code", "A"}, {"isDown", true}};
+  KeyPressArgs args;
+  ArgError error = DecodeVariantMapArgs(&map, &args);
+  EXPECT_EQ(error.code, ArgErrorCode::kWrongType);
+  EXPECT_EQ(error.key, "code");
+}
+
+TEST(MethodArgs, WidensIntegersButRejectsOverflow) {
+  ValueMap map = {{"x", 3}, {"y", int64_t{-4}}};
+  MouseXYArgs xy;
+  ASSERT_TRUE(DecodeVariantMapArgs(&map, &xy).ok());
+  EXPECT_EQ(xy.x, 3.0);
+  EXPECT_EQ(xy.y, -4.0);
+
+  ValueMap big = {{"code", int64_t{1} << 40}, {"isDown", false}};
+  KeyPressArgs key;
+  ArgError error = DecodeVariantMapArgs(&big, &key);
+  EXPECT_EQ(error.code, ArgErrorCode::kOutOfRange);
+  EXPECT_EQ(error.key, "code");
+}
+
+TEST(MethodArgs, DoesNotTreatDoublesAsIntegersOrBools) {
+  ValueMap map = {{"buttonId", 1.0}, {"isDown", 1}};
+  MousePressArgs args;
+  EXPECT_EQ(DecodeVariantMapArgs(&map, &args).code, ArgErrorCode::kWrongType);
+}
+
+TEST(MethodArgs, OptionalKeysKeepDefaultsAndUnknownKeysAreIgnored) {
+  ValueMap map = {{"includeButtonsAndWheel", true}, {"futureKey", 1}, {7, 8}};
+  SetCursorMovedCoalescingArgs args;
+  args.rate_hz = 120;
+  ArgError error = DecodeVariantMapArgs(&map, &args);
+  ASSERT_TRUE(error.ok());
+  EXPECT_EQ(args.rate_hz, 120);
+  EXPECT_TRUE(args.include_buttons_and_wheel);
+}
+
+TEST(MethodArgs, DecodesStrings) {
+  ValueMap map = {{"id", 1}, {"action", "a_down"}};
+  DoControlActionArgs args;
+  ASSERT_TRUE(DecodeVariantMapArgs(&map, &args).ok());
+  EXPECT_EQ(args.id, 1);
+  EXPECT_EQ(args.action, "a_down");
+}
+
+TEST(MethodArgs, DecodesTypedLists) {
+  ListValueMap map = {{"keyMap", std::vector<int32_t>{65, 66, 0, 0, 0}},
+                      {"sensitivityX", 2},
+                      {"curve", std::vector<double>{0, 1, 10, 2}}};
+  InputRemapArgs args;
+  ASSERT_TRUE(DecodeVariantMapArgs(&map, &args).ok());
+  EXPECT_EQ(args.key_map, (std::vector<int32_t>{65, 66, 0, 0, 0}));
+  EXPECT_TRUE(args.button_map.empty());
+  EXPECT_EQ(args.sensitivity_x, 2.0);
+  EXPECT_EQ(args.curve, (std::vector<double>{0, 1, 10, 2}));
+
+  ListValueMap wrong = {{"buttonMap", std::vector<double>{1, 3}}};
+  EXPECT_EQ(DecodeVariantMapArgs(&wrong, &args).code, ArgErrorCode::kWrongType);
+  // A variant without list alternatives rejects them as any other type.
+  ValueMap scalar = {{"keyMap", 65}};
+  EXPECT_EQ(DecodeVariantMapArgs(&scalar, &args).code, ArgErrorCode::kWrongType);
+}
+
+// The display calls used to read their maps with std::get, which throws on
+// a wrong type.
+TEST(MethodArgs, DecodesDisplayCallsWithoutThrowing) {
+  ValueMap mode = {{"mode", 2}};
+  MultiDisplayModeArgs multi;
+  ASSERT_TRUE(DecodeVariantMapArgs(&mode, &multi).ok());
+  EXPECT_EQ(multi.mode, 2);
+  EXPECT_EQ(multi.primary_display_id, 0);
+
+  ValueMap wrong = {{"displayUid", "1"}, {"orientation", 1}};
+  DisplayOrientationArgs orientation;
+  ArgError error = DecodeVariantMapArgs(&wrong, &orientation);
+  EXPECT_EQ(error.code, ArgErrorCode::kWrongType);
+  EXPECT_EQ(error.key, "displayUid");
+
+  ValueMap partial = {{"displayUid", 1}, {"width", 1920}, {"height", 1080}};
+  ChangeDisplaySettingsArgs settings;
+  EXPECT_EQ(DecodeVariantMapArgs(&partial, &settings).code, ArgErrorCode::kMissing);
+
+  ListValueMap triples = {{"configs", std::vector<int32_t>{1920, 1080, 60}}};
+  CustomDisplayConfigsArgs custom;
+  ASSERT_TRUE(DecodeVariantMapArgs(&triples, &custom).ok());
+  EXPECT_EQ(custom.configs, (std::vector<int32_t>{1920, 1080, 60}));
+}
+
+TEST(MethodArgs, SchemaKeysAreResolvedAtCompileTime) {
+  static_assert(ArgsDecoder<PenMoveArgs>::kFieldCount == 7, "");
+  static_assert(std::get<3>(ArgsDecoder<PenMoveArgs>::kFields).key == "hasButton", "");
+  static_assert(!std::get<0>(ArgsDecoder<SetCursorMovedCoalescingArgs>::kFields).required, "");
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+
+#include <set>
+#include <string>
+
+#include "method_dispatch.h"
+
+namespace hardware_simulator {
+namespace test {
+
+// The table is resolved at compile time, so lookups can be checked there too.
+static_assert(LookupMethod("mouseMoveR") == MethodId::kMouseMoveR);
+static_assert(LookupMethod("touchMove") == MethodId::kTouchMove);
+static_assert(LookupMethod("") == MethodId::kUnknown);
+
+TEST(MethodDispatch, ResolvesEveryRegisteredMethod) {
+  for (const auto& entry : method_dispatch::kMethods) {
+    EXPECT_EQ(LookupMethod(entry.name), entry.id) << entry.name;
+  }
+}
+
+TEST(MethodDispatch, MethodIdsAreUnique) {
+  std::set<MethodId> ids;
+  for (const auto& entry : method_dispatch::kMethods) {
+    EXPECT_NE(entry.id, MethodId::kUnknown) << entry.name;
+    EXPECT_TRUE(ids.insert(entry.id).second) << entry.name;
+  }
+}
+
+TEST(MethodDispatch, RejectsUnknownNames) {
+  EXPECT_EQ(LookupMethod("keyPress"), MethodId::kUnknown);
+  EXPECT_EQ(LookupMethod("mouseMove"), MethodId::kUnknown);
+  EXPECT_EQ(LookupMethod("touchMoveX"), MethodId::kUnknown);
+  EXPECT_EQ(LookupMethod("notAMethod"), MethodId::kUnknown);
+}
+
+TEST(MethodDispatch, AcceptsNonTerminatedNames) {
+  std::string buffer = "penMoveGarbage";
+  EXPECT_EQ(LookupMethod(std::string_view(buffer.data(), 7)), MethodId::kPenMove);
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
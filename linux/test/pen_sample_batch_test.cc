@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "pen_sample_batch.h"
+#include "pen_tilt.h"
+
+namespace hardware_simulator {
+namespace test {
+
+namespace {
+
+constexpr double kDegreesPerRadian = 57.29577951308232;
+
+// PenTiltFromPolar's angles before truncation.
+void ExactTilt(double rotation, double tilt, double* tilt_x, double* tilt_y) {
+  double r = -rotation / kDegreesPerRadian;
+  double t = tilt / kDegreesPerRadian;
+  *tilt_x = std::atan2(std::sin(r) * std::sin(t), std::cos(t)) * kDegreesPerRadian;
+  *tilt_y = std::atan2(std::cos(r) * std::sin(t), std::cos(t)) * kDegreesPerRadian;
+}
+
+ScreenTransform TwoScreens() {
+  ScreenMetrics metrics;
+  metrics.primary_width = 1920;
+  metrics.primary_height = 1080;
+  metrics.virtual_width = 65535;
+  metrics.virtual_height = 65535;
+  return ScreenTransform(
+      {{0, 0, 1920, 1080, true}, {1920, 0, 3840, 1080, false}}, metrics);
+}
+
+}  // namespace
+
+TEST(PenSampleBatch, TiltStaysWithinAHundredthOfADegree) {
+  std::vector<float> rotation;
+  std::vector<float> tilt;
+  // Short of 90, where the exact projection divides rounding error by a
+  // cosine of about 1e-16 and is no reference.
+  for (int r = 0; r <= 3600; r += 5) {
+    for (int t = 0; t < 900; t += 5) {
+      rotation.push_back(r / 10.0f);
+      tilt.push_back(t / 10.0f);
+    }
+  }
+  std::vector<float> tilt_x(rotation.size());
+  std::vector<float> tilt_y(rotation.size());
+  PolarToTiltDegrees(rotation.data(), tilt.data(), rotation.size(),
+                     tilt_x.data(), tilt_y.data());
+
+  double max_error = 0;
+  for (size_t i = 0; i < rotation.size(); ++i) {
+    double exact_x;
+    double exact_y;
+    ExactTilt(rotation[i], tilt[i], &exact_x, &exact_y);
+    max_error = std::max(max_error, std::fabs(tilt_x[i] - exact_x));
+    max_error = std::max(max_error, std::fabs(tilt_y[i] - exact_y));
+  }
+  EXPECT_LT(max_error, 0.01);
+}
+
+TEST(PenSampleBatch, GivesNoTiltForInvalidSamples) {
+  // Seven samples, so both the four-wide kernel and the tail see some.
+  const float rotation[] = {90, -1, 361, 90, 90, NAN, 90};
+  const float tilt[] = {-1, 45, 45, 45, NAN, 45, -0.5f};
+  float tilt_x[7];
+  float tilt_y[7];
+  PolarToTiltDegrees(rotation, tilt, 7, tilt_x, tilt_y);
+  for (int i = 0; i < 7; ++i) {
+    if (i == 3) {
+      continue;
+    }
+    EXPECT_EQ(tilt_x[i], 0) << i;
+    EXPECT_EQ(tilt_y[i], 0) << i;
+  }
+  EXPECT_NEAR(tilt_x[3], -45, 0.01);
+  EXPECT_NEAR(tilt_y[3], 0, 0.01);
+}
+
+TEST(PenSampleBatch, MatchesThePerSampleConversion) {
+  ScreenTransform screens = TwoScreens();
+  std::vector<PenSample> samples;
+  for (int i = 0; i < 37; ++i) {
+    PenSample sample;
+    sample.x = i / 36.0;
+    sample.y = 1 - i / 36.0;
+    sample.pressure = i / 30.0f;
+    sample.rotation = i * 10.0f;
+    sample.tilt = i * 2.4f;
+    samples.push_back(sample);
+  }
+  ConvertedPenSamples converted;
+  ConvertPenSamples(*screens.VirtualDesktopMap(1), samples.data(), samples.size(),
+                    4095, &converted);
+
+  ASSERT_EQ(converted.size, samples.size());
+  for (size_t i = 0; i < samples.size(); ++i) {
+    int32_t x;
+    int32_t y;
+    ASSERT_TRUE(screens.ToVirtualDesktop(1, samples[i].x, samples[i].y, &x, &y));
+    EXPECT_EQ(converted.x[i], x) << i;
+    EXPECT_EQ(converted.y[i], y) << i;
+
+    PenTilt tilt;
+    PenTiltFromPolar(samples[i].rotation, samples[i].tilt, &tilt);
+    EXPECT_LE(std::abs(converted.tilt_x[i] - tilt.x), 1) << i;
+    EXPECT_LE(std::abs(converted.tilt_y[i] - tilt.y), 1) << i;
+  }
+  EXPECT_EQ(converted.pressure[0], 0);
+  EXPECT_EQ(converted.pressure[15], 2047);
+  // Over 1 saturates.
+  EXPECT_EQ(converted.pressure[36], 4095);
+}
+
+TEST(PenSampleBatch, ReportsTheSmallestPressureAsOne) {
+  ScreenTransform screens = TwoScreens();
+  PenSample sample;
+  sample.pressure = 1e-6f;
+  ConvertedPenSamples converted;
+  ConvertPenSamples(*screens.VirtualDesktopMap(0), &sample, 1, 4095, &converted);
+  EXPECT_EQ(converted.pressure[0], 1);
+  EXPECT_EQ(screens.VirtualDesktopMap(2), nullptr);
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+
+#include "pen_tilt.h"
+
+namespace hardware_simulator {
+namespace test {
+
+namespace {
+
+PenTilt Convert(double rotation, double tilt) {
+  PenTilt out;
+  EXPECT_TRUE(PenTiltFromPolar(rotation, tilt, &out));
+  return out;
+}
+
+}  // namespace
+
+TEST(PenTilt, ProjectsPolarTiltOntoBothPlanes) {
+  EXPECT_EQ(Convert(0, 0).x, 0);
+  EXPECT_EQ(Convert(0, 0).y, 0);
+
+  EXPECT_EQ(Convert(0, 45).x, 0);
+  EXPECT_EQ(Convert(0, 45).y, 45);
+  EXPECT_EQ(Convert(90, 45).x, -45);
+  EXPECT_EQ(Convert(90, 45).y, 0);
+  EXPECT_EQ(Convert(180, 45).y, -45);
+  EXPECT_EQ(Convert(270, 45).x, 45);
+
+  // Diagonal: each projection is less than the tilt itself.
+  PenTilt diagonal = Convert(45, 60);
+  EXPECT_EQ(diagonal.x, -50);
+  EXPECT_EQ(diagonal.y, 50);
+}
+
+TEST(PenTilt, RejectsMissingTilt) {
+  PenTilt out{7, 7};
+  EXPECT_FALSE(PenTiltFromPolar(90, -1, &out));
+  EXPECT_EQ(out.x, 0);
+  EXPECT_EQ(out.y, 0);
+  EXPECT_FALSE(PenTiltFromPolar(-1, 30, &out));
+  EXPECT_FALSE(PenTiltFromPolar(361, 30, &out));
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
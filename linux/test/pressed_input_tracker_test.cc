@@ -0,0 +1,148 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+#include "pressed_input_tracker.h"
+#include "recording_input_sink.h"
+
+namespace hardware_simulator {
+namespace test {
+
+namespace {
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+}  // namespace
+
+TEST(PressedInputTracker, ReleasesEverythingPressedInOneSweep) {
+  PressedInputTracker tracker;
+  tracker.KeyEvent(16, true);
+  tracker.KeyEvent(65, true);
+  tracker.KeyEvent(255, true);
+  tracker.KeyEvent(66, true);
+  tracker.KeyEvent(66, false);
+  tracker.MouseButton(1, true);
+  tracker.MouseButton(5, true);
+  tracker.TouchEvent(0, 0.5, 0.5, 7, true);
+  tracker.TouchMove(1, 0.25, 0.75, 7);
+  tracker.TouchEvent(0, 0.125, 0.125, 9, true);
+  tracker.PenEvent(2, 0.5, 0.25, true);
+  tracker.PenMove(2, 0.5, 0.5);
+
+  RecordingInputSink sink;
+  EXPECT_EQ(tracker.ReleaseAll(sink), 8u);
+  EXPECT_THAT(sink.events,
+              ElementsAre("key 16 up", "key 65 up", "key 255 up",
+                          "button 1 up", "button 5 up",
+                          "touch 7 up 0.25 0.75 screen=1",
+                          "touch 9 up 0.125 0.125 screen=0",
+                          "pen up 0.5 0.5 screen=2 button=0 pressure=0 "
+                          "rotation=0 tilt=0"));
+
+  EXPECT_FALSE(tracker.IsKeyDown(65));
+  EXPECT_FALSE(tracker.IsMouseButtonDown(1));
+  EXPECT_FALSE(tracker.IsTouchDown(7));
+  EXPECT_FALSE(tracker.IsPenDown());
+  RecordingInputSink again;
+  EXPECT_EQ(tracker.ReleaseAll(again), 0u);
+  EXPECT_THAT(again.events, IsEmpty());
+}
+
+TEST(PressedInputTracker, ReleasesTouchesAlone) {
+  PressedInputTracker tracker;
+  tracker.KeyEvent(65, true);
+  tracker.TouchEvent(0, 0.5, 0.5, 7, true);
+  tracker.PenEvent(2, 0.5, 0.25, true);
+
+  RecordingInputSink sink;
+  EXPECT_EQ(tracker.ReleaseTouches(sink), 1u);
+  EXPECT_THAT(sink.events, ElementsAre("touch 7 up 0.5 0.5 screen=0"));
+  EXPECT_FALSE(tracker.IsTouchDown(7));
+  EXPECT_TRUE(tracker.IsKeyDown(65));
+  EXPECT_TRUE(tracker.IsPenDown());
+}
+
+TEST(PressedInputTracker, ReportsStateAndIgnoresOutOfRangeInputs) {
+  PressedInputTracker tracker;
+  tracker.KeyEvent(0x41, true);
+  tracker.KeyEvent(300, true);
+  tracker.MouseButton(0, true);
+  tracker.MouseButton(6, true);
+  tracker.MouseButton(3, true);
+
+  EXPECT_TRUE(tracker.IsKeyDown(0x41));
+  EXPECT_FALSE(tracker.IsKeyDown(0x42));
+  EXPECT_FALSE(tracker.IsKeyDown(300));
+  EXPECT_TRUE(tracker.IsMouseButtonDown(3));
+  EXPECT_FALSE(tracker.IsMouseButtonDown(6));
+
+  // Moving or lifting an unknown contact changes nothing.
+  tracker.TouchMove(0, 0.5, 0.5, 1);
+  tracker.TouchEvent(0, 0.5, 0.5, 1, false);
+  EXPECT_FALSE(tracker.IsTouchDown(1));
+
+  RecordingInputSink sink;
+  tracker.ReleaseAll(sink);
+  EXPECT_THAT(sink.events, ElementsAre("key 65 up", "button 3 up"));
+}
+
+TEST(PressedInputTracker, ReusesContactSlotsUpToTheLimit) {
+  PressedInputTracker tracker;
+  for (uint32_t id = 0; id < kMaxTouchContactsLimit; ++id) {
+    ASSERT_TRUE(tracker.TouchEvent(0, 0, 0, 1000 + id, true));
+  }
+  EXPECT_FALSE(tracker.TouchEvent(0, 0, 0, 5000, true));
+  // A second down for a known contact does not need a new slot.
+  EXPECT_TRUE(tracker.TouchEvent(0, 0.5, 0, 1000, true));
+
+  tracker.TouchEvent(0, 0, 0, 1100, false);
+  EXPECT_TRUE(tracker.TouchEvent(0, 0, 0, 5000, true));
+  EXPECT_TRUE(tracker.IsTouchDown(5000));
+  EXPECT_FALSE(tracker.IsTouchDown(1100));
+
+  RecordingInputSink sink;
+  EXPECT_EQ(tracker.ReleaseAll(sink), kMaxTouchContactsLimit);
+}
+
+// Keys are pressed and released from several threads while another keeps
+// reading; every key ends up released exactly as its thread left it.
+TEST(PressedInputTracker, KeysAreSafeToUpdateFromManyThreads) {
+  PressedInputTracker tracker;
+  std::atomic<bool> done{false};
+  std::thread reader([&] {
+    while (!done.load()) {
+      for (uint16_t key = 0; key < kTrackedKeyCount; ++key) {
+        tracker.IsKeyDown(key);
+      }
+    }
+  });
+
+  std::vector<std::thread> writers;
+  for (int t = 0; t < 4; ++t) {
+    writers.emplace_back([&tracker, t] {
+      for (int round = 0; round < 2000; ++round) {
+        for (uint16_t key = t; key < kTrackedKeyCount; key += 4) {
+          tracker.KeyEvent(key, round % 2 == 0);
+        }
+      }
+      // Leave this thread's keys with the lowest one down.
+      tracker.KeyEvent(static_cast<uint16_t>(t), true);
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  done = true;
+  reader.join();
+
+  RecordingInputSink sink;
+  tracker.ReleaseAll(sink);
+  EXPECT_THAT(sink.events,
+              ElementsAre("key 0 up", "key 1 up", "key 2 up", "key 3 up"));
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
@@ -0,0 +1,59 @@
+#ifndef HARDWARE_SIMULATOR_TEST_RECORDING_EVENT_WRITER_H_
+#define HARDWARE_SIMULATOR_TEST_RECORDING_EVENT_WRITER_H_
+
+#include <linux/input.h>
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#include "uinput_device.h"
+
+namespace hardware_simulator {
+namespace test {
+
+struct EventSpec {
+  uint16_t type;
+  uint16_t code;
+  int32_t value;
+};
+
+inline std::string FormatEvent(uint16_t type, uint16_t code, int32_t value) {
+  return std::to_string(type) + ":" + std::to_string(code) + ":" +
+         std::to_string(value);
+}
+
+// What one Write of |events| followed by SYN_REPORT records, for comparing
+// with EXPECT_THAT(writer.batches, ElementsAre(Batch({...}), ...)).
+inline std::string Batch(std::initializer_list<EventSpec> events) {
+  std::string batch;
+  for (const EventSpec& event : events) {
+    batch += FormatEvent(event.type, event.code, event.value) + " ";
+  }
+  return batch + FormatEvent(EV_SYN, SYN_REPORT, 0);
+}
+
+// EventWriter standing in for a uinput device. Each Write is recorded as one
+// line of type:code:value triples, so batch boundaries are kept.
+class RecordingEventWriter : public EventWriter {
+ public:
+  bool Write(const input_event* events, size_t count) override {
+    std::string batch;
+    for (size_t i = 0; i < count; ++i) {
+      if (i != 0) {
+        batch += " ";
+      }
+      batch += FormatEvent(events[i].type, events[i].code, events[i].value);
+    }
+    batches.push_back(batch);
+    return true;
+  }
+
+  std::vector<std::string> batches;
+};
+
+}  // namespace test
+}  // namespace hardware_simulator
+
+#endif  // HARDWARE_SIMULATOR_TEST_RECORDING_EVENT_WRITER_H_
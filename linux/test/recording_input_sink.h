@@ -0,0 +1,96 @@
+#ifndef HARDWARE_SIMULATOR_TEST_RECORDING_INPUT_SINK_H_
+#define HARDWARE_SIMULATOR_TEST_RECORDING_INPUT_SINK_H_
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "input_sink.h"
+
+namespace hardware_simulator {
+namespace test {
+
+// InputSink that records every call as a short readable line, so tests can
+// compare the injected sequence with EXPECT_THAT(sink.events, ElementsAre(...)).
+class RecordingInputSink : public InputSink {
+ public:
+  void KeyEvent(uint16_t key_code, bool is_down) override {
+    Record("key %u %s", key_code, is_down ? "down" : "up");
+  }
+  void MouseMoveRelative(double dx, double dy) override {
+    Record("move_rel %g %g", dx, dy);
+  }
+  void MouseMoveAbsolute(double x, double y, int screen_id) override {
+    Record("move_abs %g %g screen=%d", x, y, screen_id);
+  }
+  void MouseButton(int button_id, bool is_down) override {
+    Record("button %d %s", button_id, is_down ? "down" : "up");
+  }
+  void MouseScroll(double dx, double dy) override {
+    Record("scroll %g %g", dx, dy);
+  }
+  void TouchEvent(int screen_id, double x, double y, uint32_t touch_id,
+                  bool is_down) override {
+    Record("touch %u %s %g %g screen=%d", touch_id, is_down ? "down" : "up", x,
+           y, screen_id);
+  }
+  void TouchMove(int screen_id, double x, double y,
+                 uint32_t touch_id) override {
+    Record("touch %u move %g %g screen=%d", touch_id, x, y, screen_id);
+  }
+  void PenEvent(int screen_id, double x, double y, bool is_down,
+                bool has_button, double pressure, double rotation,
+                double tilt) override {
+    Record("pen %s %g %g screen=%d button=%d pressure=%g rotation=%g tilt=%g",
+           is_down ? "down" : "up", x, y, screen_id, has_button, pressure,
+           rotation, tilt);
+  }
+  void PenMove(int screen_id, double x, double y, bool has_button,
+               double pressure, double rotation, double tilt) override {
+    Record("pen move %g %g screen=%d button=%d pressure=%g rotation=%g tilt=%g",
+           x, y, screen_id, has_button, pressure, rotation, tilt);
+  }
+  void KeyRepeat(uint16_t key_code) override {
+    Record("key %u repeat", key_code);
+  }
+  void TouchRepeat(uint32_t touch_id) override {
+    Record("touch %u repeat", touch_id);
+  }
+
+  std::vector<std::string> events;
+
+ private:
+  template <typename... Args>
+  void Record(const char* format, Args... args) {
+    char line[160];
+    snprintf(line, sizeof(line), format, args...);
+    events.emplace_back(line);
+  }
+};
+
+// Also records where each touch frame starts, as "touch frame <size>".
+class FrameRecordingSink : public RecordingInputSink {
+ public:
+  void TouchFrame(const TouchUpdate* updates, size_t count) override {
+    events.push_back("touch frame " + std::to_string(count));
+    RecordingInputSink::TouchFrame(updates, count);
+  }
+};
+
+// Also records where each pen move run starts, as
+// "pen run <size> screen=<id>".
+class PenRunRecordingSink : public RecordingInputSink {
+ public:
+  void PenMoveBatch(int screen_id, const PenSample* samples,
+                    size_t count) override {
+    events.push_back("pen run " + std::to_string(count) +
+                     " screen=" + std::to_string(screen_id));
+    RecordingInputSink::PenMoveBatch(screen_id, samples, count);
+  }
+};
+
+}  // namespace test
+}  // namespace hardware_simulator
+
+#endif  // HARDWARE_SIMULATOR_TEST_RECORDING_INPUT_SINK_H_
@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "screen_transform.h"
+
+namespace hardware_simulator {
+namespace test {
+
+namespace {
+
+ScreenRect Screen(int32_t left, int32_t top, int32_t width, int32_t height,
+                  bool is_primary = false) {
+  ScreenRect screen;
+  screen.left = left;
+  screen.top = top;
+  screen.right = left + width;
+  screen.bottom = top + height;
+  screen.is_primary = is_primary;
+  return screen;
+}
+
+// A 4K primary with a 1080p screen to its left and a portrait screen above
+// and to the right, with the virtual desktop metrics Windows reports for it.
+std::vector<ScreenRect> MixedLayout() {
+  return {Screen(0, 0, 3840, 2160, true), Screen(-1920, 600, 1920, 1080),
+          Screen(3840, -400, 1080, 1920)};
+}
+
+ScreenMetrics MixedMetrics() {
+  ScreenMetrics metrics;
+  metrics.primary_width = 3840;
+  metrics.primary_height = 2160;
+  metrics.virtual_width = 1920 + 3840 + 1080;
+  metrics.virtual_height = 400 + 2160;
+  return metrics;
+}
+
+// The per-event computations the Windows plugin did before snapshots.
+void LegacyPrimaryNormalized(const std::vector<ScreenRect>& screens,
+                             const ScreenMetrics& metrics, int index, double x,
+                             double y, int32_t* out_x, int32_t* out_y) {
+  const ScreenRect& screen = screens[index];
+  int ox = screen.left + static_cast<int>((screen.right - screen.left) * x);
+  int oy = screen.top + static_cast<int>((screen.bottom - screen.top) * y);
+  *out_x = static_cast<int32_t>(
+      ox * (65535.0f / static_cast<int>(metrics.primary_width)));
+  *out_y = static_cast<int32_t>(
+      oy * (65535.0f / static_cast<int>(metrics.primary_height)));
+}
+
+void LegacyVirtualDesktop(const std::vector<ScreenRect>& screens,
+                          const ScreenMetrics& metrics, int index, double x,
+                          double y, int32_t* out_x, int32_t* out_y) {
+  int32_t left = 0, top = 0, right = 0, bottom = 0;
+  for (const auto& screen : screens) {
+    left = std::min(left, screen.left);
+    top = std::min(top, screen.top);
+    right = std::max(right, screen.right);
+    bottom = std::max(bottom, screen.bottom);
+  }
+  const ScreenRect& screen = screens[index];
+  double global_x =
+      (screen.left - left + (screen.right - screen.left) * x) / (right - left);
+  double global_y =
+      (screen.top - top + (screen.bottom - screen.top) * y) / (bottom - top);
+  *out_x = static_cast<int32_t>(global_x * metrics.virtual_width);
+  *out_y = static_cast<int32_t>(global_y * metrics.virtual_height);
+}
+
+}  // namespace
+
+TEST(ScreenTransform, MatchesThePerEventComputation) {
+  const auto screens = MixedLayout();
+  const auto metrics = MixedMetrics();
+  ScreenTransform transform(screens, metrics);
+  ASSERT_EQ(transform.screen_count(), 3u);
+
+  for (int index = 0; index < 3; ++index) {
+    for (double x = 0; x <= 1.0; x += 0.0625) {
+      for (double y = 0; y <= 1.0; y += 0.125) {
+        int32_t expected_x, expected_y, actual_x = 0, actual_y = 0;
+        LegacyPrimaryNormalized(screens, metrics, index, x, y, &expected_x,
+                                &expected_y);
+        ASSERT_TRUE(
+            transform.ToPrimaryNormalized(index, x, y, &actual_x, &actual_y));
+        // The old path truncated to whole pixels and scaled in float.
+        EXPECT_NEAR(actual_x, expected_x, 1 + 65535.0 / metrics.primary_width);
+        EXPECT_NEAR(actual_y, expected_y, 1 + 65535.0 / metrics.primary_height);
+
+        LegacyVirtualDesktop(screens, metrics, index, x, y, &expected_x,
+                             &expected_y);
+        ASSERT_TRUE(
+            transform.ToVirtualDesktop(index, x, y, &actual_x, &actual_y));
+        EXPECT_NEAR(actual_x, expected_x, 1);
+        EXPECT_NEAR(actual_y, expected_y, 1);
+      }
+    }
+  }
+}
+
+TEST(ScreenTransform, RejectsUnknownScreens) {
+  ScreenTransform transform(MixedLayout(), MixedMetrics());
+  int32_t x = 7, y = 7;
+  EXPECT_FALSE(transform.ToPrimaryNormalized(-1, 0.5, 0.5, &x, &y));
+  EXPECT_FALSE(transform.ToVirtualDesktop(3, 0.5, 0.5, &x, &y));
+  EXPECT_EQ(x, 7);
+
+  ScreenTransform empty({}, ScreenMetrics());
+  EXPECT_FALSE(empty.ToVirtualDesktop(0, 0.5, 0.5, &x, &y));
+}
+
+TEST(ScreenTransform, AppliesScreenRotationToTheCallerPosition) {
+  ScreenMetrics metrics;
+  metrics.primary_width = 65535;
+  metrics.primary_height = 65535;
+  auto at = [&](ScreenRotation rotation, double u, double v) {
+    ScreenRect screen = Screen(0, 0, 1000, 500, true);
+    screen.rotation = rotation;
+    ScreenTransform transform({screen}, metrics);
+    int32_t x = -1, y = -1;
+    EXPECT_TRUE(transform.ToPrimaryNormalized(0, u, v, &x, &y));
+    return std::make_pair(x, y);
+  };
+
+  // The caller's top-left corner lands on each corner of the screen in turn.
+  EXPECT_EQ(at(ScreenRotation::kNone, 0, 0), std::make_pair(0, 0));
+  EXPECT_EQ(at(ScreenRotation::k90, 0, 0), std::make_pair(1000, 0));
+  EXPECT_EQ(at(ScreenRotation::k180, 0, 0), std::make_pair(1000, 500));
+  EXPECT_EQ(at(ScreenRotation::k270, 0, 0), std::make_pair(0, 500));
+  // Moving right along the caller's x moves down the screen at 90 degrees.
+  EXPECT_EQ(at(ScreenRotation::k90, 1, 0), std::make_pair(1000, 500));
+  EXPECT_EQ(at(ScreenRotation::k270, 0.5, 1), std::make_pair(1000, 250));
+}
+
+TEST(ScreenTransformPublisher, ReadersAlwaysSeeACompleteSnapshot) {
+  ScreenTransformPublisher publisher;
+  EXPECT_EQ(publisher.Current()->screen_count(), 0u);
+
+  std::atomic<bool> done{false};
+  std::atomic<int> torn{0};
+  std::thread reader([&] {
+    while (!done.load()) {
+      std::shared_ptr<const ScreenTransform> transform = publisher.Current();
+      // Snapshot n has n screens, each n pixels wide.
+      size_t count = transform->screen_count();
+      for (const auto& screen : transform->screens()) {
+        if (screen.right - screen.left != static_cast<int32_t>(count)) {
+          torn.fetch_add(1);
+        }
+      }
+    }
+  });
+
+  for (int32_t n = 1; n <= 200; ++n) {
+    std::vector<ScreenRect> screens;
+    for (int32_t i = 0; i < n; ++i) {
+      screens.push_back(Screen(i * n, 0, n, 10));
+    }
+    publisher.Publish(
+        std::make_shared<const ScreenTransform>(screens, ScreenMetrics()));
+  }
+  done = true;
+  reader.join();
+
+  EXPECT_EQ(torn.load(), 0);
+  EXPECT_EQ(publisher.Current()->screen_count(), 200u);
+}
+
+TEST(ScreenTransformPublisher, FreesSnapshotsOnceNoReaderHoldsThem) {
+  ScreenTransformPublisher publisher;
+  std::weak_ptr<const ScreenTransform> first = publisher.Current();
+  std::shared_ptr<const ScreenTransform> held = std::make_shared<const ScreenTransform>(
+      std::vector<ScreenRect>{Screen(0, 0, 100, 100)}, ScreenMetrics());
+  std::weak_ptr<const ScreenTransform> second = held;
+  publisher.Publish(held);
+  EXPECT_TRUE(first.expired());
+
+  publisher.Publish(std::make_shared<const ScreenTransform>(std::vector<ScreenRect>(), ScreenMetrics()));
+  EXPECT_FALSE(second.expired());
+  held.reset();
+  EXPECT_TRUE(second.expired());
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "shortcut_policy.h"
+
+namespace hardware_simulator {
+namespace test {
+
+namespace {
+
+constexpr uint8_t kTab = 0x09;
+constexpr uint8_t kEscape = 0x1B;
+constexpr uint8_t kA = 0x41;
+constexpr uint8_t kF4 = 0x73;
+constexpr uint8_t kLeftShift = 0xA0;
+constexpr uint8_t kRightShift = 0xA1;
+constexpr uint8_t kLeftCtrl = 0xA2;
+constexpr uint8_t kRightCtrl = 0xA3;
+constexpr uint8_t kLeftAlt = 0xA4;
+constexpr uint8_t kLeftWin = 0x5B;
+
+// Feeds a synthetic event stream, "+key" for a down and "-key" for an up, and
+// returns which were blocked as a string of 'B' and '.'.
+std::string Feed(ShortcutPolicy& policy,
+                const std::vector<std::pair<uint8_t, bool>>& events,
+                bool capture = true) {
+  std::string blocked;
+  for (const auto& [key, is_down] : events) {
+    blocked += policy.OnKey(key, is_down, capture).block ? 'B' : '.';
+  }
+  return blocked;
+}
+
+std::pair<uint8_t, bool> Down(uint8_t key) { return {key, true}; }
+std::pair<uint8_t, bool> Up(uint8_t key) { return {key, false}; }
+
+}  // namespace
+
+TEST(ShortcutPolicy, DefaultRulesCaptureTheSystemShortcuts) {
+  ShortcutPolicy policy;
+  EXPECT_EQ(Feed(policy, {Down(kLeftWin), Up(kLeftWin), Down(kRightCtrl),
+                         Up(kRightCtrl), Down(kA), Up(kA), Down(kTab),
+                         Up(kTab)}),
+            "BBBB....");
+  // Alt+Tab, Alt+F4, Ctrl+Alt+Esc; the Alt key itself is captured too.
+  EXPECT_EQ(Feed(policy, {Down(kLeftAlt), Down(kTab), Up(kTab), Down(kF4),
+                         Up(kF4), Down(kLeftCtrl), Down(kEscape), Up(kEscape),
+                         Up(kLeftCtrl), Up(kLeftAlt)}),
+            "BBBBB.BB.B");
+  // Ctrl+Esc alone is left to the system.
+  EXPECT_EQ(Feed(policy, {Down(kLeftCtrl), Down(kEscape), Up(kEscape),
+                         Up(kLeftCtrl)}),
+            "....");
+}
+
+TEST(ShortcutPolicy, TracksModifiersFromTheEventsItSees) {
+  ShortcutPolicy policy;
+  policy.OnKey(kLeftShift, true, true);
+  policy.OnKey(kRightShift, true, true);
+  EXPECT_EQ(policy.modifiers(),
+            kShortcutShift | kShortcutLeftShift | kShortcutRightShift);
+  policy.OnKey(kLeftShift, false, true);
+  EXPECT_EQ(policy.modifiers(), kShortcutShift | kShortcutRightShift);
+  policy.OnKey(kRightShift, false, true);
+  EXPECT_EQ(policy.modifiers(), 0);
+
+  // Generic codes count as the left key.
+  policy.OnKey(0x12, true, true);  // VK_MENU
+  EXPECT_EQ(policy.modifiers(), kShortcutAlt | kShortcutLeftAlt);
+  // Modifiers are tracked while not capturing, too.
+  policy.OnKey(0x12, false, false);
+  EXPECT_EQ(policy.modifiers(), 0);
+}
+
+TEST(ShortcutPolicy, CompilesConfiguredRules) {
+  ShortcutPolicy policy;
+  ASSERT_TRUE(policy.SetRules({{kA, kShortcutCtrl | kShortcutShift},
+                               {kA, kShortcutRightAlt},
+                               {kF4, 0}}));
+  EXPECT_EQ(Feed(policy, {Down(kA), Up(kA), Down(kLeftWin), Up(kLeftWin),
+                         Down(kF4), Up(kF4)}),
+            "....BB");
+  // Ctrl+Shift+A, with an extra Alt still matching; left Alt alone does not
+  // satisfy a right-Alt rule.
+  EXPECT_EQ(Feed(policy, {Down(kLeftCtrl), Down(kLeftShift), Down(kLeftAlt),
+                         Down(kA), Up(kA), Up(kLeftShift), Down(kA), Up(kA),
+                         Up(kLeftAlt), Up(kLeftCtrl)}),
+            "...BB.....");
+  EXPECT_EQ(Feed(policy, {Down(0xA5), Down(kA), Up(kA), Up(0xA5)}), ".BB.");
+
+  // Invalid rules leave the compiled ones alone.
+  EXPECT_FALSE(policy.SetRules({{0, 0}}));
+  EXPECT_FALSE(policy.SetRules({{kA, 0x1000}}));
+  EXPECT_EQ(Feed(policy, {Down(kF4), Up(kF4)}), "BB");
+
+  ASSERT_TRUE(policy.SetRules({}));
+  EXPECT_EQ(Feed(policy, {Down(kLeftWin), Up(kLeftWin)}), "..");
+}
+
+TEST(ShortcutPolicy, DecodesRulePairs) {
+  std::vector<ShortcutRule> rules;
+  ASSERT_TRUE(DecodeShortcutRules({kTab, kShortcutAlt, kLeftWin, 0}, &rules));
+  ASSERT_EQ(rules.size(), 2u);
+  EXPECT_EQ(rules[0].key, kTab);
+  EXPECT_EQ(rules[0].modifiers, kShortcutAlt);
+  EXPECT_EQ(rules[1].key, kLeftWin);
+
+  EXPECT_FALSE(DecodeShortcutRules({kTab}, &rules));
+  EXPECT_FALSE(DecodeShortcutRules({256, 0}, &rules));
+  EXPECT_FALSE(DecodeShortcutRules({0, 0}, &rules));
+  EXPECT_FALSE(DecodeShortcutRules({kTab, -1}, &rules));
+  EXPECT_FALSE(DecodeShortcutRules({kTab, 0x1000}, &rules));
+  EXPECT_EQ(rules.size(), 2u);
+}
+
+TEST(ShortcutPolicy, KeepsADecisionFromDownToUp) {
+  ShortcutPolicy policy;
+  // Alt released before Tab: Tab's up is still swallowed, repeats too.
+  EXPECT_EQ(Feed(policy, {Down(kLeftAlt), Down(kTab), Up(kLeftAlt), Down(kTab),
+                         Up(kTab)}),
+            "BBBBB");
+  // Tab went down alone and is released alone even with Alt pressed since.
+  EXPECT_EQ(Feed(policy, {Down(kTab), Down(kLeftAlt), Up(kTab), Up(kLeftAlt)}),
+            ".B.B");
+  // Focus lost while Win was held: its up is still swallowed.
+  EXPECT_TRUE(policy.OnKey(kLeftWin, true, true).block);
+  EXPECT_TRUE(policy.OnKey(kLeftWin, false, false).block);
+  // Nothing is captured without focus.
+  EXPECT_EQ(Feed(policy, {Down(kLeftWin), Up(kLeftWin)}, false), "..");
+}
+
+TEST(ShortcutPolicy, ReportsOnlyStateChanges) {
+  ShortcutPolicy policy;
+  EXPECT_TRUE(policy.OnKey(kLeftWin, true, true).changed);
+  EXPECT_FALSE(policy.OnKey(kLeftWin, true, true).changed);
+  EXPECT_TRUE(policy.IsKeyDown(kLeftWin));
+  EXPECT_TRUE(policy.IsKeyBlocked(kLeftWin));
+  EXPECT_TRUE(policy.OnKey(kLeftWin, false, true).changed);
+  EXPECT_FALSE(policy.OnKey(kLeftWin, false, true).changed);
+
+  policy.OnKey(kLeftAlt, true, true);
+  policy.Reset();
+  EXPECT_EQ(policy.modifiers(), 0);
+  EXPECT_FALSE(policy.IsKeyDown(kLeftAlt));
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
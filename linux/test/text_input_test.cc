@@ -0,0 +1,168 @@
+#include <X11/keysym.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "text_input.h"
+
+namespace hardware_simulator {
+namespace test {
+
+namespace {
+
+using std::chrono::microseconds;
+using testing::ElementsAre;
+
+// Keymap-backed text sink: records the keysym press and release each key
+// would be typed with, and where the batches start.
+class RecordingTextSink : public TextSink {
+ public:
+  size_t TypeKeys(const TypedKey* keys, size_t count) override {
+    events.push_back("batch");
+    size_t typed = (std::min)(count, accept);
+    for (size_t i = 0; i < typed; ++i) {
+      char line[32];
+      std::snprintf(line, sizeof(line), "keysym 0x%x",
+                    KeysymForTypedKey(keys[i]));
+      events.push_back(line);
+    }
+    accept -= typed;
+    return typed;
+  }
+
+  std::vector<std::string> events;
+  size_t accept = SIZE_MAX;
+};
+
+std::vector<TypedKey> Decode(const std::string& text,
+                             size_t* replaced = nullptr) {
+  std::vector<TypedKey> keys;
+  size_t count = DecodeTypedText(text.data(), text.size(), &keys);
+  if (replaced) {
+    *replaced = count;
+  }
+  return keys;
+}
+
+TypedKey Character(uint32_t code_point) {
+  return {TypedKeyKind::kCharacter, code_point};
+}
+
+TypedKey Key(uint32_t virtual_key) {
+  return {TypedKeyKind::kKey, virtual_key};
+}
+
+}  // namespace
+
+TEST(TextInput, DecodesUtf8IntoCharacters) {
+  size_t replaced = 1;
+  EXPECT_THAT(Decode("a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80", &replaced),
+              ElementsAre(Character('a'), Character(0xE9), Character(0x20AC),
+                          Character(0x1F600)));
+  EXPECT_EQ(replaced, 0u);
+}
+
+TEST(TextInput, TypesLineBreaksTabsAndBackspacesAsKeys) {
+  EXPECT_THAT(Decode("a\r\nb\nc\rd\te\b\x01\x7F"),
+              ElementsAre(Character('a'), Key(0x0D), Character('b'), Key(0x0D),
+                          Character('c'), Key(0x0D), Character('d'), Key(0x09),
+                          Character('e'), Key(0x08)));
+}
+
+TEST(TextInput, ReplacesMalformedSequences) {
+  size_t replaced = 0;
+  // Stray continuation, overlong '/', encoded surrogate, past U+10FFFF and a
+  // sequence cut short by the end of the text.
+  EXPECT_THAT(
+      Decode("\x80" "a" "\xC0\xAF" "\xED\xA0\x80" "\xF4\x90\x80\x80" "\xE2\x82",
+             &replaced),
+      ElementsAre(Character(0xFFFD), Character('a'), Character(0xFFFD),
+                  Character(0xFFFD), Character(0xFFFD), Character(0xFFFD),
+                  Character(0xFFFD), Character(0xFFFD), Character(0xFFFD),
+                  Character(0xFFFD), Character(0xFFFD), Character(0xFFFD)));
+  EXPECT_EQ(replaced, 11u);
+  // A truncated sequence gives back the byte that broke it.
+  EXPECT_THAT(Decode("\xE2\x82" "b"),
+              ElementsAre(Character(0xFFFD), Character('b')));
+}
+
+TEST(TextInput, EncodesSupplementaryCharactersAsSurrogatePairs) {
+  uint16_t units[2] = {0, 0};
+  EXPECT_EQ(EncodeUtf16(0x20AC, units), 1u);
+  EXPECT_EQ(units[0], 0x20AC);
+  EXPECT_EQ(EncodeUtf16(0x1F600, units), 2u);
+  EXPECT_EQ(units[0], 0xD83D);
+  EXPECT_EQ(units[1], 0xDE00);
+}
+
+TEST(TextInput, MapsKeysToKeysyms) {
+  EXPECT_EQ(KeysymForTypedKey(Character('a')), static_cast<uint32_t>(XK_a));
+  EXPECT_EQ(KeysymForTypedKey(Character(0xE9)),
+            static_cast<uint32_t>(XK_eacute));
+  EXPECT_EQ(KeysymForTypedKey(Character(0x20AC)), 0x010020ACu);
+  EXPECT_EQ(KeysymForTypedKey(Key(0x0D)), static_cast<uint32_t>(XK_Return));
+  EXPECT_EQ(KeysymForTypedKey(Key(0x09)), static_cast<uint32_t>(XK_Tab));
+  EXPECT_EQ(KeysymForTypedKey(Key(0x08)),
+            static_cast<uint32_t>(XK_BackSpace));
+}
+
+TEST(TextInput, TypesUnpacedTextInOneBatch) {
+  RecordingTextSink sink;
+  int waits = 0;
+  EXPECT_EQ(TypeText(Decode("hi\n"), TextPacing(), sink,
+                     [&](microseconds) { return ++waits, true; }),
+            3u);
+  EXPECT_EQ(waits, 0);
+  EXPECT_THAT(sink.events, ElementsAre("batch", "keysym 0x68", "keysym 0x69",
+                                       "keysym 0xff0d"));
+}
+
+TEST(TextInput, WaitsBetweenPacedBatches) {
+  RecordingTextSink sink;
+  TextPacing pacing;
+  pacing.keys_per_batch = 2;
+  pacing.batch_interval = microseconds(5000);
+  std::vector<microseconds> waits;
+  EXPECT_EQ(TypeText(Decode("abcde"), pacing, sink,
+                     [&](microseconds interval) {
+                       waits.push_back(interval);
+                       return true;
+                     }),
+            5u);
+  EXPECT_THAT(waits, ElementsAre(microseconds(5000), microseconds(5000)));
+  EXPECT_THAT(sink.events,
+              ElementsAre("batch", "keysym 0x61", "keysym 0x62", "batch",
+                          "keysym 0x63", "keysym 0x64", "batch",
+                          "keysym 0x65"));
+}
+
+TEST(TextInput, StopsWhenTheWaitIsCancelled) {
+  RecordingTextSink sink;
+  TextPacing pacing;
+  pacing.keys_per_batch = 2;
+  pacing.batch_interval = microseconds(1000);
+  int waits = 0;
+  EXPECT_EQ(TypeText(Decode("abcde"), pacing, sink,
+                     [&](microseconds) { return ++waits < 2; }),
+            4u);
+  EXPECT_EQ(waits, 2);
+}
+
+TEST(TextInput, StopsAtTheFirstBatchNotTypedCompletely) {
+  RecordingTextSink sink;
+  sink.accept = 3;
+  TextPacing pacing;
+  pacing.keys_per_batch = 2;
+  EXPECT_EQ(TypeText(Decode("abcde"), pacing, sink,
+                     [](microseconds) { return true; }),
+            3u);
+  EXPECT_THAT(sink.events, ElementsAre("batch", "keysym 0x61", "keysym 0x62",
+                                       "batch", "keysym 0x63"));
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
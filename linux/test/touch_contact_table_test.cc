@@ -0,0 +1,163 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "touch_contact_table.h"
+
+namespace hardware_simulator {
+namespace test {
+
+namespace {
+
+using testing::ElementsAre;
+
+struct Point {
+  double x = 0;
+  double y = 0;
+};
+
+const char* PhaseName(TouchPhase phase) {
+  switch (phase) {
+    case TouchPhase::kDown:
+      return "down";
+    case TouchPhase::kMove:
+      return "move";
+    case TouchPhase::kUp:
+      return "up";
+  }
+  return "?";
+}
+
+// Plays the OS side: each Submit() records the frame exactly as it would be
+// injected, slot by slot, and then ends it.
+class RecordingTouchBackend {
+ public:
+  void Submit(TouchContactTable<Point>& table) {
+    std::string frame;
+    for (size_t slot = 0; slot < table.size(); ++slot) {
+      char contact[64];
+      snprintf(contact, sizeof(contact), "%s%u:%s@%g,%g",
+               slot ? " " : "", table.touch_id(slot),
+               PhaseName(table.phase(slot)), table.contacts()[slot].x,
+               table.contacts()[slot].y);
+      frame += contact;
+    }
+    frames.push_back(frame);
+    table.EndFrame();
+  }
+
+  std::vector<std::string> frames;
+};
+
+void Set(Point* point, double x, double y) {
+  ASSERT_NE(point, nullptr);
+  point->x = x;
+  point->y = y;
+}
+
+}  // namespace
+
+TEST(TouchContactTable, SubmitsActiveContactsDenselyAndDropsLiftedOnes) {
+  TouchContactTable<Point> table;
+  RecordingTouchBackend backend;
+
+  Set(table.Down(7), 1, 1);
+  backend.Submit(table);
+  Set(table.Down(3), 2, 2);
+  backend.Submit(table);
+  Set(table.Move(7), 1.5, 1);
+  backend.Submit(table);
+  Set(table.Up(7), 1.5, 1);
+  backend.Submit(table);
+  Set(table.Move(3), 2, 3);
+  backend.Submit(table);
+
+  EXPECT_THAT(backend.frames,
+              ElementsAre("7:down@1,1",
+                          "7:move@1,1 3:down@2,2",
+                          "7:move@1.5,1 3:move@2,2",
+                          "7:up@1.5,1 3:move@2,2",
+                          // 3 moved into the freed slot 0.
+                          "3:move@2,3"));
+  EXPECT_EQ(table.SlotOf(3), 0);
+  EXPECT_EQ(table.SlotOf(7), -1);
+}
+
+TEST(TouchContactTable, MoveBeforeTheFirstFrameKeepsTheDown) {
+  TouchContactTable<Point> table;
+  RecordingTouchBackend backend;
+  Set(table.Down(1), 0, 0);
+  Set(table.Move(1), 5, 5);
+  backend.Submit(table);
+  EXPECT_THAT(backend.frames, ElementsAre("1:down@5,5"));
+}
+
+TEST(TouchContactTable, IgnoresUnknownAndLiftedContacts) {
+  TouchContactTable<Point> table;
+  EXPECT_EQ(table.Move(4), nullptr);
+  EXPECT_EQ(table.Up(4), nullptr);
+  EXPECT_FALSE(table.Remove(4));
+
+  table.Down(4);
+  table.Up(4);
+  EXPECT_EQ(table.Move(4), nullptr);
+}
+
+TEST(TouchContactTable, HonoursAConfigurableContactLimit) {
+  TouchContactTable<Point> table(20);
+  EXPECT_EQ(table.max_contacts(), 20u);
+  for (uint32_t id = 100; id < 120; ++id) {
+    EXPECT_NE(table.Down(id), nullptr) << id;
+  }
+  EXPECT_EQ(table.Down(120), nullptr);
+  EXPECT_EQ(table.size(), 20u);
+
+  table.Up(105);
+  table.EndFrame();
+  EXPECT_NE(table.Down(120), nullptr);
+
+  table.Reset(0);
+  EXPECT_EQ(table.max_contacts(), 1u);
+  EXPECT_TRUE(table.empty());
+  table.Reset(100000);
+  EXPECT_EQ(table.max_contacts(), kMaxTouchContactsLimit);
+}
+
+// Random downs and lifts against a reference set: every known id must map
+// to the slot holding it, and slots must stay packed.
+TEST(TouchContactTable, IndexStaysConsistentUnderChurn) {
+  TouchContactTable<Point> table(kMaxTouchContactsLimit);
+  std::set<uint32_t> reference;
+  std::mt19937 random(1234);
+  std::uniform_int_distribution<uint32_t> id_of(0, 400);
+
+  for (int step = 0; step < 20000; ++step) {
+    uint32_t id = id_of(random);
+    if (reference.count(id)) {
+      table.Up(id);
+      table.EndFrame();
+      reference.erase(id);
+    } else if (reference.size() < table.max_contacts()) {
+      Set(table.Down(id), id, 0);
+      reference.insert(id);
+    }
+
+    ASSERT_EQ(table.size(), reference.size());
+    if (step % 97 == 0) {
+      for (uint32_t known : reference) {
+        int slot = table.SlotOf(known);
+        ASSERT_GE(slot, 0) << known;
+        ASSERT_EQ(table.touch_id(slot), known);
+        ASSERT_EQ(table.contacts()[slot].x, known);
+      }
+    }
+  }
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
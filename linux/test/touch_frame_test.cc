@@ -0,0 +1,113 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "input_injector.h"
+#include "recording_input_sink.h"
+#include "touch_frame.h"
+
+namespace hardware_simulator {
+namespace test {
+
+namespace {
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+TouchUpdate Move(uint32_t touch_id, double x) {
+  TouchUpdate update;
+  update.type = TouchUpdateType::kMove;
+  update.touch_id = touch_id;
+  update.x = x;
+  return update;
+}
+
+}  // namespace
+
+TEST(TouchFrameSink, CollapsesRepeatedMovesIntoOneFrame) {
+  FrameRecordingSink sink;
+  TouchFrameSink frames(sink);
+  for (uint32_t id = 1; id <= 3; ++id) {
+    frames.TouchEvent(0, 0, 0, id, true);
+  }
+  frames.FlushTouchFrame();
+  // Three pinch steps of three fingers.
+  for (int step = 1; step <= 3; ++step) {
+    for (uint32_t id = 1; id <= 3; ++id) {
+      frames.TouchMove(0, step * 0.1, 0.5, id);
+    }
+  }
+  EXPECT_EQ(sink.events.size(), 4u);
+  frames.FlushTouchFrame();
+  frames.FlushTouchFrame();
+
+  EXPECT_THAT(sink.events,
+              ElementsAre("touch frame 3", "touch 1 down 0 0 screen=0",
+                          "touch 2 down 0 0 screen=0", "touch 3 down 0 0 screen=0",
+                          "touch frame 3", "touch 1 move 0.3 0.5 screen=0",
+                          "touch 2 move 0.3 0.5 screen=0",
+                          "touch 3 move 0.3 0.5 screen=0"));
+}
+
+TEST(TouchFrameSink, KeepsEveryDownAndUpInOrder) {
+  FrameRecordingSink sink;
+  TouchFrameSink frames(sink);
+  frames.TouchEvent(0, 0.1, 0, 1, true);
+  frames.TouchMove(0, 0.2, 0, 1);
+  frames.TouchMove(0, 0.3, 0, 1);
+  frames.TouchEvent(0, 0.5, 0, 2, true);
+  frames.TouchEvent(0, 0.3, 0, 1, false);
+  frames.TouchEvent(0, 0.4, 0, 1, true);
+  frames.FlushTouchFrame();
+
+  // A move right after the down, and the up right after the moves, each
+  // start a frame; contact 2's down rides along with the moves.
+  EXPECT_THAT(sink.events,
+              ElementsAre("touch frame 1", "touch 1 down 0.1 0 screen=0",
+                          "touch frame 2", "touch 1 move 0.3 0 screen=0",
+                          "touch 2 down 0.5 0 screen=0", "touch frame 1",
+                          "touch 1 up 0.3 0 screen=0", "touch frame 1",
+                          "touch 1 down 0.4 0 screen=0"));
+}
+
+TEST(TouchFrameSink, CommitsBeforeOtherInput) {
+  FrameRecordingSink sink;
+  TouchFrameSink frames(sink);
+  frames.TouchMove(0, 0.5, 0.5, 4);
+  frames.KeyEvent(65, true);
+  frames.TouchMove(0, 0.6, 0.5, 4);
+  frames.TouchRepeat(4);
+
+  EXPECT_THAT(sink.events,
+              ElementsAre("touch frame 1", "touch 4 move 0.5 0.5 screen=0",
+                          "key 65 down", "touch frame 1",
+                          "touch 4 move 0.6 0.5 screen=0", "touch 4 repeat"));
+}
+
+TEST(TouchFrameSink, FlushWithNothingStagedDoesNothing) {
+  FrameRecordingSink sink;
+  TouchFrameSink frames(sink);
+  frames.FlushTouchFrame();
+  EXPECT_THAT(sink.events, IsEmpty());
+}
+
+// Frames posted through the injector queue reach the platform sink whole,
+// and single touch calls still inject one by one.
+TEST(TouchFrameSink, ReceivesQueuedFramesWhole) {
+  FrameRecordingSink sink;
+  TouchFrameSink frames(sink);
+  InputInjector injector(frames);
+  QueuedInputSink queued(injector);
+
+  const TouchUpdate pinch[] = {Move(1, 0.1), Move(2, 0.9), Move(3, 0.5)};
+  queued.TouchFrame(pinch, 3);
+  queued.TouchMove(0, 0.2, 0, 1);
+  injector.Stop();
+
+  EXPECT_THAT(sink.events,
+              ElementsAre("touch frame 3", "touch 1 move 0.1 0 screen=0",
+                          "touch 2 move 0.9 0 screen=0", "touch 3 move 0.5 0 screen=0",
+                          "touch frame 1", "touch 1 move 0.2 0 screen=0"));
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
@@ -0,0 +1,329 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <utility>
+
+#include "recording_event_writer.h"
+#include "uinput_device.h"
+#include "uinput_input_sink.h"
+
+namespace hardware_simulator {
+namespace test {
+
+namespace {
+
+using testing::Contains;
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+constexpr uint16_t kVkA = 0x41;
+constexpr uint16_t kVkLeftWin = 0x5B;
+constexpr uint16_t kVkLeftControl = 0xA2;
+
+class UinputInputSinkTest : public testing::Test {
+ protected:
+  UinputInputSinkTest() {
+    // Two 1920x1080 screens side by side, the primary on the left.
+    screens_.Publish(MakeUinputScreenTransform(
+        {{0, 0, 1920, 1080, true}, {1920, 0, 3840, 1080, false}}));
+    auto keyboard = std::make_unique<RecordingEventWriter>();
+    auto mouse = std::make_unique<RecordingEventWriter>();
+    auto pointer = std::make_unique<RecordingEventWriter>();
+    auto touch = std::make_unique<RecordingEventWriter>();
+    auto pen = std::make_unique<RecordingEventWriter>();
+    keyboard_ = keyboard.get();
+    mouse_ = mouse.get();
+    pointer_ = pointer.get();
+    touch_ = touch.get();
+    pen_ = pen.get();
+    sink_ = std::make_unique<UinputInputSink>(
+        UinputWriters{std::move(keyboard), std::move(mouse), std::move(pointer),
+                      std::move(touch), std::move(pen)},
+        screens_);
+  }
+
+  ScreenTransformPublisher screens_;
+  RecordingEventWriter* keyboard_;
+  RecordingEventWriter* mouse_;
+  RecordingEventWriter* pointer_;
+  RecordingEventWriter* touch_;
+  RecordingEventWriter* pen_;
+  std::unique_ptr<UinputInputSink> sink_;
+};
+
+}  // namespace
+
+TEST_F(UinputInputSinkTest, WritesEachKeyAsOneBatch) {
+  sink_->KeyEvent(kVkA, true);
+  sink_->KeyRepeat(kVkA);
+  sink_->KeyEvent(kVkA, false);
+  sink_->KeyEvent(kVkLeftWin, true);
+
+  EXPECT_THAT(keyboard_->batches,
+              ElementsAre(Batch({{EV_KEY, KEY_A, 1}}), Batch({{EV_KEY, KEY_A, 2}}),
+                          Batch({{EV_KEY, KEY_A, 0}}),
+                          Batch({{EV_KEY, KEY_LEFTMETA, 1}})));
+  EXPECT_THAT(mouse_->batches, IsEmpty());
+}
+
+TEST_F(UinputInputSinkTest, DropsUnmappedKeysAndRepeatsOfReleasedOnes) {
+  sink_->KeyEvent(0xFF, true);
+  sink_->KeyRepeat(kVkA);
+  sink_->KeyEvent(kVkA, true);
+  sink_->KeyEvent(kVkA, false);
+  sink_->KeyRepeat(kVkA);
+
+  EXPECT_THAT(keyboard_->batches, ElementsAre(Batch({{EV_KEY, KEY_A, 1}}),
+                                              Batch({{EV_KEY, KEY_A, 0}})));
+}
+
+// Typed text must not come out as Ctrl+letter because the client holds Ctrl.
+TEST_F(UinputInputSinkTest, LiftsHeldModifiersAroundKeyFrames) {
+  sink_->KeyEvent(kVkLeftControl, true);
+  sink_->KeyEvent(kVkA, true);
+  keyboard_->batches.clear();
+  input_event frames[4] = {};
+  frames[0].type = EV_KEY;
+  frames[0].code = KEY_B;
+  frames[0].value = 1;
+  frames[1].type = EV_SYN;
+  frames[1].code = SYN_REPORT;
+  frames[2] = frames[0];
+  frames[2].value = 0;
+  frames[3] = frames[1];
+
+  EXPECT_TRUE(sink_->WriteKeyFrames(frames, 4));
+  EXPECT_THAT(keyboard_->batches,
+              ElementsAre(Batch({{EV_KEY, KEY_LEFTCTRL, 0}}) + " " +
+                          Batch({{EV_KEY, KEY_B, 1}}) + " " +
+                          Batch({{EV_KEY, KEY_B, 0}}) + " " +
+                          Batch({{EV_KEY, KEY_LEFTCTRL, 1}})));
+}
+
+TEST_F(UinputInputSinkTest, MovesRelativelyCarryingFractions) {
+  sink_->MouseMoveRelative(3, -4);
+  sink_->MouseMoveRelative(0.6, -0.6);
+  sink_->MouseMoveRelative(0.6, 0);
+
+  EXPECT_THAT(mouse_->batches,
+              ElementsAre(Batch({{EV_REL, REL_X, 3}, {EV_REL, REL_Y, -4}}),
+                          Batch({{EV_REL, REL_X, 1}})));
+}
+
+TEST_F(UinputInputSinkTest, MapsButtonIds) {
+  for (int button = 1; button <= 6; ++button) {
+    sink_->MouseButton(button, true);
+  }
+  sink_->MouseButton(1, false);
+
+  EXPECT_THAT(mouse_->batches,
+              ElementsAre(Batch({{EV_KEY, BTN_LEFT, 1}}), Batch({{EV_KEY, BTN_MIDDLE, 1}}),
+                          Batch({{EV_KEY, BTN_RIGHT, 1}}), Batch({{EV_KEY, BTN_SIDE, 1}}),
+                          Batch({{EV_KEY, BTN_EXTRA, 1}}), Batch({{EV_KEY, BTN_LEFT, 0}})));
+}
+
+TEST_F(UinputInputSinkTest, ScrollsInHiResUnitsWithWholeLegacyNotches) {
+  sink_->MouseScroll(0, 30);
+  sink_->MouseScroll(0, 30);
+  sink_->MouseScroll(-60, 0);
+
+  EXPECT_THAT(mouse_->batches,
+              ElementsAre(Batch({{EV_REL, REL_WHEEL_HI_RES, 60}}),
+                          Batch({{EV_REL, REL_WHEEL, 1}, {EV_REL, REL_WHEEL_HI_RES, 60}}),
+                          Batch({{EV_REL, REL_HWHEEL, -1},
+                                 {EV_REL, REL_HWHEEL_HI_RES, -120}})));
+}
+
+TEST_F(UinputInputSinkTest, MovesAbsolutelyAcrossTheScreenLayout) {
+  sink_->MouseMoveAbsolute(0, 0, 0);
+  sink_->MouseMoveAbsolute(0.5, 0.5, 1);
+  sink_->MouseMoveAbsolute(1, 1, 1);
+  sink_->MouseMoveAbsolute(0.5, 0.5, 2);
+
+  EXPECT_THAT(pointer_->batches,
+              ElementsAre(Batch({{EV_ABS, ABS_X, 0}, {EV_ABS, ABS_Y, 0}}),
+                          Batch({{EV_ABS, ABS_X, 49151}, {EV_ABS, ABS_Y, 32767}}),
+                          Batch({{EV_ABS, ABS_X, kUinputAxisMax},
+                                 {EV_ABS, ABS_Y, kUinputAxisMax}})));
+  EXPECT_THAT(mouse_->batches, IsEmpty());
+}
+
+TEST_F(UinputInputSinkTest, ReportsTouchContactsInTypeBSlots) {
+  sink_->TouchEvent(0, 0.25, 0.5, 7, true);
+  sink_->TouchEvent(0, 0.75, 0.5, 9, true);
+  sink_->TouchMove(0, 0.75, 0.25, 9);
+  sink_->TouchMove(0, 0.5, 0.5, 7);
+  sink_->TouchEvent(0, 0.5, 0.5, 7, false);
+  sink_->TouchEvent(0, 0.75, 0.25, 9, false);
+
+  EXPECT_THAT(
+      touch_->batches,
+      ElementsAre(
+          Batch({{EV_ABS, ABS_MT_SLOT, 0},
+                 {EV_ABS, ABS_MT_TRACKING_ID, 0},
+                 {EV_ABS, ABS_MT_POSITION_X, 8191},
+                 {EV_ABS, ABS_MT_POSITION_Y, 32767},
+                 {EV_KEY, BTN_TOUCH, 1},
+                 {EV_ABS, ABS_X, 8191},
+                 {EV_ABS, ABS_Y, 32767}}),
+          Batch({{EV_ABS, ABS_MT_SLOT, 1},
+                 {EV_ABS, ABS_MT_TRACKING_ID, 1},
+                 {EV_ABS, ABS_MT_POSITION_X, 24575},
+                 {EV_ABS, ABS_MT_POSITION_Y, 32767}}),
+          Batch({{EV_ABS, ABS_MT_POSITION_X, 24575},
+                 {EV_ABS, ABS_MT_POSITION_Y, 16383}}),
+          Batch({{EV_ABS, ABS_MT_SLOT, 0},
+                 {EV_ABS, ABS_MT_POSITION_X, 16383},
+                 {EV_ABS, ABS_MT_POSITION_Y, 32767},
+                 {EV_ABS, ABS_X, 16383},
+                 {EV_ABS, ABS_Y, 32767}}),
+          // The single-touch axes move over to the contact still down.
+          Batch({{EV_ABS, ABS_MT_TRACKING_ID, -1},
+                 {EV_ABS, ABS_X, 24575},
+                 {EV_ABS, ABS_Y, 16383}}),
+          Batch({{EV_ABS, ABS_MT_SLOT, 1},
+                 {EV_ABS, ABS_MT_TRACKING_ID, -1},
+                 {EV_KEY, BTN_TOUCH, 0}})));
+}
+
+TEST_F(UinputInputSinkTest, ReusesFreedSlotsWithNewTrackingIds) {
+  sink_->TouchEvent(1, 0, 0, 1, true);
+  sink_->TouchEvent(1, 0, 0, 2, true);
+  sink_->TouchEvent(1, 0, 0, 1, false);
+  sink_->TouchMove(1, 0.5, 0, 2);
+  touch_->batches.clear();
+  sink_->TouchEvent(1, 0.5, 0.5, 3, true);
+
+  EXPECT_THAT(touch_->batches,
+              ElementsAre(Batch({{EV_ABS, ABS_MT_SLOT, 0},
+                                 {EV_ABS, ABS_MT_TRACKING_ID, 2},
+                                 {EV_ABS, ABS_MT_POSITION_X, 49151},
+                                 {EV_ABS, ABS_MT_POSITION_Y, 32767}})));
+}
+
+TEST_F(UinputInputSinkTest, IgnoresUnknownContactsAndScreens) {
+  sink_->TouchMove(0, 0.5, 0.5, 4);
+  sink_->TouchEvent(0, 0.5, 0.5, 4, false);
+  sink_->TouchEvent(2, 0.5, 0.5, 4, true);
+  sink_->TouchRepeat(4);
+  sink_->TouchEvent(0, 0.5, 0.5, 4, true);
+  sink_->TouchMove(0, 0.5, 0.5, 4);
+
+  // The last move changes nothing, so it writes nothing.
+  EXPECT_THAT(touch_->batches, ElementsAre(Batch({{EV_ABS, ABS_MT_SLOT, 0},
+                                                  {EV_ABS, ABS_MT_TRACKING_ID, 0},
+                                                  {EV_ABS, ABS_MT_POSITION_X, 16383},
+                                                  {EV_ABS, ABS_MT_POSITION_Y, 32767},
+                                                  {EV_KEY, BTN_TOUCH, 1},
+                                                  {EV_ABS, ABS_X, 16383},
+                                                  {EV_ABS, ABS_Y, 32767}})));
+}
+
+TEST_F(UinputInputSinkTest, WritesATouchFrameAsOneBatch) {
+  TouchUpdate frame[3];
+  frame[0].type = TouchUpdateType::kDown;
+  frame[0].touch_id = 1;
+  frame[0].x = 0.25;
+  frame[1] = frame[0];
+  frame[1].touch_id = 2;
+  frame[1].x = 0.5;
+  // Unknown contacts are skipped, not a reason to split the frame.
+  frame[2].type = TouchUpdateType::kMove;
+  frame[2].touch_id = 3;
+  sink_->TouchFrame(frame, 3);
+
+  EXPECT_THAT(touch_->batches,
+              ElementsAre(Batch({{EV_ABS, ABS_MT_SLOT, 0},
+                                 {EV_ABS, ABS_MT_TRACKING_ID, 0},
+                                 {EV_ABS, ABS_MT_POSITION_X, 8191},
+                                 {EV_ABS, ABS_MT_POSITION_Y, 0},
+                                 {EV_ABS, ABS_MT_SLOT, 1},
+                                 {EV_ABS, ABS_MT_TRACKING_ID, 1},
+                                 {EV_ABS, ABS_MT_POSITION_X, 16383},
+                                 {EV_ABS, ABS_MT_POSITION_Y, 0},
+                                 {EV_KEY, BTN_TOUCH, 1},
+                                 {EV_ABS, ABS_X, 8191},
+                                 {EV_ABS, ABS_Y, 0}})));
+}
+
+TEST_F(UinputInputSinkTest, DropsContactsBeyondTheSlotCount) {
+  for (uint32_t id = 0; id <= static_cast<uint32_t>(kUinputTouchSlots); ++id) {
+    sink_->TouchEvent(0, 0.5, 0.5, id, true);
+  }
+  EXPECT_EQ(touch_->batches.size(), static_cast<size_t>(kUinputTouchSlots));
+  EXPECT_EQ(touch_->batches.back(),
+            Batch({{EV_ABS, ABS_MT_SLOT, kUinputTouchSlots - 1},
+                   {EV_ABS, ABS_MT_TRACKING_ID, kUinputTouchSlots - 1},
+                   {EV_ABS, ABS_MT_POSITION_X, 16383},
+                   {EV_ABS, ABS_MT_POSITION_Y, 32767}}));
+}
+
+TEST_F(UinputInputSinkTest, ReportsPenStrokes) {
+  // Tilted 45 degrees toward the right (rotation 90), half pressure.
+  sink_->PenEvent(0, 0.5, 0.5, true, false, 0.5, 90, 45);
+  sink_->PenMove(0, 0.25, 0.5, true, 0.25, 90, 45);
+  sink_->PenMove(0, 0.25, 0.5, false, 0.25, 90, 45);
+  sink_->PenEvent(0, 0.25, 0.5, false, false, 0, 90, 45);
+
+  EXPECT_THAT(pen_->batches,
+              ElementsAre(Batch({{EV_KEY, BTN_TOOL_PEN, 1},
+                                 {EV_ABS, ABS_X, 16383},
+                                 {EV_ABS, ABS_Y, 32767},
+                                 {EV_ABS, ABS_PRESSURE, 2047},
+                                 {EV_ABS, ABS_TILT_X, -45},
+                                 {EV_KEY, BTN_TOUCH, 1}}),
+                          Batch({{EV_ABS, ABS_X, 8191},
+                                 {EV_ABS, ABS_PRESSURE, 1023},
+                                 {EV_KEY, BTN_STYLUS, 1}}),
+                          Batch({{EV_KEY, BTN_STYLUS, 0}}),
+                          Batch({{EV_ABS, ABS_PRESSURE, 0},
+                                 {EV_KEY, BTN_TOUCH, 0},
+                                 {EV_KEY, BTN_TOOL_PEN, 0}})));
+}
+
+TEST_F(UinputInputSinkTest, HoversOnMovesWhileThePenIsUp) {
+  sink_->PenEvent(0, 0.5, 0.5, false, false, 0, -1, -1);
+  sink_->PenMove(1, 0, 0, false, 0.8, -1, -1);
+  sink_->PenEvent(1, 0, 0, true, false, 0, -1, -1);
+
+  EXPECT_THAT(pen_->batches,
+              ElementsAre(Batch({{EV_KEY, BTN_TOOL_PEN, 1}, {EV_ABS, ABS_X, 32767}}),
+                          // No pressure reported in contact: half.
+                          Batch({{EV_ABS, ABS_PRESSURE, 2047}, {EV_KEY, BTN_TOUCH, 1}})));
+}
+
+TEST_F(UinputInputSinkTest, WritesPenRunsAsOneBatchOfFrames) {
+  sink_->PenEvent(0, 0.5, 0.5, true, false, 0.5, -1, -1);
+  PenSample samples[3];
+  samples[0].x = 0.25;
+  samples[0].y = 0.5;
+  samples[0].pressure = 0.25f;
+  samples[1] = samples[0];
+  samples[2] = samples[0];
+  samples[2].x = 0.125;
+  samples[2].pressure = 0;
+  sink_->PenMoveBatch(0, samples, 3);
+  sink_->PenMoveBatch(2, samples, 3);
+
+  ASSERT_EQ(pen_->batches.size(), 2u);
+  // The unchanged second sample adds no frame; no pressure in contact is half.
+  EXPECT_EQ(pen_->batches[1],
+            Batch({{EV_ABS, ABS_X, 8191}, {EV_ABS, ABS_PRESSURE, 1023}}) + " " +
+                Batch({{EV_ABS, ABS_X, 4095}, {EV_ABS, ABS_PRESSURE, 2047}}));
+}
+
+TEST(UinputDevice, RejectsNodesThatAreNotUinput) {
+  EXPECT_EQ(UinputDevice::Create(KeyboardDeviceSpec(), "/dev/null"), nullptr);
+  EXPECT_EQ(UinputDevice::Create(KeyboardDeviceSpec(), "/nonexistent"), nullptr);
+}
+
+TEST(UinputDevice, KeyboardHasEveryMappedKey) {
+  UinputDeviceSpec spec = KeyboardDeviceSpec();
+  EXPECT_THAT(spec.keys, Contains(KEY_A));
+  EXPECT_THAT(spec.keys, Contains(KEY_LEFTMETA));
+  EXPECT_THAT(spec.keys, Contains(KEY_102ND));
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
@@ -0,0 +1,159 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "recording_event_writer.h"
+#include "text_input.h"
+#include "uinput_text_sink.h"
+
+namespace hardware_simulator {
+namespace test {
+
+namespace {
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+constexpr uint32_t kVkReturn = 0x0D;
+
+// A US layout's letters and digits, plus "@" on Shift+2 and "€" on AltGr+E.
+bool LookupUsKeysym(uint32_t keysym, KeyPosition* position) {
+  if (keysym == 'a' || keysym == 'b') {
+    position->evdev = keysym == 'a' ? KEY_A : KEY_B;
+    return true;
+  }
+  if (keysym == 'A') {
+    position->evdev = KEY_A;
+    position->shift = true;
+    return true;
+  }
+  if (keysym == '@') {
+    position->evdev = KEY_2;
+    position->shift = true;
+    return true;
+  }
+  if (keysym == 0x010020AC) {  // €
+    position->evdev = KEY_E;
+    position->alt_gr = true;
+    return true;
+  }
+  return false;
+}
+
+// What a batch of key changes records: one SYN_REPORT frame per change,
+// all in one write.
+std::string Keys(std::initializer_list<std::pair<uint16_t, int32_t>> keys) {
+  std::string batch;
+  for (const auto& key : keys) {
+    if (!batch.empty()) {
+      batch += " ";
+    }
+    batch += Batch({{EV_KEY, key.first, key.second}});
+  }
+  return batch;
+}
+
+std::vector<TypedKey> Decode(const std::string& text) {
+  std::vector<TypedKey> keys;
+  DecodeTypedText(text.data(), text.size(), &keys);
+  return keys;
+}
+
+class FailingEventWriter : public EventWriter {
+ public:
+  bool Write(const input_event*, size_t) override { return false; }
+};
+
+}  // namespace
+
+TEST(UinputTextSink, TypesCharactersOnTheirLayoutKeys) {
+  RecordingEventWriter keyboard;
+  UinputTextSink sink(keyboard, LookupUsKeysym);
+  std::vector<TypedKey> keys = Decode("aA@");
+
+  EXPECT_EQ(sink.TypeKeys(keys.data(), keys.size()), 3u);
+  EXPECT_THAT(keyboard.batches,
+              ElementsAre(Keys({{KEY_A, 1}, {KEY_A, 0},
+                                {KEY_LEFTSHIFT, 1}, {KEY_A, 1}, {KEY_A, 0},
+                                {KEY_LEFTSHIFT, 0},
+                                {KEY_LEFTSHIFT, 1}, {KEY_2, 1}, {KEY_2, 0},
+                                {KEY_LEFTSHIFT, 0}})));
+}
+
+TEST(UinputTextSink, HoldsAltGrForThirdLevelCharacters) {
+  RecordingEventWriter keyboard;
+  UinputTextSink sink(keyboard, LookupUsKeysym);
+  std::vector<TypedKey> keys = Decode("\xE2\x82\xAC");
+
+  sink.TypeKeys(keys.data(), keys.size());
+
+  EXPECT_THAT(keyboard.batches,
+              ElementsAre(Keys({{KEY_RIGHTALT, 1}, {KEY_E, 1}, {KEY_E, 0},
+                                {KEY_RIGHTALT, 0}})));
+}
+
+TEST(UinputTextSink, PressesKeysByVirtualKeyCode) {
+  RecordingEventWriter keyboard;
+  UinputTextSink sink(keyboard, LookupUsKeysym);
+  TypedKey enter{TypedKeyKind::kKey, kVkReturn};
+
+  sink.TypeKeys(&enter, 1);
+
+  EXPECT_THAT(keyboard.batches,
+              ElementsAre(Keys({{KEY_ENTER, 1}, {KEY_ENTER, 0}})));
+}
+
+// "ñ" (U+00F1) is not on the layout: Ctrl+Shift+U, then f1 and a space.
+TEST(UinputTextSink, EntersCharactersOffTheLayoutAsUnicode) {
+  RecordingEventWriter keyboard;
+  UinputTextSink sink(keyboard, LookupUsKeysym);
+  std::vector<TypedKey> keys = Decode("\xC3\xB1");
+
+  EXPECT_EQ(sink.TypeKeys(keys.data(), keys.size()), 1u);
+  EXPECT_THAT(keyboard.batches,
+              ElementsAre(Keys({{KEY_LEFTCTRL, 1}, {KEY_LEFTSHIFT, 1},
+                                {KEY_U, 1}, {KEY_U, 0},
+                                {KEY_LEFTSHIFT, 0}, {KEY_LEFTCTRL, 0},
+                                {KEY_F, 1}, {KEY_F, 0},
+                                {KEY_1, 1}, {KEY_1, 0},
+                                {KEY_SPACE, 1}, {KEY_SPACE, 0}})));
+}
+
+TEST(UinputTextSink, WritesEachBatchOnce) {
+  RecordingEventWriter keyboard;
+  UinputTextSink sink(keyboard, LookupUsKeysym);
+  std::vector<TypedKey> keys = Decode("abab");
+  TextPacing pacing;
+  pacing.keys_per_batch = 2;
+  size_t typed = 0;
+
+  EXPECT_TRUE(TypeNextBatch(keys, pacing, sink, &typed));
+  EXPECT_TRUE(TypeNextBatch(keys, pacing, sink, &typed));
+
+  EXPECT_EQ(typed, 4u);
+  std::string ab = Keys({{KEY_A, 1}, {KEY_A, 0}, {KEY_B, 1}, {KEY_B, 0}});
+  EXPECT_THAT(keyboard.batches, ElementsAre(ab, ab));
+}
+
+TEST(UinputTextSink, TypesNothingWhenTheWriteFails) {
+  FailingEventWriter keyboard;
+  UinputTextSink sink(keyboard, LookupUsKeysym);
+  std::vector<TypedKey> keys = Decode("ab");
+
+  EXPECT_EQ(sink.TypeKeys(keys.data(), keys.size()), 0u);
+}
+
+TEST(UinputTextSink, WritesNothingForAnEmptyBatch) {
+  RecordingEventWriter keyboard;
+  UinputTextSink sink(keyboard, LookupUsKeysym);
+
+  EXPECT_EQ(sink.TypeKeys(nullptr, 0), 0u);
+  EXPECT_THAT(keyboard.batches, IsEmpty());
+}
+
+}  // namespace test
+}  // namespace hardware_simulator
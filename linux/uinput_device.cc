@@ -0,0 +1,157 @@
+#include "uinput_device.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/uinput.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "key_codes.h"
+
+namespace hardware_simulator {
+
+namespace {
+
+constexpr uint16_t kMouseButtons[] = {BTN_LEFT, BTN_RIGHT, BTN_MIDDLE,
+                                      BTN_SIDE, BTN_EXTRA};
+
+bool SetBits(int fd, unsigned long request,
+             const std::vector<uint16_t>& codes) {
+  for (uint16_t code : codes) {
+    if (ioctl(fd, request, static_cast<int>(code)) < 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Configure(int fd, const UinputDeviceSpec& spec) {
+  if ((!spec.keys.empty() && ioctl(fd, UI_SET_EVBIT, EV_KEY) < 0) ||
+      (!spec.relative_axes.empty() && ioctl(fd, UI_SET_EVBIT, EV_REL) < 0) ||
+      (!spec.absolute_axes.empty() && ioctl(fd, UI_SET_EVBIT, EV_ABS) < 0) ||
+      ioctl(fd, UI_SET_EVBIT, EV_SYN) < 0) {
+    return false;
+  }
+  if (!SetBits(fd, UI_SET_KEYBIT, spec.keys) ||
+      !SetBits(fd, UI_SET_RELBIT, spec.relative_axes) ||
+      !SetBits(fd, UI_SET_PROPBIT, spec.properties)) {
+    return false;
+  }
+  for (const UinputAxis& axis : spec.absolute_axes) {
+    uinput_abs_setup setup{};
+    setup.code = axis.code;
+    setup.absinfo.minimum = axis.min;
+    setup.absinfo.maximum = axis.max;
+    setup.absinfo.resolution = axis.resolution;
+    if (ioctl(fd, UI_SET_ABSBIT, static_cast<int>(axis.code)) < 0 ||
+        ioctl(fd, UI_ABS_SETUP, &setup) < 0) {
+      return false;
+    }
+  }
+
+  uinput_setup setup{};
+  setup.id.bustype = BUS_VIRTUAL;
+  setup.id.product = spec.product;
+  std::strncpy(setup.name, spec.name.c_str(), UINPUT_MAX_NAME_SIZE - 1);
+  return ioctl(fd, UI_DEV_SETUP, &setup) >= 0 && ioctl(fd, UI_DEV_CREATE) >= 0;
+}
+
+}  // namespace
+
+UinputDeviceSpec KeyboardDeviceSpec() {
+  UinputDeviceSpec spec;
+  spec.name = "Hardware Simulator Keyboard";
+  spec.product = 1;
+  for (int vk = 1; vk < 256; ++vk) {
+    uint16_t code = KeyCodesFor(static_cast<uint16_t>(vk)).evdev;
+    if (code != 0 &&
+        std::find(spec.keys.begin(), spec.keys.end(), code) == spec.keys.end()) {
+      spec.keys.push_back(code);
+    }
+  }
+  return spec;
+}
+
+UinputDeviceSpec MouseDeviceSpec() {
+  UinputDeviceSpec spec;
+  spec.name = "Hardware Simulator Mouse";
+  spec.product = 2;
+  spec.keys.assign(std::begin(kMouseButtons), std::end(kMouseButtons));
+  spec.relative_axes = {REL_X,     REL_Y,           REL_WHEEL,
+                        REL_HWHEEL, REL_WHEEL_HI_RES, REL_HWHEEL_HI_RES};
+  return spec;
+}
+
+UinputDeviceSpec PointerDeviceSpec() {
+  UinputDeviceSpec spec;
+  spec.name = "Hardware Simulator Pointer";
+  spec.product = 3;
+  // Absolute axes without buttons aren't classified as a pointer, so the
+  // display server would ignore the device. Clicks still go to the mouse.
+  spec.keys.assign(std::begin(kMouseButtons), std::end(kMouseButtons));
+  spec.absolute_axes = {{ABS_X, 0, kUinputAxisMax, 0},
+                        {ABS_Y, 0, kUinputAxisMax, 0}};
+  return spec;
+}
+
+UinputDeviceSpec TouchscreenDeviceSpec() {
+  UinputDeviceSpec spec;
+  spec.name = "Hardware Simulator Touchscreen";
+  spec.product = 4;
+  spec.keys = {BTN_TOUCH};
+  spec.absolute_axes = {{ABS_X, 0, kUinputAxisMax, 0},
+                        {ABS_Y, 0, kUinputAxisMax, 0},
+                        {ABS_MT_SLOT, 0, kUinputTouchSlots - 1, 0},
+                        {ABS_MT_TRACKING_ID, 0, 65535, 0},
+                        {ABS_MT_POSITION_X, 0, kUinputAxisMax, 0},
+                        {ABS_MT_POSITION_Y, 0, kUinputAxisMax, 0}};
+  spec.properties = {INPUT_PROP_DIRECT};
+  return spec;
+}
+
+UinputDeviceSpec PenDeviceSpec() {
+  UinputDeviceSpec spec;
+  spec.name = "Hardware Simulator Pen";
+  spec.product = 5;
+  spec.keys = {BTN_TOOL_PEN, BTN_TOUCH, BTN_STYLUS};
+  // Tilt resolution is in units per radian.
+  spec.absolute_axes = {{ABS_X, 0, kUinputAxisMax, 0},
+                        {ABS_Y, 0, kUinputAxisMax, 0},
+                        {ABS_PRESSURE, 0, kUinputPenPressureMax, 0},
+                        {ABS_TILT_X, -90, 90, 57},
+                        {ABS_TILT_Y, -90, 90, 57}};
+  spec.properties = {INPUT_PROP_DIRECT};
+  return spec;
+}
+
+std::unique_ptr<UinputDevice> UinputDevice::Create(const UinputDeviceSpec& spec,
+                                                   const char* path) {
+  int fd = open(path, O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+  if (fd < 0) {
+    return nullptr;
+  }
+  if (!Configure(fd, spec)) {
+    close(fd);
+    return nullptr;
+  }
+  return std::unique_ptr<UinputDevice>(new UinputDevice(fd));
+}
+
+UinputDevice::~UinputDevice() {
+  ioctl(fd_, UI_DEV_DESTROY);
+  close(fd_);
+}
+
+bool UinputDevice::Write(const input_event* events, size_t count) {
+  size_t size = count * sizeof(input_event);
+  ssize_t written;
+  do {
+    written = write(fd_, events, size);
+  } while (written < 0 && errno == EINTR);
+  return written == static_cast<ssize_t>(size);
+}
+
+}  // namespace hardware_simulator
@@ -0,0 +1,90 @@
+#ifndef FLUTTER_PLUGIN_UINPUT_DEVICE_H_
+#define FLUTTER_PLUGIN_UINPUT_DEVICE_H_
+
+#include <linux/input.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "touch_contact_table.h"
+
+namespace hardware_simulator {
+
+// Range of every absolute axis the virtual devices report. The kernel and
+// the display server scale it to the span of the screen layout.
+constexpr int32_t kUinputAxisMax = 65535;
+
+// Multitouch slots of the virtual touchscreen.
+constexpr int32_t kUinputTouchSlots = static_cast<int32_t>(kDefaultMaxTouchContacts);
+
+// Range of the virtual pen's ABS_PRESSURE.
+constexpr int32_t kUinputPenPressureMax = 4095;
+
+// Destination of evdev events.
+class EventWriter {
+ public:
+  virtual ~EventWriter() = default;
+
+  // Writes |count| events at once, so the reader never sees part of a
+  // frame. Callers end each batch with SYN_REPORT.
+  virtual bool Write(const input_event* events, size_t count) = 0;
+};
+
+struct UinputAxis {
+  uint16_t code = 0;
+  int32_t min = 0;
+  int32_t max = 0;
+  int32_t resolution = 0;  // Units per millimetre; 0 if unknown.
+};
+
+// The capabilities a virtual device is created with.
+struct UinputDeviceSpec {
+  std::string name;
+  uint16_t product = 0;
+  std::vector<uint16_t> keys;  // EV_KEY codes, buttons included.
+  std::vector<uint16_t> relative_axes;
+  std::vector<UinputAxis> absolute_axes;
+  std::vector<uint16_t> properties;  // INPUT_PROP_*.
+};
+
+// Every key a virtual-key code maps to.
+UinputDeviceSpec KeyboardDeviceSpec();
+// Buttons 1-5, motion and both wheels.
+UinputDeviceSpec MouseDeviceSpec();
+// Buttons and ABS_X/ABS_Y over 0..kUinputAxisMax.
+UinputDeviceSpec PointerDeviceSpec();
+// A direct touchscreen with kUinputTouchSlots type B slots over
+// 0..kUinputAxisMax, plus the single-touch axes it emulates.
+UinputDeviceSpec TouchscreenDeviceSpec();
+// A pen display: tip, barrel button, pressure, and tilt in degrees over the
+// same span as the touchscreen.
+UinputDeviceSpec PenDeviceSpec();
+
+// A device created through /dev/uinput, destroyed with the object. The
+// kernel releases any key or button it still holds when it goes away.
+class UinputDevice : public EventWriter {
+ public:
+  // Null when |path| can't be opened for writing, usually for lack of access
+  // to /dev/uinput, or isn't a uinput node.
+  static std::unique_ptr<UinputDevice> Create(
+      const UinputDeviceSpec& spec, const char* path = "/dev/uinput");
+
+  ~UinputDevice() override;
+
+  UinputDevice(const UinputDevice&) = delete;
+  UinputDevice& operator=(const UinputDevice&) = delete;
+
+  bool Write(const input_event* events, size_t count) override;
+
+ private:
+  explicit UinputDevice(int fd) : fd_(fd) {}
+
+  int fd_;
+};
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_UINPUT_DEVICE_H_
@@ -0,0 +1,455 @@
+#include "uinput_input_sink.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "key_codes.h"
+#include "pen_tilt.h"
+
+namespace hardware_simulator {
+
+namespace {
+
+// A wheel notch in REL_WHEEL_HI_RES units, which are WHEEL_DELTA units.
+constexpr int32_t kWheelNotch = 120;
+
+uint16_t ButtonCode(int button_id) {
+  switch (button_id) {
+    case 1:
+      return BTN_LEFT;
+    case 2:
+      return BTN_MIDDLE;
+    case 3:
+      return BTN_RIGHT;
+    case 4:
+      return BTN_SIDE;
+    case 5:
+      return BTN_EXTRA;
+    default:
+      return 0;
+  }
+}
+
+// ABS_PRESSURE for a 0..1 pressure. A pen in contact that doesn't report
+// pressure gets half, so readers that take the tip from pressure see it.
+int32_t PenPressure(double pressure) {
+  if (!(pressure > 0)) {
+    return kUinputPenPressureMax / 2;
+  }
+  return std::clamp(static_cast<int32_t>(pressure * kUinputPenPressureMax), 1,
+                    kUinputPenPressureMax);
+}
+
+// Whole units of |value| plus what was carried, keeping the fraction.
+int32_t TakeWhole(double value, double* remainder) {
+  double total = value + *remainder;
+  int32_t whole = static_cast<int32_t>(total);
+  *remainder = total - whole;
+  return whole;
+}
+
+}  // namespace
+
+std::shared_ptr<const ScreenTransform> MakeUinputScreenTransform(
+    std::vector<ScreenRect> screens) {
+  ScreenMetrics metrics;
+  for (const ScreenRect& screen : screens) {
+    if (screen.is_primary) {
+      metrics.primary_width = screen.right - screen.left;
+      metrics.primary_height = screen.bottom - screen.top;
+    }
+  }
+  metrics.virtual_width = kUinputAxisMax;
+  metrics.virtual_height = kUinputAxisMax;
+  return std::make_shared<const ScreenTransform>(std::move(screens), metrics);
+}
+
+UinputInputSink::UinputInputSink(UinputWriters writers,
+                                 const ScreenTransformPublisher& screens)
+    : writers_(std::move(writers)), screens_(screens) {
+  batch_.reserve(8);
+}
+
+std::unique_ptr<UinputInputSink> UinputInputSink::Create(
+    const ScreenTransformPublisher& screens) {
+  UinputWriters writers;
+  writers.keyboard = UinputDevice::Create(KeyboardDeviceSpec());
+  writers.mouse = UinputDevice::Create(MouseDeviceSpec());
+  writers.pointer = UinputDevice::Create(PointerDeviceSpec());
+  writers.touch = UinputDevice::Create(TouchscreenDeviceSpec());
+  writers.pen = UinputDevice::Create(PenDeviceSpec());
+  if (!writers.keyboard || !writers.mouse || !writers.pointer || !writers.touch ||
+      !writers.pen) {
+    return nullptr;
+  }
+  return std::make_unique<UinputInputSink>(std::move(writers), screens);
+}
+
+void UinputInputSink::KeyEvent(uint16_t key_code, bool is_down) {
+  uint16_t code = KeyCodesFor(key_code).evdev;
+  if (code == 0) {
+    return;
+  }
+  held_keys_.set(code, is_down);
+  Add(EV_KEY, code, is_down ? 1 : 0);
+  Commit(writers_.keyboard.get());
+}
+
+bool UinputInputSink::WriteKeyFrames(const input_event* events, size_t count) {
+  static constexpr uint16_t kModifierKeys[] = {
+      KEY_LEFTSHIFT, KEY_RIGHTSHIFT, KEY_LEFTCTRL, KEY_RIGHTCTRL,
+      KEY_LEFTALT,   KEY_RIGHTALT,   KEY_LEFTMETA, KEY_RIGHTMETA};
+  auto add_held_modifiers = [this](int32_t value) {
+    size_t frame_start = batch_.size();
+    for (uint16_t code : kModifierKeys) {
+      if (held_keys_.test(code)) {
+        Add(EV_KEY, code, value);
+      }
+    }
+    if (batch_.size() != frame_start) {
+      Add(EV_SYN, SYN_REPORT, 0);
+    }
+  };
+  add_held_modifiers(0);
+  batch_.insert(batch_.end(), events, events + count);
+  add_held_modifiers(1);
+  bool written = batch_.empty() ||
+                 writers_.keyboard->Write(batch_.data(), batch_.size());
+  batch_.clear();
+  return written;
+}
+
+void UinputInputSink::MouseMoveRelative(double dx, double dy) {
+  int32_t x = TakeWhole(dx, &remainder_x_);
+  int32_t y = TakeWhole(dy, &remainder_y_);
+  if (x != 0) {
+    Add(EV_REL, REL_X, x);
+  }
+  if (y != 0) {
+    Add(EV_REL, REL_Y, y);
+  }
+  Commit(writers_.mouse.get());
+}
+
+void UinputInputSink::MouseMoveAbsolute(double x, double y, int screen_id) {
+  int32_t axis_x;
+  int32_t axis_y;
+  if (!screens_.Current()->ToVirtualDesktop(screen_id, x, y, &axis_x, &axis_y)) {
+    return;
+  }
+  Add(EV_ABS, ABS_X, std::clamp(axis_x, 0, kUinputAxisMax));
+  Add(EV_ABS, ABS_Y, std::clamp(axis_y, 0, kUinputAxisMax));
+  Commit(writers_.pointer.get());
+}
+
+void UinputInputSink::MouseButton(int button_id, bool is_down) {
+  uint16_t code = ButtonCode(button_id);
+  if (code == 0) {
+    return;
+  }
+  Add(EV_KEY, code, is_down ? 1 : 0);
+  Commit(writers_.mouse.get());
+}
+
+void UinputInputSink::MouseScroll(double dx, double dy) {
+  // The same scale as the Windows backend's WHEEL_DELTA units. Readers that
+  // only know the legacy axes get whole notches as they add up.
+  int32_t hwheel = static_cast<int32_t>(dx) * 2;
+  int32_t wheel = static_cast<int32_t>(dy) * 2;
+  if (wheel != 0) {
+    wheel_remainder_ += wheel;
+    int32_t notches = wheel_remainder_ / kWheelNotch;
+    wheel_remainder_ -= notches * kWheelNotch;
+    if (notches != 0) {
+      Add(EV_REL, REL_WHEEL, notches);
+    }
+    Add(EV_REL, REL_WHEEL_HI_RES, wheel);
+  }
+  if (hwheel != 0) {
+    hwheel_remainder_ += hwheel;
+    int32_t notches = hwheel_remainder_ / kWheelNotch;
+    hwheel_remainder_ -= notches * kWheelNotch;
+    if (notches != 0) {
+      Add(EV_REL, REL_HWHEEL, notches);
+    }
+    Add(EV_REL, REL_HWHEEL_HI_RES, hwheel);
+  }
+  Commit(writers_.mouse.get());
+}
+
+void UinputInputSink::TouchEvent(int screen_id, double x, double y,
+                                 uint32_t touch_id, bool is_down) {
+  StageTouchEvent(screen_id, x, y, touch_id, is_down);
+  CommitTouchFrame();
+}
+
+void UinputInputSink::TouchMove(int screen_id, double x, double y,
+                                uint32_t touch_id) {
+  StageTouchMove(screen_id, x, y, touch_id);
+  CommitTouchFrame();
+}
+
+void UinputInputSink::TouchFrame(const TouchUpdate* updates, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    const TouchUpdate& update = updates[i];
+    if (update.type == TouchUpdateType::kMove) {
+      StageTouchMove(update.screen_id, update.x, update.y, update.touch_id);
+    } else {
+      StageTouchEvent(update.screen_id, update.x, update.y, update.touch_id,
+                      update.type == TouchUpdateType::kDown);
+    }
+  }
+  CommitTouchFrame();
+}
+
+void UinputInputSink::StageTouchEvent(int screen_id, double x, double y,
+                                      uint32_t touch_id, bool is_down) {
+  int32_t axis_x;
+  int32_t axis_y;
+  if (!screens_.Current()->ToVirtualDesktop(screen_id, x, y, &axis_x, &axis_y)) {
+    return;
+  }
+  UinputTouchContact* contact;
+  if (is_down) {
+    bool known = touches_.SlotOf(touch_id) >= 0;
+    contact = touches_.Down(touch_id);
+    if (contact == nullptr) {
+      return;
+    }
+    if (!known) {
+      // The table holds at most kUinputTouchSlots contacts, so one is free.
+      contact->mt_slot = __builtin_ctz(~used_mt_slots_);
+      used_mt_slots_ |= 1u << contact->mt_slot;
+    }
+  } else {
+    contact = touches_.Up(touch_id);
+    if (contact == nullptr) {
+      return;
+    }
+  }
+  MoveContact(contact, axis_x, axis_y);
+}
+
+void UinputInputSink::StageTouchMove(int screen_id, double x, double y,
+                                     uint32_t touch_id) {
+  int32_t axis_x;
+  int32_t axis_y;
+  if (!screens_.Current()->ToVirtualDesktop(screen_id, x, y, &axis_x, &axis_y)) {
+    return;
+  }
+  UinputTouchContact* contact = touches_.Move(touch_id);
+  if (contact == nullptr) {
+    return;
+  }
+  MoveContact(contact, axis_x, axis_y);
+}
+
+void UinputInputSink::PenEvent(int screen_id, double x, double y, bool is_down,
+                               bool has_button, double pressure,
+                               double rotation, double tilt) {
+  if (!is_down && !pen_.in_range) {
+    return;
+  }
+  UinputPenState pen = pen_;
+  if (!MapPen(screen_id, x, y, rotation, tilt, &pen)) {
+    return;
+  }
+  pen.in_range = is_down;
+  pen.touching = is_down;
+  pen.button = is_down && has_button;
+  pen.pressure = is_down ? PenPressure(pressure) : 0;
+  AddPenFrame(pen);
+  Flush(writers_.pen.get());
+}
+
+void UinputInputSink::PenMove(int screen_id, double x, double y,
+                              bool has_button, double pressure,
+                              double rotation, double tilt) {
+  UinputPenState pen = pen_;
+  if (!MapPen(screen_id, x, y, rotation, tilt, &pen)) {
+    return;
+  }
+  pen.in_range = true;
+  pen.button = has_button;
+  pen.pressure = pen.touching ? PenPressure(pressure) : 0;
+  AddPenFrame(pen);
+  Flush(writers_.pen.get());
+}
+
+void UinputInputSink::PenMoveBatch(int screen_id, const PenSample* samples,
+                                   size_t count) {
+  std::shared_ptr<const ScreenTransform> screens = screens_.Current();
+  const AffineMap* map = screens->VirtualDesktopMap(screen_id);
+  if (map == nullptr) {
+    return;
+  }
+  ConvertPenSamples(*map, samples, count, kUinputPenPressureMax, &converted_pen_);
+  for (size_t i = 0; i < count; ++i) {
+    UinputPenState pen = pen_;
+    pen.in_range = true;
+    pen.button = samples[i].has_button;
+    pen.x = std::clamp(converted_pen_.x[i], 0, kUinputAxisMax);
+    pen.y = std::clamp(converted_pen_.y[i], 0, kUinputAxisMax);
+    pen.tilt_x = converted_pen_.tilt_x[i];
+    pen.tilt_y = converted_pen_.tilt_y[i];
+    if (pen.touching) {
+      pen.pressure = converted_pen_.pressure[i] > 0 ? converted_pen_.pressure[i]
+                                                    : PenPressure(0);
+    }
+    AddPenFrame(pen);
+  }
+  Flush(writers_.pen.get());
+}
+
+void UinputInputSink::KeyRepeat(uint16_t key_code) {
+  uint16_t code = KeyCodesFor(key_code).evdev;
+  if (code == 0 || !held_keys_.test(code)) {
+    return;
+  }
+  Add(EV_KEY, code, 2);
+  Commit(writers_.keyboard.get());
+}
+
+// Contacts stay down on evdev until they lift; there is nothing to refresh.
+void UinputInputSink::TouchRepeat(uint32_t /*touch_id*/) {}
+
+void UinputInputSink::Add(uint16_t type, uint16_t code, int32_t value) {
+  input_event event{};
+  event.type = type;
+  event.code = code;
+  event.value = value;
+  batch_.push_back(event);
+}
+
+void UinputInputSink::Commit(EventWriter* writer) {
+  if (batch_.empty()) {
+    return;
+  }
+  Add(EV_SYN, SYN_REPORT, 0);
+  Flush(writer);
+}
+
+void UinputInputSink::Flush(EventWriter* writer) {
+  if (batch_.empty()) {
+    return;
+  }
+  writer->Write(batch_.data(), batch_.size());
+  batch_.clear();
+}
+
+void UinputInputSink::MoveContact(UinputTouchContact* contact, int32_t x,
+                                  int32_t y) {
+  x = std::clamp(x, 0, kUinputAxisMax);
+  y = std::clamp(y, 0, kUinputAxisMax);
+  if (x != contact->x || y != contact->y) {
+    contact->x = x;
+    contact->y = y;
+    contact->moved = true;
+  }
+}
+
+void UinputInputSink::CommitTouchFrame() {
+  // The contact single-touch readers follow: the same one while it stays
+  // down, otherwise the first one still down.
+  int pointer = touching_ ? touches_.SlotOf(pointer_touch_id_) : -1;
+  bool pointer_changed = false;
+  if (pointer < 0 || touches_.phase(pointer) == TouchPhase::kUp) {
+    pointer = -1;
+    for (size_t slot = 0; slot < touches_.size(); ++slot) {
+      if (touches_.phase(slot) != TouchPhase::kUp) {
+        pointer = static_cast<int>(slot);
+        break;
+      }
+    }
+    pointer_changed = pointer >= 0;
+  }
+  bool pointer_moved = pointer >= 0 &&
+                       (pointer_changed || touches_.phase(pointer) == TouchPhase::kDown ||
+                        touches_.contacts()[pointer].moved);
+
+  for (size_t slot = 0; slot < touches_.size(); ++slot) {
+    UinputTouchContact& contact = touches_.contacts()[slot];
+    TouchPhase phase = touches_.phase(slot);
+    if (phase == TouchPhase::kDown) {
+      SelectSlot(contact.mt_slot);
+      Add(EV_ABS, ABS_MT_TRACKING_ID, next_tracking_id_);
+      next_tracking_id_ = (next_tracking_id_ + 1) & 0xFFFF;
+    }
+    if (phase == TouchPhase::kDown || contact.moved) {
+      SelectSlot(contact.mt_slot);
+      Add(EV_ABS, ABS_MT_POSITION_X, contact.x);
+      Add(EV_ABS, ABS_MT_POSITION_Y, contact.y);
+    }
+    if (phase == TouchPhase::kUp) {
+      SelectSlot(contact.mt_slot);
+      Add(EV_ABS, ABS_MT_TRACKING_ID, -1);
+      used_mt_slots_ &= ~(1u << contact.mt_slot);
+    }
+    contact.moved = false;
+  }
+
+  bool touching = pointer >= 0;
+  if (touching != touching_) {
+    Add(EV_KEY, BTN_TOUCH, touching ? 1 : 0);
+    touching_ = touching;
+  }
+  if (pointer_moved) {
+    const UinputTouchContact& contact = touches_.contacts()[pointer];
+    pointer_touch_id_ = touches_.touch_id(pointer);
+    Add(EV_ABS, ABS_X, contact.x);
+    Add(EV_ABS, ABS_Y, contact.y);
+  }
+  Commit(writers_.touch.get());
+  touches_.EndFrame();
+}
+
+void UinputInputSink::SelectSlot(int32_t mt_slot) {
+  if (mt_slot != current_mt_slot_) {
+    Add(EV_ABS, ABS_MT_SLOT, mt_slot);
+    current_mt_slot_ = mt_slot;
+  }
+}
+
+bool UinputInputSink::MapPen(int screen_id, double x, double y, double rotation,
+                             double tilt, UinputPenState* pen) const {
+  int32_t axis_x;
+  int32_t axis_y;
+  if (!screens_.Current()->ToVirtualDesktop(screen_id, x, y, &axis_x, &axis_y)) {
+    return false;
+  }
+  pen->x = std::clamp(axis_x, 0, kUinputAxisMax);
+  pen->y = std::clamp(axis_y, 0, kUinputAxisMax);
+  PenTilt pen_tilt;
+  PenTiltFromPolar(rotation, tilt, &pen_tilt);
+  pen->tilt_x = pen_tilt.x;
+  pen->tilt_y = pen_tilt.y;
+  return true;
+}
+
+void UinputInputSink::AddPenFrame(const UinputPenState& pen) {
+  size_t frame_start = batch_.size();
+  auto add_changed = [this](uint16_t type, uint16_t code, int32_t from, int32_t to) {
+    if (from != to) {
+      Add(type, code, to);
+    }
+  };
+  if (pen.in_range && !pen_.in_range) {
+    Add(EV_KEY, BTN_TOOL_PEN, 1);
+  }
+  add_changed(EV_ABS, ABS_X, pen_.x, pen.x);
+  add_changed(EV_ABS, ABS_Y, pen_.y, pen.y);
+  add_changed(EV_ABS, ABS_PRESSURE, pen_.pressure, pen.pressure);
+  add_changed(EV_ABS, ABS_TILT_X, pen_.tilt_x, pen.tilt_x);
+  add_changed(EV_ABS, ABS_TILT_Y, pen_.tilt_y, pen.tilt_y);
+  add_changed(EV_KEY, BTN_TOUCH, pen_.touching, pen.touching);
+  add_changed(EV_KEY, BTN_STYLUS, pen_.button, pen.button);
+  if (!pen.in_range && pen_.in_range) {
+    Add(EV_KEY, BTN_TOOL_PEN, 0);
+  }
+  pen_ = pen;
+  if (batch_.size() != frame_start) {
+    Add(EV_SYN, SYN_REPORT, 0);
+  }
+}
+
+}  // namespace hardware_simulator
@@ -0,0 +1,158 @@
+#ifndef FLUTTER_PLUGIN_UINPUT_INPUT_SINK_H_
+#define FLUTTER_PLUGIN_UINPUT_INPUT_SINK_H_
+
+#include <linux/input.h>
+
+#include <bitset>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "input_sink.h"
+#include "pen_sample_batch.h"
+#include "screen_transform.h"
+#include "touch_contact_table.h"
+#include "uinput_device.h"
+
+namespace hardware_simulator {
+
+// The devices a UinputInputSink writes to.
+struct UinputWriters {
+  std::unique_ptr<EventWriter> keyboard;
+  std::unique_ptr<EventWriter> mouse;
+  std::unique_ptr<EventWriter> pointer;
+  std::unique_ptr<EventWriter> touch;
+  std::unique_ptr<EventWriter> pen;
+};
+
+// A touch contact as the touchscreen reports it.
+struct UinputTouchContact {
+  int32_t x = 0;
+  int32_t y = 0;
+  // Its type B slot, kept for the contact's life. TouchContactTable moves
+  // contacts between its own slots, so this is not the table slot.
+  int32_t mt_slot = 0;
+  // Moved since the last frame.
+  bool moved = false;
+};
+
+// What the pen device reports. Axes start at 0 on the device too.
+struct UinputPenState {
+  bool in_range = false;
+  bool touching = false;
+  bool button = false;
+  int32_t x = 0;
+  int32_t y = 0;
+  int32_t pressure = 0;
+  int32_t tilt_x = 0;
+  int32_t tilt_y = 0;
+};
+
+// A snapshot for UinputInputSink: |screens| in desktop pixels, with the
+// virtual desktop measured in absolute axis units rather than pixels.
+std::shared_ptr<const ScreenTransform> MakeUinputScreenTransform(
+    std::vector<ScreenRect> screens);
+
+// The Linux injection backend: virtual evdev devices created through
+// uinput, which X11 and Wayland sessions alike treat as hardware.
+//
+// Each call writes one batch ending in SYN_REPORT, so the reader applies a
+// move's X and Y, or a wheel's two resolutions, together. Absolute moves
+// map screen fractions onto an ABS_X/ABS_Y range spanning every screen.
+//
+// Touch uses the multitouch type B protocol: every contact change in a
+// frame goes into one batch of ABS_MT_SLOT, ABS_MT_TRACKING_ID and
+// ABS_MT_POSITION_X/Y updates. A TouchFrame is one such frame, however many
+// contacts it changes. For single-touch readers, BTN_TOUCH and
+// ABS_X/ABS_Y follow one contact until it lifts, then another.
+//
+// The pen goes in range with penEvent down and out of range with the up,
+// as on Windows. A penMove while it is up hovers in range. A run of pen
+// moves is written in one batch, one SYN_REPORT frame per sample.
+//
+// Not thread-safe.
+class UinputInputSink : public InputSink {
+ public:
+  // |screens| holds MakeUinputScreenTransform snapshots and must outlive
+  // the sink.
+  UinputInputSink(UinputWriters writers, const ScreenTransformPublisher& screens);
+
+  // Creates the virtual devices; null when any of them can't be.
+  static std::unique_ptr<UinputInputSink> Create(
+      const ScreenTransformPublisher& screens);
+
+  void KeyEvent(uint16_t key_code, bool is_down) override;
+  void MouseMoveRelative(double dx, double dy) override;
+  void MouseMoveAbsolute(double x, double y, int screen_id) override;
+  void MouseButton(int button_id, bool is_down) override;
+  void MouseScroll(double dx, double dy) override;
+  void TouchEvent(int screen_id, double x, double y, uint32_t touch_id,
+                  bool is_down) override;
+  void TouchMove(int screen_id, double x, double y, uint32_t touch_id) override;
+  // Applies every update, then writes one frame for all of them.
+  void TouchFrame(const TouchUpdate* updates, size_t count) override;
+  void PenEvent(int screen_id, double x, double y, bool is_down,
+                bool has_button, double pressure, double rotation,
+                double tilt) override;
+  void PenMove(int screen_id, double x, double y, bool has_button,
+               double pressure, double rotation, double tilt) override;
+  // Converts the run in one pass and writes it as one batch of frames.
+  void PenMoveBatch(int screen_id, const PenSample* samples, size_t count) override;
+  void KeyRepeat(uint16_t key_code) override;
+  void TouchRepeat(uint32_t touch_id) override;
+
+  // Writes |count| key events, each frame ending in SYN_REPORT, to the
+  // keyboard as one batch. Modifiers the client holds are released before
+  // them and pressed again after, so typed text does not pick them up.
+  bool WriteKeyFrames(const input_event* events, size_t count);
+
+ private:
+  void Add(uint16_t type, uint16_t code, int32_t value);
+  // Ends the batch with SYN_REPORT and writes it, unless it is empty.
+  void Commit(EventWriter* writer);
+  // Writes the batch as it is, unless it is empty.
+  void Flush(EventWriter* writer);
+  // Apply one touch update to touches_ without writing anything.
+  void StageTouchEvent(int screen_id, double x, double y, uint32_t touch_id,
+                       bool is_down);
+  void StageTouchMove(int screen_id, double x, double y, uint32_t touch_id);
+  // Updates the position, clamped to the axes, noting whether it changed.
+  void MoveContact(UinputTouchContact* contact, int32_t x, int32_t y);
+  // Emits the contacts' changes since the last frame as one batch.
+  void CommitTouchFrame();
+  void SelectSlot(int32_t mt_slot);
+  // Fills in the position and tilt of |*pen|; false for unknown screens.
+  bool MapPen(int screen_id, double x, double y, double rotation, double tilt,
+              UinputPenState* pen) const;
+  // Adds what changed from pen_ to |pen| as a frame ending in SYN_REPORT,
+  // or nothing if nothing changed.
+  void AddPenFrame(const UinputPenState& pen);
+
+  UinputWriters writers_;
+  const ScreenTransformPublisher& screens_;
+  std::vector<input_event> batch_;
+  std::bitset<KEY_CNT> held_keys_;
+  // Fractions of a pixel, and of a wheel notch in hi-res units, carried
+  // into the next call.
+  double remainder_x_ = 0;
+  double remainder_y_ = 0;
+  int32_t wheel_remainder_ = 0;
+  int32_t hwheel_remainder_ = 0;
+
+  TouchContactTable<UinputTouchContact> touches_{static_cast<size_t>(kUinputTouchSlots)};
+  // Bit n set while type B slot n has a contact.
+  uint32_t used_mt_slots_ = 0;
+  // The slot the device last selected, -1 before the first.
+  int32_t current_mt_slot_ = -1;
+  int32_t next_tracking_id_ = 0;
+  // Touch id of the contact ABS_X/ABS_Y follow, when touching_.
+  uint32_t pointer_touch_id_ = 0;
+  bool touching_ = false;
+
+  UinputPenState pen_;
+  ConvertedPenSamples converted_pen_;
+};
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_UINPUT_INPUT_SINK_H_
@@ -0,0 +1,108 @@
+#include "uinput_text_sink.h"
+
+#include <utility>
+
+#include "key_codes.h"
+
+namespace hardware_simulator {
+
+namespace {
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+// Virtual-key code of a lowercase hex digit: '0'-'9' are their own, 'a'-'f'
+// the letter keys.
+uint16_t HexDigitVirtualKey(char digit) {
+  return static_cast<uint16_t>(digit <= '9' ? digit : digit - 'a' + 'A');
+}
+
+}  // namespace
+
+UinputTextSink::UinputTextSink(EventWriter& keyboard, KeysymLookup lookup)
+    : keyboard_(keyboard), lookup_(std::move(lookup)) {}
+
+size_t UinputTextSink::TypeKeys(const TypedKey* keys, size_t count) {
+  batch_.clear();
+  for (size_t i = 0; i < count; ++i) {
+    if (keys[i].kind == TypedKeyKind::kKey) {
+      KeyPosition position;
+      position.evdev = KeyCodesFor(static_cast<uint16_t>(keys[i].code)).evdev;
+      AddTap(position);
+    } else {
+      AddCharacter(keys[i].code, KeysymForTypedKey(keys[i]));
+    }
+  }
+  if (batch_.empty()) {
+    return count;
+  }
+  return keyboard_.Write(batch_.data(), batch_.size()) ? count : 0;
+}
+
+void UinputTextSink::AddKey(uint16_t code, bool is_down) {
+  input_event event{};
+  event.type = EV_KEY;
+  event.code = code;
+  event.value = is_down ? 1 : 0;
+  batch_.push_back(event);
+  input_event report{};
+  report.type = EV_SYN;
+  report.code = SYN_REPORT;
+  batch_.push_back(report);
+}
+
+void UinputTextSink::AddTap(const KeyPosition& position) {
+  if (position.evdev == 0) {
+    return;
+  }
+  if (position.shift) {
+    AddKey(KEY_LEFTSHIFT, true);
+  }
+  if (position.alt_gr) {
+    AddKey(KEY_RIGHTALT, true);
+  }
+  AddKey(position.evdev, true);
+  AddKey(position.evdev, false);
+  if (position.alt_gr) {
+    AddKey(KEY_RIGHTALT, false);
+  }
+  if (position.shift) {
+    AddKey(KEY_LEFTSHIFT, false);
+  }
+}
+
+void UinputTextSink::AddCharacter(uint32_t code_point, uint32_t keysym) {
+  KeyPosition position;
+  if (lookup_ && lookup_(keysym, &position)) {
+    AddTap(position);
+    return;
+  }
+  AddKey(KEY_LEFTCTRL, true);
+  AddKey(KEY_LEFTSHIFT, true);
+  AddKey(KEY_U, true);
+  AddKey(KEY_U, false);
+  AddKey(KEY_LEFTSHIFT, false);
+  AddKey(KEY_LEFTCTRL, false);
+  char digits[8];
+  int count = 0;
+  do {
+    digits[count++] = kHexDigits[code_point & 0xF];
+    code_point >>= 4;
+  } while (code_point != 0 && count < 8);
+  while (count > 0) {
+    char digit = digits[--count];
+    AddTap(PositionOf(static_cast<uint32_t>(digit), HexDigitVirtualKey(digit)));
+  }
+  AddTap(PositionOf(' ', ' '));
+}
+
+KeyPosition UinputTextSink::PositionOf(uint32_t keysym, uint16_t virtual_key) const {
+  KeyPosition position;
+  if (lookup_ && lookup_(keysym, &position)) {
+    return position;
+  }
+  position = KeyPosition();
+  position.evdev = KeyCodesFor(virtual_key).evdev;
+  return position;
+}
+
+}  // namespace hardware_simulator
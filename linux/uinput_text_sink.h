@@ -0,0 +1,79 @@
+#ifndef FLUTTER_PLUGIN_UINPUT_TEXT_SINK_H_
+#define FLUTTER_PLUGIN_UINPUT_TEXT_SINK_H_
+
+#include <linux/input.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "locked_input_sink.h"
+#include "text_input.h"
+#include "uinput_device.h"
+#include "uinput_input_sink.h"
+
+namespace hardware_simulator {
+
+// Where a keysym sits on the active keyboard layout: the evdev key and the
+// modifiers that select its level.
+struct KeyPosition {
+  uint16_t evdev = 0;
+  bool shift = false;
+  bool alt_gr = false;
+};
+
+// Finds the key that types |keysym| on the active layout. Returns false
+// when no key does.
+using KeysymLookup = std::function<bool(uint32_t keysym, KeyPosition* position)>;
+
+// The Linux typeText backend, typing on the virtual keyboard.
+//
+// evdev only knows key positions, so a character is typed as the key that
+// produces its keysym (KeysymForTypedKey) on the active layout, with Shift
+// and AltGr as that key's level needs. A character the layout has no key
+// for is entered as Ctrl+Shift+U, its code point in hex and a space, which
+// GTK and IBus take as Unicode input. Keys go by their evdev code.
+//
+// Each batch is one write to |keyboard|, every press and release its own
+// frame. Not thread-safe; the plugin writes through a LockedKeyboardWriter.
+class UinputTextSink : public TextSink {
+ public:
+  UinputTextSink(EventWriter& keyboard, KeysymLookup lookup);
+
+  size_t TypeKeys(const TypedKey* keys, size_t count) override;
+
+ private:
+  void AddKey(uint16_t code, bool is_down);
+  void AddTap(const KeyPosition& position);
+  void AddCharacter(uint32_t code_point, uint32_t keysym);
+  // The key for |keysym|, or |virtual_key|'s when the layout has none.
+  KeyPosition PositionOf(uint32_t keysym, uint16_t virtual_key) const;
+
+  EventWriter& keyboard_;
+  KeysymLookup lookup_;
+  std::vector<input_event> batch_;
+};
+
+// The keyboard of |devices| as UinputTextSink writes to it: under |lock|,
+// which every other call into |devices| takes too, and with the modifiers
+// the client holds lifted while the text is typed.
+class LockedKeyboardWriter : public EventWriter {
+ public:
+  LockedKeyboardWriter(UinputInputSink& devices, LockedInputSink& lock)
+      : devices_(devices), lock_(lock) {}
+
+  bool Write(const input_event* events, size_t count) override {
+    bool written = false;
+    lock_.WithLock([&] { written = devices_.WriteKeyFrames(events, count); });
+    return written;
+  }
+
+ private:
+  UinputInputSink& devices_;
+  LockedInputSink& lock_;
+};
+
+}  // namespace hardware_simulator
+
+#endif  // FLUTTER_PLUGIN_UINPUT_TEXT_SINK_H_
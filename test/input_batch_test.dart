@@ -0,0 +1,25 @@
+import 'dart:typed_data';
+
+import 'package:flutter_test/flutter_test.dart';
+import 'package:hardware_simulator/input_batch.dart';
+
+void main() {
+  // Doubling an empty or header-only buffer never made room for a record.
+  for (final capacity in [0, 1]) {
+    test('grows from an initial capacity of $capacity', () {
+      final batch = InputBatch(initialCapacity: capacity);
+      for (var i = 0; i < 5; i++) {
+        batch.addKeyEvent(0x41 + i, true);
+      }
+
+      final message = batch.takeMessage();
+      expect(batch.isEmpty, isTrue);
+      expect(message.lengthInBytes, 8 + 5 * InputBatch.recordSize);
+      expect(message.getUint16(6, Endian.little), 5);
+      for (var i = 0; i < 5; i++) {
+        final offset = 8 + i * InputBatch.recordSize;
+        expect(message.getUint16(offset + 2, Endian.little), 0x41 + i);
+      }
+    });
+  }
+}
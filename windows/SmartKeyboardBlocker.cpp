@@ -8,7 +8,7 @@
 HHOOK SmartKeyboardBlocker::hook_handle_ = nullptr;
 HWND SmartKeyboardBlocker::target_window_ = nullptr;
 SmartKeyboardBlocker::BlockedKeyCallback SmartKeyboardBlocker::callback_ = nullptr;
-std::unordered_map<DWORD, bool> SmartKeyboardBlocker::key_states_;
+hardware_simulator::ShortcutPolicy SmartKeyboardBlocker::policy_;
 
 bool SmartKeyboardBlocker::StartBlocking(HWND target_window, BlockedKeyCallback callback) {
     if (hook_handle_) {
@@ -53,7 +53,7 @@ void SmartKeyboardBlocker::StopBlocking() {
         }
         target_window_ = nullptr;
         callback_ = nullptr;
-        key_states_.clear(); // Clear key states
+        policy_.Reset(); // Forget held keys and modifiers
         std::cout << "Keyboard blocking stopped." << std::endl;
     }
 }
@@ -63,37 +63,20 @@ LRESULT CALLBACK SmartKeyboardBlocker::KeyboardHookProc(int code, WPARAM wParam,
         return CallNextHookEx(nullptr, code, wParam, lParam);
     }
 
-    // Key check: only block when target window is active
-    if (!IsTargetWindowActive()) {
-        // Target window not active, let other apps use shortcuts normally
-        return CallNextHookEx(nullptr, code, wParam, lParam);
-    }
-
     KBDLLHOOKSTRUCT* kb_struct = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
     DWORD vk_code = kb_struct->vkCode;
     bool is_key_down = (wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN);
-    
-    /*
-    // Only process on key down to avoid duplicate callbacks
-    if (!is_key_down) {
-        return CallNextHookEx(nullptr, code, wParam, lParam);
-    }
-    */
-
-    if (ShouldBlockKey(vk_code)) {
-        // Check if this is a repeat key event using key states tracking
-        auto it = key_states_.find(vk_code);
-        bool was_down = (it != key_states_.end()) ? it->second : false;
-        
-        // Only call callback if state changed (new press or release)
-        if (was_down != is_key_down) {
-            // Call callback to notify user
-            if (callback_) {
-                callback_(vk_code, is_key_down);
-            }
-            
-            // Update key state
-            key_states_[vk_code] = is_key_down;
+
+    // Every event goes through the policy, focused or not, so its modifier
+    // state stays in step without asking GetAsyncKeyState. Only block when
+    // the target window is active; other apps keep their shortcuts.
+    hardware_simulator::ShortcutDecision decision =
+        policy_.OnKey(static_cast<uint8_t>(vk_code), is_key_down, IsTargetWindowActive());
+
+    if (decision.block) {
+        // Only call callback on a new press or release, not on repeats
+        if (decision.changed && callback_) {
+            callback_(vk_code, is_key_down);
         }
 
         // Block this key - return 1 to prevent system processing
@@ -104,48 +87,6 @@ LRESULT CALLBACK SmartKeyboardBlocker::KeyboardHookProc(int code, WPARAM wParam,
     return CallNextHookEx(nullptr, code, wParam, lParam);
 }
 
-bool SmartKeyboardBlocker::ShouldBlockKey(DWORD vk_code) {
-    switch (vk_code) {
-    case VK_LWIN:
-    case VK_RWIN:
-        return true;
-
-    // TODO: Therotically we don't need to block VK_MENU
-    // However there is a bug on flutter windows that ALT
-    // is not triggered when press ALT frequently.
-    case VK_LMENU:
-        return true;
-    case VK_RMENU:
-        return true;
-
-    case VK_RCONTROL:
-        return true;
-
-    case VK_TAB:
-        // Check if Alt is also pressed
-        if (GetAsyncKeyState(VK_MENU) & 0x8000) {
-            return true;
-        }
-        break;
-
-    case VK_F4:
-        // Check if Alt is also pressed
-        if (GetAsyncKeyState(VK_MENU) & 0x8000) {
-            return true;
-        }
-        break;
-
-    case VK_ESCAPE:
-        // Check if Ctrl+Alt are also pressed
-        if ((GetAsyncKeyState(VK_CONTROL) & 0x8000) && (GetAsyncKeyState(VK_MENU) & 0x8000)) {
-            return true;
-        }
-        break;
-    }
-
-    return false;
-}
-
 bool SmartKeyboardBlocker::IsTargetWindowActive() {
     if (!target_window_) {
         return false;
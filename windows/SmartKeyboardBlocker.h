@@ -2,6 +2,9 @@
 
 #include <windows.h>
 #include <functional>
+#include <vector>
+
+#include "shortcut_policy.h"
 
 /**
  * Smart Keyboard Blocker - Only blocks keys when the current app has focus
@@ -36,6 +39,15 @@ public:
      */
     static void SetCallback(BlockedKeyCallback callback) { callback_ = callback; }
 
+    /**
+     * Replace the shortcuts captured while the target window has focus
+     * (static method). Call on the thread that starts blocking.
+     * @return Returns false, keeping the current rules, if a rule is invalid
+     */
+    static bool SetRules(const std::vector<hardware_simulator::ShortcutRule>& rules) {
+        return policy_.SetRules(rules);
+    }
+
     /**
      * Get current process main window
      */
@@ -53,10 +65,8 @@ private:
     static LRESULT CALLBACK KeyboardHookProc(int code, WPARAM wParam, LPARAM lParam);
     static BOOL CALLBACK EnumWindowsProc(HWND hwnd, LPARAM lParam);
 
-    static bool ShouldBlockKey(DWORD vk_code);
-
     // Static member variables
     static HHOOK hook_handle_;
     static BlockedKeyCallback callback_;
-    static std::unordered_map<DWORD, bool> key_states_; // Track key states to avoid repeat callbacks
+    static hardware_simulator::ShortcutPolicy policy_; // Rules and modifier/key state seen by the hook
 };
@@ -463,12 +463,10 @@ MousePosition GetMousePositionAndScreenId() {
     monitorInfo.cbSize = sizeof(MONITORINFOEX);
     GetMonitorInfo(hMonitor, &monitorInfo);
 
-    // Use HardwareSimulatorPlugin's static monitors
-    const auto& monitors_info = hardware_simulator::HardwareSimulatorPlugin::GetStaticMonitors();
-    std::vector<RECT> monitors;
-    for (const auto& info : monitors_info) {
-        monitors.push_back(info.rect);
-    }
+    // Use HardwareSimulatorPlugin's monitor snapshot; it may be replaced
+    // concurrently, this one stays valid while |transform| holds it.
+    const auto transform = hardware_simulator::HardwareSimulatorPlugin::CurrentScreenTransform();
+    const auto& monitors = transform->screens();
 
     int screenId = 0;
     for (size_t i = 0; i < monitors.size(); ++i) {
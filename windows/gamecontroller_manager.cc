@@ -3,6 +3,7 @@
 #include <sstream>
 #include <Xinput.h>
 
+std::mutex GameControllerManager::controllers_mutex;
 PVIGEM_CLIENT GameControllerManager::vigem_client = nullptr;
 bool GameControllerManager::initialized = false;
 std::array<PVIGEM_TARGET, 4> GameControllerManager::controllers = {};
@@ -25,6 +26,7 @@ int GameControllerManager::InitializeVigem() {
 }
 
 int GameControllerManager::CreateGameController() {
+  std::lock_guard<std::mutex> lock(controllers_mutex);
   if (!initialized && InitializeVigem() != 0) {
     return -1;
   }
@@ -57,6 +59,7 @@ int GameControllerManager::CreateGameController() {
 }
 
 bool GameControllerManager::RemoveGameController(int id) {
+  std::lock_guard<std::mutex> lock(controllers_mutex);
   if (id < 1 || id > 4) {
     std::cerr << "Invalid slot id: " << id << std::endl;
     return false;
@@ -82,6 +85,7 @@ bool GameControllerManager::RemoveGameController(int id) {
 }
 
 bool GameControllerManager::DoControllerAction(int id, std::string& action) {
+    std::lock_guard<std::mutex> lock(controllers_mutex);
     std::istringstream iss(action);
 
     _XINPUT_GAMEPAD gamepad;
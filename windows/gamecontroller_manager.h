@@ -4,6 +4,7 @@
 #include <iostream>
 #include <memory>
 #include <array>
+#include <mutex>
 
 #include <ViGEm/Client.h>
 
@@ -16,6 +17,9 @@ public:
 private:
   static int InitializeVigem();
 
+  // Create and remove run on a control-plane worker while actions arrive on
+  // the platform thread; this guards the client and the slots.
+  static std::mutex controllers_mutex;
   static PVIGEM_CLIENT vigem_client;
   static bool initialized;
   static std::array<PVIGEM_TARGET, 4> controllers;
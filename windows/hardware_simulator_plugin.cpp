@@ -1,7 +1,28 @@
 #include "hardware_simulator_plugin.h"
 
+#include "auto_repeat.h"
 #include "cursor_monitor.h"
 #include "gamecontroller_manager.h"
+#include "gesture.h"
+#include "input_batch.h"
+#include "input_injector.h"
+#include "input_lease.h"
+#include "input_remap.h"
+#include "input_retry.h"
+#include "input_ring_ffi.h"
+#include "input_sink.h"
+#include "input_smoothing.h"
+#include "key_codes.h"
+#include "method_args.h"
+#include "method_dispatch.h"
+#include "method_schema.h"
+#include "pen_sample_batch.h"
+#include "pen_tilt.h"
+#include "pressed_input_tracker.h"
+#include "shortcut_policy.h"
+#include "text_input.h"
+#include "touch_contact_table.h"
+#include "touch_frame.h"
 #include "notification_window.h"
 #include "virtual_display_control.h"
 #include "SmartKeyboardBlocker.h"
@@ -15,17 +36,22 @@
 // For HID usage constants
 #include <hidusage.h>
 
+#include <flutter/binary_messenger.h>
 #include <flutter/method_channel.h>
 #include <flutter/plugin_registrar_windows.h>
 #include <flutter/standard_method_codec.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
-#include <future>
+#include <exception>
 #include <memory>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 // Used to run win32 service.
+#include <objbase.h>  // CoInitializeEx for ShellExecuteExW
 #include <sddl.h>
 #include <shellapi.h>
 #include <shlwapi.h>  // PathCombineW, PathRemoveFileSpecW
@@ -46,6 +72,10 @@ void performPenEvent(int screenId, double x, double y, bool isDown, bool hasButt
 void performPenMove(int screenId, double x, double y, bool hasButton, double pressure, double rotation, double tilt);
 void clearAllPressedEvents();
 bool setPrimaryDisplay(int displayIndex);
+InputSink& GetPluginInputSink();
+InputSink& GetInjectorInputSink();
+InputSink& GetClientInputSink();
+void WaitForInjectorIdle();
 
 thread_local HDESK _lastKnownInputDesktop = nullptr;
 PFN_CreateSyntheticPointerDevice fnCreateSyntheticPointerDevice = nullptr;
@@ -53,105 +83,93 @@ PFN_InjectSyntheticPointerInput fnInjectSyntheticPointerInput = nullptr;
 PFN_DestroySyntheticPointerDevice fnDestroySyntheticPointerDevice = nullptr;
 
 HSYNTHETICPOINTERDEVICE g_touchDevice = nullptr;
-POINTER_TYPE_INFO g_touchInfo[10] = {};
-UINT32 g_activeTouchSlots = 0;
+// Active contacts, packed so a frame is injected straight from the table.
+TouchContactTable<POINTER_TYPE_INFO> g_touchContacts;
 
 HSYNTHETICPOINTERDEVICE g_penDevice = nullptr;
 POINTER_TYPE_INFO g_penInfo = {};
 
-// auto repeat feature
-struct KeyState {
-    bool isDown = false;
-    std::chrono::steady_clock::time_point lastEventTime;
-};
-
-struct TouchState {
-    bool isDown = false;
-    double x = 0;
-    double y = 0;
-    int screenId = 0;
-    std::chrono::steady_clock::time_point lastEventTime;
-};
+// Injection runs on one long-lived thread. Method calls, the batch channel and
+// the input ring only queue records and return.
+static std::unique_ptr<InputInjector> g_injector;
+static std::unique_ptr<QueuedInputSink> g_injector_sink;
+// On the injector thread: gathers each posted touch frame into one
+// send_touch_input.
+static std::unique_ptr<TouchFrameSink> g_touch_frame_sink;
+// Client input passes through the remap profile on its way to the injector;
+// releases and repeats the plugin makes itself do not.
+static std::unique_ptr<RemappingInputSink> g_remapping_sink;
+// Client pen and touch positions are smoothed, when enabled, before that.
+static std::unique_ptr<SmoothingInputSink> g_smoothing_sink;
+
+// Everything injected and not yet released, for clearAllPressedEvents.
+static PressedInputTracker g_pressed;
 
+// auto repeat feature
 static bool g_auto_repeat_enabled = true;
-static std::atomic<bool> g_thread_running{false};
-static std::recursive_mutex g_event_mutex;
-static std::unordered_map<uint16_t, KeyState> g_key_states;
-static uint16_t g_last_known_key_down = 0;
-static std::unordered_map<uint32_t, TouchState> g_touch_states;
-
-static void EventMonitorThread() {
-    while (g_thread_running) {
-        if (g_auto_repeat_enabled) {
-            auto now = std::chrono::steady_clock::now();
-            
-            {
-                std::lock_guard<std::recursive_mutex> lock(g_event_mutex);
-                
-                // Check key states
-                if (g_key_states.find(g_last_known_key_down) != g_key_states.end()) {
-                    if (g_key_states[g_last_known_key_down].isDown) {
-                        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-                            now - g_key_states[g_last_known_key_down].lastEventTime).count();
-                        if (duration >= 500) {  // 500ms repeat interval for keys
-                            performKeyEvent(g_last_known_key_down, true, true);
-                        }
-                    }
-                }
-                
-                // Check touch states
-                for (auto& [id, state] : g_touch_states) {
-                    if (state.isDown) {
-                        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-                            now - state.lastEventTime).count();
-                        if (duration >= 300) {  // 300ms repeat interval for touch
-                            performTouchEvent(state.screenId, state.x, state.y, id, true, true);
-                            state.lastEventTime = now;
-                        }
-                    }
-                }
-            }
-        }
-        
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
-    }
-}
+// Every held key and touch contact, tracked on the injector thread. Repeats
+// are posted back to the injector, which drops those for inputs released in
+// the meantime.
+static std::unique_ptr<AutoRepeatScheduler> g_auto_repeat;
 
 void HardwareSimulatorPlugin::StopMonitorThread() {
-    if (g_thread_running) {
-        g_thread_running = false;
-        if (monitor_thread_ && monitor_thread_->joinable()) {
-            monitor_thread_->join();
-        }
-        monitor_thread_.reset();
-    }
+    g_auto_repeat.reset();
 }
 
 void HardwareSimulatorPlugin::StartMonitorThread() {
-    if (!g_thread_running) {
-        g_thread_running = true;
-        monitor_thread_ = std::make_unique<std::thread>(EventMonitorThread);
+    if (g_auto_repeat) {
+        return;
     }
+    g_auto_repeat = std::make_unique<AutoRepeatScheduler>([](const HeldInput& input) {
+        if (input.type == HeldInputType::kKey) {
+            GetInjectorInputSink().KeyRepeat(static_cast<uint16_t>(input.id));
+        } else {
+            GetInjectorInputSink().TouchRepeat(input.id);
+        }
+    });
+    g_auto_repeat->SetEnabled(g_auto_repeat_enabled);
 }
 
 void SetAutoRepeatEnabled(bool enabled) {
-    if (g_auto_repeat_enabled == enabled) {
-        return;  // No change needed
+    g_auto_repeat_enabled = enabled;
+    if (g_auto_repeat) {
+        g_auto_repeat->SetEnabled(enabled);
     }
+}
 
-    g_auto_repeat_enabled = enabled;
-    
-    // Note: Since this is a global function, we can't access the plugin instance directly.
-    // The auto-repeat state will be handled when the thread is next started/stopped.
-    if (!enabled) {
-        // Clear any existing states
-        std::lock_guard<std::recursive_mutex> lock(g_event_mutex);
-        g_key_states.clear();
-        g_touch_states.clear();
+// Key repeat delay and interval in milliseconds, for |key_code| or, when
+// negative, for every key without its own timing.
+void setKeyRepeatTiming(int key_code, int delay_ms, int interval_ms) {
+    if (!g_auto_repeat) {
+        return;
+    }
+    RepeatTiming timing;
+    timing.delay = std::chrono::milliseconds((std::max)(delay_ms, 0));
+    timing.interval = std::chrono::milliseconds((std::max)(interval_ms, 0));
+    if (key_code < 0) {
+        g_auto_repeat->SetDefaultKeyTiming(timing);
+    } else {
+        g_auto_repeat->SetKeyTiming(static_cast<uint16_t>(key_code), timing);
     }
 }
 // end of auto repeat feature
 
+// Releases everything a client holds when its heartbeats stop, e.g. when its
+// connection drops mid-press. Expiry runs on the watchdog's thread.
+static std::unique_ptr<InputLeaseWatchdog> g_input_lease;
+
+void setInputLease(int timeout_ms) {
+    if (g_input_lease) {
+        g_input_lease->Start(std::chrono::milliseconds((std::max)(timeout_ms, 0)));
+    }
+}
+
+void renewInputLease() {
+    if (g_input_lease) {
+        g_input_lease->Renew();
+    }
+}
+
 //Todo:OpenInputDesktop should fail because we have a window resource in this process.
 //We need to create another process to handle this scenario.
 HDESK syncThreadDesktop() {
@@ -173,14 +191,32 @@ HDESK syncThreadDesktop() {
     return hDesk;
 }
 
+// Injections rejected by the OS, usually across a desktop switch, are retried
+// on one long-lived worker that resyncs its thread desktop first.
+static std::unique_ptr<InputRetryEngine> g_retry_engine;
+
+// Set on shutdown so paced text, gestures and waits on elevated batch files
+// stop at their next step.
+static std::atomic<bool> g_shutting_down{false};
+
+// Delivers |attempt| now, or hands it to the retry worker if it fails.
+template <typename Attempt>
+void injectWithRetry(Attempt&& attempt) {
+    if (g_retry_engine) {
+        g_retry_engine->Inject(std::forward<Attempt>(attempt));
+        return;
+    }
+    attempt();
+}
+
 std::optional<int> HardwareSimulatorPlugin::dpi_monitor_proc_id_ = NULL;
-std::vector<MonitorInfo> HardwareSimulatorPlugin::static_monitors_;
+ScreenTransformPublisher HardwareSimulatorPlugin::screen_transforms_;
 std::map<int, std::function<void(int)>> HardwareSimulatorPlugin::display_count_callbacks_;
 std::mutex HardwareSimulatorPlugin::display_count_callbacks_mutex_;
 int HardwareSimulatorPlugin::previous_display_count_ = -1;
 
 void HardwareSimulatorPlugin::UpdateStaticMonitors() {
-    static_monitors_.clear();
+    std::vector<ScreenRect> screens;
     
     // Original implementation using EnumDisplayMonitors (commented out)
     /*
@@ -203,78 +239,68 @@ void HardwareSimulatorPlugin::UpdateStaticMonitors() {
             devMode.dmSize = sizeof(DEVMODE);
             
             if (EnumDisplaySettings(displayDevice.DeviceName, ENUM_CURRENT_SETTINGS, &devMode)) {
-                MonitorInfo info;
-                info.rect.left = devMode.dmPosition.x;
-                info.rect.top = devMode.dmPosition.y;
-                info.rect.right = devMode.dmPosition.x + devMode.dmPelsWidth;
-                info.rect.bottom = devMode.dmPosition.y + devMode.dmPelsHeight;
-                info.is_primary = (displayDevice.StateFlags & DISPLAY_DEVICE_PRIMARY_DEVICE) != 0;
+                // dmPelsWidth/Height are already in the rotated desktop
+                // orientation, and so are the positions callers send.
+                ScreenRect screen;
+                screen.left = devMode.dmPosition.x;
+                screen.top = devMode.dmPosition.y;
+                screen.right = devMode.dmPosition.x + static_cast<int32_t>(devMode.dmPelsWidth);
+                screen.bottom = devMode.dmPosition.y + static_cast<int32_t>(devMode.dmPelsHeight);
+                screen.is_primary = (displayDevice.StateFlags & DISPLAY_DEVICE_PRIMARY_DEVICE) != 0;
                 
-                static_monitors_.push_back(info);
+                screens.push_back(screen);
             }
         }
     }
     
+    // SendInput scales against these, in this process's DPI context, so they
+    // are read once here rather than on every event.
+    ScreenMetrics metrics;
+    metrics.primary_width = GetSystemMetrics(SM_CXSCREEN);
+    metrics.primary_height = GetSystemMetrics(SM_CYSCREEN);
+    metrics.virtual_width = GetSystemMetrics(SM_CXVIRTUALSCREEN);
+    metrics.virtual_height = GetSystemMetrics(SM_CYVIRTUALSCREEN);
+
+    int current_display_count = static_cast<int>(screens.size());
+    screen_transforms_.Publish(std::make_shared<const ScreenTransform>(std::move(screens), metrics));
+
     // Check if display count changed and notify callbacks
-    int current_display_count = static_cast<int>(static_monitors_.size());
     // We report even the count is not changed, because it maybe a screen switch
     //if (current_display_count != previous_display_count_) {
     notifyDisplayCountChanged(current_display_count);
     //}
 }
 
-const std::vector<MonitorInfo>& HardwareSimulatorPlugin::GetStaticMonitors() {
-    return static_monitors_;
-}
-
-std::vector<MonitorInfo> get_monitors() {
-    return HardwareSimulatorPlugin::GetStaticMonitors();
+std::vector<MonitorInfo> HardwareSimulatorPlugin::GetStaticMonitors() {
+    std::vector<MonitorInfo> monitors;
+    std::shared_ptr<const ScreenTransform> transform = CurrentScreenTransform();
+    for (const auto& screen : transform->screens()) {
+        MonitorInfo info;
+        info.rect = {screen.left, screen.top, screen.right, screen.bottom};
+        info.is_primary = screen.is_primary;
+        monitors.push_back(info);
+    }
+    return monitors;
 }
 
 bool adjust_to_main_screen(int screen_index, double x_percent, double y_percent, LONG& out_x, LONG& out_y) {
-    auto monitors = get_monitors();
-    if (screen_index < 0 || screen_index >= monitors.size()) return false;
-
-    const auto& screen = monitors[screen_index];
-    int ox, oy;
-    ox = screen.rect.left + static_cast<int>((screen.rect.right - screen.rect.left) * x_percent);
-    oy = screen.rect.top + static_cast<int>((screen.rect.bottom - screen.rect.top) * y_percent);
-
-    int primary_width = GetSystemMetrics(SM_CXSCREEN);
-    int primary_height = GetSystemMetrics(SM_CYSCREEN);
-
-    out_x = static_cast<LONG>(ox * (65535.0f / primary_width));
-    out_y = static_cast<LONG>(oy * (65535.0f / primary_height));
+    int32_t x, y;
+    if (!HardwareSimulatorPlugin::CurrentScreenTransform()->ToPrimaryNormalized(screen_index, x_percent, y_percent, &x, &y)) {
+        return false;
+    }
+    out_x = x;
+    out_y = y;
     return true;
 }
 
 bool adjust_touch_to_screen(int screen_index, double x_percent, double y_percent, LONG& out_x, LONG& out_y) {
-    auto monitors = get_monitors();
-    if (monitors.empty() || screen_index < 0 || screen_index >= monitors.size()) {
+    int32_t x, y;
+    if (!HardwareSimulatorPlugin::CurrentScreenTransform()->ToVirtualDesktop(screen_index, x_percent, y_percent, &x, &y)) {
         out_x = out_y = 0;
         return false;
     }
-
-    RECT global_bounds = {0};
-    for (const auto& monitor : monitors) {
-        global_bounds.left = (std::min)(global_bounds.left, monitor.rect.left);
-        global_bounds.top = (std::min)(global_bounds.top, monitor.rect.top);
-        global_bounds.right = (std::max)(global_bounds.right, monitor.rect.right);
-        global_bounds.bottom = (std::max)(global_bounds.bottom, monitor.rect.bottom);
-    }
-
-    const auto& screen = monitors[screen_index];
-    
-    double global_x = (screen.rect.left - global_bounds.left + 
-                      (screen.rect.right - screen.rect.left) * x_percent) / 
-                     (global_bounds.right - global_bounds.left);
-    
-    double global_y = (screen.rect.top - global_bounds.top + 
-                      (screen.rect.bottom - screen.rect.top) * y_percent) / 
-                     (global_bounds.bottom - global_bounds.top);
-
-    out_x = static_cast<LONG>(global_x * GetSystemMetrics(SM_CXVIRTUALSCREEN));
-    out_y = static_cast<LONG>(global_y * GetSystemMetrics(SM_CYVIRTUALSCREEN));
+    out_x = x;
+    out_y = y;
     return true;
 }
 
@@ -299,7 +325,8 @@ bool createTouchDevice() {
         }
     }
 
-    g_touchDevice = fnCreateSyntheticPointerDevice(PT_TOUCH, ARRAYSIZE(g_touchInfo), POINTER_FEEDBACK_DEFAULT);
+    g_touchDevice = fnCreateSyntheticPointerDevice(
+        PT_TOUCH, static_cast<ULONG>(g_touchContacts.max_contacts()), POINTER_FEEDBACK_DEFAULT);
     return g_touchDevice != nullptr;
 }
 
@@ -329,127 +356,113 @@ void destroyPenDevice() {
     }
 }
 
-bool sendTouchInput() {
+bool sendTouchInput(const POINTER_TYPE_INFO* info, UINT32 count) {
     if (!g_touchDevice || !fnInjectSyntheticPointerInput) {
         return false;
     }
 
-    if (fnInjectSyntheticPointerInput(g_touchDevice, g_touchInfo, g_activeTouchSlots)) {
+    if (fnInjectSyntheticPointerInput(g_touchDevice, info, count)) {
         return true;
     }
 
     return false;
 }
 
-void async_send_touch_input_retry() {
-    while (true) {
-        auto send = sendTouchInput();
-        if (send == 1) {
-            break;
-        }
+UINT32 touchPointerFlags(TouchPhase phase) {
+    switch (phase) {
+    case TouchPhase::kDown:
+        return TOUCHEVENTF_PRIMARY | POINTER_FLAG_INRANGE | POINTER_FLAG_INCONTACT | POINTER_FLAG_DOWN;
+    case TouchPhase::kMove:
+        return POINTER_FLAG_INRANGE | POINTER_FLAG_INCONTACT | POINTER_FLAG_UPDATE;
+    case TouchPhase::kUp:
+    default:
+        return POINTER_FLAG_UP;
+    }
+}
 
-        auto hDesk = syncThreadDesktop();
-        if (_lastKnownInputDesktop != hDesk) {
-            _lastKnownInputDesktop = hDesk;
-        }
-        else {
-            break;
-        }
+// Lifts all contacts and recreates the touch device for |max_contacts|
+// simultaneous contacts on its next use. The device and the contact table
+// belong to the injector thread, so the reset runs there, after the input
+// queued before it. Returns the limit in effect.
+int setTouchContactLimit(int max_contacts) {
+    const size_t limit = TouchContactTable<POINTER_TYPE_INFO>::ClampMaxContacts(
+        max_contacts > 0 ? static_cast<size_t>(max_contacts) : kDefaultMaxTouchContacts);
+    auto reset = [limit] {
+        // The ups go out as one frame on the old device, which still knows
+        // the contacts.
+        TouchFrameSink release(GetPluginInputSink());
+        g_pressed.ReleaseTouches(release);
+        release.FlushTouchFrame();
+        destroyTouchDevice();
+        g_touchContacts.Reset(limit);
+    };
+    if (g_injector) {
+        g_injector->PostTask(reset);
+    } else {
+        reset();
     }
+    return static_cast<int>(limit);
 }
 
+// Injects every active contact as one frame, then drops the lifted ones.
 void send_touch_input() {
-    auto send = sendTouchInput();
-    if (send != true) {
-        // put resend into new thread.
-        std::future<void> retry_future = std::async(std::launch::async, async_send_touch_input_retry);
-        retry_future.wait();
-    }
+    for (size_t slot = 0; slot < g_touchContacts.size(); ++slot) {
+        g_touchContacts.contacts()[slot].touchInfo.pointerInfo.pointerFlags =
+            touchPointerFlags(g_touchContacts.phase(slot));
+    }
+
+    // The retry may run after later events changed the table, so it injects
+    // a copy of this frame.
+    std::vector<POINTER_TYPE_INFO> frame(g_touchContacts.contacts(),
+                                         g_touchContacts.contacts() + g_touchContacts.size());
+    g_touchContacts.EndFrame();
+    injectWithRetry([frame = std::move(frame)] {
+        return sendTouchInput(frame.data(), static_cast<UINT32>(frame.size()));
+    });
 }
 
-bool sendPenInput() {
+bool sendPenInput(const POINTER_TYPE_INFO& info) {
     if (!g_penDevice || !fnInjectSyntheticPointerInput) {
         return false;
     }
 
-    if (fnInjectSyntheticPointerInput(g_penDevice, &g_penInfo, 1)) {
+    if (fnInjectSyntheticPointerInput(g_penDevice, &info, 1)) {
         return true;
     }
 
     return false;
 }
 
-void async_send_pen_input_retry() {
-    while (true) {
-        auto send = sendPenInput();
-        if (send == 1) {
-            break;
-        }
-
-        auto hDesk = syncThreadDesktop();
-        if (_lastKnownInputDesktop != hDesk) {
-            _lastKnownInputDesktop = hDesk;
-        }
-        else {
-            break;
-        }
-    }
-}
-
 void send_pen_input() {
-    auto send = sendPenInput();
-    if (send != true) {
-        // put resend into new thread.
-        std::future<void> retry_future = std::async(std::launch::async, async_send_pen_input_retry);
-        retry_future.wait();
-    }
+    POINTER_TYPE_INFO info = g_penInfo;
+    injectWithRetry([info] { return sendPenInput(info); });
 }
 
-void performTouchEvent(int screenId, double x, double y, uint32_t touchId, bool isDown, bool isRepeat = false) {
+// Updates the contact table for a touch down or up without injecting it.
+// Returns false when nothing changed.
+bool stageTouchEvent(int screenId, double x, double y, uint32_t touchId, bool isDown, bool isRepeat) {
     if (!g_touchDevice) {
         if (!createTouchDevice()) {
-            return;
-        }
-    }
-
-    POINTER_TYPE_INFO* pointer = nullptr;
-    for (UINT32 i = 0; i < ARRAYSIZE(g_touchInfo); i++) {
-        if (g_touchInfo[i].touchInfo.pointerInfo.pointerId == touchId) {
-            pointer = &g_touchInfo[i];
-            break;
+            return false;
         }
     }
 
-    if (!pointer) {
-        for (UINT32 i = 0; i < ARRAYSIZE(g_touchInfo); i++) {
-            if (g_touchInfo[i].touchInfo.pointerInfo.pointerFlags == POINTER_FLAG_NONE) {
-                pointer = &g_touchInfo[i];
-                g_touchInfo[i].touchInfo.pointerInfo.pointerId = touchId;
-                g_activeTouchSlots = (g_activeTouchSlots > (i + 1)) ? g_activeTouchSlots : (i + 1);
-                break;
-            }
-        }
-    }
+    LONG out_x, out_y;
+    if (!adjust_touch_to_screen(screenId,x,y,out_x,out_y)) return false;
 
+    POINTER_TYPE_INFO* pointer = isDown ? g_touchContacts.Down(touchId) : g_touchContacts.Up(touchId);
     if (!pointer) {
-        return;
+        return false;
     }
 
     pointer->type = PT_TOUCH;
     auto& touchInfo = pointer->touchInfo;
     touchInfo.pointerInfo.pointerType = PT_TOUCH;
+    touchInfo.pointerInfo.pointerId = touchId;
 
-    LONG out_x, out_y;
-    if (!adjust_touch_to_screen(screenId,x,y,out_x,out_y)) return;
     touchInfo.pointerInfo.ptPixelLocation.x = out_x;//static_cast<LONG>(x * GetSystemMetrics(SM_CXSCREEN));
     touchInfo.pointerInfo.ptPixelLocation.y = out_y;//static_cast<LONG>(y * GetSystemMetrics(SM_CYSCREEN));
 
-    if (isDown) {
-        touchInfo.pointerInfo.pointerFlags = TOUCHEVENTF_PRIMARY | POINTER_FLAG_INRANGE | POINTER_FLAG_INCONTACT | POINTER_FLAG_DOWN;
-    } else {
-        touchInfo.pointerInfo.pointerFlags = POINTER_FLAG_UP;
-    }
-
     touchInfo.touchMask = TOUCH_MASK_CONTACTAREA | TOUCH_MASK_ORIENTATION | TOUCH_MASK_PRESSURE;
 
     touchInfo.rcContact.left = touchInfo.pointerInfo.ptPixelLocation.x - 10;
@@ -459,59 +472,86 @@ void performTouchEvent(int screenId, double x, double y, uint32_t touchId, bool
 
     touchInfo.pressure = 1024;
 
-    send_touch_input();
-
     // Add state tracking
-    if (g_auto_repeat_enabled && !isRepeat) {
-        std::lock_guard<std::recursive_mutex> lock(g_event_mutex);
+    g_pressed.TouchEvent(screenId, x, y, touchId, isDown);
+    if (g_auto_repeat && !isRepeat) {
         if (isDown) {
-            g_touch_states[touchId] = {true, x, y, screenId, std::chrono::steady_clock::now()};
-        } else if (g_touch_states.find(touchId) != g_touch_states.end()) {
-            g_touch_states.erase(touchId);
+            g_auto_repeat->TouchDown(touchId, screenId, x, y);
+        } else {
+            g_auto_repeat->TouchUp(touchId);
         }
     }
+    return true;
 }
 
-void performTouchMove(int screenId, double x, double y, uint32_t touchId) {
+// Updates a contact's position in the table without injecting it. Returns
+// false for unknown or lifted contacts.
+bool stageTouchMove(int screenId, double x, double y, uint32_t touchId) {
     if (!g_touchDevice) {
-        return;
+        return false;
     }
 
-    POINTER_TYPE_INFO* pointer = nullptr;
-    for (UINT32 i = 0; i < ARRAYSIZE(g_touchInfo); i++) {
-        if (g_touchInfo[i].touchInfo.pointerInfo.pointerId == touchId) {
-            pointer = &g_touchInfo[i];
-            break;
-        }
-    }
+    LONG out_x, out_y;
+    if (!adjust_touch_to_screen(screenId, x, y, out_x, out_y)) return false;
 
+    POINTER_TYPE_INFO* pointer = g_touchContacts.Move(touchId);
     if (!pointer) {
-        return;
+        return false;
     }
 
     auto& touchInfo = pointer->touchInfo;
 
-    LONG out_x, out_y;
-    if (!adjust_touch_to_screen(screenId, x, y, out_x, out_y)) return;
     touchInfo.pointerInfo.ptPixelLocation.x = out_x;//static_cast<LONG>(x * GetSystemMetrics(SM_CXSCREEN));
     touchInfo.pointerInfo.ptPixelLocation.y = out_y;//static_cast<LONG>(y * GetSystemMetrics(SM_CYSCREEN));
 
-    touchInfo.pointerInfo.pointerFlags = POINTER_FLAG_INRANGE | POINTER_FLAG_INCONTACT | POINTER_FLAG_UPDATE;
-
     touchInfo.rcContact.left = touchInfo.pointerInfo.ptPixelLocation.x - 10;
     touchInfo.rcContact.right = touchInfo.pointerInfo.ptPixelLocation.x + 10;
     touchInfo.rcContact.top = touchInfo.pointerInfo.ptPixelLocation.y - 10;
     touchInfo.rcContact.bottom = touchInfo.pointerInfo.ptPixelLocation.y + 10;
 
-    if (g_auto_repeat_enabled) {
-        std::lock_guard<std::recursive_mutex> lock(g_event_mutex);
-        if (g_touch_states.find(touchId) != g_touch_states.end()) {
-            //update the position
-            g_touch_states[touchId] = { true, x, y, screenId, std::chrono::steady_clock::now() };
+    g_pressed.TouchMove(screenId, x, y, touchId);
+    if (g_auto_repeat) {
+        g_auto_repeat->TouchMove(touchId, screenId, x, y);
+    }
+    return true;
+}
+
+void performTouchEvent(int screenId, double x, double y, uint32_t touchId, bool isDown, bool isRepeat = false) {
+    if (stageTouchEvent(screenId, x, y, touchId, isDown, isRepeat)) {
+        send_touch_input();
+    }
+}
+
+void performTouchMove(int screenId, double x, double y, uint32_t touchId) {
+    if (stageTouchMove(screenId, x, y, touchId)) {
+        send_touch_input();
+    }
+}
+
+// Applies a whole frame of contact updates and injects it once. Each
+// contact appears at most once (see TouchFrameBuilder).
+void performTouchFrame(const TouchUpdate* updates, size_t count) {
+    bool changed = false;
+    for (size_t i = 0; i < count; ++i) {
+        const TouchUpdate& update = updates[i];
+        if (update.type == TouchUpdateType::kMove) {
+            changed |= stageTouchMove(update.screen_id, update.x, update.y, update.touch_id);
+        } else {
+            changed |= stageTouchEvent(update.screen_id, update.x, update.y, update.touch_id,
+                                       update.type == TouchUpdateType::kDown, false);
         }
     }
+    if (changed) {
+        send_touch_input();
+    }
+}
 
-    send_touch_input();
+// Keeps a held contact alive with an update at its current position. Dropped
+// when the contact was lifted after the repeat was scheduled.
+void performTouchRepeat(uint32_t touchId) {
+    if (g_touchDevice && g_touchContacts.Move(touchId)) {
+        send_touch_input();
+    }
 }
 
 void performPenEvent(int screenId, double x, double y, bool isDown, bool hasButton, double pressure, double rotation, double tilt) {
@@ -568,23 +608,15 @@ void performPenEvent(int screenId, double x, double y, bool isDown, bool hasButt
     }
 
     // We require rotation and tilt to perform the conversion to X and Y tilt angles
-    if (tilt >= 0.0 && rotation >= 0.0 && rotation <= 360.0) {
-        const double M_PI = 3.14159265358979323846;
-        auto rotationRads = rotation * (M_PI / 180.0);
-        auto tiltRads = tilt * (M_PI / 180.0);
-        auto r = std::sin(tiltRads);
-        auto z = std::cos(tiltRads);
-
-        // Convert polar coordinates into X and Y tilt angles
+    PenTilt penTilt;
+    if (PenTiltFromPolar(rotation, tilt, &penTilt)) {
         penInfo.penMask |= PEN_MASK_TILT_X | PEN_MASK_TILT_Y;
-        penInfo.tiltX = static_cast<INT32>(std::atan2(std::sin(-rotationRads) * r, z) * 180.0 / M_PI);
-        penInfo.tiltY = static_cast<INT32>(std::atan2(std::cos(-rotationRads) * r, z) * 180.0 / M_PI);
-    } else {
-        penInfo.tiltX = 0;
-        penInfo.tiltY = 0;
     }
+    penInfo.tiltX = penTilt.x;
+    penInfo.tiltY = penTilt.y;
 
     send_pen_input();
+    g_pressed.PenEvent(screenId, x, y, isDown);
 
     // Clear edge-triggered flags after sending
     constexpr auto EDGE_TRIGGERED_POINTER_FLAGS = POINTER_FLAG_DOWN | POINTER_FLAG_UP | POINTER_FLAG_CANCELED | POINTER_FLAG_UPDATE;
@@ -631,29 +663,83 @@ void performPenMove(int screenId, double x, double y, bool hasButton, double pre
     }
 
     // We require rotation and tilt to perform the conversion to X and Y tilt angles
-    if (tilt >= 0.0 && rotation >= 0.0 && rotation <= 360.0) {
-        const double M_PI = 3.14159265358979323846;
-        auto rotationRads = rotation * (M_PI / 180.0);
-        auto tiltRads = tilt * (M_PI / 180.0);
-        auto r = std::sin(tiltRads);
-        auto z = std::cos(tiltRads);
-
-        // Convert polar coordinates into X and Y tilt angles
+    PenTilt penTilt;
+    if (PenTiltFromPolar(rotation, tilt, &penTilt)) {
         penInfo.penMask |= PEN_MASK_TILT_X | PEN_MASK_TILT_Y;
-        penInfo.tiltX = static_cast<INT32>(std::atan2(std::sin(-rotationRads) * r, z) * 180.0 / M_PI);
-        penInfo.tiltY = static_cast<INT32>(std::atan2(std::cos(-rotationRads) * r, z) * 180.0 / M_PI);
-    } else {
-        penInfo.tiltX = 0;
-        penInfo.tiltY = 0;
     }
+    penInfo.tiltX = penTilt.x;
+    penInfo.tiltY = penTilt.y;
 
     send_pen_input();
+    // Moves are always sent in contact.
+    g_pressed.PenEvent(screenId, x, y, true);
 
     // Clear edge-triggered flags after sending
     constexpr auto EDGE_TRIGGERED_POINTER_FLAGS = POINTER_FLAG_DOWN | POINTER_FLAG_UP | POINTER_FLAG_CANCELED | POINTER_FLAG_UPDATE;
     penInfo.pointerInfo.pointerFlags &= ~EDGE_TRIGGERED_POINTER_FLAGS;
 }
 
+// Scratch for performPenMoveBatch, on the injector thread.
+static ConvertedPenSamples g_converted_pen;
+
+// performPenMove for a run of samples on one screen. Positions, pressure and
+// tilt are converted for the whole run at once (see ConvertPenSamples); the
+// synthetic pointer API still takes one frame per pointer per call, so each
+// sample is its own injection.
+void performPenMoveBatch(int screenId, const PenSample* samples, size_t count) {
+    if (!g_penDevice || count == 0) {
+        return;
+    }
+    // Held for the run so a display change can't free the map underneath it.
+    std::shared_ptr<const ScreenTransform> transform = HardwareSimulatorPlugin::CurrentScreenTransform();
+    const AffineMap* map = transform->VirtualDesktopMap(screenId);
+    if (!map) {
+        return;
+    }
+    ConvertPenSamples(*map, samples, count, 1024, &g_converted_pen);
+
+    auto& penInfo = g_penInfo.penInfo;
+    for (size_t i = 0; i < count; ++i) {
+        const PenSample& sample = samples[i];
+        penInfo.pointerInfo.ptPixelLocation.x = g_converted_pen.x[i];
+        penInfo.pointerInfo.ptPixelLocation.y = g_converted_pen.y[i];
+        penInfo.pointerInfo.pointerFlags = POINTER_FLAG_INRANGE | POINTER_FLAG_INCONTACT | POINTER_FLAG_UPDATE;
+
+        if (sample.has_button) {
+            penInfo.penFlags |= PEN_FLAG_BARREL;
+        } else {
+            penInfo.penFlags &= ~PEN_FLAG_BARREL;
+        }
+
+        penInfo.penMask = PEN_MASK_NONE;
+        if (g_converted_pen.pressure[i] > 0) {
+            penInfo.penMask |= PEN_MASK_PRESSURE;
+        }
+        penInfo.pressure = static_cast<UINT32>(g_converted_pen.pressure[i]);
+
+        if (sample.rotation >= 0.0f && sample.rotation <= 360.0f) {
+            penInfo.penMask |= PEN_MASK_ROTATION;
+            penInfo.rotation = static_cast<INT32>(sample.rotation);
+        } else {
+            penInfo.rotation = 0;
+        }
+
+        // Converted tilt is zero where PenTiltFromPolar would have failed.
+        if (sample.tilt >= 0.0f && sample.rotation >= 0.0f && sample.rotation <= 360.0f) {
+            penInfo.penMask |= PEN_MASK_TILT_X | PEN_MASK_TILT_Y;
+        }
+        penInfo.tiltX = g_converted_pen.tilt_x[i];
+        penInfo.tiltY = g_converted_pen.tilt_y[i];
+
+        send_pen_input();
+    }
+    const PenSample& last = samples[count - 1];
+    g_pressed.PenEvent(screenId, last.x, last.y, true);
+
+    constexpr auto EDGE_TRIGGERED_POINTER_FLAGS = POINTER_FLAG_DOWN | POINTER_FLAG_UP | POINTER_FLAG_CANCELED | POINTER_FLAG_UPDATE;
+    penInfo.pointerInfo.pointerFlags &= ~EDGE_TRIGGERED_POINTER_FLAGS;
+}
+
 BOOL IsRunningAsSystem() {
     BOOL bIsSystem = FALSE;
     HANDLE hToken = NULL;
@@ -702,6 +788,9 @@ BOOL IsRunningAsSystem() {
     return bIsSystem;
 }
 
+// How often a wait on an elevated batch file checks for shutdown.
+constexpr DWORD kElevatedWaitSliceMs = 100;
+
 bool RunBatchAsAdmin(
     LPCWSTR lpBatchFileName, 
     DWORD* pErrorCode = nullptr, 
@@ -740,15 +829,27 @@ bool RunBatchAsAdmin(
         sei.fMask = SEE_MASK_NOCLOSEPROCESS; 
     }
 
-    if (!ShellExecuteExW(&sei)) {
-        const DWORD err = GetLastError();
-        if (pErrorCode) *pErrorCode = err;
+    // The service calls run on a control-plane worker, which has no COM
+    // apartment of its own, and ShellExecuteExW may hand the verb to a shell
+    // extension through COM.
+    const HRESULT com_init = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE);
+    const BOOL executed = ShellExecuteExW(&sei);
+    const DWORD execute_error = GetLastError();
+    if (SUCCEEDED(com_init)) {
+        CoUninitialize();
+    }
+
+    if (!executed) {
+        if (pErrorCode) *pErrorCode = execute_error;
         return false;
     }
 
-    // if needed, wait for result.
+    // if needed, wait for result. The plugin's destructor waits for this
+    // call, so the wait gives up once the plugin is shutting down.
     if (bWait && sei.hProcess) {
-        WaitForSingleObject(sei.hProcess, INFINITE);
+        while (WaitForSingleObject(sei.hProcess, kElevatedWaitSliceMs) == WAIT_TIMEOUT &&
+               !g_shutting_down.load(std::memory_order_relaxed)) {
+        }
         CloseHandle(sei.hProcess);
     }
 
@@ -772,6 +873,39 @@ void setDragWindowContents(bool enable) {
   }
 }
 
+// Timer that flushes coalesced raw mouse motion while the cursor is locked.
+constexpr UINT_PTR kCursorMotionTimerId = 0x4853;
+
+int64_t SteadyClockMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int GetWindowRefreshRate(HWND hwnd) {
+    HMONITOR monitor = MonitorFromWindow(hwnd, MONITOR_DEFAULTTONEAREST);
+    MONITORINFOEXW info = {};
+    info.cbSize = sizeof(info);
+    if (monitor && GetMonitorInfoW(monitor, &info)) {
+        DEVMODEW mode = {};
+        mode.dmSize = sizeof(mode);
+        if (EnumDisplaySettingsW(info.szDevice, ENUM_CURRENT_SETTINGS, &mode) && mode.dmDisplayFrequency > 1) {
+            return static_cast<int>(mode.dmDisplayFrequency);
+        }
+    }
+    return 60;
+}
+
+// Button transitions of a raw mouse packet as kMouseButton* bits.
+uint32_t RawButtonMask(USHORT button_flags, bool down) {
+    uint32_t mask = 0;
+    if (button_flags & (down ? RI_MOUSE_LEFT_BUTTON_DOWN : RI_MOUSE_LEFT_BUTTON_UP)) mask |= kMouseButtonLeft;
+    if (button_flags & (down ? RI_MOUSE_MIDDLE_BUTTON_DOWN : RI_MOUSE_MIDDLE_BUTTON_UP)) mask |= kMouseButtonMiddle;
+    if (button_flags & (down ? RI_MOUSE_RIGHT_BUTTON_DOWN : RI_MOUSE_RIGHT_BUTTON_UP)) mask |= kMouseButtonRight;
+    if (button_flags & (down ? RI_MOUSE_BUTTON_4_DOWN : RI_MOUSE_BUTTON_4_UP)) mask |= kMouseButtonX1;
+    if (button_flags & (down ? RI_MOUSE_BUTTON_5_DOWN : RI_MOUSE_BUTTON_5_UP)) mask |= kMouseButtonX2;
+    return mask;
+}
+
 // static
 void HardwareSimulatorPlugin::RegisterWithRegistrar(
     flutter::PluginRegistrarWindows *registrar) {
@@ -780,6 +914,9 @@ void HardwareSimulatorPlugin::RegisterWithRegistrar(
           registrar->messenger(), "hardware_simulator",
           &flutter::StandardMethodCodec::GetInstance());
 
+  // A plugin destroyed by an earlier engine set the shutdown flag; this one
+  // starts with it clear.
+  g_shutting_down = false;
   auto plugin = std::make_unique<HardwareSimulatorPlugin>();
   auto plugin_pointer = plugin.get();
 
@@ -791,9 +928,50 @@ void HardwareSimulatorPlugin::RegisterWithRegistrar(
         plugin_pointer->HandleMethodCall(call, std::move(result));
       });
 
-  // Start the monitor thread if auto-repeat is enabled
-  if (g_auto_repeat_enabled) {
-      plugin_pointer->StartMonitorThread();
+  g_retry_engine = std::make_unique<InputRetryEngine>(RetryPolicy(), [] {
+      _lastKnownInputDesktop = syncThreadDesktop();
+  });
+  g_touch_frame_sink = std::make_unique<TouchFrameSink>(GetPluginInputSink());
+  g_injector = std::make_unique<InputInjector>(*g_touch_frame_sink);
+  g_injector_sink = std::make_unique<QueuedInputSink>(*g_injector);
+  g_remapping_sink = std::make_unique<RemappingInputSink>(*g_injector_sink);
+  g_smoothing_sink = std::make_unique<SmoothingInputSink>(*g_remapping_sink);
+
+  // Held keys and touches are tracked even while auto-repeat is disabled, so
+  // clearAllPressedEvents can release them.
+  plugin_pointer->StartMonitorThread();
+  g_input_lease = std::make_unique<InputLeaseWatchdog>([] { clearAllPressedEvents(); });
+
+  // Batched input events arrive as raw bytes and are decoded in place.
+  registrar->messenger()->SetMessageHandler(
+      kInputBatchChannel,
+      [](const uint8_t* message, size_t message_size, flutter::BinaryReply reply) {
+          DecodeInputBatch(message, message_size, GetClientInputSink());
+          reply(nullptr, 0);
+      });
+
+  // Rings opened by lib/input_ring.dart drain on their own thread into the
+  // injector queue.
+  SetInputRingSink(&GetClientInputSink());
+
+  // Display, controller and service calls run on workers; their replies are
+  // delivered back on the platform thread through a posted window message.
+  // Without a view there is no window to wake, so they stay inline.
+  if (registrar->GetView()) {
+      HWND reply_window = GetAncestor(registrar->GetView()->GetNativeWindow(), GA_ROOT);
+      const UINT reply_message = RegisterWindowMessageW(L"HardwareSimulatorControlPlaneReply");
+      plugin_pointer->control_plane_ = std::make_unique<ControlPlaneExecutor>(
+          kControlPlaneWorkers,
+          [reply_window, reply_message] { PostMessageW(reply_window, reply_message, 0, 0); });
+      plugin_pointer->control_plane_proc_id_ = registrar->RegisterTopLevelWindowProcDelegate(
+          [plugin_pointer, reply_message](HWND hwnd, UINT message, WPARAM wparam,
+                                          LPARAM lparam) -> std::optional<LRESULT> {
+              if (message == reply_message && plugin_pointer->control_plane_) {
+                  plugin_pointer->control_plane_->RunPendingReplies();
+                  return 0;
+              }
+              return std::nullopt;
+          });
   }
 
   registrar->AddPlugin(std::move(plugin));
@@ -820,40 +998,41 @@ HardwareSimulatorPlugin::HardwareSimulatorPlugin() {
 }
 
 HardwareSimulatorPlugin::~HardwareSimulatorPlugin() {
+    // Workers call back into this plugin; let running jobs finish first.
+    g_shutting_down = true;
+    if (control_plane_proc_id_.has_value()) {
+        registrar_->UnregisterTopLevelWindowProcDelegate(control_plane_proc_id_.value());
+        control_plane_proc_id_.reset();
+    }
+    control_plane_.reset();
+    SetInputRingSink(nullptr);
+    // The injector thread uses the auto-repeat scheduler and the touch and pen
+    // devices until it stops; repeats posted after that are ignored.
+    g_input_lease.reset();
+    if (g_injector) {
+        g_injector->Stop();
+    }
     StopMonitorThread();
+    g_smoothing_sink.reset();
+    g_remapping_sink.reset();
+    g_injector_sink.reset();
+    g_injector.reset();
+    g_touch_frame_sink.reset();
+    g_retry_engine.reset();
     destroyTouchDevice();
     destroyPenDevice();
     CleanupCursorLock();
+    if (registrar_) {
+        registrar_->messenger()->SetMessageHandler(kInputBatchChannel, nullptr);
+    }
     if (dpi_monitor_proc_id_.has_value()) {
         registrar_->UnregisterTopLevelWindowProcDelegate(dpi_monitor_proc_id_.value());
         dpi_monitor_proc_id_.reset();
     }
 }
 
-void async_send_input_retry(INPUT& i) {
-    while (true) {
-        auto send = SendInput(1, &i, sizeof(INPUT));
-        if (send == 1) {
-            break;
-        }
-
-        auto hDesk = syncThreadDesktop();
-        if (_lastKnownInputDesktop != hDesk) {
-            _lastKnownInputDesktop = hDesk;
-        }
-        else {
-            break;
-        }
-    }
-}
-
 void send_input(INPUT& i) {
-    auto send = SendInput(1, &i, sizeof(INPUT));
-    if (send != 1) {
-        // put resend into new thread.
-        std::future<void> retry_future = std::async(std::launch::async, async_send_input_retry, std::ref(i));
-        retry_future.wait();
-    }
+    injectWithRetry([i]() mutable { return SendInput(1, &i, sizeof(INPUT)) == 1; });
 }
 
 void performMouseButton(int button, bool release) {
@@ -896,111 +1075,172 @@ void performMouseButton(int button, bool release) {
     }*/
 
     send_input(i);
+    g_pressed.MouseButton(button, !release);
 }
 
 #pragma warning(disable:4244)
 
-void performKeyEvent(uint16_t modcode, bool isDown, bool isRepeat = false) {
-    INPUT i{};
+// Fills |i| with a press or release of virtual key |modcode|.
+void fillKeyInput(INPUT& i, uint16_t modcode, bool isDown) {
     i.type = INPUT_KEYBOARD;
     auto& ki = i.ki;
 
-    // For some reason, MapVirtualKey(VK_LWIN, MAPVK_VK_TO_VSC) doesn't seem to work :/
-    if (modcode != VK_LWIN && modcode != VK_RWIN && modcode != VK_PAUSE) {
-        ki.wScan = MapVirtualKey(modcode, MAPVK_VK_TO_VSC);
+    // Scancodes come from the compile-time table; only keys whose meaning
+    // depends on the host layout still ask it, so e.g. VK_OEM_1 keeps landing
+    // on the key that produces it, and so do keys the table doesn't list.
+    // Listed keys without a single scancode (VK_PAUSE) go by virtual-key code.
+    // https://docs.microsoft.com/en-us/windows/win32/inputdev/about-keyboard-input#keystroke-message-flags
+    const KeyCodes& codes = KeyCodesFor(modcode);
+    uint16_t scancode = codes.scancode;
+    bool extended = codes.extended();
+    if (codes.layout_dependent()) {
+        scancode = static_cast<uint16_t>(MapVirtualKey(modcode, MAPVK_VK_TO_VSC));
+    } else if (!codes.listed()) {
+        // The _EX form puts the E0/E1 prefix in the high byte. E1 keys have
+        // no single scancode either.
+        UINT mapped = MapVirtualKey(modcode, MAPVK_VK_TO_VSC_EX);
+        scancode = (mapped & 0xFF00) == 0xE100 ? 0 : static_cast<uint16_t>(mapped & 0xFF);
+        extended = (mapped & 0xFF00) == 0xE000;
+    }
+    if (scancode != 0) {
+        ki.wScan = scancode;
         ki.dwFlags = KEYEVENTF_SCANCODE;
+        if (extended) {
+            ki.dwFlags |= KEYEVENTF_EXTENDEDKEY;
+        }
     }
     else {
         ki.wVk = modcode;
     }
 
-    // https://docs.microsoft.com/en-us/windows/win32/inputdev/about-keyboard-input#keystroke-message-flags
-    switch (modcode) {
-    case VK_RMENU:
-    case VK_RCONTROL:
-    case VK_INSERT:
-    case VK_DELETE:
-    case VK_HOME:
-    case VK_END:
-    case VK_PRIOR:
-    case VK_NEXT:
-    case VK_UP:
-    case VK_DOWN:
-    case VK_LEFT:
-    case VK_RIGHT:
-    case VK_DIVIDE:
-        ki.dwFlags |= KEYEVENTF_EXTENDEDKEY;
-        break;
-    default:
-        break;
-    }
-
     if (!isDown) {
         ki.dwFlags |= KEYEVENTF_KEYUP;
     }
+}
 
+void performKeyEvent(uint16_t modcode, bool isDown, bool isRepeat = false) {
+    INPUT i{};
+    fillKeyInput(i, modcode, isDown);
     send_input(i);
 
     // Add state tracking
-    if (g_auto_repeat_enabled && !isRepeat) {
-        std::lock_guard<std::recursive_mutex> lock(g_event_mutex);
+    g_pressed.KeyEvent(modcode, isDown);
+    if (g_auto_repeat && !isRepeat) {
         if (isDown) {
-            g_key_states[modcode] = {true, std::chrono::steady_clock::now()};
-            g_last_known_key_down = modcode;
-        } else if (g_key_states.find(modcode) != g_key_states.end()) {
-            g_key_states.erase(modcode);
+            g_auto_repeat->KeyDown(modcode);
+        } else {
+            g_auto_repeat->KeyUp(modcode);
         }
     }
 }
 
-void clearAllPressedEvents() {
-    std::lock_guard<std::recursive_mutex> lock(g_event_mutex);
-    
-    // Clear all pressed keyboard keys
-    for (auto& [keyCode, state] : g_key_states) {
-        if (state.isDown) {
-            performKeyEvent(keyCode, false); // Send key up event
-        }
+// Dropped when the key was released after the repeat was scheduled.
+void performKeyRepeat(uint16_t modcode) {
+    if (g_auto_repeat && g_auto_repeat->IsKeyHeld(modcode)) {
+        performKeyEvent(modcode, true, true);
     }
-    g_key_states.clear();
-    g_last_known_key_down = 0;
-    
-    // Clear all pressed touch points
-    for (auto& [touchId, state] : g_touch_states) {
-        if (state.isDown) {
-            performTouchEvent(state.screenId, state.x, state.y, touchId, false); // Send touch up event
+}
+
+// typeText feature
+// Types characters as KEYEVENTF_UNICODE events, independent of the keyboard
+// layout, and keys by scancode. Each batch is one SendInput call.
+class UnicodeTextSink : public TextSink {
+public:
+    size_t TypeKeys(const TypedKey* keys, size_t count) override {
+        inputs_.clear();
+        key_ends_.clear();
+        for (size_t k = 0; k < count; ++k) {
+            if (keys[k].kind == TypedKeyKind::kKey) {
+                AppendKey(static_cast<uint16_t>(keys[k].code));
+            } else {
+                uint16_t units[2];
+                size_t unit_count = EncodeUtf16(keys[k].code, units);
+                for (size_t u = 0; u < unit_count; ++u) {
+                    AppendUnit(units[u], true);
+                    AppendUnit(units[u], false);
+                }
+            }
+            key_ends_.push_back(inputs_.size());
         }
+
+        UINT total = static_cast<UINT>(inputs_.size());
+        UINT sent = SendInput(total, inputs_.data(), sizeof(INPUT));
+        if (sent < total) {
+            // Usually a desktop switch; resync once and send the rest.
+            syncThreadDesktop();
+            sent += SendInput(total - sent, inputs_.data() + sent, sizeof(INPUT));
+        }
+        return static_cast<size_t>(std::upper_bound(key_ends_.begin(), key_ends_.end(), sent) - key_ends_.begin());
     }
-    g_touch_states.clear();
-    
-    // Clear pen device if it exists and is in contact
-    if (g_penDevice && (g_penInfo.penInfo.pointerInfo.pointerFlags & POINTER_FLAG_INCONTACT)) {
-        // Send pen up event to clear the state
-        g_penInfo.penInfo.pointerInfo.pointerFlags &= ~(POINTER_FLAG_INCONTACT | POINTER_FLAG_INRANGE);
-        g_penInfo.penInfo.pointerInfo.pointerFlags |= POINTER_FLAG_UP;
-        send_pen_input();
-        // Clear edge-triggered flags
-        constexpr auto EDGE_TRIGGERED_POINTER_FLAGS = POINTER_FLAG_DOWN | POINTER_FLAG_UP | POINTER_FLAG_CANCELED | POINTER_FLAG_UPDATE;
-        g_penInfo.penInfo.pointerInfo.pointerFlags &= ~EDGE_TRIGGERED_POINTER_FLAGS;
-    }
-    
-    // Clear mouse buttons (left and right)
-    // Check if mouse buttons are currently pressed using GetAsyncKeyState
-    if (GetAsyncKeyState(VK_LBUTTON) & 0x8000) {
-        performMouseButton(1, true); // Left button up
-    }
-    if (GetAsyncKeyState(VK_RBUTTON) & 0x8000) {
-        performMouseButton(3, true); // Right button up
-    }
-    if (GetAsyncKeyState(VK_MBUTTON) & 0x8000) {
-        performMouseButton(2, true); // Middle button up
+
+private:
+    void AppendKey(uint16_t virtual_key) {
+        INPUT down{};
+        fillKeyInput(down, virtual_key, true);
+        inputs_.push_back(down);
+        INPUT up{};
+        fillKeyInput(up, virtual_key, false);
+        inputs_.push_back(up);
     }
-    if (GetAsyncKeyState(VK_XBUTTON1) & 0x8000) {
-        performMouseButton(4, true); // XButton1 up
+
+    void AppendUnit(uint16_t unit, bool isDown) {
+        INPUT i{};
+        i.type = INPUT_KEYBOARD;
+        i.ki.wScan = unit;
+        i.ki.dwFlags = KEYEVENTF_UNICODE | (isDown ? 0 : KEYEVENTF_KEYUP);
+        inputs_.push_back(i);
     }
-    if (GetAsyncKeyState(VK_XBUTTON2) & 0x8000) {
-        performMouseButton(5, true); // XButton2 up
+
+    std::vector<INPUT> inputs_;
+    // Index past the last INPUT of each key.
+    std::vector<size_t> key_ends_;
+};
+
+// Types UTF-8 |text| in batches of |keys_per_batch| keys (all at once when
+// not positive), |batch_interval_ms| apart. Input queued before the call is
+// injected first. Returns how many keys were typed.
+int typeText(const std::string& text, int keys_per_batch, int batch_interval_ms) {
+    std::vector<TypedKey> keys;
+    DecodeTypedText(text.data(), text.size(), &keys);
+
+    TextPacing pacing;
+    pacing.keys_per_batch = keys_per_batch > 0 ? static_cast<size_t>(keys_per_batch) : 0;
+    pacing.batch_interval = std::chrono::milliseconds((std::max)(batch_interval_ms, 0));
+
+    WaitForInjectorIdle();
+    UnicodeTextSink sink;
+    size_t typed = TypeText(keys, pacing, sink, [](std::chrono::microseconds interval) {
+        std::this_thread::sleep_for(interval);
+        return !g_shutting_down.load(std::memory_order_relaxed);
+    });
+    return static_cast<int>(typed);
+}
+// end of typeText feature
+
+// performGesture feature
+// Plays |spec| on the gesture lane. Every deadline is counted from one start
+// time, so sleep overshoot doesn't add up over the gesture. Frames go through
+// the injector queue like other touch input and reach the OS from the
+// injector thread, one touch frame each. Returns how many were injected.
+int performGesture(const GestureSpec& spec) {
+    GesturePlayer player(spec);
+    auto start = std::chrono::steady_clock::now();
+    size_t frames = PlayGesture(player, GetClientInputSink(), [start](std::chrono::microseconds at) {
+        std::this_thread::sleep_until(start + at);
+        return !g_shutting_down.load(std::memory_order_relaxed);
+    });
+    return static_cast<int>(frames);
+}
+// end of performGesture feature
+
+void clearAllPressedEvents() {
+    // Ups go through the injector thread, which owns the touch and pen state
+    // and drops repeats of inputs released here.
+    if (g_remapping_sink) {
+        g_remapping_sink->ForgetPressed();
     }
+    g_pressed.ReleaseAll(GetInjectorInputSink());
+    WaitForInjectorIdle();
 }
 
 bool setPrimaryDisplay(int displayIndex) {
@@ -1037,14 +1277,26 @@ bool setPrimaryDisplay(int displayIndex) {
 }
 
 void performMouseMoveRelative(double x,double y){
+    // Scaled motion has fractions of a count; carry them into the next move
+    // so slow movement under a low sensitivity is not lost. Injector thread
+    // only.
+    static double carry_x = 0;
+    static double carry_y = 0;
+    x += carry_x;
+    y += carry_y;
+    LONG dx = static_cast<LONG>(x);
+    LONG dy = static_cast<LONG>(y);
+    carry_x = x - dx;
+    carry_y = y - dy;
+
     INPUT i {};
 
     i.type = INPUT_MOUSE;
     auto &mi = i.mi;
 
     mi.dwFlags = MOUSEEVENTF_MOVE;
-    mi.dx = x;
-    mi.dy = y;
+    mi.dx = dx;
+    mi.dy = dy;
 
     send_input(i);
 }
@@ -1129,6 +1381,121 @@ void hscroll(int distance) {
     send_input(i);
 }
 
+void performMouseScroll(double dx, double dy) {
+    int deltax = static_cast<int>(dx);
+    int deltay = static_cast<int>(dy);
+    if (deltax != 0) {
+        hscroll(deltax * 2);
+    }
+    if (deltay != 0) {
+        scroll(deltay * 2);
+    }
+}
+
+// Feeds events decoded from the binary input batch channel into the same
+// injection functions HandleMethodCall uses.
+class PluginInputSink : public InputSink {
+public:
+    void KeyEvent(uint16_t key_code, bool is_down) override {
+        performKeyEvent(key_code, is_down);
+    }
+    void MouseMoveRelative(double dx, double dy) override {
+        performMouseMoveRelative(dx, dy);
+    }
+    void MouseMoveAbsolute(double x, double y, int screen_id) override {
+        performMouseMoveAbsl(x, y, screen_id);
+    }
+    void MouseButton(int button_id, bool is_down) override {
+        performMouseButton(button_id, !is_down);
+    }
+    void MouseScroll(double dx, double dy) override {
+        performMouseScroll(dx, dy);
+    }
+    void TouchEvent(int screen_id, double x, double y, uint32_t touch_id, bool is_down) override {
+        performTouchEvent(screen_id, x, y, touch_id, is_down);
+    }
+    void TouchMove(int screen_id, double x, double y, uint32_t touch_id) override {
+        performTouchMove(screen_id, x, y, touch_id);
+    }
+    void TouchFrame(const TouchUpdate* updates, size_t count) override {
+        performTouchFrame(updates, count);
+    }
+    void PenEvent(int screen_id, double x, double y, bool is_down, bool has_button,
+                  double pressure, double rotation, double tilt) override {
+        performPenEvent(screen_id, x, y, is_down, has_button, pressure, rotation, tilt);
+    }
+    void PenMove(int screen_id, double x, double y, bool has_button,
+                 double pressure, double rotation, double tilt) override {
+        performPenMove(screen_id, x, y, has_button, pressure, rotation, tilt);
+    }
+    void PenMoveBatch(int screen_id, const PenSample* samples, size_t count) override {
+        performPenMoveBatch(screen_id, samples, count);
+    }
+    void KeyRepeat(uint16_t key_code) override {
+        performKeyRepeat(key_code);
+    }
+    void TouchRepeat(uint32_t touch_id) override {
+        performTouchRepeat(touch_id);
+    }
+};
+
+static PluginInputSink g_input_sink;
+
+InputSink& GetPluginInputSink() {
+    return g_input_sink;
+}
+
+// The sink producers should use: the injector queue while the plugin is
+// registered, direct injection otherwise.
+InputSink& GetInjectorInputSink() {
+    if (g_injector_sink) {
+        return *g_injector_sink;
+    }
+    return g_input_sink;
+}
+
+// The sink for input from Dart: smoothed, remapped, then queued for the
+// injector.
+InputSink& GetClientInputSink() {
+    if (g_smoothing_sink) {
+        return *g_smoothing_sink;
+    }
+    if (g_remapping_sink) {
+        return *g_remapping_sink;
+    }
+    return GetInjectorInputSink();
+}
+
+// Loads a remap profile; it applies to client input from the next event on.
+RemapStatus setInputRemap(const InputRemapSpec& spec) {
+    auto remap = std::make_shared<InputRemap>();
+    RemapStatus status = InputRemap::Build(spec, remap.get());
+    if (status == RemapStatus::kOk && g_remapping_sink) {
+        g_remapping_sink->Publish(std::move(remap));
+    }
+    return status;
+}
+
+// Turns smoothing of client pen or touch input on or off from the next
+// sample on.
+void setInputSmoothing(SmoothedDevice device, bool enabled, const OneEuroParams& params) {
+    if (!g_smoothing_sink) {
+        return;
+    }
+    if (enabled) {
+        g_smoothing_sink->Enable(device, params);
+    } else {
+        g_smoothing_sink->Disable(device);
+    }
+}
+
+// Lets queued input reach the OS before a call that injects directly.
+void WaitForInjectorIdle() {
+    if (g_injector) {
+        g_injector->WaitUntilIdle();
+    }
+}
+
 std::wstring stringToWstring(const std::string& str) {
     int wideCharLen = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), -1, nullptr, 0);
     if (wideCharLen <= 0) return L"";
@@ -1138,11 +1505,134 @@ std::wstring stringToWstring(const std::string& str) {
     return wstr;
 }
 
+// Control-plane calls are serialized per subsystem: VirtualDisplayControl and
+// GameControllerManager keep static state, so each gets one lane and calls
+// into it keep the order Dart issued them in. Controller actions are input
+// and stay on the platform thread, behind the manager's own lock.
+enum ControlLane {
+    kControlLaneNone = 0,
+    kControlLaneDisplay,
+    kControlLaneGameController,
+    kControlLaneService,
+    // Paced text runs for as long as it takes; it must not hold up the
+    // other lanes.
+    kControlLaneText,
+    // Gestures sleep between frames for their whole duration, and one
+    // gesture's contacts must be up before the next one's go down.
+    kControlLaneGesture,
+};
+
+constexpr size_t kControlPlaneWorkers = 5;
+
+ControlLane ControlLaneFor(MethodId method_id) {
+    switch (method_id) {
+    case MethodId::kSetPrimaryDisplay:
+    case MethodId::kInitParsecVdd:
+    case MethodId::kCreateDisplay:
+    case MethodId::kRemoveDisplay:
+    case MethodId::kCheckVddStatus:
+    case MethodId::kGetAllDisplays:
+    case MethodId::kGetDisplayList:
+    case MethodId::kChangeDisplaySettings:
+    case MethodId::kGetDisplayConfigs:
+    case MethodId::kGetCustomDisplayConfigs:
+    case MethodId::kSetCustomDisplayConfigs:
+    case MethodId::kSetDisplayOrientation:
+    case MethodId::kGetDisplayOrientation:
+    case MethodId::kSetMultiDisplayMode:
+    case MethodId::kGetCurrentMultiDisplayMode:
+    case MethodId::kSetPrimaryDisplayOnly:
+    case MethodId::kRestoreDisplayConfiguration:
+    case MethodId::kHasPendingConfiguration:
+        return kControlLaneDisplay;
+    case MethodId::kCreateGameController:
+    case MethodId::kRemoveGameController:
+        return kControlLaneGameController;
+    case MethodId::kRegisterService:
+    case MethodId::kUnregisterService:
+        return kControlLaneService;
+    case MethodId::kTypeText:
+        return kControlLaneText;
+    case MethodId::kPerformGesture:
+        return kControlLaneGesture;
+    default:
+        return kControlLaneNone;
+    }
+}
+
+// Completes a method call from a control-plane worker. The engine expects
+// results on the platform thread, so each reply is handed to the executor,
+// which runs it there after waking the window.
+class PlatformThreadResult : public flutter::MethodResult<flutter::EncodableValue> {
+public:
+    PlatformThreadResult(std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result,
+                         ControlPlaneExecutor* executor)
+        : result_(std::move(result)), executor_(executor) {}
+
+protected:
+    void SuccessInternal(const flutter::EncodableValue* value) override {
+        std::optional<flutter::EncodableValue> copy;
+        if (value) {
+            copy = *value;
+        }
+        executor_->PostReply([result = result_, copy = std::move(copy)] {
+            if (copy) {
+                result->Success(*copy);
+            } else {
+                result->Success();
+            }
+        });
+    }
+
+    void ErrorInternal(const std::string& error_code,
+                       const std::string& error_message,
+                       const flutter::EncodableValue* error_details) override {
+        std::optional<flutter::EncodableValue> details;
+        if (error_details) {
+            details = *error_details;
+        }
+        executor_->PostReply([result = result_, error_code, error_message, details = std::move(details)] {
+            if (details) {
+                result->Error(error_code, error_message, *details);
+            } else {
+                result->Error(error_code, error_message);
+            }
+        });
+    }
+
+    void NotImplementedInternal() override {
+        executor_->PostReply([result = result_] { result->NotImplemented(); });
+    }
+
+private:
+    std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> result_;
+    ControlPlaneExecutor* executor_;
+};
+
+// Decodes |args| into |out|, or replies with a typed error and returns false.
+template <typename Args>
+bool DecodeArgsOrReply(const flutter::EncodableMap* args, Args* out,
+                       flutter::MethodResult<flutter::EncodableValue>* result) {
+    ArgError error = DecodeVariantMapArgs(args, out);
+    if (!error.ok()) {
+        result->Error(ArgErrorCodeName(error.code), error.Message());
+        return false;
+    }
+    return true;
+}
+
 void HardwareSimulatorPlugin::HandleMethodCall(
     const flutter::MethodCall<flutter::EncodableValue> &method_call,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
   const flutter::EncodableMap* args = std::get_if<flutter::EncodableMap>(method_call.arguments());
-  if (method_call.method_name().compare("getPlatformVersion") == 0) {
+  MethodId method_id = LookupMethod(method_call.method_name());
+  if (ControlLaneFor(method_id) != kControlLaneNone) {
+    DispatchControlPlaneCall(method_id, args, std::move(result));
+    return;
+  }
+
+  switch (method_id) {
+  case MethodId::kGetPlatformVersion: {
     std::ostringstream version_stream;
     version_stream << "Windows ";
     if (IsWindows10OrGreater()) {
@@ -1153,51 +1643,62 @@ void HardwareSimulatorPlugin::HandleMethodCall(
       version_stream << "7";
     }
     result->Success(flutter::EncodableValue(version_stream.str()));
-  } else if (method_call.method_name().compare("getMonitorCount") == 0) {
+    break;
+  }
+  case MethodId::kGetMonitorCount: {
     int monitorCount = GetSystemMetrics(SM_CMONITORS);
     //update_monitors();
     result->Success(flutter::EncodableValue(monitorCount));
-  } else if (method_call.method_name().compare("KeyPress") == 0) {
-        auto keyCode = (args->find(flutter::EncodableValue("code")))->second;
-        auto isDown = (args->find(flutter::EncodableValue("isDown")))->second;
-        performKeyEvent(static_cast<int>(std::get<int>((keyCode))), static_cast<bool>(std::get<bool>((isDown))));
+    break;
+  }
+  case MethodId::kKeyPress: {
+        KeyPressArgs key;
+        if (!DecodeArgsOrReply(args, &key, result.get())) break;
+        GetClientInputSink().KeyEvent(static_cast<uint16_t>(key.code), key.is_down);
         result->Success(nullptr);
-  } else if (method_call.method_name().compare("mouseMoveR") == 0) {
-        auto deltax = (args->find(flutter::EncodableValue("x")))->second;
-        auto deltay = (args->find(flutter::EncodableValue("y")))->second;
-        performMouseMoveRelative(static_cast<double>(std::get<double>((deltax))), static_cast<double>(std::get<double>((deltay))));
+    break;
+  }
+  case MethodId::kMouseMoveR: {
+        MouseXYArgs delta;
+        if (!DecodeArgsOrReply(args, &delta, result.get())) break;
+        GetClientInputSink().MouseMoveRelative(delta.x, delta.y);
         result->Success(nullptr);
-  } else if (method_call.method_name().compare("mouseMoveA") == 0) {
-        auto percentx = (args->find(flutter::EncodableValue("x")))->second;
-        auto percenty = (args->find(flutter::EncodableValue("y")))->second;
-        auto screenId = (args->find(flutter::EncodableValue("screenId")))->second;
-        performMouseMoveAbsl(static_cast<double>(std::get<double>((percentx))), static_cast<double>(std::get<double>((percenty))), static_cast<int>(std::get<int>((screenId))));
+    break;
+  }
+  case MethodId::kMouseMoveA: {
+        MouseMoveAArgs position;
+        if (!DecodeArgsOrReply(args, &position, result.get())) break;
+        GetClientInputSink().MouseMoveAbsolute(position.x, position.y, position.screen_id);
         result->Success(nullptr);
-  } else if (method_call.method_name().compare("mouseMoveToWindowPosition") == 0) {
-        auto percentx = (args->find(flutter::EncodableValue("x")))->second;
-        auto percenty = (args->find(flutter::EncodableValue("y")))->second;
-        performMouseMoveToWindowPosition(static_cast<double>(std::get<double>((percentx))), static_cast<double>(std::get<double>((percenty))));
+    break;
+  }
+  case MethodId::kMouseMoveToWindowPosition: {
+        MouseXYArgs percent;
+        if (!DecodeArgsOrReply(args, &percent, result.get())) break;
+        WaitForInjectorIdle();
+        performMouseMoveToWindowPosition(percent.x, percent.y);
         result->Success(nullptr);
-  } else if (method_call.method_name().compare("mousePress") == 0) {
-        auto buttonid = (args->find(flutter::EncodableValue("buttonId")))->second;
-        auto isDown = (args->find(flutter::EncodableValue("isDown")))->second;
-        performMouseButton(static_cast<int>(std::get<int>((buttonid))), !static_cast<bool>(std::get<bool>((isDown))));
+    break;
+  }
+  case MethodId::kMousePress: {
+        MousePressArgs button;
+        if (!DecodeArgsOrReply(args, &button, result.get())) break;
+        GetClientInputSink().MouseButton(button.button_id, button.is_down);
         result->Success(nullptr);
-  } else if (method_call.method_name().compare("mouseScroll") == 0) {
-        auto dx = (args->find(flutter::EncodableValue("dx")))->second;
-        auto dy = (args->find(flutter::EncodableValue("dy")))->second;
-        int deltax = static_cast<double>(std::get<double>((dx)));
-        int deltay = static_cast<double>(std::get<double>((dy)));
-        if (deltax!=0){
-          hscroll(deltax * 2);
-        }
-        if (deltay!=0){
-          scroll(deltay * 2);
-        }
+    break;
+  }
+  case MethodId::kMouseScroll: {
+        MouseScrollArgs scroll;
+        if (!DecodeArgsOrReply(args, &scroll, result.get())) break;
+        GetClientInputSink().MouseScroll(scroll.dx, scroll.dy);
         result->Success(nullptr);
-  } else if (method_call.method_name().compare("hookCursorImage") == 0) {
-        auto callbackID = static_cast<int>(std::get<int>((args->find(flutter::EncodableValue("callbackID")))->second));
-        auto hookAll = static_cast<bool>(std::get<bool>((args->find(flutter::EncodableValue("hookAll")))->second));
+    break;
+  }
+  case MethodId::kHookCursorImage: {
+        HookCursorImageArgs hook;
+        if (!DecodeArgsOrReply(args, &hook, result.get())) break;
+        auto callbackID = hook.callback_id;
+        auto hookAll = hook.hook_all;
         CursorMonitor::startHook([this, callbackID](int message, int msg_info, const std::vector<uint8_t>& cursorImage) {
             flutter::EncodableMap encoded_message;
             encoded_message[flutter::EncodableValue("callbackID")] = flutter::EncodableValue(callbackID);
@@ -1210,12 +1711,19 @@ void HardwareSimulatorPlugin::HandleMethodCall(
             }
         }, callbackID, hookAll);
         result->Success(nullptr);
-  } else if (method_call.method_name().compare("unhookCursorImage") == 0) {
-        auto callbackID = static_cast<int>(std::get<int>((args->find(flutter::EncodableValue("callbackID")))->second));
-        CursorMonitor::endHook(callbackID);
+    break;
+  }
+  case MethodId::kUnhookCursorImage: {
+        CallbackIdArgs hook;
+        if (!DecodeArgsOrReply(args, &hook, result.get())) break;
+        CursorMonitor::endHook(hook.callback_id);
         result->Success(nullptr);
-  } else if (method_call.method_name().compare("hookCursorPosition") == 0) {
-        auto callbackID = static_cast<int>(std::get<int>((args->find(flutter::EncodableValue("callbackID")))->second));
+    break;
+  }
+  case MethodId::kHookCursorPosition: {
+        CallbackIdArgs hook;
+        if (!DecodeArgsOrReply(args, &hook, result.get())) break;
+        auto callbackID = hook.callback_id;
         CursorMonitor::startPositionHook([this, callbackID](int message, int screenId, double xPercent, double yPercent) {
             flutter::EncodableMap encoded_message;
             encoded_message[flutter::EncodableValue("callbackID")] = flutter::EncodableValue(callbackID);
@@ -1229,12 +1737,19 @@ void HardwareSimulatorPlugin::HandleMethodCall(
             }
         }, callbackID);
         result->Success(nullptr);
-  } else if (method_call.method_name().compare("unhookCursorPosition") == 0) {
-        auto callbackID = static_cast<int>(std::get<int>((args->find(flutter::EncodableValue("callbackID")))->second));
-        CursorMonitor::endPositionHook(callbackID);
+    break;
+  }
+  case MethodId::kUnhookCursorPosition: {
+        CallbackIdArgs hook;
+        if (!DecodeArgsOrReply(args, &hook, result.get())) break;
+        CursorMonitor::endPositionHook(hook.callback_id);
         result->Success(nullptr);
-  } else if (method_call.method_name().compare("addDisplayCountChangedCallback") == 0) {
-        auto callbackID = static_cast<int>(std::get<int>((args->find(flutter::EncodableValue("callbackID")))->second));
+    break;
+  }
+  case MethodId::kAddDisplayCountChangedCallback: {
+        CallbackIdArgs callback;
+        if (!DecodeArgsOrReply(args, &callback, result.get())) break;
+        auto callbackID = callback.callback_id;
         addDisplayCountChangedCallback([this, callbackID](int displayCount) {
             flutter::EncodableMap encoded_message;
             encoded_message[flutter::EncodableValue("callbackID")] = flutter::EncodableValue(callbackID);
@@ -1245,127 +1760,274 @@ void HardwareSimulatorPlugin::HandleMethodCall(
             }
         }, callbackID);
         result->Success(nullptr);
-  } else if (method_call.method_name().compare("removeDisplayCountChangedCallback") == 0) {
-        auto callbackID = static_cast<int>(std::get<int>((args->find(flutter::EncodableValue("callbackID")))->second));
-        removeDisplayCountChangedCallback(callbackID);
+    break;
+  }
+  case MethodId::kRemoveDisplayCountChangedCallback: {
+        CallbackIdArgs callback;
+        if (!DecodeArgsOrReply(args, &callback, result.get())) break;
+        removeDisplayCountChangedCallback(callback.callback_id);
         result->Success(nullptr);
-  } else if (method_call.method_name().compare("createGameController") == 0) {
-        int hr = GameControllerManager::CreateGameController();
-        result->Success(flutter::EncodableValue(hr));
-  } else if (method_call.method_name().compare("removeGameController") == 0) {
-        auto id = static_cast<int>(std::get<int>((args->find(flutter::EncodableValue("id")))->second));
-        int hr = GameControllerManager::RemoveGameController(id);
-        result->Success(flutter::EncodableValue(hr));
-  } else if (method_call.method_name().compare("doControlAction") == 0) {
-    if (args) {
-        auto id_iter = args->find(flutter::EncodableValue("id"));
-        auto action_iter = args->find(flutter::EncodableValue("action"));
-        
-        if (id_iter != args->end() && action_iter != args->end() &&
-            std::holds_alternative<int>(id_iter->second) &&
-            std::holds_alternative<std::string>(action_iter->second)) {
-            
-            int id = std::get<int>(id_iter->second);
-            std::string action = std::get<std::string>(action_iter->second);
-
-            GameControllerManager::DoControllerAction(id, action);
-            result->Success(flutter::EncodableValue());
-        } else {
-            result->Error("InvalidArguments", "Missing or invalid arguments for doControlAction");
-        }
-    } else {
-        result->Error("NullArguments", "Arguments are null for doControlAction");
-    }
-  } else if (method_call.method_name().compare("registerService") == 0) {
-        DWORD dword;
-        bool allowed_to_run = RunBatchAsAdmin(L"service.bat", &dword, true);
-        result->Success(flutter::EncodableValue(allowed_to_run));
-  } else if (method_call.method_name().compare("unregisterService") == 0) {
-        DWORD dword;
-        RunBatchAsAdmin(L"unregisterservice.bat", &dword, false);
-        result->Success(flutter::EncodableValue());
-  } else if (method_call.method_name().compare("isRunningAsSystem") == 0) {
+    break;
+  }
+  case MethodId::kIsRunningAsSystem: {
         if (IsRunningAsSystem()) {
             result->Success(flutter::EncodableValue(true));
         }
         else {
             result->Success(flutter::EncodableValue(false));
         }
-  } else if (method_call.method_name().compare("showNotification") == 0) {
-        auto content = static_cast<std::string>(std::get<std::string>((args->find(flutter::EncodableValue("content")))->second));
-        NotificationWindow::Show(stringToWstring(content));
-  } else if (method_call.method_name().compare("touchEvent") == 0) {
-        auto screenId = (args->find(flutter::EncodableValue("screenId")))->second;
-        auto x = (args->find(flutter::EncodableValue("x")))->second;
-        auto y = (args->find(flutter::EncodableValue("y")))->second;
-        auto touchId = (args->find(flutter::EncodableValue("touchId")))->second;
-        auto isDown = (args->find(flutter::EncodableValue("isDown")))->second;
-        performTouchEvent(
-            static_cast<int>(std::get<int>((screenId))),
-            static_cast<double>(std::get<double>((x))),
-            static_cast<double>(std::get<double>((y))),
-            static_cast<uint32_t>(std::get<int>((touchId))),
-            static_cast<bool>(std::get<bool>((isDown)))
-        );
+    break;
+  }
+  case MethodId::kShowNotification: {
+        ShowNotificationArgs notification;
+        if (!DecodeArgsOrReply(args, &notification, result.get())) break;
+        NotificationWindow::Show(stringToWstring(notification.content));
+    break;
+  }
+  case MethodId::kTouchEvent: {
+        TouchEventArgs touch;
+        if (!DecodeArgsOrReply(args, &touch, result.get())) break;
+        GetClientInputSink().TouchEvent(touch.screen_id, touch.x, touch.y,
+                                          static_cast<uint32_t>(touch.touch_id), touch.is_down);
         result->Success(nullptr);
-  } else if (method_call.method_name().compare("touchMove") == 0) {
-        auto screenId = (args->find(flutter::EncodableValue("screenId")))->second;
-        auto x = (args->find(flutter::EncodableValue("x")))->second;
-        auto y = (args->find(flutter::EncodableValue("y")))->second;
-        auto touchId = (args->find(flutter::EncodableValue("touchId")))->second;
-        performTouchMove(
-            static_cast<int>(std::get<int>((screenId))),
-            static_cast<double>(std::get<double>((x))),
-            static_cast<double>(std::get<double>((y))),
-            static_cast<uint32_t>(std::get<int>((touchId)))
-        );
+    break;
+  }
+  case MethodId::kTouchMove: {
+        TouchMoveArgs touch;
+        if (!DecodeArgsOrReply(args, &touch, result.get())) break;
+        GetClientInputSink().TouchMove(touch.screen_id, touch.x, touch.y,
+                                         static_cast<uint32_t>(touch.touch_id));
         result->Success(nullptr);
-  } else if (method_call.method_name().compare("penEvent") == 0) {
-        auto screenId = (args->find(flutter::EncodableValue("screenId")))->second;
-        auto x = (args->find(flutter::EncodableValue("x")))->second;
-        auto y = (args->find(flutter::EncodableValue("y")))->second;
-        auto isDown = (args->find(flutter::EncodableValue("isDown")))->second;
-        auto hasButton = (args->find(flutter::EncodableValue("hasButton")))->second;
-        auto pressure = (args->find(flutter::EncodableValue("pressure")))->second;
-        auto rotation = (args->find(flutter::EncodableValue("rotation")))->second;
-        auto tilt = (args->find(flutter::EncodableValue("tilt")))->second;
-        performPenEvent(
-            static_cast<int>(std::get<int>((screenId))),
-            static_cast<double>(std::get<double>((x))),
-            static_cast<double>(std::get<double>((y))),
-            static_cast<bool>(std::get<bool>((isDown))),
-            static_cast<bool>(std::get<bool>((hasButton))),
-            static_cast<double>(std::get<double>((pressure))),
-            static_cast<double>(std::get<double>((rotation))),
-            static_cast<double>(std::get<double>((tilt)))
-        );
+    break;
+  }
+  case MethodId::kPenEvent: {
+        PenEventArgs pen;
+        if (!DecodeArgsOrReply(args, &pen, result.get())) break;
+        GetClientInputSink().PenEvent(pen.screen_id, pen.x, pen.y, pen.is_down, pen.has_button,
+                                        pen.pressure, pen.rotation, pen.tilt);
         result->Success(nullptr);
-  } else if (method_call.method_name().compare("penMove") == 0) {
-        auto screenId = (args->find(flutter::EncodableValue("screenId")))->second;
-        auto x = (args->find(flutter::EncodableValue("x")))->second;
-        auto y = (args->find(flutter::EncodableValue("y")))->second;
-        auto hasButton = (args->find(flutter::EncodableValue("hasButton")))->second;
-        auto pressure = (args->find(flutter::EncodableValue("pressure")))->second;
-        auto rotation = (args->find(flutter::EncodableValue("rotation")))->second;
-        auto tilt = (args->find(flutter::EncodableValue("tilt")))->second;
-        performPenMove(
-            static_cast<int>(std::get<int>((screenId))),
-            static_cast<double>(std::get<double>((x))),
-            static_cast<double>(std::get<double>((y))),
-            static_cast<bool>(std::get<bool>((hasButton))),
-            static_cast<double>(std::get<double>((pressure))),
-            static_cast<double>(std::get<double>((rotation))),
-            static_cast<double>(std::get<double>((tilt)))
-        );
+    break;
+  }
+  case MethodId::kPenMove: {
+        PenMoveArgs pen;
+        if (!DecodeArgsOrReply(args, &pen, result.get())) break;
+        GetClientInputSink().PenMove(pen.screen_id, pen.x, pen.y, pen.has_button,
+                                       pen.pressure, pen.rotation, pen.tilt);
         result->Success(nullptr);
-  } else if (method_call.method_name().compare("clearAllPressedEvents") == 0) {
+    break;
+  }
+  case MethodId::kClearAllPressedEvents: {
+        WaitForInjectorIdle();
         clearAllPressedEvents();
         result->Success(nullptr);
-  } else if (method_call.method_name().compare("setPrimaryDisplay") == 0) {
-        auto displayIndex = static_cast<int>(std::get<int>((args->find(flutter::EncodableValue("displayIndex")))->second));
-        bool success = setPrimaryDisplay(displayIndex);
+    break;
+  }
+  case MethodId::kPutImmersiveModeEnabled: {
+     EnabledArgs immersive;
+     if (!DecodeArgsOrReply(args, &immersive, result.get())) break;
+     SetImmersiveMode(immersive.enabled);
+     result->Success(flutter::EncodableValue(true));
+    break;
+  }
+  case MethodId::kSetDragWindowContents: {
+     EnabledArgs drag;
+     if (!DecodeArgsOrReply(args, &drag, result.get())) break;
+     setDragWindowContents(drag.enabled);
+     result->Success();
+    break;
+  }
+  case MethodId::kLockCursor: {
+        LockCursor();
+        result->Success(flutter::EncodableValue(true));
+    break;
+  }
+  case MethodId::kUnlockCursor: {
+        UnlockCursor();
+        result->Success(flutter::EncodableValue(true));
+    break;
+  }
+  case MethodId::kUpdateStaticMonitors: {
+        UpdateStaticMonitors();
+        result->Success();
+    break;
+  }
+  case MethodId::kSetTouchContactLimit: {
+        TouchContactLimitArgs limit;
+        if (!DecodeArgsOrReply(args, &limit, result.get())) break;
+        result->Success(flutter::EncodableValue(setTouchContactLimit(limit.max_contacts)));
+    break;
+  }
+  case MethodId::kSetInputRemap: {
+        InputRemapArgs remap;
+        if (!DecodeArgsOrReply(args, &remap, result.get())) break;
+        InputRemapSpec spec;
+        spec.key_map = std::move(remap.key_map);
+        spec.button_map = std::move(remap.button_map);
+        spec.sensitivity_x = remap.sensitivity_x;
+        spec.sensitivity_y = remap.sensitivity_y;
+        spec.curve = std::move(remap.curve);
+        RemapStatus status = setInputRemap(spec);
+        if (status != RemapStatus::kOk) {
+            result->Error("InvalidRemap", RemapStatusMessage(status));
+            break;
+        }
+        result->Success();
+    break;
+  }
+  case MethodId::kSetInputSmoothing: {
+        SetInputSmoothingArgs smoothing;
+        if (!DecodeArgsOrReply(args, &smoothing, result.get())) break;
+        SmoothedDevice device;
+        OneEuroParams params;
+        if (!MakeSmoothingParams(smoothing, &device, &params)) {
+            result->Error("InvalidSmoothing",
+                          "device must be pen or touch, cutoffs positive and beta not negative");
+            break;
+        }
+        setInputSmoothing(device, smoothing.enabled, params);
+        result->Success();
+    break;
+  }
+  case MethodId::kSetShortcutCapturePolicy: {
+        // Runs on the platform thread, which also runs the keyboard hook.
+        ShortcutCaptureArgs capture;
+        if (!DecodeArgsOrReply(args, &capture, result.get())) break;
+        std::vector<ShortcutRule> rules = DefaultShortcutRules();
+        if (!capture.use_defaults && !DecodeShortcutRules(capture.rules, &rules)) {
+            result->Error("InvalidShortcutRule",
+                          "rules must be (key, modifiers) pairs with keys in 1..255 and known modifier bits");
+            break;
+        }
+        SmartKeyboardBlocker::SetRules(rules);
+        result->Success();
+    break;
+  }
+  case MethodId::kSetInputLease: {
+        InputLeaseArgs lease;
+        if (!DecodeArgsOrReply(args, &lease, result.get())) break;
+        setInputLease(lease.timeout_ms);
+        result->Success();
+    break;
+  }
+  case MethodId::kRenewInputLease: {
+        renewInputLease();
+        result->Success();
+    break;
+  }
+  case MethodId::kSetKeyRepeatTiming: {
+        KeyRepeatTimingArgs timing;
+        if (!DecodeArgsOrReply(args, &timing, result.get())) break;
+        setKeyRepeatTiming(timing.key_code, timing.delay_ms, timing.interval_ms);
+        result->Success();
+    break;
+  }
+  case MethodId::kDoControlAction: {
+        DoControlActionArgs control;
+        if (!DecodeArgsOrReply(args, &control, result.get())) break;
+        GameControllerManager::DoControllerAction(control.id, control.action);
+        result->Success(flutter::EncodableValue());
+    break;
+  }
+  case MethodId::kSetCursorMovedCoalescing: {
+        SetCursorMovedCoalescingArgs coalescing;
+        if (!DecodeArgsOrReply(args, &coalescing, result.get())) break;
+        SetCursorMovedCoalescing(coalescing.rate_hz, coalescing.include_buttons_and_wheel);
+        result->Success();
+    break;
+  }
+  default:
+    result->NotImplemented();
+    break;
+  }
+}
+
+void HardwareSimulatorPlugin::DispatchControlPlaneCall(
+    MethodId method_id,
+    const flutter::EncodableMap* args,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  if (!control_plane_) {
+    HandleControlPlaneCall(method_id, args, result.get());
+    return;
+  }
+
+  // The method call and its arguments die when HandleMethodCall returns.
+  std::shared_ptr<const flutter::EncodableMap> args_copy;
+  if (args) {
+    args_copy = std::make_shared<const flutter::EncodableMap>(*args);
+  }
+  auto platform_result = std::make_shared<PlatformThreadResult>(std::move(result), control_plane_.get());
+  control_plane_->SubmitCancellable(
+      ControlLaneFor(method_id),
+      [this, method_id, args_copy, platform_result] {
+        try {
+          HandleControlPlaneCall(method_id, args_copy.get(), platform_result.get());
+        } catch (const std::exception& e) {
+          platform_result->Error("InternalError", e.what());
+        }
+      },
+      // The plugin is going away before the call got to run.
+      [platform_result] {
+        platform_result->Error("Cancelled", "The plugin was shut down before the call ran.");
+      });
+}
+
+// Runs on a control-plane worker (or inline when there is no executor).
+// |result| may be completed from any thread.
+void HardwareSimulatorPlugin::HandleControlPlaneCall(
+    MethodId method_id,
+    const flutter::EncodableMap* args,
+    flutter::MethodResult<flutter::EncodableValue>* result) {
+  switch (method_id) {
+  case MethodId::kCreateGameController: {
+        int hr = GameControllerManager::CreateGameController();
+        result->Success(flutter::EncodableValue(hr));
+    break;
+  }
+  case MethodId::kRemoveGameController: {
+        GameControllerIdArgs controller;
+        if (!DecodeArgsOrReply(args, &controller, result)) break;
+        int hr = GameControllerManager::RemoveGameController(controller.id);
+        result->Success(flutter::EncodableValue(hr));
+    break;
+  }
+  case MethodId::kTypeText: {
+        TypeTextArgs text;
+        if (!DecodeArgsOrReply(args, &text, result)) break;
+        int typed = typeText(text.text, text.keys_per_batch, text.batch_interval_ms);
+        result->Success(flutter::EncodableValue(typed));
+    break;
+  }
+  case MethodId::kPerformGesture: {
+        PerformGestureArgs gesture;
+        if (!DecodeArgsOrReply(args, &gesture, result)) break;
+        GestureSpec spec;
+        if (!MakeGestureSpec(gesture, &spec)) {
+            result->Error("InvalidGesture", "type must be pinch, swipe, drag or longPress");
+            break;
+        }
+        result->Success(flutter::EncodableValue(performGesture(spec)));
+    break;
+  }
+  case MethodId::kRegisterService: {
+        DWORD dword;
+        bool allowed_to_run = RunBatchAsAdmin(L"service.bat", &dword, true);
+        result->Success(flutter::EncodableValue(allowed_to_run));
+    break;
+  }
+  case MethodId::kUnregisterService: {
+        DWORD dword;
+        RunBatchAsAdmin(L"unregisterservice.bat", &dword, false);
+        result->Success(flutter::EncodableValue());
+    break;
+  }
+  case MethodId::kSetPrimaryDisplay: {
+        SetPrimaryDisplayArgs display;
+        if (!DecodeArgsOrReply(args, &display, result)) break;
+        bool success = setPrimaryDisplay(display.display_index);
         result->Success(flutter::EncodableValue(success));
-  } else if (method_call.method_name().compare("initParsecVdd") == 0) {
+    break;
+  }
+  case MethodId::kInitParsecVdd: {
     if (!VirtualDisplayControl::IsInitialized()) {
       if (VirtualDisplayControl::Initialize()) {
         result->Success(flutter::EncodableValue(true));
@@ -1375,7 +2037,9 @@ void HardwareSimulatorPlugin::HandleMethodCall(
     } else {
       result->Success(flutter::EncodableValue(true));
     }
-  } else if (method_call.method_name().compare("createDisplay") == 0) {
+    break;
+  }
+  case MethodId::kCreateDisplay: {
      if (VirtualDisplayControl::IsInitialized()) {
          int displayId = VirtualDisplayControl::AddDisplay();
          if (displayId >= 0) {
@@ -1386,26 +2050,30 @@ void HardwareSimulatorPlugin::HandleMethodCall(
      } else {
          result->Error("NOT_INITIALIZED", "Parsec not initialized");
      }
-  } else if (method_call.method_name().compare("removeDisplay") == 0) {
-     auto displayId_iter = args->find(flutter::EncodableValue("displayUid"));
-     if (displayId_iter == args->end()) {
-         result->Error("MISSING_ARGUMENT", "Missing 'displayUid' argument");
-         return;
-     }
-     auto displayId = displayId_iter->second;
+    break;
+  }
+  case MethodId::kRemoveDisplay: {
+     DisplayUidArgs display;
+     if (!DecodeArgsOrReply(args, &display, result)) break;
      if (VirtualDisplayControl::IsInitialized()) {
-        VirtualDisplayControl::RemoveDisplay(static_cast<int>(std::get<int>((displayId))));
+         VirtualDisplayControl::RemoveDisplay(display.display_uid);
          result->Success(flutter::EncodableValue(true));
      } else {
          result->Error("NOT_INITIALIZED", "Parsec not initialized");
      }
-  } else if (method_call.method_name().compare("checkVddStatus") == 0) {
+    break;
+  }
+  case MethodId::kCheckVddStatus: {
      bool status = VirtualDisplayControl::CheckVddStatus();
      result->Success(flutter::EncodableValue(status));
-  } else if (method_call.method_name().compare("getAllDisplays") == 0) {
+    break;
+  }
+  case MethodId::kGetAllDisplays: {
      int displayCount = VirtualDisplayControl::GetAllDisplays();
      result->Success(flutter::EncodableValue(displayCount));
-  } else if (method_call.method_name().compare("getDisplayList") == 0) {
+    break;
+  }
+  case MethodId::kGetDisplayList: {
      flutter::EncodableList displayList;
      auto displays = VirtualDisplayControl::GetDetailedDisplayList();
      
@@ -1431,48 +2099,25 @@ void HardwareSimulatorPlugin::HandleMethodCall(
      }
      
      result->Success(flutter::EncodableValue(displayList));
-  } else if (method_call.method_name().compare("changeDisplaySettings") == 0) {
-     // Change display settings
-     const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
-     if (!arguments) {
-         result->Error("INVALID_ARGUMENTS", "Arguments must be a map");
-         return;
-     }
-
-     // Get display uid
-     auto uid_it = arguments->find(flutter::EncodableValue("displayUid"));
-     if (uid_it == arguments->end()) {
-         result->Error("MISSING_ARGUMENT", "Missing 'displayUid' argument");
-         return;
-     }
-     int display_uid = std::get<int>(uid_it->second);
-
-     // Get new configuration
-     auto width_it = arguments->find(flutter::EncodableValue("width"));
-     auto height_it = arguments->find(flutter::EncodableValue("height"));
-     auto refresh_rate_it = arguments->find(flutter::EncodableValue("refreshRate"));
-     
-     if (width_it == arguments->end() || height_it == arguments->end() || refresh_rate_it == arguments->end()) {
-         result->Error("MISSING_ARGUMENT", "Missing width, height, or refreshRate arguments");
-         return;
-     }
-     
+    break;
+  }
+  case MethodId::kChangeDisplaySettings: {
+     ChangeDisplaySettingsArgs settings;
+     if (!DecodeArgsOrReply(args, &settings, result)) break;
      VirtualDisplay::DisplayConfig new_config;
-     new_config.width = std::get<int>(width_it->second);
-     new_config.height = std::get<int>(height_it->second);
-     new_config.refresh_rate = std::get<int>(refresh_rate_it->second);
-     
-     bool success = VirtualDisplayControl::ChangeDisplaySettings(display_uid, new_config);
+     new_config.width = settings.width;
+     new_config.height = settings.height;
+     new_config.refresh_rate = settings.refresh_rate;
+
+     bool success = VirtualDisplayControl::ChangeDisplaySettings(settings.display_uid, new_config);
      result->Success(flutter::EncodableValue(success));
-  } else if (method_call.method_name().compare("getDisplayConfigs") == 0) {
-     auto display_uid_it = args->find(flutter::EncodableValue("displayUid"));
-     if (display_uid_it == args->end()) {
-         result->Error("MISSING_ARGUMENT", "Missing 'displayUid' argument");
-         return;
-     }
-     
-     int display_uid = std::get<int>(display_uid_it->second);
-     
+    break;
+  }
+  case MethodId::kGetDisplayConfigs: {
+     DisplayUidArgs display;
+     if (!DecodeArgsOrReply(args, &display, result)) break;
+     int display_uid = display.display_uid;
+
      auto displays = VirtualDisplayControl::GetDetailedDisplayList();
      auto it = std::find_if(displays.begin(), displays.end(),
          [display_uid](const VirtualDisplayControl::DetailedDisplayInfo& display) {
@@ -1495,7 +2140,9 @@ void HardwareSimulatorPlugin::HandleMethodCall(
      }
      
      result->Success(flutter::EncodableValue(configList));
-  } else if (method_call.method_name().compare("getCustomDisplayConfigs") == 0) {
+    break;
+  }
+  case MethodId::kGetCustomDisplayConfigs: {
      auto configs = VirtualDisplayControl::GetCustomDisplayConfigs();
      
      flutter::EncodableList configList;
@@ -1508,123 +2155,77 @@ void HardwareSimulatorPlugin::HandleMethodCall(
      }
      
      result->Success(flutter::EncodableValue(configList));
-  } else if (method_call.method_name().compare("setCustomDisplayConfigs") == 0) {
-     auto configs_it = args->find(flutter::EncodableValue("configs"));
-     if (configs_it == args->end()) {
-         result->Error("MISSING_ARGUMENT", "Missing 'configs' argument");
-         return;
+    break;
+  }
+  case MethodId::kSetCustomDisplayConfigs: {
+     CustomDisplayConfigsArgs custom;
+     if (!DecodeArgsOrReply(args, &custom, result)) break;
+     if (custom.configs.size() % 3 != 0) {
+         result->Error("InvalidDisplayConfigs", "configs must be (width, height, refreshRate) triples");
+         break;
      }
-     
-     auto configs_list = std::get<flutter::EncodableList>(configs_it->second);
      std::vector<VirtualDisplay::DisplayConfig> configs;
-     
-     for (const auto& item : configs_list) {
-         auto config_map = std::get<flutter::EncodableMap>(item);
-         
-         auto width_it = config_map.find(flutter::EncodableValue("width"));
-         auto height_it = config_map.find(flutter::EncodableValue("height"));
-         auto refresh_rate_it = config_map.find(flutter::EncodableValue("refreshRate"));
-         
-         if (width_it != config_map.end() && height_it != config_map.end() && refresh_rate_it != config_map.end()) {
-             VirtualDisplay::DisplayConfig config;
-             config.width = std::get<int>(width_it->second);
-             config.height = std::get<int>(height_it->second);
-             config.refresh_rate = std::get<int>(refresh_rate_it->second);
-             configs.push_back(config);
-         }
+     for (size_t i = 0; i < custom.configs.size(); i += 3) {
+         VirtualDisplay::DisplayConfig config;
+         config.width = custom.configs[i];
+         config.height = custom.configs[i + 1];
+         config.refresh_rate = custom.configs[i + 2];
+         configs.push_back(config);
      }
-     
+
      bool success = VirtualDisplayControl::SetCustomDisplayConfigs(configs);
      result->Success(flutter::EncodableValue(success));
-  } else if (method_call.method_name().compare("setDisplayOrientation") == 0) {
-     auto display_uid_it = args->find(flutter::EncodableValue("displayUid"));
-     auto orientation_it = args->find(flutter::EncodableValue("orientation"));
-     
-     if (display_uid_it == args->end() || orientation_it == args->end()) {
-         result->Error("MISSING_ARGUMENT", "Missing required arguments");
-         return;
-     }
-     
-     int display_uid = std::get<int>(display_uid_it->second);
-     int orientation = std::get<int>(orientation_it->second);
-     
-     bool success = VirtualDisplayControl::SetDisplayOrientation(display_uid, 
-                                                                  static_cast<VirtualDisplay::Orientation>(orientation));
+    break;
+  }
+  case MethodId::kSetDisplayOrientation: {
+     DisplayOrientationArgs orientation;
+     if (!DecodeArgsOrReply(args, &orientation, result)) break;
+     bool success = VirtualDisplayControl::SetDisplayOrientation(
+         orientation.display_uid, static_cast<VirtualDisplay::Orientation>(orientation.orientation));
      result->Success(flutter::EncodableValue(success));
-  } else if (method_call.method_name().compare("getDisplayOrientation") == 0) {
-     auto display_uid_it = args->find(flutter::EncodableValue("displayUid"));
-     
-     if (display_uid_it == args->end()) {
-         result->Error("MISSING_ARGUMENT", "Missing displayUid argument");
-         return;
-     }
-     
-     int display_uid = std::get<int>(display_uid_it->second);
-     VirtualDisplay::Orientation orientation = VirtualDisplayControl::GetDisplayOrientation(display_uid);
-     
+    break;
+  }
+  case MethodId::kGetDisplayOrientation: {
+     DisplayUidArgs display;
+     if (!DecodeArgsOrReply(args, &display, result)) break;
+     VirtualDisplay::Orientation orientation = VirtualDisplayControl::GetDisplayOrientation(display.display_uid);
      result->Success(flutter::EncodableValue(static_cast<int>(orientation)));
-  } else if (method_call.method_name().compare("setMultiDisplayMode") == 0) {
-     auto mode_it = args->find(flutter::EncodableValue("mode"));
-     auto primary_id_it = args->find(flutter::EncodableValue("primaryDisplayId"));
-     
-     if (mode_it == args->end()) {
-         result->Error("MISSING_ARGUMENT", "Missing mode argument");
-         return;
-     }
-     
-     int mode = std::get<int>(mode_it->second);
-     int primary_display_id = 0;
-     if (primary_id_it != args->end()) {
-         primary_display_id = std::get<int>(primary_id_it->second);
-     }
-     
+    break;
+  }
+  case MethodId::kSetMultiDisplayMode: {
+     MultiDisplayModeArgs multi;
+     if (!DecodeArgsOrReply(args, &multi, result)) break;
      bool success = VirtualDisplayControl::SetMultiDisplayMode(
-         static_cast<VirtualDisplayControl::MultiDisplayMode>(mode), 
-         primary_display_id);
-     
+         static_cast<VirtualDisplayControl::MultiDisplayMode>(multi.mode),
+         multi.primary_display_id);
      result->Success(flutter::EncodableValue(success));
-  } else if (method_call.method_name().compare("getCurrentMultiDisplayMode") == 0) {
+    break;
+  }
+  case MethodId::kGetCurrentMultiDisplayMode: {
      VirtualDisplayControl::MultiDisplayMode mode = VirtualDisplayControl::GetCurrentMultiDisplayMode();
      result->Success(flutter::EncodableValue(static_cast<int>(mode)));
-  } else if (method_call.method_name().compare("setPrimaryDisplayOnly") == 0) {
-     auto display_uid_it = args->find(flutter::EncodableValue("displayUid"));
-     
-     if (display_uid_it == args->end()) {
-         result->Error("MISSING_ARGUMENT", "Missing displayUid argument");
-         return;
-     }
-     
-     int display_uid = std::get<int>(display_uid_it->second);
-     bool success = VirtualDisplayControl::SetPrimaryDisplayOnly(display_uid);
-     
+    break;
+  }
+  case MethodId::kSetPrimaryDisplayOnly: {
+     DisplayUidArgs display;
+     if (!DecodeArgsOrReply(args, &display, result)) break;
+     bool success = VirtualDisplayControl::SetPrimaryDisplayOnly(display.display_uid);
      result->Success(flutter::EncodableValue(success));
-  } else if (method_call.method_name().compare("restoreDisplayConfiguration") == 0) {
+    break;
+  }
+  case MethodId::kRestoreDisplayConfiguration: {
      bool success = VirtualDisplayControl::RestoreDisplayConfiguration();
      result->Success(flutter::EncodableValue(success));
-  } else if (method_call.method_name().compare("hasPendingConfiguration") == 0) {
+    break;
+  }
+  case MethodId::kHasPendingConfiguration: {
      bool has_pending = VirtualDisplayControl::HasPendingConfiguration();
      result->Success(flutter::EncodableValue(has_pending));
-  } else if (method_call.method_name().compare("putImmersiveModeEnabled") == 0) {
-     auto enabled = (args->find(flutter::EncodableValue("enabled")))->second;
-     bool immersive_enabled = static_cast<bool>(std::get<bool>((enabled)));
-     SetImmersiveMode(immersive_enabled);
-     result->Success(flutter::EncodableValue(true));
-  } else if (method_call.method_name().compare("setDragWindowContents") == 0) {
-     auto enabled = (args->find(flutter::EncodableValue("enabled")))->second;
-     bool immersive_enabled = static_cast<bool>(std::get<bool>((enabled)));
-     setDragWindowContents(immersive_enabled);
-     result->Success();
-  } else if (method_call.method_name().compare("lockCursor") == 0) {
-        LockCursor();
-        result->Success(flutter::EncodableValue(true));
-  } else if (method_call.method_name().compare("unlockCursor") == 0) {
-        UnlockCursor();
-        result->Success(flutter::EncodableValue(true));
-  } else if (method_call.method_name().compare("updateStaticMonitors") == 0) {
-        UpdateStaticMonitors();
-        result->Success();
-  } else {
+    break;
+  }
+  default:
     result->NotImplemented();
+    break;
   }
 }
 
@@ -1775,17 +2376,30 @@ bool HardwareSimulatorPlugin::SubscribeToRawInputData() {
                     RAWINPUT* raw = (RAWINPUT*)lpb;
                     if (raw->header.dwType == RIM_TYPEMOUSE) {
                         // Get relative mouse movement
-                        int deltaX = raw->data.mouse.lLastX;
-                        int deltaY = raw->data.mouse.lLastY;
-                        
-                        // Send mouse movement to Dart layer
-                        if (channel_) {
-                            flutter::EncodableMap move_message;
-                            move_message[flutter::EncodableValue("dx")] = flutter::EncodableValue(static_cast<double>(deltaX));
-                            move_message[flutter::EncodableValue("dy")] = flutter::EncodableValue(static_cast<double>(deltaY));
-                            
-                            channel_->InvokeMethod("onCursorMoved", 
-                                std::make_unique<flutter::EncodableValue>(move_message));
+                        const RAWMOUSE& mouse = raw->data.mouse;
+                        RawMouseSample sample;
+                        sample.dx = mouse.lLastX;
+                        sample.dy = mouse.lLastY;
+                        sample.timestamp_us = SteadyClockMicros();
+
+                        if (cursor_moved_buttons_and_wheel_) {
+                            sample.buttons_down = RawButtonMask(mouse.usButtonFlags, true);
+                            sample.buttons_up = RawButtonMask(mouse.usButtonFlags, false);
+                            if (mouse.usButtonFlags & RI_MOUSE_WHEEL) {
+                                sample.wheel = static_cast<SHORT>(mouse.usButtonData);
+                            }
+                            if (mouse.usButtonFlags & RI_MOUSE_HWHEEL) {
+                                sample.hwheel = static_cast<SHORT>(mouse.usButtonData);
+                            }
+                        }
+
+                        // Coalesce into one onCursorMoved per flush interval
+                        CursorMotion flushed;
+                        if (cursor_motion_.Add(sample, &flushed)) {
+                            SendCursorMotion(flushed);
+                        }
+                        if (cursor_motion_.ShouldFlush(sample.timestamp_us)) {
+                            FlushCursorMotion(sample.timestamp_us);
                         }
                     }
                 }
@@ -1795,6 +2409,15 @@ bool HardwareSimulatorPlugin::SubscribeToRawInputData() {
                 //return 0;
             }
 
+            // Deliver motion left over when the mouse stops between packets
+            if (message == WM_TIMER && wparam == kCursorMotionTimerId) {
+                int64_t now_us = SteadyClockMicros();
+                if (cursor_motion_.ShouldFlush(now_us)) {
+                    FlushCursorMotion(now_us);
+                }
+                return 0;
+            }
+
             if (message == WM_DPICHANGED || message == WM_DISPLAYCHANGE) {
                 HardwareSimulatorPlugin::UpdateStaticMonitors();
             }
@@ -1802,7 +2425,9 @@ bool HardwareSimulatorPlugin::SubscribeToRawInputData() {
             return std::nullopt;
         });
     
+    raw_input_window_ = rid[0].hwndTarget;
     raw_input_registered_ = true;
+    StartCursorMotionTimer();
     return true;
 }
 
@@ -1811,6 +2436,13 @@ void HardwareSimulatorPlugin::UnsubscribeFromRawInputData() {
         return;
     }
     
+    // Stop coalescing; anything still pending belongs to the locked session
+    if (raw_input_window_) {
+        KillTimer(raw_input_window_, kCursorMotionTimerId);
+        raw_input_window_ = nullptr;
+    }
+    FlushCursorMotion(SteadyClockMicros());
+
     // Unregister top-level window procedure delegate
     if (raw_input_proc_id_.has_value()) {
         registrar_->UnregisterTopLevelWindowProcDelegate(raw_input_proc_id_.value());
@@ -1828,6 +2460,65 @@ void HardwareSimulatorPlugin::UnsubscribeFromRawInputData() {
     raw_input_registered_ = false;
 }
 
+void HardwareSimulatorPlugin::SetCursorMovedCoalescing(int rate_hz, bool include_buttons_and_wheel) {
+    cursor_moved_rate_hz_ = rate_hz;
+    cursor_moved_buttons_and_wheel_ = include_buttons_and_wheel;
+    if (raw_input_registered_) {
+        StartCursorMotionTimer();
+    }
+}
+
+void HardwareSimulatorPlugin::StartCursorMotionTimer() {
+    int rate_hz = cursor_moved_rate_hz_;
+    if (rate_hz == 0) {
+        rate_hz = GetWindowRefreshRate(raw_input_window_);
+    }
+
+    if (rate_hz < 0) {
+        // Every raw packet is delivered as it arrives, nothing to time out.
+        cursor_motion_.set_flush_interval_us(0);
+        KillTimer(raw_input_window_, kCursorMotionTimerId);
+        return;
+    }
+
+    int64_t interval_us = 1000000 / rate_hz;
+    cursor_motion_.set_flush_interval_us(interval_us);
+    UINT interval_ms = (std::max)(static_cast<UINT>(interval_us / 1000), static_cast<UINT>(USER_TIMER_MINIMUM));
+    SetTimer(raw_input_window_, kCursorMotionTimerId, interval_ms, nullptr);
+}
+
+void HardwareSimulatorPlugin::FlushCursorMotion(int64_t now_us) {
+    CursorMotion motion;
+    if (cursor_motion_.Flush(now_us, &motion)) {
+        SendCursorMotion(motion);
+    }
+}
+
+void HardwareSimulatorPlugin::SendCursorMotion(const CursorMotion& motion) {
+    // Send mouse movement to Dart layer
+    if (!channel_) {
+        return;
+    }
+
+    flutter::EncodableMap move_message;
+    move_message[flutter::EncodableValue("dx")] = flutter::EncodableValue(static_cast<double>(motion.dx));
+    move_message[flutter::EncodableValue("dy")] = flutter::EncodableValue(static_cast<double>(motion.dy));
+    move_message[flutter::EncodableValue("sampleCount")] = flutter::EncodableValue(static_cast<int>(motion.sample_count));
+    move_message[flutter::EncodableValue("firstTimestampUs")] = flutter::EncodableValue(motion.first_timestamp_us);
+    move_message[flutter::EncodableValue("lastTimestampUs")] = flutter::EncodableValue(motion.last_timestamp_us);
+    if (motion.wheel != 0 || motion.hwheel != 0) {
+        move_message[flutter::EncodableValue("wheelDx")] = flutter::EncodableValue(static_cast<double>(motion.hwheel));
+        move_message[flutter::EncodableValue("wheelDy")] = flutter::EncodableValue(static_cast<double>(motion.wheel));
+    }
+    if (motion.buttons_down != 0 || motion.buttons_up != 0) {
+        move_message[flutter::EncodableValue("buttonsDown")] = flutter::EncodableValue(static_cast<int>(motion.buttons_down));
+        move_message[flutter::EncodableValue("buttonsUp")] = flutter::EncodableValue(static_cast<int>(motion.buttons_up));
+    }
+
+    channel_->InvokeMethod("onCursorMoved",
+        std::make_unique<flutter::EncodableValue>(move_message));
+}
+
 // Display count change callback management
 void HardwareSimulatorPlugin::addDisplayCountChangedCallback(std::function<void(int)> callback, int callbackId) {
     std::lock_guard<std::mutex> lock(display_count_callbacks_mutex_);
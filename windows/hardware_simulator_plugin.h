@@ -13,6 +13,10 @@
 #include <functional>
 #include <map>
 #include "SmartKeyboardBlocker.h"
+#include "control_plane_executor.h"
+#include "cursor_motion_accumulator.h"
+#include "method_dispatch.h"
+#include "screen_transform.h"
 
 struct MonitorInfo {
     RECT rect;
@@ -50,10 +54,18 @@ class HardwareSimulatorPlugin : public flutter::Plugin {
   void LockCursor();
   void UnlockCursor();
   bool IsCursorLocked() const { return cursor_locked_; }
+
+  // Locked-cursor raw input is summed and delivered to Dart at |rate_hz|.
+  // 0 follows the refresh rate of the window's monitor, negative delivers
+  // every raw packet. Buttons and wheel are only reported when asked for.
+  void SetCursorMovedCoalescing(int rate_hz, bool include_buttons_and_wheel);
   
   // Static monitor management
   static void UpdateStaticMonitors();
-  static const std::vector<MonitorInfo>& GetStaticMonitors();
+  static std::vector<MonitorInfo> GetStaticMonitors();
+  // Snapshot of the monitor layout, rebuilt by UpdateStaticMonitors. It
+  // stays valid for as long as the returned reference is held.
+  static std::shared_ptr<const ScreenTransform> CurrentScreenTransform() { return screen_transforms_.Current(); }
   
   // Display count change callback management
   static void addDisplayCountChangedCallback(std::function<void(int)> callback, int callbackId);
@@ -62,7 +74,6 @@ class HardwareSimulatorPlugin : public flutter::Plugin {
 
  private:
   std::unique_ptr<flutter::MethodChannel<flutter::EncodableValue>> channel_;
-  std::unique_ptr<std::thread> monitor_thread_;
   bool immersive_mode_enabled_ = false;
   
   // Cursor lock related members
@@ -75,10 +86,20 @@ class HardwareSimulatorPlugin : public flutter::Plugin {
   // Raw Input related members
   bool raw_input_registered_ = false;
   std::optional<int> raw_input_proc_id_;
+  HWND raw_input_window_ = nullptr;
+
+  // Slow display, controller and service calls run here, off the platform thread.
+  std::unique_ptr<ControlPlaneExecutor> control_plane_;
+  std::optional<int> control_plane_proc_id_;
+
+  // Locked-cursor motion coalescing
+  CursorMotionAccumulator cursor_motion_;
+  int cursor_moved_rate_hz_ = 0;
+  bool cursor_moved_buttons_and_wheel_ = false;
   static std::optional<int> dpi_monitor_proc_id_;
   
   // Static monitor management
-  static std::vector<MonitorInfo> static_monitors_;
+  static ScreenTransformPublisher screen_transforms_;
   
   // Display count change callbacks
   static std::map<int, std::function<void(int)>> display_count_callbacks_;
@@ -90,6 +111,17 @@ class HardwareSimulatorPlugin : public flutter::Plugin {
   HWND FindFlutterWindow();
   bool SubscribeToRawInputData();
   void UnsubscribeFromRawInputData();
+  void StartCursorMotionTimer();
+  void FlushCursorMotion(int64_t now_us);
+  void SendCursorMotion(const CursorMotion& motion);
+  void DispatchControlPlaneCall(
+      MethodId method_id,
+      const flutter::EncodableMap* args,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleControlPlaneCall(
+      MethodId method_id,
+      const flutter::EncodableMap* args,
+      flutter::MethodResult<flutter::EncodableValue>* result);
 };
 
 }  // namespace hardware_simulator